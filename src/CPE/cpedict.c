@@ -41,6 +41,7 @@
 #include "common/xmlns_priv.h"
 #include "common/elements.h"
 #include "common/xmltext_priv.h"
+#include "common/oscap_profile.h"
 #include "source/oscap_source_priv.h"
 #include "source/public/oscap_source.h"
 #include <string.h>
@@ -49,8 +50,11 @@
 
 struct cpe_dict_model *cpe_dict_model_import_source(struct oscap_source *source)
 {
+	struct oscap_profile_span span;
+	oscap_profile_begin(&span, OSCAP_PROFILE_MODEL_PARSING);
 	xmlTextReader *reader = oscap_source_get_xmlTextReader(source);
 	if (reader == NULL) {
+		oscap_profile_end(&span);
 		return NULL;
 	}
 	struct cpe_dict_model *dict = NULL;
@@ -64,6 +68,7 @@ struct cpe_dict_model *cpe_dict_model_import_source(struct oscap_source *source)
 	}
 	cpe_parser_ctx_free(ctx);
 	xmlFreeTextReader(reader);
+	oscap_profile_end(&span);
 	return dict;
 }
 
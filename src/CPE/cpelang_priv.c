@@ -46,6 +46,7 @@
 #include "common/_error.h"
 #include "common/xmlns_priv.h"
 #include "common/xmltext_priv.h"
+#include "common/oscap_profile.h"
 #include "source/oscap_source_priv.h"
 #include "source/public/oscap_source.h"
 
@@ -218,6 +219,8 @@ struct cpe_platform *cpe_platform_new()
 
 struct cpe_lang_model *cpe_lang_model_import_source(struct oscap_source *source)
 {
+	struct oscap_profile_span span;
+	oscap_profile_begin(&span, OSCAP_PROFILE_MODEL_PARSING);
 	xmlTextReaderPtr reader = oscap_source_get_xmlTextReader(source);
 	struct cpe_lang_model *ret = NULL;
 
@@ -229,6 +232,7 @@ struct cpe_lang_model *cpe_lang_model_import_source(struct oscap_source *source)
 		}
 	}
 	xmlFreeTextReader(reader);
+	oscap_profile_end(&span);
 	return ret;
 }
 
@@ -30,6 +30,7 @@
 #include "common/_error.h"
 #include "common/list.h"
 #include "common/oscapxml.h"
+#include "common/oscap_profile.h"
 #include "common/public/oscap.h"
 #include "common/util.h"
 #include "ds_common.h"
@@ -37,6 +38,7 @@
 #include "ds_sds_session_priv.h"
 #include "sds_index_priv.h"
 #include "sds_priv.h"
+#include "sds_stream_priv.h"
 #include "source/oscap_source_priv.h"
 #include "source/public/oscap_source.h"
 #include "source/xslt_priv.h"
@@ -46,6 +48,9 @@
 struct ds_sds_session {
 	struct oscap_source *source;            ///< Source DataStream raw representation
 	struct ds_sds_index *index;             ///< Source DataStream index
+	struct ds_sds_stream *stream;           ///< Parts of the DataStream in its raw content
+	bool stream_scanned;                    ///< The raw content has been scanned for the parts
+	xmlDoc *datastreams;                    ///< DOM of the DataStream without its components
 	char *temp_dir;                         ///< Temp directory managed by the session
 	const char *target_dir;                 ///< Target directory for current split
 	const char *datastream_id;              ///< ID of selected datastream
@@ -84,6 +89,10 @@ void ds_sds_session_free(struct ds_sds_session *sds_session)
 {
 	if (sds_session != NULL) {
 		ds_sds_index_free(sds_session->index);
+		ds_sds_stream_free(sds_session->stream);
+		if (sds_session->datastreams != NULL) {
+			xmlFreeDoc(sds_session->datastreams);
+		}
 		if (sds_session->temp_dir != NULL) {
 			oscap_acquire_cleanup_dir(&(sds_session->temp_dir));
 		}
@@ -105,10 +114,33 @@ void ds_sds_session_reset(struct ds_sds_session *session)
 	session->component_uris = oscap_htable_new();
 }
 
+/**
+ * Get the parts of the DataStream in its raw content. Returns NULL when
+ * the content is not available or when it can't be split without DOM.
+ */
+static struct ds_sds_stream *ds_sds_session_get_stream(struct ds_sds_session *session, const char **buffer, size_t *size)
+{
+	*buffer = oscap_source_get_raw_buffer(session->source, size);
+	if (!session->stream_scanned) {
+		session->stream_scanned = true;
+		if (*buffer != NULL) {
+			session->stream = ds_sds_stream_new(*buffer, *size);
+		}
+	}
+	return *buffer != NULL ? session->stream : NULL;
+}
+
 struct ds_sds_index *ds_sds_session_get_sds_idx(struct ds_sds_session *session)
 {
 	if (session->index == NULL) {
-		xmlTextReader *reader = oscap_source_get_xmlTextReader(session->source);
+		const char *buffer;
+		size_t size;
+		xmlTextReader *reader;
+		if (ds_sds_session_get_stream(session, &buffer, &size) != NULL) {
+			reader = xmlReaderForMemory(buffer, size, oscap_source_readable_origin(session->source), NULL, 0);
+		} else {
+			reader = oscap_source_get_xmlTextReader(session->source);
+		}
 		if (reader == NULL) {
 			return NULL;
 		}
@@ -196,6 +228,10 @@ const char *ds_sds_session_get_readable_origin(const struct ds_sds_session *sess
 
 struct oscap_source *ds_sds_session_select_checklist(struct ds_sds_session *session, const char *datastream_id, const char *component_id, const char *benchmark_id)
 {
+	if (ds_sds_session_get_sds_idx(session) == NULL) {
+		// the error has been set while building the index
+		return NULL;
+	}
 	session->datastream_id = datastream_id;
 	session->checklist_id = component_id;
 
@@ -249,9 +285,25 @@ struct oscap_source *ds_sds_session_select_tailoring(struct ds_sds_session *sess
 	return tailoring;
 }
 
+static xmlDoc *ds_sds_session_get_datastreams(struct ds_sds_session *session)
+{
+	if (session->datastreams == NULL) {
+		const char *buffer;
+		size_t size;
+		struct ds_sds_stream *stream = ds_sds_session_get_stream(session, &buffer, &size);
+		if (stream != NULL) {
+			session->datastreams = ds_sds_stream_get_datastreams(stream, buffer);
+		}
+	}
+	return session->datastreams != NULL ? session->datastreams : oscap_source_get_xmlDoc(session->source);
+}
+
 xmlNode *ds_sds_session_get_selected_datastream(struct ds_sds_session *session)
 {
-	xmlDoc *doc = oscap_source_get_xmlDoc(session->source);
+	xmlDoc *doc = ds_sds_session_get_datastreams(session);
+	if (doc == NULL) {
+		return NULL;
+	}
 	xmlNode *datastream = ds_sds_lookup_datastream_in_collection(doc, session->datastream_id);
 	if (datastream == NULL) {
 		char *error = session->datastream_id ?
@@ -268,6 +320,21 @@ xmlDoc *ds_sds_session_get_xmlDoc(struct ds_sds_session *session)
 	return oscap_source_get_xmlDoc(session->source);
 }
 
+struct oscap_source *ds_sds_session_cut_component(struct ds_sds_session *session, const char *component_id, const char *relative_filepath)
+{
+	const char *buffer;
+	size_t size;
+	struct ds_sds_stream *stream = ds_sds_session_get_stream(session, &buffer, &size);
+	if (stream == NULL) {
+		return NULL;
+	}
+	char *component = ds_sds_stream_get_component(stream, buffer, component_id, &size);
+	if (component == NULL) {
+		return NULL;
+	}
+	return oscap_source_new_take_xml_memory(component, size, relative_filepath);
+}
+
 int ds_sds_session_register_component_source(struct ds_sds_session *session, const char *relative_filepath, struct oscap_source *component)
 {
 	if (!oscap_htable_add(session->component_sources, relative_filepath, component)) {
@@ -323,11 +390,14 @@ int ds_sds_session_register_component_with_dependencies(struct ds_sds_session *s
 	int res = -1;
 	xmlNode *component_ref = containter_get_component_ref_by_id(container, component_id);
 	if (component_ref != NULL) {
+		struct oscap_profile_span span;
+		oscap_profile_begin(&span, OSCAP_PROFILE_SDS_EXTRACTION);
 		if (target_filename == NULL) {
 			res = ds_sds_dump_component_ref(component_ref, session);
 		} else {
 			res = ds_sds_dump_component_ref_as(component_ref, session, "." , target_filename);
 		}
+		oscap_profile_end(&span);
 	}
 	else {
 		oscap_seterr(OSCAP_EFAMILY_XML, "No '%s' component ref found in file '%s' in datastream of id '%s'.",
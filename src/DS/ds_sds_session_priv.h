@@ -34,6 +34,12 @@
 
 xmlNode *ds_sds_session_get_selected_datastream(struct ds_sds_session *session);
 xmlDoc *ds_sds_session_get_xmlDoc(struct ds_sds_session *session);
+/**
+ * Cut a component out of the raw content of the DataStream without
+ * building DOM of the whole DataStream.
+ * @returns new source of the component or NULL if it has to be taken from DOM
+ */
+struct oscap_source *ds_sds_session_cut_component(struct ds_sds_session *session, const char *component_id, const char *relative_filepath);
 int ds_sds_session_register_component_source(struct ds_sds_session *session, const char *relative_filepath, struct oscap_source *component);
 const char *ds_sds_session_get_target_dir(struct ds_sds_session *session);
 struct oscap_htable *ds_sds_session_get_component_sources(struct ds_sds_session *session);
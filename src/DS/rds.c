@@ -32,6 +32,7 @@
 #include "common/util.h"
 #include "common/list.h"
 #include "common/debug_priv.h"
+#include "common/oscap_xml_stream.h"
 
 #include "ds_common.h"
 #include "ds_rds_session.h"
@@ -176,15 +177,22 @@ int ds_rds_dump_arf_content(struct ds_rds_session *session, const char *containe
 	return ds_rds_session_register_component_source(session, content_id, source);
 }
 
-xmlNodePtr ds_rds_create_report(xmlDocPtr target_doc, xmlNodePtr reports_node, xmlDocPtr source_doc, const char* report_id)
+static xmlNodePtr ds_rds_new_report(xmlDocPtr target_doc, const char *report_id, xmlNodePtr *report_content)
 {
 	xmlNsPtr arf_ns = xmlSearchNsByHref(target_doc, xmlDocGetRootElement(target_doc), BAD_CAST arf_ns_uri);
 
 	xmlNodePtr report = xmlNewNode(arf_ns, BAD_CAST "report");
 	xmlSetProp(report, BAD_CAST "id", BAD_CAST report_id);
 
-	xmlNodePtr report_content = xmlNewNode(arf_ns, BAD_CAST "content");
-	xmlAddChild(report, report_content);
+	*report_content = xmlNewNode(arf_ns, BAD_CAST "content");
+	xmlAddChild(report, *report_content);
+	return report;
+}
+
+xmlNodePtr ds_rds_create_report(xmlDocPtr target_doc, xmlNodePtr reports_node, xmlDocPtr source_doc, const char* report_id)
+{
+	xmlNodePtr report_content = NULL;
+	xmlNodePtr report = ds_rds_new_report(target_doc, report_id, &report_content);
 
 	xmlDOMWrapCtxtPtr wrap_ctxt = xmlDOMWrapNewCtxt();
 	xmlNodePtr res_node = NULL;
@@ -661,16 +669,9 @@ static void ds_rds_add_xccdf_test_results(xmlDocPtr doc, xmlNodePtr reports,
 	}
 }
 
-static int _ds_rds_create_from_dom(xmlDocPtr *ret, xmlDocPtr sds_doc,
-		xmlDocPtr tailoring_doc, const char *tailoring_filepath,
-		char *tailoring_doc_timestamp, xmlDocPtr xccdf_result_file_doc,
-		struct oscap_htable *oval_result_sources,
-		struct oscap_htable *oval_result_mapping,
-		struct oscap_htable *arf_report_mapping,
-		bool clone)
+static xmlDocPtr ds_rds_new_collection(xmlNodePtr *relationships, xmlNodePtr *assets,
+		xmlNodePtr *arf_content, xmlNodePtr *reports)
 {
-	*ret = NULL;
-
 	xmlDocPtr doc = xmlNewDoc(BAD_CAST "1.0");
 	xmlNodePtr root = xmlNewNode(NULL, BAD_CAST "asset-report-collection");
 	xmlDocSetRootElement(doc, root);
@@ -681,20 +682,115 @@ static int _ds_rds_create_from_dom(xmlDocPtr *ret, xmlDocPtr sds_doc,
 	xmlNsPtr core_ns = xmlNewNs(root, BAD_CAST core_ns_uri, BAD_CAST "core");
 	xmlNewNs(root, BAD_CAST ai_ns_uri, BAD_CAST "ai");
 
-	xmlNodePtr relationships = xmlNewNode(core_ns, BAD_CAST "relationships");
-	xmlNewNs(relationships, BAD_CAST arfvocab_ns_uri, BAD_CAST "arfvocab");
-	xmlAddChild(root, relationships);
+	*relationships = xmlNewNode(core_ns, BAD_CAST "relationships");
+	xmlNewNs(*relationships, BAD_CAST arfvocab_ns_uri, BAD_CAST "arfvocab");
+	xmlAddChild(root, *relationships);
 
 	xmlNodePtr report_requests = xmlNewNode(arf_ns, BAD_CAST "report-requests");
 	xmlAddChild(root, report_requests);
 
-	xmlNodePtr assets = xmlNewNode(arf_ns, BAD_CAST "assets");
-	xmlAddChild(root, assets);
+	*assets = xmlNewNode(arf_ns, BAD_CAST "assets");
+	xmlAddChild(root, *assets);
 
 	xmlNodePtr report_request = xmlNewNode(arf_ns, BAD_CAST "report-request");
 	xmlSetProp(report_request, BAD_CAST "id", BAD_CAST "collection1");
+	xmlAddChild(report_requests, report_request);
+
+	*arf_content = xmlNewNode(arf_ns, BAD_CAST "content");
+	xmlAddChild(report_request, *arf_content);
+
+	*reports = xmlNewNode(arf_ns, BAD_CAST "reports");
+	return doc;
+}
+
+/*
+ * Add a component with the user tailoring to the data stream collection
+ * sds_res_node and reference it from the checklists of its first data stream.
+ * The component ids are made unique within the collection, which is the
+ * original one the sds_res_node was copied from when it is being streamed.
+ */
+static void ds_rds_add_tailoring(xmlDocPtr doc, xmlNodePtr sds_res_node, xmlNodePtr collection,
+		xmlDocPtr tailoring_doc, const char *tailoring_filepath, const char *tailoring_doc_timestamp)
+{
+	char *mangled_tailoring_filepath = ds_sds_mangle_filepath(tailoring_filepath);
+	char *tailoring_component_id = oscap_sprintf("scap_org.open-scap_comp_%s_tailoring", mangled_tailoring_filepath);
+	char *tailoring_component_ref_id = oscap_sprintf("scap_org.open-scap_cref_%s_tailoring", mangled_tailoring_filepath);
+
+	// Need unique id (ref_id) - if generated already exists, then create new one
+	int counter = 0;
+	while (lookup_component_in_collection(collection, tailoring_component_id) != NULL) {
+		free(tailoring_component_id);
+		tailoring_component_id = oscap_sprintf("scap_org.open-scap_comp_%s_tailoring%03d", mangled_tailoring_filepath, counter++);
+	}
+
+	counter = 0;
+	while (ds_sds_find_component_ref(xmlDocGetRootElement((xmlDocPtr) collection)->children, tailoring_component_ref_id) != NULL) {
+		free(tailoring_component_ref_id);
+		tailoring_component_ref_id = oscap_sprintf("scap_org.open-scap_cref_%s_tailoring%03d", mangled_tailoring_filepath, counter++);
+	}
+
+	free(mangled_tailoring_filepath);
+
+	xmlDOMWrapCtxtPtr tailoring_wrap_ctxt = xmlDOMWrapNewCtxt();
+	xmlNodePtr tailoring_res_node = NULL;
+	xmlDOMWrapCloneNode(tailoring_wrap_ctxt, tailoring_doc, xmlDocGetRootElement(tailoring_doc),
+			&tailoring_res_node, doc, NULL, 1, 0);
+	xmlNsPtr sds_ns = sds_res_node->ns;
+	xmlNodePtr tailoring_component = xmlNewNode(sds_ns, BAD_CAST "component");
+	xmlSetProp(tailoring_component, BAD_CAST "id", BAD_CAST tailoring_component_id);
+	xmlSetProp(tailoring_component, BAD_CAST "timestamp", BAD_CAST tailoring_doc_timestamp);
+	xmlAddChild(tailoring_component, tailoring_res_node);
+	xmlAddChild(sds_res_node, tailoring_component);
+
+	xmlNodePtr checklists_element = NULL;
+	xmlNodePtr datastream_element = node_get_child_element(sds_res_node, "data-stream");
+	if (datastream_element == NULL) {
+		datastream_element = xmlNewNode(sds_ns, BAD_CAST "data-stream");
+		xmlAddChild(sds_res_node, datastream_element);
+		checklists_element = xmlNewNode(sds_ns, BAD_CAST "checklists");
+		xmlAddChild(datastream_element, checklists_element);
+	}
+	else {
+		checklists_element = node_get_child_element(datastream_element, "checklists");
+	}
+
+	xmlNodePtr tailoring_component_ref = xmlNewNode(sds_ns, BAD_CAST "component-ref");
+	xmlSetProp(tailoring_component_ref, BAD_CAST "id", BAD_CAST tailoring_component_ref_id);
+	free(tailoring_component_ref_id);
+	xmlNsPtr xlink_ns = xmlSearchNsByHref(doc, sds_res_node, BAD_CAST xlink_ns_uri);
+	if (!xlink_ns) {
+		xlink_ns = xmlNewNs(tailoring_component_ref, BAD_CAST xlink_ns_uri, BAD_CAST "xlink");
+	}
+	char *tailoring_cref_href = oscap_sprintf("#%s", tailoring_component_id);
+	free(tailoring_component_id);
+	xmlSetNsProp(tailoring_component_ref, xlink_ns, BAD_CAST "href", BAD_CAST tailoring_cref_href);
+	free(tailoring_cref_href);
+	xmlAddChild(checklists_element, tailoring_component_ref);
+
+	xmlDOMWrapReconcileNamespaces(tailoring_wrap_ctxt, tailoring_res_node, 0);
+	xmlDOMWrapFreeCtxt(tailoring_wrap_ctxt);
+}
 
-	xmlNodePtr arf_content = xmlNewNode(arf_ns, BAD_CAST "content");
+static xmlDocPtr ds_rds_get_oval_result_doc(const char *oval_filename, struct oscap_htable *oval_result_sources,
+		struct oscap_htable *oval_result_mapping, bool pop)
+{
+	const char *report_file = oscap_htable_get(oval_result_mapping, oval_filename);
+	struct oscap_source *oval_source = oscap_htable_get(oval_result_sources, report_file);
+	return pop ? oscap_source_pop_xmlDoc(oval_source) : oscap_source_get_xmlDoc(oval_source);
+}
+
+static int _ds_rds_create_from_dom(xmlDocPtr *ret, xmlDocPtr sds_doc,
+		xmlDocPtr tailoring_doc, const char *tailoring_filepath,
+		char *tailoring_doc_timestamp, xmlDocPtr xccdf_result_file_doc,
+		struct oscap_htable *oval_result_sources,
+		struct oscap_htable *oval_result_mapping,
+		struct oscap_htable *arf_report_mapping,
+		bool clone)
+{
+	*ret = NULL;
+
+	xmlNodePtr relationships, assets, arf_content, reports;
+	xmlDocPtr doc = ds_rds_new_collection(&relationships, &assets, &arf_content, &reports);
 
 	xmlDOMWrapCtxtPtr sds_wrap_ctxt = xmlDOMWrapNewCtxt();
 	xmlNodePtr sds_res_node = NULL;
@@ -710,71 +806,9 @@ static int _ds_rds_create_from_dom(xmlDocPtr *ret, xmlDocPtr sds_doc,
 	xmlDOMWrapFreeCtxt(sds_wrap_ctxt);
 
 	if (tailoring_doc && strcmp(tailoring_filepath, "NONEXISTENT")) {
-		char *mangled_tailoring_filepath = ds_sds_mangle_filepath(tailoring_filepath);
-		char *tailoring_component_id = oscap_sprintf("scap_org.open-scap_comp_%s_tailoring", mangled_tailoring_filepath);
-		char *tailoring_component_ref_id = oscap_sprintf("scap_org.open-scap_cref_%s_tailoring", mangled_tailoring_filepath);
-
-		// Need unique id (ref_id) - if generated already exists, then create new one
-		int counter = 0;
-		while (lookup_component_in_collection(sds_res_node, tailoring_component_id) != NULL) {
-			free(tailoring_component_id);
-			tailoring_component_id = oscap_sprintf("scap_org.open-scap_comp_%s_tailoring%03d", mangled_tailoring_filepath, counter++);
-		}
-
-		counter = 0;
-		while (ds_sds_find_component_ref(xmlDocGetRootElement((xmlDocPtr) sds_res_node)->children, tailoring_component_ref_id) != NULL) {
-			free(tailoring_component_ref_id);
-			tailoring_component_ref_id = oscap_sprintf("scap_org.open-scap_cref_%s_tailoring%03d", mangled_tailoring_filepath, counter++);
-		}
-
-		free(mangled_tailoring_filepath);
-
-		xmlDOMWrapCtxtPtr tailoring_wrap_ctxt = xmlDOMWrapNewCtxt();
-		xmlNodePtr tailoring_res_node = NULL;
-		xmlDOMWrapCloneNode(tailoring_wrap_ctxt, tailoring_doc, xmlDocGetRootElement(tailoring_doc),
-				&tailoring_res_node, doc, NULL, 1, 0);
-		xmlNsPtr sds_ns = sds_res_node->ns;
-		xmlNodePtr tailoring_component = xmlNewNode(sds_ns, BAD_CAST "component");
-		xmlSetProp(tailoring_component, BAD_CAST "id", BAD_CAST tailoring_component_id);
-		xmlSetProp(tailoring_component, BAD_CAST "timestamp", BAD_CAST tailoring_doc_timestamp);
-		xmlAddChild(tailoring_component, tailoring_res_node);
-		xmlAddChild(sds_res_node, tailoring_component);
-
-		xmlNodePtr checklists_element = NULL;
-		xmlNodePtr datastream_element = node_get_child_element(sds_res_node, "data-stream");
-		if (datastream_element == NULL) {
-			datastream_element = xmlNewNode(sds_ns, BAD_CAST "data-stream");
-			xmlAddChild(sds_res_node, datastream_element);
-			checklists_element = xmlNewNode(sds_ns, BAD_CAST "checklists");
-			xmlAddChild(datastream_element, checklists_element);
-		}
-		else {
-			checklists_element = node_get_child_element(datastream_element, "checklists");
-		}
-
-		xmlNodePtr tailoring_component_ref = xmlNewNode(sds_ns, BAD_CAST "component-ref");
-		xmlSetProp(tailoring_component_ref, BAD_CAST "id", BAD_CAST tailoring_component_ref_id);
-		free(tailoring_component_ref_id);
-		xmlNsPtr xlink_ns = xmlSearchNsByHref(doc, sds_res_node, BAD_CAST xlink_ns_uri);
-		if (!xlink_ns) {
-			xlink_ns = xmlNewNs(tailoring_component_ref, BAD_CAST xlink_ns_uri, BAD_CAST "xlink");
-		}
-		char *tailoring_cref_href = oscap_sprintf("#%s", tailoring_component_id);
-		free(tailoring_component_id);
-		xmlSetNsProp(tailoring_component_ref, xlink_ns, BAD_CAST "href", BAD_CAST tailoring_cref_href);
-		free(tailoring_cref_href);
-		xmlAddChild(checklists_element, tailoring_component_ref);
-
-		xmlDOMWrapReconcileNamespaces(tailoring_wrap_ctxt, tailoring_res_node, 0);
-		xmlDOMWrapFreeCtxt(tailoring_wrap_ctxt);
+		ds_rds_add_tailoring(doc, sds_res_node, sds_res_node, tailoring_doc, tailoring_filepath, tailoring_doc_timestamp);
 	}
 
-	xmlAddChild(report_request, arf_content);
-
-	xmlAddChild(report_requests, report_request);
-
-	xmlNodePtr reports = xmlNewNode(arf_ns, BAD_CAST "reports");
-
 	ds_rds_add_xccdf_test_results(doc, reports, xccdf_result_file_doc,
 			relationships, assets, "collection1", arf_report_mapping);
 
@@ -783,15 +817,13 @@ static int _ds_rds_create_from_dom(xmlDocPtr *ret, xmlDocPtr sds_doc,
 		const struct oscap_htable_item *report_mapping_item = oscap_htable_iterator_next(hit);
 		const char *oval_filename = report_mapping_item->key;
 		const char *report_id = report_mapping_item->value;
-		const char *report_file = oscap_htable_get(oval_result_mapping, oval_filename);
-		struct oscap_source *oval_source = oscap_htable_get(oval_result_sources, report_file);
-		xmlDoc *oval_result_doc = oscap_source_get_xmlDoc(oval_source);
+		xmlDoc *oval_result_doc = ds_rds_get_oval_result_doc(oval_filename, oval_result_sources, oval_result_mapping, false);
 
 		ds_rds_create_report(doc, reports, oval_result_doc, report_id);
 	}
 	oscap_htable_iterator_free(hit);
 
-	xmlAddChild(root, reports);
+	xmlAddChild(xmlDocGetRootElement(doc), reports);
 
 	*ret = doc;
 	return 0;
@@ -823,6 +855,185 @@ static int ds_rds_create_from_dom_clone(xmlDocPtr *ret, xmlDocPtr sds_doc,
 			arf_report_mapping, true);
 }
 
+int ds_rds_export_from_dom(const char *target_file, xmlDocPtr sds_doc,
+		xmlDocPtr tailoring_doc, const char *tailoring_filepath,
+		const char *tailoring_doc_timestamp, xmlDocPtr xccdf_result_file_doc,
+		struct oscap_htable *oval_result_sources,
+		struct oscap_htable *oval_result_mapping,
+		struct oscap_htable *arf_report_mapping)
+{
+	xmlNodePtr relationships, assets, arf_content, reports;
+	xmlDocPtr doc = ds_rds_new_collection(&relationships, &assets, &arf_content, &reports);
+	xmlNodePtr root = xmlDocGetRootElement(doc);
+
+	// Only the start tag of the data stream collection is copied, its
+	// children are written straight from the source document.
+	xmlNodePtr sds_root = xmlDocGetRootElement(sds_doc);
+	xmlNodePtr sds_res_node = xmlDocCopyNode(sds_root, doc, 2);
+	xmlAddChild(arf_content, sds_res_node);
+
+	// The tailoring goes to a copy of the first data stream, which replaces
+	// the original one in the output, and to new nodes appended after the
+	// children of the collection.
+	xmlNodePtr datastream_element = node_get_child_element(sds_root, "data-stream");
+	xmlNodePtr datastream_copy = NULL;
+	xmlNodePtr tailoring_nodes = xmlNewDocNode(doc, NULL, BAD_CAST "tailoring", NULL);
+	if (tailoring_doc && strcmp(tailoring_filepath, "NONEXISTENT")) {
+		if (datastream_element != NULL) {
+			xmlDOMWrapCtxtPtr wrap_ctxt = xmlDOMWrapNewCtxt();
+			xmlDOMWrapCloneNode(wrap_ctxt, sds_doc, datastream_element,
+					&datastream_copy, doc, sds_res_node, 1, 0);
+			xmlAddChild(sds_res_node, datastream_copy);
+			xmlDOMWrapFreeCtxt(wrap_ctxt);
+		}
+		ds_rds_add_tailoring(doc, sds_res_node, sds_root, tailoring_doc, tailoring_filepath, tailoring_doc_timestamp);
+		if (datastream_copy != NULL)
+			xmlUnlinkNode(datastream_copy);
+		while (sds_res_node->children != NULL) {
+			xmlNodePtr node = sds_res_node->children;
+			xmlUnlinkNode(node);
+			xmlAddChild(tailoring_nodes, node);
+		}
+	}
+
+	ds_rds_add_xccdf_test_results(doc, reports, xccdf_result_file_doc,
+			relationships, assets, "collection1", arf_report_mapping);
+	xmlAddChild(root, reports);
+
+	struct oscap_xml_stream *stream = oscap_xml_stream_new(target_file, doc);
+	if (stream == NULL) {
+		xmlFreeNode(datastream_copy);
+		xmlFreeNode(tailoring_nodes);
+		xmlFreeDoc(doc);
+		return -1;
+	}
+	xmlNodePtr report_request = arf_content->parent;
+	xmlNodePtr report_requests = report_request->parent;
+	oscap_xml_stream_open(stream, root);
+	oscap_xml_stream_open(stream, report_requests);
+	oscap_xml_stream_open(stream, report_request);
+	oscap_xml_stream_open(stream, arf_content);
+	oscap_xml_stream_open(stream, sds_res_node);
+	for (xmlNodePtr child = sds_root->children; child != NULL; child = child->next) {
+		if (child == datastream_element && datastream_copy != NULL)
+			oscap_xml_stream_write(stream, doc, datastream_copy);
+		else
+			oscap_xml_stream_write(stream, sds_doc, child);
+	}
+	xmlFreeNode(datastream_copy);
+	while (tailoring_nodes->children != NULL) {
+		xmlNodePtr node = tailoring_nodes->children;
+		xmlUnlinkNode(node);
+		xmlAddChild(sds_res_node, node);
+	}
+	xmlFreeNode(tailoring_nodes);
+	oscap_xml_stream_close(stream, sds_res_node);
+	oscap_xml_stream_close(stream, arf_content);
+	oscap_xml_stream_close(stream, report_request);
+	oscap_xml_stream_close(stream, report_requests);
+
+	// Test results are small, they have already been copied into reports.
+	// OVAL results are written one at a time from their own documents.
+	oscap_xml_stream_open(stream, reports);
+	oscap_xml_stream_flush(stream, reports);
+	struct oscap_htable_iterator *hit = oscap_htable_iterator_new(arf_report_mapping);
+	while (oscap_htable_iterator_has_more(hit)) {
+		const struct oscap_htable_item *report_mapping_item = oscap_htable_iterator_next(hit);
+		xmlDoc *oval_result_doc = ds_rds_get_oval_result_doc(report_mapping_item->key, oval_result_sources, oval_result_mapping, false);
+
+		xmlNodePtr report_content = NULL;
+		xmlNodePtr report = ds_rds_new_report(doc, report_mapping_item->value, &report_content);
+		xmlAddChild(reports, report);
+		oscap_xml_stream_open(stream, report);
+		oscap_xml_stream_open(stream, report_content);
+		oscap_xml_stream_write(stream, oval_result_doc, xmlDocGetRootElement(oval_result_doc));
+		oscap_xml_stream_close(stream, report_content);
+		oscap_xml_stream_close(stream, report);
+	}
+	oscap_htable_iterator_free(hit);
+	oscap_xml_stream_close(stream, reports);
+	oscap_xml_stream_close(stream, root);
+
+	int ret = oscap_xml_stream_free(stream);
+	xmlFreeDoc(doc);
+	return ret;
+}
+
+static bool ds_rds_is_checklist_component(xmlNodePtr component)
+{
+	if (component->type != XML_ELEMENT_NODE || !oscap_streq((const char *) component->name, "component"))
+		return false;
+
+	for (xmlNodePtr child = component->children; child != NULL; child = child->next) {
+		if (child->type != XML_ELEMENT_NODE)
+			continue;
+		return oscap_streq((const char *) child->name, "Benchmark") ||
+			oscap_streq((const char *) child->name, "Tailoring");
+	}
+	return false;
+}
+
+static void ds_rds_move_node(xmlDocPtr source_doc, xmlNodePtr node, xmlDocPtr doc, xmlNodePtr parent)
+{
+	xmlUnlinkNode(node);
+	xmlDOMWrapCtxtPtr wrap_ctxt = xmlDOMWrapNewCtxt();
+	xmlDOMWrapAdoptNode(wrap_ctxt, source_doc, node, doc, parent, 0);
+	xmlAddChild(parent, node);
+	xmlDOMWrapReconcileNamespaces(wrap_ctxt, node, 0);
+	xmlDOMWrapFreeCtxt(wrap_ctxt);
+}
+
+int ds_rds_create_report_index(xmlDocPtr *ret, xmlDocPtr sds_doc,
+		xmlDocPtr tailoring_doc, const char *tailoring_filepath,
+		const char *tailoring_doc_timestamp, xmlDocPtr xccdf_result_file_doc,
+		struct oscap_htable *oval_result_sources,
+		struct oscap_htable *oval_result_mapping,
+		struct oscap_htable *arf_report_mapping)
+{
+	xmlNodePtr relationships, assets, arf_content, reports;
+	xmlDocPtr doc = ds_rds_new_collection(&relationships, &assets, &arf_content, &reports);
+
+	xmlNodePtr sds_root = xmlDocGetRootElement(sds_doc);
+	xmlNodePtr sds_res_node = xmlDocCopyNode(sds_root, doc, 2);
+	xmlAddChild(arf_content, sds_res_node);
+
+	// The tailoring ids are made unique within the whole collection before
+	// its checklist components are moved out, the same as in the ARF export.
+	if (tailoring_doc && strcmp(tailoring_filepath, "NONEXISTENT")) {
+		ds_rds_add_tailoring(doc, sds_res_node, sds_root, tailoring_doc, tailoring_filepath, tailoring_doc_timestamp);
+	}
+	xmlNodePtr child = sds_root->children;
+	while (child != NULL) {
+		xmlNodePtr next = child->next;
+		if (ds_rds_is_checklist_component(child))
+			ds_rds_move_node(sds_doc, child, doc, sds_res_node);
+		child = next;
+	}
+
+	ds_rds_add_xccdf_test_results(doc, reports, xccdf_result_file_doc,
+			relationships, assets, "collection1", arf_report_mapping);
+
+	struct oscap_htable_iterator *hit = oscap_htable_iterator_new(arf_report_mapping);
+	while (oscap_htable_iterator_has_more(hit)) {
+		const struct oscap_htable_item *report_mapping_item = oscap_htable_iterator_next(hit);
+		xmlDoc *oval_result_doc = ds_rds_get_oval_result_doc(report_mapping_item->key, oval_result_sources, oval_result_mapping, true);
+		if (oval_result_doc == NULL)
+			continue;
+
+		xmlNodePtr report_content = NULL;
+		xmlNodePtr report = ds_rds_new_report(doc, report_mapping_item->value, &report_content);
+		xmlAddChild(reports, report);
+		ds_rds_move_node(oval_result_doc, xmlDocGetRootElement(oval_result_doc), doc, report_content);
+		xmlFreeDoc(oval_result_doc);
+	}
+	oscap_htable_iterator_free(hit);
+
+	xmlAddChild(xmlDocGetRootElement(doc), reports);
+
+	*ret = doc;
+	return 0;
+}
+
 struct oscap_source *ds_rds_create_source(struct oscap_source *sds_source, struct oscap_source *tailoring_source, struct oscap_source *xccdf_result_source, struct oscap_htable *oval_result_sources, struct oscap_htable *oval_result_mapping, struct oscap_htable *arf_report_mapping, const char *target_file)
 {
 	xmlDoc *sds_doc = oscap_source_get_xmlDoc(sds_source);
@@ -892,12 +1103,14 @@ int ds_rds_create(const char* sds_file, const char* xccdf_result_file, const cha
 		}
 	}
 	if (result == 0) {
-		struct oscap_source *target_rds = ds_rds_create_source(sds_source, NULL, xccdf_result_source, oval_result_sources, oval_result_mapping, arf_report_mapping, target_file);
-		result = target_rds == NULL;
-		if (result == 0) {
-			result = oscap_source_save_as(target_rds, NULL);
+		xmlDoc *sds_doc = oscap_source_get_xmlDoc(sds_source);
+		xmlDoc *result_file_doc = oscap_source_get_xmlDoc(xccdf_result_source);
+		if (sds_doc == NULL || result_file_doc == NULL) {
+			result = -1;
+		} else {
+			result = ds_rds_export_from_dom(target_file, sds_doc, NULL, NULL, NULL, result_file_doc,
+					oval_result_sources, oval_result_mapping, arf_report_mapping);
 		}
-		oscap_source_free(target_rds);
 	}
 	oscap_htable_free(oval_result_sources, (oscap_destruct_func) oscap_source_free);
 	oscap_htable_free(oval_result_mapping, (oscap_destruct_func) free);
@@ -40,4 +40,19 @@ struct oscap_source *ds_rds_create_source(struct oscap_source *sds_source, struc
 xmlNodePtr ds_rds_create_report(xmlDocPtr target_doc, xmlNodePtr reports_node, xmlDocPtr source_doc, const char* report_id);
 
 int ds_rds_create_from_dom(xmlDocPtr* ret, xmlDocPtr sds_doc, xmlDocPtr tailoring_doc, const char* tailoring_filepath, char *tailoring_doc_timestamp, xmlDocPtr xccdf_result_file_doc, struct oscap_htable* oval_result_sources, struct oscap_htable* oval_result_mapping, struct oscap_htable *arf_report_mapping);
+
+/*
+ * Write the ARF straight to target_file. The data stream collection and the
+ * OVAL results are copied to the output from their own documents, so the
+ * result data stream is never assembled in memory.
+ */
+int ds_rds_export_from_dom(const char *target_file, xmlDocPtr sds_doc, xmlDocPtr tailoring_doc, const char *tailoring_filepath, const char *tailoring_doc_timestamp, xmlDocPtr xccdf_result_file_doc, struct oscap_htable *oval_result_sources, struct oscap_htable *oval_result_mapping, struct oscap_htable *arf_report_mapping);
+
+/*
+ * Create an ARF which holds only what the HTML report is generated from:
+ * the XCCDF checklists, the tailoring and the reports. The checklist
+ * components are moved from sds_doc and the OVAL results documents are
+ * taken over from oval_result_sources.
+ */
+int ds_rds_create_report_index(xmlDocPtr *ret, xmlDocPtr sds_doc, xmlDocPtr tailoring_doc, const char *tailoring_filepath, const char *tailoring_doc_timestamp, xmlDocPtr xccdf_result_file_doc, struct oscap_htable *oval_result_sources, struct oscap_htable *oval_result_mapping, struct oscap_htable *arf_report_mapping);
 #endif
@@ -239,6 +239,14 @@ static int ds_sds_register_sce(struct ds_sds_session *session, xmlNodePtr compon
 	return ret;
 }
 
+static int ds_sds_register_source(struct ds_sds_session *session, struct oscap_source *component_source, const char *relative_filepath)
+{
+	if (ds_sds_session_register_component_source(session, relative_filepath, component_source) != 0) {
+		oscap_source_free(component_source);
+	}
+	return 0; // TODO: Return value of ds_sds_session_register_component_source(). (commit message)
+}
+
 static int ds_sds_register_xmlDoc(struct ds_sds_session *session, xmlDoc* doc, xmlNodePtr component_inner_root, const char *relative_filepath)
 {
 	xmlDoc *new_doc = ds_doc_from_foreign_node(component_inner_root, doc);
@@ -247,11 +255,7 @@ static int ds_sds_register_xmlDoc(struct ds_sds_session *session, xmlDoc* doc, x
 	}
 
 	struct oscap_source *component_source = oscap_source_new_from_xmlDoc(new_doc, relative_filepath);
-
-	if (ds_sds_session_register_component_source(session, relative_filepath, component_source) != 0) {
-		oscap_source_free(component_source);
-	}
-	return 0; // TODO: Return value of ds_sds_session_register_component_source(). (commit message)
+	return ds_sds_register_source(session, component_source, relative_filepath);
 }
 
 static int ds_sds_register_component(struct ds_sds_session *session, xmlDoc* doc, xmlNodePtr component_inner_root, const char* component_id, const char* target_filename_dirname, const char* relative_filepath)
@@ -293,7 +297,17 @@ static xmlNodePtr ds_sds_get_component_root_by_id(xmlDoc *doc, const char* compo
 
 static int ds_sds_dump_local_component(const char* component_id, struct ds_sds_session *session, const char *target_filename_dirname, const char *relative_filepath)
 {
+	// Parse the component on its own if it can be cut out of the raw
+	// DataStream, scripts and broken components are handled by DOM.
+	struct oscap_source *component_source = ds_sds_session_cut_component(session, component_id, relative_filepath);
+	if (component_source != NULL) {
+		return ds_sds_register_source(session, component_source, relative_filepath);
+	}
+
 	xmlDoc *doc = ds_sds_session_get_xmlDoc(session);
+	if (doc == NULL) {
+		return -1;
+	}
 
 	xmlNodePtr inner_root = ds_sds_get_component_root_by_id(doc, component_id);
 
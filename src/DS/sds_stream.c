@@ -0,0 +1,757 @@
+/*
+ * Copyright 2026 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <ctype.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#include <libxml/parser.h>
+#include <libxml/tree.h>
+
+#include "common/debug_priv.h"
+#include "common/list.h"
+#include "common/util.h"
+#include "sds_stream_priv.h"
+
+struct sds_range {
+	size_t start;
+	size_t end;                     ///< the first byte after the range
+};
+
+struct sds_ns {
+	struct sds_range prefix;        ///< empty for the default namespace
+	struct sds_range uri;           ///< value of the xmlns attribute
+	struct sds_range decl;          ///< the whole xmlns attribute
+};
+
+/* Declaration of a namespace used inside of a component but declared outside */
+struct sds_insert {
+	size_t at;                      ///< end of the start tag of the element using the namespace
+	struct sds_range decl;
+};
+
+struct sds_component {
+	size_t start;                   ///< start of the root element of the component
+	size_t end;                     ///< end of the root element
+	bool script;                    ///< the root element is a script
+	struct sds_insert *ns;          ///< declarations to be added, ordered by position
+	size_t ns_count;
+	size_t ns_alloc;
+};
+
+struct ds_sds_stream {
+	struct sds_range root;          ///< start tag of the root element
+	size_t root_end;                ///< end of the root element
+	size_t size;                    ///< size of the raw content
+	struct sds_range root_name;     ///< qualified name of the root element
+	bool root_empty;                ///< the root element has no content
+	struct sds_range *datastreams;  ///< ds:data-stream elements
+	size_t datastream_count;
+	size_t datastreams_alloc;
+	struct oscap_htable *components;        ///< maps component IDs to struct sds_component
+};
+
+struct sds_element {
+	struct sds_range name;
+	size_t ns_count;                ///< namespace declarations in scope before the element
+};
+
+struct sds_scan {
+	const char *buf;
+	size_t size;
+	size_t pos;
+	struct ds_sds_stream *stream;
+
+	struct sds_ns *ns;              ///< namespace declarations in scope
+	size_t ns_count;
+	size_t ns_alloc;
+	struct sds_element *elements;   ///< open elements
+	size_t depth;
+	size_t elements_alloc;
+	struct sds_range *attrs;        ///< names of the attributes of the current start tag
+	size_t attr_count;
+	size_t attrs_alloc;
+
+	size_t datastream_start;
+	bool in_datastream;
+	struct sds_component *component;        ///< component being scanned
+	struct sds_range component_id;
+	bool in_inner;                  ///< inside of the root element of the component
+	size_t inner_ns;                ///< first namespace declaration inside of the component
+};
+
+static const char *sds_ns_uri = "http://scap.nist.gov/schema/scap/source/1.2";
+
+/* Make room for one more item of the array, returns false if there is no memory */
+static bool sds_grow(void **array, size_t count, size_t *alloc, size_t item_size)
+{
+	if (count < *alloc)
+		return true;
+	size_t new_alloc = *alloc == 0 ? 16 : 2 * *alloc;
+	void *new_array = realloc(*array, new_alloc * item_size);
+	if (new_array == NULL)
+		return false;
+	*array = new_array;
+	*alloc = new_alloc;
+	return true;
+}
+
+#define SDS_GROW(array, count, alloc) sds_grow((void **) &(array), (count), &(alloc), sizeof(*(array)))
+
+static void sds_component_free(struct sds_component *component)
+{
+	if (component != NULL) {
+		free(component->ns);
+		free(component);
+	}
+}
+
+void ds_sds_stream_free(struct ds_sds_stream *stream)
+{
+	if (stream != NULL) {
+		free(stream->datastreams);
+		oscap_htable_free(stream->components, (oscap_destruct_func) sds_component_free);
+		free(stream);
+	}
+}
+
+/* UTF-8 without characters that are not allowed in XML 1.0 */
+static bool sds_valid_chars(const unsigned char *buf, size_t size)
+{
+	size_t i = 0;
+
+	while (i < size) {
+		unsigned char c = buf[i];
+		if (c < 0x80) {
+			if (c < 0x20 && c != '\t' && c != '\n' && c != '\r')
+				return false;
+			++i;
+			continue;
+		}
+
+		size_t len;
+		unsigned int cp;
+		if ((c & 0xE0) == 0xC0) {
+			len = 2;
+			cp = c & 0x1F;
+		} else if ((c & 0xF0) == 0xE0) {
+			len = 3;
+			cp = c & 0x0F;
+		} else if ((c & 0xF8) == 0xF0) {
+			len = 4;
+			cp = c & 0x07;
+		} else {
+			return false;
+		}
+		if (i + len > size)
+			return false;
+		for (size_t j = 1; j < len; ++j) {
+			if ((buf[i + j] & 0xC0) != 0x80)
+				return false;
+			cp = (cp << 6) | (buf[i + j] & 0x3F);
+		}
+		if ((len == 2 && cp < 0x80) || (len == 3 && cp < 0x800) || (len == 4 && cp < 0x10000) ||
+		    cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF) || cp == 0xFFFE || cp == 0xFFFF)
+			return false;
+		i += len;
+	}
+
+	return true;
+}
+
+static inline bool sds_is_space(char c)
+{
+	return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+/* ASCII subset of XML name characters, anything beyond ASCII is left to libxml2 */
+static inline bool sds_is_name_char(char c)
+{
+	return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+		c == '_' || c == ':' || c == '-' || c == '.' || (unsigned char) c >= 0x80;
+}
+
+static inline bool sds_is_name_start(char c)
+{
+	return sds_is_name_char(c) && !(c >= '0' && c <= '9') && c != '-' && c != '.' && c != ':';
+}
+
+/* Name of an element or attribute with at most one prefix */
+static bool sds_valid_qname(const char *name, size_t len)
+{
+	const char *colon = memchr(name, ':', len);
+
+	if (len == 0 || !sds_is_name_start(name[0]))
+		return false;
+	if (colon == NULL)
+		return true;
+	++colon;
+	len -= colon - name;
+	return len > 0 && sds_is_name_start(colon[0]) && memchr(colon, ':', len) == NULL;
+}
+
+static bool sds_range_eq(const struct sds_scan *scan, struct sds_range a, struct sds_range b)
+{
+	return a.end - a.start == b.end - b.start &&
+		memcmp(scan->buf + a.start, scan->buf + b.start, a.end - a.start) == 0;
+}
+
+static bool sds_range_is(const struct sds_scan *scan, struct sds_range r, const char *str)
+{
+	size_t len = strlen(str);
+	return r.end - r.start == len && memcmp(scan->buf + r.start, str, len) == 0;
+}
+
+static struct sds_range sds_prefix(const struct sds_scan *scan, struct sds_range name)
+{
+	const char *colon = memchr(scan->buf + name.start, ':', name.end - name.start);
+	struct sds_range prefix = { name.start, colon == NULL ? name.start : (size_t)(colon - scan->buf) };
+	return prefix;
+}
+
+static struct sds_range sds_local_name(const struct sds_scan *scan, struct sds_range name)
+{
+	struct sds_range prefix = sds_prefix(scan, name);
+	struct sds_range local = { prefix.end == prefix.start ? name.start : prefix.end + 1, name.end };
+	return local;
+}
+
+/* Length of a predefined entity or character reference, 0 if it isn't one */
+static size_t sds_reference(const char *ref, const char *end)
+{
+	static const char *entities[] = { "&amp;", "&lt;", "&gt;", "&quot;", "&apos;" };
+
+	for (size_t i = 0; i < sizeof(entities) / sizeof(entities[0]); ++i) {
+		size_t len = strlen(entities[i]);
+		if ((size_t)(end - ref) >= len && memcmp(ref, entities[i], len) == 0)
+			return len;
+	}
+
+	const char *p = ref + 1;
+	if (p == end || *p != '#')
+		return 0;
+	++p;
+	bool hex = p < end && *p == 'x';
+	if (hex)
+		++p;
+	const char *digits = p;
+	unsigned long cp = 0;
+	while (p < end && (hex ? isxdigit((unsigned char) *p) : isdigit((unsigned char) *p))) {
+		if (cp <= 0x10FFFF)
+			cp = cp * (hex ? 16 : 10) + (isdigit((unsigned char) *p) ? *p - '0' : (tolower((unsigned char) *p) - 'a' + 10));
+		++p;
+	}
+	if (p == digits || p == end || *p != ';')
+		return 0;
+	// the character has to be allowed in XML 1.0
+	if (!(cp == 0x9 || cp == 0xA || cp == 0xD || (cp >= 0x20 && cp <= 0xD7FF) ||
+	      (cp >= 0xE000 && cp <= 0xFFFD) || (cp >= 0x10000 && cp <= 0x10FFFF)))
+		return 0;
+	return p + 1 - ref;
+}
+
+/* Character data may only contain the references that need no DTD */
+static bool sds_valid_text(const char *text, const char *end, bool attribute)
+{
+	while (text < end) {
+		if (*text == '&') {
+			size_t len = sds_reference(text, end);
+			if (len == 0)
+				return false;
+			text += len;
+			continue;
+		}
+		if (attribute && *text == '<')
+			return false;
+		if (!attribute && *text == ']' && end - text >= 3 && memcmp(text, "]]>", 3) == 0)
+			return false;
+		++text;
+	}
+	return true;
+}
+
+/* Only UTF-8 content is cut into pieces, libxml2 assumes UTF-8 when there is no XML declaration */
+static bool sds_valid_declaration(const char *decl, const char *end)
+{
+	const char *encoding = NULL;
+
+	for (const char *p = decl; p + 8 <= end; ++p) {
+		if (memcmp(p, "encoding", 8) == 0) {
+			encoding = p + 8;
+			break;
+		}
+	}
+	if (encoding == NULL)
+		return true;
+
+	while (encoding < end && (sds_is_space(*encoding) || *encoding == '='))
+		++encoding;
+	if (encoding == end || (*encoding != '"' && *encoding != '\''))
+		return false;
+	const char *value = encoding + 1;
+	const char *value_end = memchr(value, *encoding, end - value);
+	if (value_end == NULL)
+		return false;
+
+	static const char *utf8[] = { "UTF-8", "UTF8", "US-ASCII", "ASCII" };
+	for (size_t i = 0; i < sizeof(utf8) / sizeof(utf8[0]); ++i) {
+		if ((size_t)(value_end - value) == strlen(utf8[i]) && strncasecmp(value, utf8[i], value_end - value) == 0)
+			return true;
+	}
+	return false;
+}
+
+/* Skip markup that isn't an element, returns false if it isn't well-formed or not supported */
+static bool sds_skip_markup(struct sds_scan *scan)
+{
+	const char *p = scan->buf + scan->pos;
+	const char *end = scan->buf + scan->size;
+	const char *terminator;
+	size_t skip;
+
+	if (end - p >= 2 && memcmp(p, "<?", 2) == 0) {
+		terminator = "?>";
+		skip = 2;
+	} else if (end - p >= 4 && memcmp(p, "<!--", 4) == 0) {
+		terminator = "-->";
+		skip = 4;
+	} else if (scan->depth > 0 && end - p >= 9 && memcmp(p, "<![CDATA[", 9) == 0) {
+		terminator = "]]>";
+		skip = 9;
+	} else {
+		// DOCTYPE can declare entities and default attributes
+		return false;
+	}
+
+	const char *found = memmem(p + skip, end - p - skip, terminator, strlen(terminator));
+	if (found == NULL)
+		return false;
+
+	if (skip == 4) {
+		// "--" must not occur within comments
+		if (memmem(p + skip, found - p - skip, "--", 2) != NULL || (found > p + skip && found[-1] == '-'))
+			return false;
+	} else if (skip == 2) {
+		const char *target = p + 2;
+		while (target < found && sds_is_name_char(*target))
+			++target;
+		if (target == p + 2 || (target < found && !sds_is_space(*target)))
+			return false;
+		if (target - p == 5 && strncasecmp(p + 2, "xml", 3) == 0) {
+			// only the XML declaration may be called so, it is checked by libxml2 later
+			if (scan->pos != 0 && !(scan->pos == 3 && memcmp(scan->buf, "\xEF\xBB\xBF", 3) == 0))
+				return false;
+			if (!sds_valid_declaration(p, found))
+				return false;
+		}
+	}
+
+	scan->pos = found + strlen(terminator) - scan->buf;
+	return true;
+}
+
+/* The element is in the namespace of Source DataStreams */
+static bool sds_in_ds_ns(const struct sds_scan *scan, struct sds_range name)
+{
+	struct sds_range prefix = sds_prefix(scan, name);
+
+	for (size_t i = scan->ns_count; i-- > 0;) {
+		if (sds_range_eq(scan, scan->ns[i].prefix, prefix))
+			return sds_range_is(scan, scan->ns[i].uri, sds_ns_uri);
+	}
+	return false;
+}
+
+/*
+ * Namespace used inside of the component but declared outside is declared
+ * on the element using it, as xmlDOMWrapCloneNode does when the component
+ * is copied out of DOM.
+ */
+static bool sds_resolve(struct sds_scan *scan, struct sds_range prefix, size_t tag_end)
+{
+	for (size_t i = scan->ns_count; i-- > 0;) {
+		if (!sds_range_eq(scan, scan->ns[i].prefix, prefix))
+			continue;
+		if (i >= scan->inner_ns)
+			return true;
+
+		struct sds_component *component = scan->component;
+		if (!SDS_GROW(component->ns, component->ns_count, component->ns_alloc))
+			return false;
+		component->ns[component->ns_count].at = tag_end;
+		component->ns[component->ns_count].decl = scan->ns[i].decl;
+		component->ns_count++;
+
+		// descendants of the element see the added declaration
+		if (!SDS_GROW(scan->ns, scan->ns_count, scan->ns_alloc))
+			return false;
+		scan->ns[scan->ns_count] = scan->ns[i];
+		scan->ns_count++;
+		return true;
+	}
+
+	// no prefix means no namespace, "xml" is bound by definition
+	return prefix.start == prefix.end || sds_range_is(scan, prefix, "xml");
+}
+
+static bool sds_end_element(struct sds_scan *scan)
+{
+	struct ds_sds_stream *stream = scan->stream;
+	struct sds_element *element = &scan->elements[--scan->depth];
+
+	scan->ns_count = element->ns_count;
+
+	if (scan->depth == 0) {
+		stream->root_end = scan->pos;
+	} else if (scan->depth == 2 && scan->in_inner) {
+		scan->component->end = scan->pos;
+		scan->in_inner = false;
+	} else if (scan->depth == 1 && scan->in_datastream) {
+		if (!SDS_GROW(stream->datastreams, stream->datastream_count, stream->datastreams_alloc))
+			return false;
+		stream->datastreams[stream->datastream_count].start = scan->datastream_start;
+		stream->datastreams[stream->datastream_count].end = scan->pos;
+		stream->datastream_count++;
+		scan->in_datastream = false;
+	} else if (scan->depth == 1 && scan->component != NULL) {
+		struct sds_component *component = scan->component;
+		char *id = NULL;
+		if (component->end != 0 && scan->component_id.end > scan->component_id.start) {
+			id = malloc(scan->component_id.end - scan->component_id.start + 1);
+			if (id == NULL)
+				return false;
+			memcpy(id, scan->buf + scan->component_id.start, scan->component_id.end - scan->component_id.start);
+			id[scan->component_id.end - scan->component_id.start] = '\0';
+		}
+		// the first component of the ID wins, as in lookup of the DOM
+		if (id == NULL || !oscap_htable_add(stream->components, id, component))
+			sds_component_free(component);
+		free(id);
+		scan->component = NULL;
+	}
+
+	return true;
+}
+
+static bool sds_start_element(struct sds_scan *scan)
+{
+	struct ds_sds_stream *stream = scan->stream;
+	const char *buf = scan->buf;
+	size_t tag_start = scan->pos;
+	size_t p = tag_start + 1;
+	size_t ns_before = scan->ns_count;
+	struct sds_range id = { 0, 0 };
+	bool empty = false;
+
+	while (p < scan->size && sds_is_name_char(buf[p]))
+		++p;
+	struct sds_range name = { tag_start + 1, p };
+	if (!sds_valid_qname(buf + name.start, name.end - name.start))
+		return false;
+
+	scan->attr_count = 0;
+	for (;;) {
+		size_t space = p;
+		while (p < scan->size && sds_is_space(buf[p]))
+			++p;
+		if (p >= scan->size)
+			return false;
+		if (buf[p] == '>')
+			break;
+		if (buf[p] == '/') {
+			if (p + 1 >= scan->size || buf[p + 1] != '>')
+				return false;
+			empty = true;
+			break;
+		}
+		if (p == space)
+			return false;
+
+		struct sds_range attr = { p, p };
+		while (p < scan->size && sds_is_name_char(buf[p]))
+			++p;
+		attr.end = p;
+		while (p < scan->size && sds_is_space(buf[p]))
+			++p;
+		if (!sds_valid_qname(buf + attr.start, attr.end - attr.start) || p >= scan->size || buf[p] != '=')
+			return false;
+		++p;
+		while (p < scan->size && sds_is_space(buf[p]))
+			++p;
+		if (p >= scan->size || (buf[p] != '"' && buf[p] != '\''))
+			return false;
+		const char *value_end = memchr(buf + p + 1, buf[p], scan->size - p - 1);
+		if (value_end == NULL || !sds_valid_text(buf + p + 1, value_end, true))
+			return false;
+		struct sds_range value = { p + 1, value_end - buf };
+		p = value.end + 1;
+
+		if (sds_range_is(scan, attr, "xmlns") ||
+		    (attr.end - attr.start > 6 && memcmp(buf + attr.start, "xmlns:", 6) == 0)) {
+			if (!SDS_GROW(scan->ns, scan->ns_count, scan->ns_alloc))
+				return false;
+			struct sds_ns *ns = &scan->ns[scan->ns_count++];
+			ns->prefix.start = attr.end - attr.start > 5 ? attr.start + 6 : attr.end;
+			ns->prefix.end = attr.end;
+			ns->uri = value;
+			ns->decl.start = attr.start;
+			ns->decl.end = p;
+		} else {
+			if (!SDS_GROW(scan->attrs, scan->attr_count, scan->attrs_alloc))
+				return false;
+			scan->attrs[scan->attr_count++] = attr;
+			if (sds_range_is(scan, attr, "id") && memchr(buf + value.start, '&', value.end - value.start) == NULL)
+				id = value;
+		}
+	}
+	size_t tag_end = p;
+	scan->pos = p + (empty ? 2 : 1);
+
+	struct sds_range local = sds_local_name(scan, name);
+	bool in_ds_ns = sds_in_ds_ns(scan, name);
+	size_t level = scan->depth;
+	if (level == 0) {
+		if (!in_ds_ns || !sds_range_is(scan, local, "data-stream-collection"))
+			return false;
+		stream->root.start = tag_start;
+		stream->root.end = scan->pos;
+		stream->root_name = name;
+		stream->root_empty = empty;
+	} else if (level == 1 && in_ds_ns) {
+		if (sds_range_is(scan, local, "data-stream")) {
+			scan->in_datastream = true;
+			scan->datastream_start = tag_start;
+		} else if (sds_range_is(scan, local, "component") || sds_range_is(scan, local, "extended-component")) {
+			scan->component = calloc(1, sizeof(struct sds_component));
+			if (scan->component == NULL)
+				return false;
+			scan->component_id = id;
+		}
+	} else if (level == 2 && scan->component != NULL && scan->component->end == 0 && !scan->in_inner) {
+		scan->component->start = tag_start;
+		scan->component->script = sds_range_is(scan, local, "script");
+		scan->in_inner = true;
+		scan->inner_ns = ns_before;
+	}
+
+	if (scan->in_inner) {
+		if (!sds_resolve(scan, sds_prefix(scan, name), tag_end))
+			return false;
+		for (size_t i = 0; i < scan->attr_count; ++i) {
+			struct sds_range prefix = sds_prefix(scan, scan->attrs[i]);
+			if (prefix.start != prefix.end && !sds_resolve(scan, prefix, tag_end))
+				return false;
+		}
+	}
+
+	if (!SDS_GROW(scan->elements, scan->depth, scan->elements_alloc))
+		return false;
+	scan->elements[scan->depth].name = name;
+	scan->elements[scan->depth].ns_count = ns_before;
+	scan->depth++;
+
+	return empty ? sds_end_element(scan) : true;
+}
+
+static bool sds_close_element(struct sds_scan *scan)
+{
+	size_t p = scan->pos + 2;
+
+	while (p < scan->size && sds_is_name_char(scan->buf[p]))
+		++p;
+	struct sds_range name = { scan->pos + 2, p };
+	while (p < scan->size && sds_is_space(scan->buf[p]))
+		++p;
+	if (p >= scan->size || scan->buf[p] != '>')
+		return false;
+	if (scan->depth == 0 || !sds_range_eq(scan, scan->elements[scan->depth - 1].name, name))
+		return false;
+
+	scan->pos = p + 1;
+	return sds_end_element(scan);
+}
+
+static bool sds_scan(struct sds_scan *scan)
+{
+	bool root_done = false;
+
+	if (scan->size >= 3 && memcmp(scan->buf, "\xEF\xBB\xBF", 3) == 0)
+		scan->pos = 3;
+
+	while (scan->pos < scan->size) {
+		const char *p = scan->buf + scan->pos;
+		const char *lt = memchr(p, '<', scan->size - scan->pos);
+		const char *text_end = lt != NULL ? lt : scan->buf + scan->size;
+
+		if (scan->depth > 0) {
+			if (!sds_valid_text(p, text_end, false))
+				return false;
+		} else {
+			for (; p < text_end; ++p) {
+				if (!sds_is_space(*p))
+					return false;
+			}
+		}
+		if (lt == NULL)
+			break;
+
+		scan->pos = lt - scan->buf;
+		if (scan->pos + 1 >= scan->size)
+			return false;
+
+		bool ok;
+		switch (lt[1]) {
+		case '?':
+		case '!':
+			ok = sds_skip_markup(scan);
+			break;
+		case '/':
+			ok = sds_close_element(scan);
+			break;
+		default:
+			if (root_done)
+				return false;
+			ok = sds_start_element(scan);
+		}
+		if (!ok)
+			return false;
+		if (scan->depth == 0 && scan->stream->root_name.end != 0)
+			root_done = true;
+	}
+
+	return root_done && scan->depth == 0;
+}
+
+struct ds_sds_stream *ds_sds_stream_new(const char *buffer, size_t size)
+{
+	if (!sds_valid_chars((const unsigned char *) buffer, size)) {
+		dD("Source DataStream is not a valid UTF-8 document, it will be split using DOM.");
+		return NULL;
+	}
+
+	struct ds_sds_stream *stream = calloc(1, sizeof(struct ds_sds_stream));
+	if (stream == NULL)
+		return NULL;
+	stream->components = oscap_htable_new();
+	if (stream->components == NULL) {
+		free(stream);
+		return NULL;
+	}
+
+	struct sds_scan scan = {
+		.buf = buffer,
+		.size = size,
+		.stream = stream,
+	};
+	bool ok = sds_scan(&scan);
+
+	sds_component_free(scan.component);
+	free(scan.ns);
+	free(scan.elements);
+	free(scan.attrs);
+
+	if (!ok) {
+		dD("Could not find components of Source DataStream in raw content at %zu, it will be split using DOM.", scan.pos);
+		ds_sds_stream_free(stream);
+		return NULL;
+	}
+
+	stream->size = size;
+	xmlDoc *doc = ds_sds_stream_get_datastreams(stream, buffer);
+	if (doc == NULL) {
+		dD("Could not parse data-streams of Source DataStream, it will be split using DOM.");
+		ds_sds_stream_free(stream);
+		return NULL;
+	}
+	xmlFreeDoc(doc);
+	return stream;
+}
+
+char *ds_sds_stream_get_component(const struct ds_sds_stream *stream, const char *buffer, const char *component_id, size_t *size)
+{
+	const struct sds_component *component = oscap_htable_get(stream->components, component_id);
+	if (component == NULL || component->script)
+		return NULL;
+
+	size_t len = component->end - component->start;
+	for (size_t i = 0; i < component->ns_count; ++i)
+		len += 1 + component->ns[i].decl.end - component->ns[i].decl.start;
+
+	char *xml = malloc(len + 1);
+	if (xml == NULL)
+		return NULL;
+	char *p = xml;
+	size_t copied = component->start;
+	for (size_t i = 0; i < component->ns_count; ++i) {
+		const struct sds_insert *insert = &component->ns[i];
+		memcpy(p, buffer + copied, insert->at - copied);
+		p += insert->at - copied;
+		copied = insert->at;
+		*p++ = ' ';
+		memcpy(p, buffer + insert->decl.start, insert->decl.end - insert->decl.start);
+		p += insert->decl.end - insert->decl.start;
+	}
+	memcpy(p, buffer + copied, component->end - copied);
+	p += component->end - copied;
+	*p = '\0';
+
+	*size = len;
+	return xml;
+}
+
+xmlDoc *ds_sds_stream_get_datastreams(const struct ds_sds_stream *stream, const char *buffer)
+{
+	if (stream->root_empty) {
+		return xmlReadMemory(buffer, stream->size, NULL, NULL, XML_PARSE_NOERROR | XML_PARSE_NOWARNING);
+	}
+
+	// everything around the root element is kept, libxml2 checks the XML declaration
+	size_t name_len = stream->root_name.end - stream->root_name.start;
+	size_t len = stream->root.end + name_len + 3 + stream->size - stream->root_end;
+	for (size_t i = 0; i < stream->datastream_count; ++i)
+		len += stream->datastreams[i].end - stream->datastreams[i].start;
+
+	char *xml = malloc(len);
+	if (xml == NULL)
+		return NULL;
+	char *p = xml;
+	memcpy(p, buffer, stream->root.end);
+	p += stream->root.end;
+	for (size_t i = 0; i < stream->datastream_count; ++i) {
+		memcpy(p, buffer + stream->datastreams[i].start, stream->datastreams[i].end - stream->datastreams[i].start);
+		p += stream->datastreams[i].end - stream->datastreams[i].start;
+	}
+	memcpy(p, "</", 2);
+	memcpy(p + 2, buffer + stream->root_name.start, name_len);
+	p[2 + name_len] = '>';
+	p += name_len + 3;
+	memcpy(p, buffer + stream->root_end, stream->size - stream->root_end);
+
+	xmlDoc *doc = xmlReadMemory(xml, len, NULL, NULL, XML_PARSE_NOERROR | XML_PARSE_NOWARNING);
+	free(xml);
+	return doc;
+}
@@ -0,0 +1,71 @@
+/*
+ * Copyright 2026 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ *
+ */
+#ifndef OSCAP_DS_SDS_STREAM_PRIV_H
+#define OSCAP_DS_SDS_STREAM_PRIV_H
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stddef.h>
+#include <libxml/tree.h>
+
+/**
+ * Byte ranges of the parts of a Source DataStream in its raw content.
+ * It allows to cut components out of the raw content and to parse each
+ * of them on its own instead of building DOM of the whole DataStream.
+ */
+struct ds_sds_stream;
+
+/**
+ * Scan raw content of a Source DataStream and record where its data-streams
+ * and components are.
+ * @param buffer raw content of the DataStream
+ * @param size size of the content
+ * @returns the ranges or NULL if the content can't be split without
+ * building DOM (it is not UTF-8, it has a DOCTYPE, it isn't well-formed, ...)
+ */
+struct ds_sds_stream *ds_sds_stream_new(const char *buffer, size_t size);
+
+void ds_sds_stream_free(struct ds_sds_stream *stream);
+
+/**
+ * Cut the root element of the component of the given ID out of the raw
+ * content. Namespaces declared outside of the component and used inside
+ * of it are declared on the elements using them.
+ * @param stream ranges of the DataStream
+ * @param buffer raw content of the DataStream that has been scanned
+ * @param component_id ID of ds:component or ds:extended-component
+ * @param size size of the result
+ * @returns NUL-terminated XML document to be freed by caller or NULL if
+ * there is no such component or if it has no element or a script inside
+ */
+char *ds_sds_stream_get_component(const struct ds_sds_stream *stream, const char *buffer, const char *component_id, size_t *size);
+
+/**
+ * Build DOM of the DataStream with its ds:data-stream elements only.
+ * @param stream ranges of the DataStream
+ * @param buffer raw content of the DataStream that has been scanned
+ * @returns the document to be freed by caller or NULL on error
+ */
+xmlDoc *ds_sds_stream_get_datastreams(const struct ds_sds_stream *stream, const char *buffer);
+
+#endif
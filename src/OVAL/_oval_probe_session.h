@@ -30,9 +30,11 @@
 #ifndef _OVAL_PROBE_SESSION
 #define _OVAL_PROBE_SESSION
 
+#include <pthread.h>
 #include "public/oval_probe_session.h"
 #include "_oval_probe_handler.h"
 #include "oval_probe_ext.h"
+#include "common/list.h"
 
 /** OVAL probe session structure.
  * This structure holds all the library side state information associated with
@@ -45,8 +47,24 @@ struct oval_probe_session {
         struct oval_syschar_model *sys_model; /**< system characteristics model */
         char         *dir;  /**< probe session directory */
         uint32_t      flg;  /**< probe session flags */
+        struct oscap_list *stats;    /**< per-probe counters (struct oval_probe_stats) */
+        pthread_mutex_t    stats_lock;
 };
 
+/**
+ * Account a query of an object to the counters of its probe.
+ * @param cache_hit the query was answered from existing system characteristics
+ */
+void oval_probe_session_count_query(oval_probe_session_t *sess, oval_subtype_t subtype, bool cache_hit);
+
+/**
+ * Account one object collected by a probe to the counters of the probe.
+ * @param syschar system characteristics of the collected object
+ * @param time_ns time of the collection in nanoseconds
+ */
+void oval_probe_session_count_collection(oval_probe_session_t *sess, oval_subtype_t subtype, struct oval_syschar *syschar,
+					 uint64_t time_ns, size_t bytes_sent, size_t bytes_received);
+
 #endif /* _OVAL_PROBE_SESSION */
 
 /// @}
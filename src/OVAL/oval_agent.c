@@ -41,6 +41,7 @@
 #include "oval_parser_impl.h"
 #include "adt/oval_string_map_impl.h"
 #include "oval_system_characteristics_impl.h"
+#include "collectVarRefs_impl.h"
 #include "results/oval_results_impl.h"
 #if defined(OVAL_PROBES_ENABLED)
 # include "oval_probe_impl.h"
@@ -49,6 +50,8 @@
 #include "common/util.h"
 #include "common/debug_priv.h"
 #include "common/_error.h"
+#include "common/oscap_parallel.h"
+#include "common/oscap_string.h"
 #include "oval_agent_xccdf_api.h"
 
 struct oval_agent_session {
@@ -63,8 +66,30 @@ struct oval_agent_session {
 	struct oval_results_model    * res_model;
 	oval_probe_session_t  * psess;
 #endif
+	unsigned int eval_threads;
+	/* definition id -> external variables it depends on, see _oval_agent_get_definition_deps() */
+	struct oscap_htable *def_deps;
+	/* memo key -> result of a definition evaluated by oval_agent_eval_rule() */
+	struct oscap_htable *def_results;
 };
 
+/**
+ * External variables whose values determine the result of a definition.
+ */
+struct oval_agent_definition_deps {
+	bool cacheable;         ///< false if the result can't be keyed by the bound values
+	size_t count;
+	const char **variables; ///< sorted ids of external variables
+};
+
+static void _oval_agent_definition_deps_free(struct oval_agent_definition_deps *deps)
+{
+	if (deps != NULL) {
+		free(deps->variables);
+		free(deps);
+	}
+}
+
 
 /**
  * Specification of structure for transformation of OVAL Result type
@@ -136,6 +161,9 @@ oval_agent_session_t * oval_agent_new_session(struct oval_definition_model *mode
 #endif
 
 	ag_sess->product_name = NULL;
+	ag_sess->eval_threads = oscap_parallel_jobs_from_env("OSCAP_OVAL_EVAL_THREADS", 1);
+	ag_sess->def_deps = oscap_htable_new();
+	ag_sess->def_results = oscap_htable_new();
 
 	return ag_sess;
 }
@@ -257,11 +285,16 @@ int oval_agent_reset_session(oval_agent_session_t * ag_sess) {
 
 void oval_agent_reset_syschar(oval_agent_session_t * ag_sess) {
 	oval_syschar_model_reset(ag_sess->sys_model);
+	/* Memoized results were computed from the syschars we have just dropped */
+	oscap_htable_free(ag_sess->def_results, free);
+	ag_sess->def_results = oscap_htable_new();
 }
 
 void oval_agent_reset_results(oval_agent_session_t * ag_sess) {
 #if defined(OVAL_PROBES_ENABLED)
 	if (ag_sess != NULL) {
+		oscap_htable_free(ag_sess->def_results, free);
+		ag_sess->def_results = oscap_htable_new();
 		oval_results_model_free(ag_sess->res_model);
 		ag_sess->res_model = oval_results_model_new_with_probe_session(
 				ag_sess->def_model, ag_sess->sys_models, ag_sess->psess);
@@ -286,12 +319,150 @@ int oval_agent_abort_session(oval_agent_session_t *ag_sess)
 #endif
 }
 
+void oval_agent_set_eval_threads(oval_agent_session_t *ag_sess, unsigned int threads)
+{
+	__attribute__nonnull__(ag_sess);
+
+	ag_sess->eval_threads = threads;
+}
+
+#if defined(OVAL_PROBES_ENABLED)
+static void _oval_agent_collect_criteria(struct oval_result_criteria_node *node, struct oscap_list *tests)
+{
+	switch (oval_result_criteria_node_get_type(node)) {
+	case OVAL_NODETYPE_CRITERIA: {
+		struct oval_result_criteria_node_iterator *subnodes = oval_result_criteria_node_get_subnodes(node);
+		while (oval_result_criteria_node_iterator_has_more(subnodes))
+			_oval_agent_collect_criteria(oval_result_criteria_node_iterator_next(subnodes), tests);
+		oval_result_criteria_node_iterator_free(subnodes);
+		break;
+	}
+	case OVAL_NODETYPE_CRITERION: {
+		struct oval_result_test *rtest = oval_result_criteria_node_get_test(node);
+		if (rtest != NULL && oval_result_test_collect(rtest))
+			oscap_list_add(tests, rtest);
+		break;
+	}
+	case OVAL_NODETYPE_EXTENDDEF: {
+		struct oval_result_definition *extends = oval_result_criteria_node_get_extends(node);
+		struct oval_result_criteria_node *criteria;
+		if (extends != NULL && (criteria = oval_result_definition_get_criteria(extends)) != NULL)
+			_oval_agent_collect_criteria(criteria, tests);
+		break;
+	}
+	default:
+		break;
+	}
+}
+
+static void _oval_agent_eval_test(size_t index, void *arg)
+{
+	oval_result_test_eval_collected(((struct oval_result_test **) arg)[index]);
+}
+
+/*
+ * Parallel variant of oval_agent_eval_system(). Objects are collected
+ * on the calling thread in the same order as in the serial mode, only
+ * the comparison of collected items with states runs on the worker
+ * threads. Every result test is evaluated exactly once by a single
+ * thread and the definitions are then resolved and reported in
+ * document order, so the results model does not depend on scheduling.
+ */
+static int _oval_agent_eval_system_parallel(oval_agent_session_t *ag_sess, agent_reporter cb, void *arg)
+{
+	struct oval_definition_iterator *oval_def_it;
+	struct oval_result_system *rsystem;
+	struct oscap_list *definitions, *tests;
+	struct oval_result_test **test_array;
+	struct oscap_iterator *it;
+	size_t test_count = 0;
+	int ret = 0, prepare_ret = 0;
+
+	rsystem = _oval_agent_get_first_result_system(ag_sess);
+	definitions = oscap_list_new();
+	tests = oscap_list_new();
+
+	dI("OVAL agent started to collect objects for OVAL definitions on your system.");
+	oval_def_it = oval_definition_model_get_definitions(ag_sess->def_model);
+	while (oval_definition_iterator_has_more(oval_def_it)) {
+		struct oval_definition *oval_def = oval_definition_iterator_next(oval_def_it);
+		struct oval_result_definition *rdef;
+		struct oval_result_criteria_node *criteria;
+
+		rdef = oval_result_system_prepare_definition(rsystem, oval_definition_get_id(oval_def));
+		if (rdef == NULL) {
+			prepare_ret = -1;
+			break;
+		}
+		oscap_list_add(definitions, oval_def);
+		if ((criteria = oval_result_definition_get_criteria(rdef)) != NULL)
+			_oval_agent_collect_criteria(criteria, tests);
+	}
+	oval_definition_iterator_free(oval_def_it);
+	if (prepare_ret != 0)
+		goto cleanup;
+
+	if (oscap_list_get_itemcount(tests) > 0) {
+		test_array = malloc(oscap_list_get_itemcount(tests) * sizeof(struct oval_result_test *));
+		if (test_array == NULL) {
+			oscap_seterr(OSCAP_EFAMILY_GLIBC, "Insufficient memory for the evaluated tests.");
+			ret = -1;
+			goto cleanup;
+		}
+		it = oscap_iterator_new(tests);
+		while (oscap_iterator_has_more(it))
+			test_array[test_count++] = oscap_iterator_next(it);
+		oscap_iterator_free(it);
+
+		dI("OVAL agent is evaluating %zu tests using %u threads.", test_count, ag_sess->eval_threads);
+		oscap_parallel_for(test_count, ag_sess->eval_threads, _oval_agent_eval_test, test_array);
+		free(test_array);
+	}
+
+	it = oscap_iterator_new(definitions);
+	while (oscap_iterator_has_more(it)) {
+		struct oval_definition *oval_def = oscap_iterator_next(it);
+		char *id = oval_definition_get_id(oval_def);
+
+		/* resolve criteria, the tests have been evaluated already */
+		ret = oval_agent_eval_definition(ag_sess, id);
+		if (ret == -1)
+			break;
+
+		if (cb != NULL) {
+			struct oval_result_definition *res_def = oval_agent_get_result_definition(ag_sess, id);
+			ret = cb(res_def, arg);
+			/* stop? */
+			if (ret != 0)
+				break;
+		}
+	}
+	oscap_iterator_free(it);
+
+cleanup:
+	oscap_list_free0(tests);
+	oscap_list_free0(definitions);
+	return ret == 0 ? prepare_ret : ret;
+}
+#endif
+
 int oval_agent_eval_system(oval_agent_session_t * ag_sess, agent_reporter cb, void *arg) {
 	struct oval_definition *oval_def;
 	struct oval_definition_iterator *oval_def_it;
 	char   *id;
 	int ret = 0;
 
+#if defined(OVAL_PROBES_ENABLED)
+	/* collect independent objects in batches before the evaluation starts */
+	oval_probe_prefetch_model(ag_sess->psess, ag_sess->def_model);
+
+	if (ag_sess->eval_threads > 1) {
+		ret = _oval_agent_eval_system_parallel(ag_sess, cb, arg);
+		dI("OVAL agent finished evaluation.");
+		return ret;
+	}
+#endif
+
 	dI("OVAL agent started to evaluate OVAL definitions on your system.");
 	oval_def_it = oval_definition_model_get_definitions(ag_sess->def_model);
 	while (oval_definition_iterator_has_more(oval_def_it)) {
@@ -336,6 +507,17 @@ struct oval_results_model * oval_agent_get_results_model(oval_agent_session_t *
 #endif
 }
 
+struct oval_probe_session *oval_agent_get_probe_session(oval_agent_session_t *ag_sess)
+{
+	__attribute__nonnull__(ag_sess);
+
+#if defined(OVAL_PROBES_ENABLED)
+	return ag_sess->psess;
+#else
+	return NULL;
+#endif
+}
+
 const char * oval_agent_get_filename(oval_agent_session_t * ag_sess) {
 	__attribute__nonnull__(ag_sess);
 
@@ -350,6 +532,8 @@ void oval_agent_destroy_session(oval_agent_session_t * ag_sess) {
 		oval_results_model_free(ag_sess->res_model);
 #endif
 		oval_syschar_model_free(ag_sess->sys_model);
+		oscap_htable_free(ag_sess->def_deps, (oscap_destruct_func) _oval_agent_definition_deps_free);
+		oscap_htable_free(ag_sess->def_results, free);
 	        free(ag_sess->filename);
 		free(ag_sess);
 	}
@@ -583,6 +767,9 @@ oval_agent_eval_multi_check(oval_agent_session_t *sess)
 	xccdf_test_result_type_t xccdf_result;
 	xccdf_test_result_type_t final_result = 0;
 
+#if defined(OVAL_PROBES_ENABLED)
+	oval_probe_prefetch_model(sess->psess, sess->def_model);
+#endif
 	oval_def_it = oval_definition_model_get_definitions(sess->def_model);
 	if (!oval_definition_iterator_has_more(oval_def_it)) {
 		// We are evaluating oval, which has no definitions. We are in state
@@ -611,6 +798,175 @@ oval_agent_eval_multi_check(oval_agent_session_t *sess)
 	return final_result;
 }
 
+static void _oval_agent_collect_criteria_deps(struct oval_criteria_node *node, struct oval_string_map *vm,
+		struct oval_string_map *visited, bool *cacheable)
+{
+	switch (oval_criteria_node_get_type(node)) {
+	case OVAL_NODETYPE_CRITERION:{
+		struct oval_test *test = oval_criteria_node_get_test(node);
+		if (test == NULL)
+			break;
+		struct oval_object *object = oval_test_get_object(test);
+		if (object != NULL) {
+			// variable_object refers to its variable by id, not by var_ref,
+			// so the variable it depends on can't be found by the walk below.
+			if (oval_object_get_subtype(object) == OVAL_INDEPENDENT_VARIABLE)
+				*cacheable = false;
+			oval_obj_collect_var_refs(object, vm);
+		}
+		struct oval_state_iterator *ste_it = oval_test_get_states(test);
+		while (oval_state_iterator_has_more(ste_it)) {
+			struct oval_state *state = oval_state_iterator_next(ste_it);
+			if (state != NULL)
+				oval_ste_collect_var_refs(state, vm);
+		}
+		oval_state_iterator_free(ste_it);
+		} break;
+	case OVAL_NODETYPE_CRITERIA:{
+		struct oval_criteria_node_iterator *cnode_it = oval_criteria_node_get_subnodes(node);
+		while (oval_criteria_node_iterator_has_more(cnode_it)) {
+			struct oval_criteria_node *subnode = oval_criteria_node_iterator_next(cnode_it);
+			if (subnode != NULL)
+				_oval_agent_collect_criteria_deps(subnode, vm, visited, cacheable);
+		}
+		oval_criteria_node_iterator_free(cnode_it);
+		} break;
+	case OVAL_NODETYPE_EXTENDDEF:{
+		struct oval_definition *definition = oval_criteria_node_get_definition(node);
+		if (definition == NULL)
+			break;
+		const char *id = oval_definition_get_id(definition);
+		if (oval_string_map_get_value(visited, id) != NULL)
+			break;
+		oval_string_map_put(visited, id, definition);
+		struct oval_criteria_node *criteria = oval_definition_get_criteria(definition);
+		if (criteria != NULL)
+			_oval_agent_collect_criteria_deps(criteria, vm, visited, cacheable);
+		} break;
+	default:
+		break;
+	}
+}
+
+static int _oval_agent_strptr_cmp(const void *a, const void *b)
+{
+	return strcmp(*(const char * const *) a, *(const char * const *) b);
+}
+
+/**
+ * Find the external variables a definition depends on, including those
+ * referenced through extend_definition, local variables and object components.
+ * The answer is cached in the session for the next rule referencing the definition.
+ * @return dependencies or NULL if they can't be determined
+ */
+static struct oval_agent_definition_deps *_oval_agent_get_definition_deps(struct oval_agent_session *sess, struct oval_definition *definition)
+{
+	const char *id = oval_definition_get_id(definition);
+	struct oval_agent_definition_deps *deps = oscap_htable_get(sess->def_deps, id);
+	if (deps != NULL)
+		return deps;
+
+	deps = calloc(1, sizeof(struct oval_agent_definition_deps));
+	if (deps == NULL)
+		return NULL;
+	deps->cacheable = true;
+	struct oval_string_map *vm = oval_string_map_new();
+	struct oval_string_map *visited = oval_string_map_new();
+	oval_string_map_put(visited, id, definition);
+	struct oval_criteria_node *criteria = oval_definition_get_criteria(definition);
+	if (criteria != NULL)
+		_oval_agent_collect_criteria_deps(criteria, vm, visited, &deps->cacheable);
+
+	size_t size = 0;
+	struct oval_variable_iterator *var_it = (struct oval_variable_iterator *) oval_string_map_values(vm);
+	while (oval_variable_iterator_has_more(var_it)) {
+		struct oval_variable *variable = oval_variable_iterator_next(var_it);
+		if (oval_variable_get_type(variable) != OVAL_VARIABLE_EXTERNAL)
+			continue;
+		if (deps->count == size) {
+			size = size ? 2 * size : 4;
+			const char **variables = realloc(deps->variables, size * sizeof(char *));
+			if (variables == NULL) {
+				// Without the full list the result can't be keyed
+				deps->cacheable = false;
+				break;
+			}
+			deps->variables = variables;
+		}
+		deps->variables[deps->count++] = oval_variable_get_id(variable);
+	}
+	oval_variable_iterator_free(var_it);
+	if (deps->count > 1)
+		qsort(deps->variables, deps->count, sizeof(char *), _oval_agent_strptr_cmp);
+
+	oval_string_map_free(visited, NULL);
+	oval_string_map_free(vm, NULL);
+	if (!oscap_htable_add(sess->def_deps, id, deps)) {
+		_oval_agent_definition_deps_free(deps);
+		return NULL;
+	}
+	return deps;
+}
+
+/**
+ * Build the key under which the result of a definition evaluated with
+ * the given bindings is memoized. The key spells out the definition id and
+ * the sorted values bound to each external variable the definition depends on,
+ * the order of check-exports does not matter the same way it does not matter
+ * for _oval_agent_resolve_variables_conflict().
+ * @return key or NULL if the result can't be memoized
+ */
+static char *_oval_agent_definition_memo_key(struct oval_agent_session *sess, struct oval_definition *definition,
+		struct xccdf_value_binding_iterator *it)
+{
+	struct oval_agent_definition_deps *deps = _oval_agent_get_definition_deps(sess, definition);
+	if (deps == NULL || !deps->cacheable)
+		return NULL;
+
+	struct oscap_htable *dict = _binding_iterator_to_dict(it);
+	struct oscap_string *key = oscap_string_new();
+	oscap_string_append_string(key, oval_definition_get_id(definition));
+	bool bound = true;
+	for (size_t i = 0; bound && i < deps->count; ++i) {
+		struct oscap_stringlist *values = oscap_htable_get(dict, deps->variables[i]);
+		if (values == NULL) {
+			// The value would be left over from whichever rule bound it last
+			bound = false;
+			break;
+		}
+		size_t count = oscap_list_get_itemcount((struct oscap_list *) values);
+		const char **sorted = malloc((count + 1) * sizeof(char *));
+		if (sorted == NULL) {
+			bound = false;
+			break;
+		}
+		size_t n = 0;
+		struct oscap_string_iterator *val_it = oscap_stringlist_get_strings(values);
+		while (oscap_string_iterator_has_more(val_it) && n < count)
+			sorted[n++] = oscap_string_iterator_next(val_it);
+		oscap_string_iterator_free(val_it);
+		qsort(sorted, n, sizeof(char *), _oval_agent_strptr_cmp);
+
+		oscap_string_append_char(key, '\n');
+		oscap_string_append_string(key, deps->variables[i]);
+		for (size_t j = 0; j < n; ++j) {
+			// Length prefix keeps values containing separators apart
+			char len[32];
+			snprintf(len, sizeof(len), "\n%zu:", strlen(sorted[j]));
+			oscap_string_append_string(key, len);
+			oscap_string_append_string(key, sorted[j]);
+		}
+		free(sorted);
+	}
+	oscap_htable_free(dict, (oscap_destruct_func) oscap_stringlist_free);
+
+	if (!bound) {
+		oscap_string_free(key);
+		return NULL;
+	}
+	return oscap_string_bequeath(key);
+}
+
 xccdf_test_result_type_t oval_agent_eval_rule(struct xccdf_policy *policy, const char *rule_id, const char *id,
 			       const char * href, struct xccdf_value_binding_iterator *it,
 			       struct xccdf_check_import_iterator * check_import_it,
@@ -624,20 +980,54 @@ xccdf_test_result_type_t oval_agent_eval_rule(struct xccdf_policy *policy, const
         if (strcmp(sess->filename, href))
             return XCCDF_RESULT_NOT_CHECKED;
 
-        /* Resolve variables */
-        retval = oval_agent_resolve_variables(sess, it);
-        if (retval != 0) return XCCDF_RESULT_UNKNOWN;
-
         if (id != NULL) {
 		struct oval_definition *definition = oval_definition_model_get_definition(oval_results_model_get_definition_model(oval_agent_get_results_model(sess)), id);
             /* If there is no such OVAL definition, return XCCDF_RESUL_NOT_CHECKED. XDCCDF should look for alternative definition in this case. */
             if (definition == NULL)
                     return XCCDF_RESULT_NOT_CHECKED;
+
+		/* Rules sharing a definition and the values bound to its variables
+		 * share the result. Resolving the variables again could start a new
+		 * variable instance only to evaluate the same thing once more. */
+		char *key = _oval_agent_definition_memo_key(sess, definition, it);
+		oval_result_t *memo = key != NULL ? oscap_htable_get(sess->def_results, key) : NULL;
+		if (memo != NULL) {
+			dI("Reusing result of definition %s evaluated with the same variable values.", id);
+			free(key);
+			return xccdf_get_result_from_oval(oval_definition_get_class(definition), *memo);
+		}
+
+		/* Resolve variables */
+		retval = oval_agent_resolve_variables(sess, it);
+		if (retval != 0) {
+			free(key);
+			return XCCDF_RESULT_UNKNOWN;
+		}
+#if defined(OVAL_PROBES_ENABLED)
+	    oval_probe_prefetch_definition(sess->psess, definition);
+#endif
             /* Evaluate OVAL definition */
 	    oval_agent_eval_definition(sess, id);
-	    oval_agent_get_definition_result(sess, id, &result);
+		if (oval_agent_get_definition_result(sess, id, &result) != 0) {
+			free(key);
+			return XCCDF_RESULT_UNKNOWN;
+		}
+		if (key != NULL) {
+			// Not memoizing the result only costs a later evaluation
+			memo = malloc(sizeof(oval_result_t));
+			if (memo != NULL) {
+				*memo = result;
+				if (!oscap_htable_add(sess->def_results, key, memo))
+					free(memo);
+			}
+			free(key);
+		}
 		return xccdf_get_result_from_oval(oval_definition_get_class(definition), result);
         } else {
+		/* Resolve variables */
+		retval = oval_agent_resolve_variables(sess, it);
+		if (retval != 0) return XCCDF_RESULT_UNKNOWN;
+
 		return oval_agent_eval_multi_check(sess);
         }
 }
@@ -1984,13 +1984,13 @@ static bool _match(const char *pattern, const char *string)
 	oscap_pcre_t *re;
 	char *error;
 	int erroffset = -1, ovector[60], ovector_len = sizeof (ovector) / sizeof (ovector[0]);
-	re = oscap_pcre_compile(pattern, OSCAP_PCRE_OPTS_UTF8, &error, &erroffset);
+	re = oscap_pcre_cache_get(pattern, OSCAP_PCRE_OPTS_UTF8, &error, &erroffset);
 	if (re == NULL) {
 		oscap_pcre_err_free(error);
 		return false;
 	}
 	match = (oscap_pcre_exec(re, string, strlen(string), 0, 0, ovector, ovector_len) >= 0);
-	oscap_pcre_free(re);
+	oscap_pcre_cache_release(re);
 	return match;
 }
 
@@ -2217,9 +2217,9 @@ static oval_syschar_collection_flag_t _oval_component_evaluate_REGEX_CAPTURE(ova
 	char *error;
 
 	pattern = oval_component_get_regex_pattern(component);
-	re = oscap_pcre_compile(pattern, OSCAP_PCRE_OPTS_UTF8, &error, &erroffset);
+	re = oscap_pcre_cache_get(pattern, OSCAP_PCRE_OPTS_UTF8, &error, &erroffset);
 	if (re == NULL) {
-		dE("oscap_pcre_compile() failed: \"%s\".", error);
+		dE("oscap_pcre_cache_get() failed: \"%s\".", error);
 		oscap_pcre_err_free(error);
 		return SYSCHAR_FLAG_ERROR;
 	}
@@ -2269,7 +2269,7 @@ static oval_syschar_collection_flag_t _oval_component_evaluate_REGEX_CAPTURE(ova
 		oval_collection_free_items(subcoll, (oscap_destruct_func) oval_value_free);
 	}
 	oval_component_iterator_free(subcomps);
-	oscap_pcre_free(re);
+	oscap_pcre_cache_release(re);
 	return flag;
 }
 
@@ -47,6 +47,7 @@
 #include "common/debug_priv.h"
 #include "common/_error.h"
 #include "common/elements.h"
+#include "common/oscap_profile.h"
 #include "oscap_source.h"
 #include "source/oscap_source_priv.h"
 
@@ -243,12 +244,15 @@ static inline int _oval_definition_model_merge_source(struct oval_definition_mod
 
 struct oval_definition_model *oval_definition_model_import_source(struct oscap_source *source)
 {
+	struct oscap_profile_span span;
+	oscap_profile_begin(&span, OSCAP_PROFILE_MODEL_PARSING);
         struct oval_definition_model *model = oval_definition_model_new();
 	int ret = _oval_definition_model_merge_source(model, source);
         if (ret == -1 ) {
                 oval_definition_model_free(model);
                 model = NULL;
         }
+	oscap_profile_end(&span);
 	return model;
 }
 
@@ -451,7 +455,8 @@ struct oval_test *oval_definition_model_get_new_test(struct oval_definition_mode
 	return test;
 }
 
-xmlNode *oval_definition_model_to_dom(struct oval_definition_model *definition_model, xmlDocPtr doc, xmlNode * parent)
+xmlNode *oval_definition_model_to_dom(struct oval_definition_model *definition_model, xmlDocPtr doc, xmlNode * parent,
+				      struct oscap_xml_stream *stream)
 {
 
 	xmlNodePtr root_node = NULL;
@@ -479,6 +484,7 @@ xmlNode *oval_definition_model_to_dom(struct oval_definition_model *definition_m
 	xmlSetNs(root_node, ns_win);
 	xmlSetNs(root_node, ns_mac);
 	xmlSetNs(root_node, ns_defntns);
+	oscap_xml_stream_open(stream, root_node);
 
 	/* Always report the generator */
 	oval_generator_to_dom(definition_model->generator, doc, root_node);
@@ -491,9 +497,12 @@ xmlNode *oval_definition_model_to_dom(struct oval_definition_model *definition_m
 			struct oval_definition *definition = oval_definition_iterator_next(definitions);
 			if (definitions_node == NULL) {
 				definitions_node = xmlNewTextChild(root_node, ns_defntns, BAD_CAST "definitions", NULL);
+				oscap_xml_stream_open(stream, definitions_node);
 			}
 			oval_definition_to_dom(definition, doc, definitions_node);
+			oscap_xml_stream_flush(stream, definitions_node);
 		}
+		oscap_xml_stream_close(stream, definitions_node);
 	}
         oval_definition_iterator_free(definitions);
 
@@ -501,10 +510,13 @@ xmlNode *oval_definition_model_to_dom(struct oval_definition_model *definition_m
 	struct oval_test_iterator *tests = oval_definition_model_get_tests(definition_model);
 	if (oval_test_iterator_has_more(tests)) {
 		xmlNode *tests_node = xmlNewTextChild(root_node, ns_defntns, BAD_CAST "tests", NULL);
+		oscap_xml_stream_open(stream, tests_node);
 		while (oval_test_iterator_has_more(tests)) {
 			struct oval_test *test = oval_test_iterator_next(tests);
 			oval_test_to_dom(test, doc, tests_node);
+			oscap_xml_stream_flush(stream, tests_node);
 		}
+		oscap_xml_stream_close(stream, tests_node);
 	}
 	oval_test_iterator_free(tests);
 
@@ -512,13 +524,16 @@ xmlNode *oval_definition_model_to_dom(struct oval_definition_model *definition_m
 	struct oval_object_iterator *objects = oval_definition_model_get_objects(definition_model);
 	if (oval_object_iterator_has_more(objects)) {
 		xmlNode *objects_node = xmlNewTextChild(root_node, ns_defntns, BAD_CAST "objects", NULL);
+		oscap_xml_stream_open(stream, objects_node);
 		while(oval_object_iterator_has_more(objects)) {
 			struct oval_object *object = oval_object_iterator_next(objects);
 			if (oval_object_get_base_obj(object))
 				/* Skip internal objects */
 				continue;
 			oval_object_to_dom(object, doc, objects_node);
+			oscap_xml_stream_flush(stream, objects_node);
 		}
+		oscap_xml_stream_close(stream, objects_node);
 	}
 	oval_object_iterator_free(objects);
 
@@ -526,10 +541,13 @@ xmlNode *oval_definition_model_to_dom(struct oval_definition_model *definition_m
 	struct oval_state_iterator *states = oval_definition_model_get_states(definition_model);
 	if (oval_state_iterator_has_more(states)) {
 		xmlNode *states_node = xmlNewTextChild(root_node, ns_defntns, BAD_CAST "states", NULL);
+		oscap_xml_stream_open(stream, states_node);
 		while (oval_state_iterator_has_more(states)) {
 			struct oval_state *state = oval_state_iterator_next(states);
 			oval_state_to_dom(state, doc, states_node);
+			oscap_xml_stream_flush(stream, states_node);
 		}
+		oscap_xml_stream_close(stream, states_node);
 	}
 	oval_state_iterator_free(states);
 
@@ -537,13 +555,17 @@ xmlNode *oval_definition_model_to_dom(struct oval_definition_model *definition_m
 	struct oval_variable_iterator *variables = oval_definition_model_get_variables(definition_model);
 	if (oval_variable_iterator_has_more(variables)) {
 		xmlNode *variables_node = xmlNewTextChild(root_node, ns_defntns, BAD_CAST "variables", NULL);
+		oscap_xml_stream_open(stream, variables_node);
 		while (oval_variable_iterator_has_more(variables)) {
 			struct oval_variable *variable = oval_variable_iterator_next(variables);
 			oval_variable_to_dom(variable, doc, variables_node);
+			oscap_xml_stream_flush(stream, variables_node);
 		}
+		oscap_xml_stream_close(stream, variables_node);
 	}
 	oval_variable_iterator_free(variables);
 
+	oscap_xml_stream_close(stream, root_node);
 	return root_node;
 }
 
@@ -560,7 +582,7 @@ int oval_definition_model_export(struct oval_definition_model *model, const char
 		return -1;
 	}
 
-	oval_definition_model_to_dom(model, doc, NULL);
+	oval_definition_model_to_dom(model, doc, NULL, NULL);
 	return oscap_xml_save_filename_free(file, doc);
 }
 
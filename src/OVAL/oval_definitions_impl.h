@@ -40,6 +40,7 @@
 #include "oval_parser_impl.h"
 #include "adt/oval_string_map_impl.h"
 #include "../common/util.h"
+#include "../common/oscap_xml_stream.h"
 
 
 oval_family_t oval_family_parse(xmlTextReaderPtr);
@@ -161,7 +162,7 @@ int oval_generator_parse_tag(xmlTextReader *, struct oval_parser_context *, void
 xmlNode *oval_generator_to_dom(struct oval_generator *, xmlDocPtr, xmlNode *);
 
 /* definition_model */
-xmlNode *oval_definition_model_to_dom(struct oval_definition_model *definition_model, xmlDocPtr doc, xmlNode * parent);
+xmlNode *oval_definition_model_to_dom(struct oval_definition_model *definition_model, xmlDocPtr doc, xmlNode * parent, struct oscap_xml_stream *stream);
 void oval_definition_model_optimize_by_filter_propagation(struct oval_definition_model *);
 
 struct oval_definition *oval_definition_model_get_new_definition(struct oval_definition_model *, const char *);
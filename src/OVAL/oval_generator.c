@@ -152,10 +152,16 @@ void oval_generator_set_timestamp(struct oval_generator *generator, const char *
 void oval_generator_update_timestamp(struct oval_generator *generator)
 {
 	time_t et;
-	struct tm *lt;
+	struct tm tm_et;
+	struct tm *lt = &tm_et;
 
 	time(&et);
-	lt = localtime(&et);
+	/* Definition models may be created by several threads at once */
+#ifdef OS_WINDOWS
+	localtime_s(lt, &et);
+#else
+	localtime_r(&et, lt);
+#endif
 	int timestamp_size = snprintf(NULL, 0, "%4d-%02d-%02dT%02d:%02d:%02d",
 		 1900 + lt->tm_year, 1 + lt->tm_mon, lt->tm_mday, lt->tm_hour, lt->tm_min, lt->tm_sec);
 	if (timestamp_size < 0) {
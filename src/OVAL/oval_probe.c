@@ -127,6 +127,7 @@ int oval_probe_query_object(oval_probe_session_t *psess, struct oval_object *obj
 			dI("System characteristics for %s_object '%s' already exist, flag: %s.", type_name, oid, flag_text);
 
 			if (sc_flg != SYSCHAR_FLAG_UNKNOWN || (flags & OVAL_PDFLAG_NOREPLY)) {
+				oval_probe_session_count_query(psess, type, true);
 				if (out_syschar)
 					*out_syschar = sysc;
 				return 0;
@@ -140,6 +141,7 @@ int oval_probe_query_object(oval_probe_session_t *psess, struct oval_object *obj
 	if (out_syschar)
 		*out_syschar = sysc;
 
+	oval_probe_session_count_query(psess, type, false);
 	ph = oval_probe_handler_get(psess->ph, type);
 
 	if (ph == NULL) {
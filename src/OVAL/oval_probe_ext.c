@@ -42,14 +42,19 @@
 #include "common/util.h"
 #include "common/bfind.h"
 #include "common/debug_priv.h"
+#include "common/oscap_profile.h"
 #include "probes/public/probe-api.h"
 #include "oval_probe_ext.h"
 #include "oval_sexp.h"
 #include "probe-table.h"
 #include "_oval_probe_handler.h"
+#include "_oval_probe_session.h"
 
 #define __ERRBUF_SIZE 128
 
+/* maximum number of requests sent to a probe before waiting for a reply */
+#define OVAL_PROBE_BATCH_WINDOW 16
+
 static oval_pdtbl_t *oval_pdtbl_new(void);
 static void          oval_pdtbl_free(oval_pdtbl_t *table);
 static int           oval_pdtbl_add(oval_pdtbl_t *table, oval_subtype_t type, int sd, const char *uri);
@@ -795,6 +800,49 @@ int oval_probe_sys_handler(oval_subtype_t type, void *ptr, int act, ...)
         return(ret);
 }
 
+/*
+ * Find the descriptor of the probe for the given subtype or register
+ * a new one. Returns 0 on success, 1 if there's no such probe and -1
+ * on error.
+ */
+static int oval_probe_ext_getpd(oval_pext_t *pext, oval_subtype_t subtype, oval_pd_t **out_pd)
+{
+	oval_pd_t *pd;
+
+	pd = oval_pdtbl_get(pext->pdtbl, subtype);
+
+        if (pd == NULL) {
+                char         probe_uri[PATH_MAX + 1];
+                size_t       probe_urilen;
+
+		if (!probe_table_exists(subtype))
+			return (1);
+
+		probe_urilen = snprintf(probe_uri, sizeof probe_uri, "%s://%s",
+				OVAL_PROBE_SCHEME, oval_subtype_get_text(subtype));
+
+                if (probe_urilen >= sizeof probe_uri) {
+                        oscap_seterr (OSCAP_EFAMILY_GLIBC, "probe URI too long");
+                        return (-1);
+                }
+
+                dI("Starting probe on URI '%s'.", probe_uri);
+
+                if (oval_pdtbl_add(pext->pdtbl, subtype, -1, probe_uri) != 0)
+                        return (1);
+
+		pd = oval_pdtbl_get(pext->pdtbl, subtype);
+
+                if (pd == NULL) {
+                        oscap_seterr (OSCAP_EFAMILY_OVAL, "internal error");
+                        return (-1);
+                }
+        }
+
+	*out_pd = pd;
+	return (0);
+}
+
 int oval_probe_ext_handler(oval_subtype_t type, void *ptr, int act, ...)
 {
         int          ret = 0;
@@ -814,46 +862,16 @@ int oval_probe_ext_handler(oval_subtype_t type, void *ptr, int act, ...)
 		sys = va_arg(ap, struct oval_syschar *);
 		flags = va_arg(ap, int);
 		obj = oval_syschar_get_object(sys);
-		oval_subtype_t obj_subtype = oval_object_get_subtype(obj);
-		pd = oval_pdtbl_get(pext->pdtbl, obj_subtype);
-
-                if (pd == NULL) {
-                        char         probe_uri[PATH_MAX + 1];
-                        size_t       probe_urilen;
-
-			if (!probe_table_exists(obj_subtype)) {
-				oval_syschar_add_new_message(sys, "OVAL object not supported", OVAL_MESSAGE_LEVEL_WARNING);
-				oval_syschar_set_flag(sys, SYSCHAR_FLAG_NOT_COLLECTED);
-				va_end(ap);
-				return (1);
-			}
-
-			probe_urilen = snprintf(probe_uri, sizeof probe_uri, "%s://%s",
-					OVAL_PROBE_SCHEME, oval_subtype_get_text(obj_subtype));
-
-                        if (probe_urilen >= sizeof probe_uri) {
-                                oscap_seterr (OSCAP_EFAMILY_GLIBC, "probe URI too long");
-				va_end(ap);
-                                return (-1);
-                        }
-
-                        dI("Starting probe on URI '%s'.", probe_uri);
 
-                        if (oval_pdtbl_add(pext->pdtbl, obj_subtype, -1, probe_uri) != 0) {
+		ret = oval_probe_ext_getpd(pext, oval_object_get_subtype(obj), &pd);
+		if (ret != 0) {
+			if (ret == 1) {
 				oval_syschar_add_new_message(sys, "OVAL object not supported", OVAL_MESSAGE_LEVEL_WARNING);
 				oval_syschar_set_flag(sys, SYSCHAR_FLAG_NOT_COLLECTED);
-				va_end(ap);
-                                return (1);
 			}
-
-			pd = oval_pdtbl_get(pext->pdtbl, obj_subtype);
-
-                        if (pd == NULL) {
-                                oscap_seterr (OSCAP_EFAMILY_OVAL, "internal error");
-				va_end(ap);
-                                return (-1);
-                        }
-                }
+			va_end(ap);
+			return (ret);
+		}
 
 		ret = oval_probe_ext_eval(pext->pdtbl->ctx, pd, pext, sys, flags);
 
@@ -878,6 +896,25 @@ int oval_probe_ext_handler(oval_subtype_t type, void *ptr, int act, ...)
 		va_end(ap);
 		return ret;
         }
+	case PROBE_HANDLER_ACT_EVAL_BATCH:
+	{
+		struct oval_syschar **sysv;
+		size_t sysc;
+		int flags;
+
+		sysv = va_arg(ap, struct oval_syschar **);
+		sysc = va_arg(ap, size_t);
+		flags = va_arg(ap, int);
+		va_end(ap);
+
+		if (sysc == 0)
+			return (0);
+		/* a missing probe is reported by the regular query */
+		if (oval_probe_ext_getpd(pext, type, &pd) != 0)
+			return (1);
+
+		return oval_probe_ext_eval_batch(pext->pdtbl->ctx, pd, pext, sysv, sysc, flags);
+	}
         case PROBE_HANDLER_ACT_OPEN:
                 break;
         case PROBE_HANDLER_ACT_INIT:
@@ -964,6 +1001,8 @@ int oval_probe_ext_eval(SEAP_CTX_t *ctx, oval_pd_t *pd, oval_pext_t *pext, struc
 {
         SEXP_t *s_obj, *s_sys;
 	struct oval_object *object;
+	uint64_t start_ns;
+	size_t bytes_sent;
 	int ret;
 
 	if (syschar == NULL) {
@@ -977,6 +1016,8 @@ int oval_probe_ext_eval(SEAP_CTX_t *ctx, oval_pd_t *pd, oval_pext_t *pext, struc
 	if (ret != 0)
 		return (1);
 
+	start_ns = oscap_profile_now();
+	bytes_sent = SEXP_sizeof(s_obj);
 	ret = oval_probe_comm(ctx, pd, s_obj, flags, &s_sys);
 	SEXP_free(s_obj);
 
@@ -1013,8 +1054,199 @@ int oval_probe_ext_eval(SEAP_CTX_t *ctx, oval_pd_t *pd, oval_pext_t *pext, struc
         /*
 	 * Convert the received S-exp to OVAL system characteristic.
 	 */
+	size_t bytes_received = SEXP_sizeof(s_sys);
 	ret = oval_sexp_to_sysch(s_sys, syschar);
 	SEXP_free(s_sys);
+	oval_probe_session_count_collection(pext->sess_ptr, oval_object_get_subtype(object), syschar,
+					    oscap_profile_now() - start_ns, bytes_sent, bytes_received);
+
+	return (ret);
+}
+
+/*
+ * Evaluate several objects of the same probe. Up to OVAL_PROBE_BATCH_WINDOW
+ * requests are kept in flight so the probe can work on the next objects
+ * while the replies to the previous ones are converted. Replies are matched
+ * with requests by the reply-id attribute. A syschar whose request failed is
+ * left untouched (flag unknown) and the error is reported later when the
+ * object is queried again by oval_probe_query_object. With OVAL_PDFLAG_NOREPLY
+ * the probes only acknowledge the requests and the syschars are not filled.
+ */
+int oval_probe_ext_eval_batch(SEAP_CTX_t *ctx, oval_pd_t *pd, oval_pext_t *pext, struct oval_syschar **sysv, size_t sysc, int flags)
+{
+	SEAP_msg_t *s_omsg[OVAL_PROBE_BATCH_WINDOW];
+	size_t      s_oidx[OVAL_PROBE_BATCH_WINDOW];
+	uint64_t    s_otime[OVAL_PROBE_BATCH_WINDOW];
+	size_t      s_osize[OVAL_PROBE_BATCH_WINDOW];
+	size_t      next, pending, i;
+	int         ret = 0;
+
+	ctx->subtype = pd->subtype;
+	if (pd->sd == -1) {
+		pd->sd = SEAP_connect(ctx);
+
+		if (pd->sd < 0) {
+			protect_errno {
+				dW("Can't connect: %u, %s.", errno, strerror(errno));
+			}
+			pd->sd = -1;
+			return (-1);
+		}
+	}
+
+	for (i = 0; i < OVAL_PROBE_BATCH_WINDOW; ++i)
+		s_omsg[i] = NULL;
+
+	next = pending = 0;
+
+	while (next < sysc || pending > 0) {
+		SEAP_msg_t *s_imsg;
+		SEXP_t *s_rid, *s_sys;
+		SEAP_msgid_t rid;
+
+		/* fill the window */
+		for (i = 0; i < OVAL_PROBE_BATCH_WINDOW && next < sysc; ++i) {
+			SEXP_t *s_obj;
+
+			if (s_omsg[i] != NULL)
+				continue;
+
+			/* objects which can't be converted are left to the regular query */
+			while (next < sysc && oval_object_to_sexp(pext->sess_ptr, oval_subtype_to_str(pd->subtype),
+								  sysv[next], &s_obj) != 0)
+				++next;
+
+			if (next == sysc)
+				break;
+
+			s_omsg[i] = SEAP_msg_new();
+			SEAP_msg_set(s_omsg[i], s_obj);
+			s_osize[i] = SEXP_sizeof(s_obj);
+			SEXP_free(s_obj);
+
+			if ((flags & OVAL_PDFLAG_NOREPLY) && SEAP_msgattr_set(s_omsg[i], "no-reply", NULL) != 0) {
+				dE("Can't set no-reply attribute.");
+				SEAP_msg_free(s_omsg[i]);
+				s_omsg[i] = NULL;
+				ret = -1;
+				goto fail;
+			}
+
+			if (SEAP_sendmsg(ctx, pd->sd, s_omsg[i]) != 0) {
+				protect_errno {
+					dW("Can't send message: %u, %s.", errno, strerror(errno));
+					SEAP_msg_free(s_omsg[i]);
+				}
+				s_omsg[i] = NULL;
+				ret = -1;
+				goto fail;
+			}
+
+			s_oidx[i] = next++;
+			s_otime[i] = oscap_profile_now();
+			++pending;
+		}
+
+		if (pending == 0)
+			break;
+
+		s_imsg = NULL;
+
+		if (SEAP_recvmsg(ctx, pd->sd, &s_imsg) != 0) {
+			SEAP_err_t *err = NULL;
+
+			SEAP_msg_free(s_imsg);
+
+			if (errno != ECANCELED) {
+				protect_errno {
+					dW("Can't receive message: %u, %s.", errno, strerror(errno));
+				}
+				ret = -1;
+				goto fail;
+			}
+
+			/* drop the request the error belongs to */
+			for (i = 0; i < OVAL_PROBE_BATCH_WINDOW; ++i) {
+				if (s_omsg[i] == NULL)
+					continue;
+				if (SEAP_recverr_byid(ctx, pd->sd, &err, SEAP_msg_id(s_omsg[i])) == 0)
+					break;
+			}
+
+			if (i == OVAL_PROBE_BATCH_WINDOW) {
+				dE("Internal error: An error was signaled on sd=%d but the error queue is empty.", pd->sd);
+				ret = -1;
+				goto fail;
+			}
+
+			dD("Probe at sd=%d reported an error for object '%s'.",
+			   pd->sd, oval_object_get_id(oval_syschar_get_object(sysv[s_oidx[i]])));
+			SEAP_error_free(err);
+			SEAP_msg_free(s_omsg[i]);
+			s_omsg[i] = NULL;
+			--pending;
+			continue;
+		}
+
+		s_rid = SEAP_msgattr_get(s_imsg, "reply-id");
+		if (s_rid == NULL) {
+			dW("Dropping a message without reply-id from sd=%d.", pd->sd);
+			SEAP_msg_free(s_imsg);
+			continue;
+		}
+#if SEAP_MSGID_BITS == 64
+		rid = SEXP_number_getu_64(s_rid);
+#else
+		rid = SEXP_number_getu_32(s_rid);
+#endif
+		SEXP_free(s_rid);
+
+		for (i = 0; i < OVAL_PROBE_BATCH_WINDOW; ++i) {
+			if (s_omsg[i] != NULL && SEAP_msg_id(s_omsg[i]) == rid)
+				break;
+		}
+
+		if (i == OVAL_PROBE_BATCH_WINDOW) {
+			dW("Dropping an unexpected reply (reply-id=%u) from sd=%d.", (unsigned int) rid, pd->sd);
+			SEAP_msg_free(s_imsg);
+			continue;
+		}
+
+		s_sys = SEAP_msg_get(s_imsg);
+		SEAP_msg_free(s_imsg);
+
+		if (s_sys != NULL && (flags & OVAL_PDFLAG_NOREPLY)) {
+			if (SEXP_typeof(s_sys) != SEXP_TYPE_LIST || SEXP_list_length(s_sys) != 0)
+				dW("Obtrusive data from probe!");
+			if (SEXP_typeof(s_sys) == SEXP_TYPE_LIST)
+				SEXP_list_free(s_sys);
+			else
+				SEXP_free(s_sys);
+		} else if (s_sys != NULL) {
+			size_t bytes_received = SEXP_sizeof(s_sys);
+
+			oval_sexp_to_sysch(s_sys, sysv[s_oidx[i]]);
+			SEXP_free(s_sys);
+			oval_probe_session_count_collection(pext->sess_ptr, pd->subtype, sysv[s_oidx[i]],
+							    oscap_profile_now() - s_otime[i], s_osize[i], bytes_received);
+		}
+
+		SEAP_msg_free(s_omsg[i]);
+		s_omsg[i] = NULL;
+		--pending;
+	}
+
+	return (0);
+fail:
+	/*
+	 * The state of the connection is unknown, close it and let
+	 * the regular query path reconnect to the probe.
+	 */
+	for (i = 0; i < OVAL_PROBE_BATCH_WINDOW; ++i)
+		SEAP_msg_free(s_omsg[i]);
+
+	SEAP_close(ctx, pd->sd);
+	pd->sd = -1;
 
 	return (ret);
 }
@@ -63,5 +63,8 @@ const char *oval_subtype_to_str(oval_subtype_t subtype);
 
 int oval_probe_hint_definition(oval_probe_session_t *sess, struct oval_definition *definition, int variable_instance_hint);
 
+void oval_probe_prefetch_definition(oval_probe_session_t *sess, struct oval_definition *definition);
+void oval_probe_prefetch_model(oval_probe_session_t *sess, struct oval_definition_model *model);
+
 #endif /* OVAL_PROBE_IMPL_H */
 /// @}
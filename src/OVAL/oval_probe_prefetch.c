@@ -0,0 +1,289 @@
+/*
+ * Copyright 2026 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdlib.h>
+
+#include "public/oval_definitions.h"
+#include "public/oval_system_characteristics.h"
+#include "oval_system_characteristics_impl.h"
+#include "oval_probe_impl.h"
+#include "_oval_probe_session.h"
+#include "_oval_probe_handler.h"
+#include "oval_probe_ext.h"
+#include "collectVarRefs_impl.h"
+#include "adt/oval_string_map_impl.h"
+#include "common/list.h"
+#include "common/debug_priv.h"
+
+/*
+ * Probes which can evaluate several objects at the same time. Objects
+ * of other types are always collected one by one by oval_probe_query_object.
+ */
+static const oval_subtype_t OVAL_PROBE_PREFETCH_SUBTYPES[] = {
+	OVAL_UNIX_FILE,
+	OVAL_UNIX_FILEEXTENDEDATTRIBUTE,
+	OVAL_UNIX_SYMLINK,
+	OVAL_INDEPENDENT_FILE_HASH,
+	OVAL_INDEPENDENT_FILE_HASH58,
+	OVAL_INDEPENDENT_TEXT_FILE_CONTENT,
+	OVAL_INDEPENDENT_TEXT_FILE_CONTENT_54,
+	OVAL_INDEPENDENT_XML_FILE_CONTENT,
+	OVAL_INDEPENDENT_YAML_FILE_CONTENT
+};
+
+#define OVAL_PROBE_PREFETCH_SUBTYPES_CNT (sizeof OVAL_PROBE_PREFETCH_SUBTYPES / sizeof OVAL_PROBE_PREFETCH_SUBTYPES[0])
+
+struct oval_probe_prefetch {
+	oval_probe_session_t *sess;
+	struct oscap_list *objects;        /* objects to collect, in document order */
+	struct oval_string_map *seen;      /* ids of the objects already considered */
+	struct oval_string_map *visited;   /* ids of the definitions already walked */
+};
+
+static void _oval_probe_prefetch_criteria(struct oval_probe_prefetch *pf, struct oval_criteria_node *cnode);
+
+static bool _oval_probe_prefetch_subtype(oval_subtype_t subtype)
+{
+	for (size_t i = 0; i < OVAL_PROBE_PREFETCH_SUBTYPES_CNT; ++i) {
+		if (OVAL_PROBE_PREFETCH_SUBTYPES[i] == subtype)
+			return true;
+	}
+	return false;
+}
+
+/*
+ * An object can be collected ahead of time only if its collection does not
+ * depend on anything evaluated on the library side, i.e. it references no
+ * variables and it contains neither sets nor filters (which need the probe
+ * to call back into the library).
+ */
+static bool _oval_probe_prefetch_object_eligible(struct oval_object *object)
+{
+	struct oval_object_content_iterator *cit;
+	struct oval_string_map *vm;
+	struct oval_iterator *vit;
+	bool eligible = true;
+
+	cit = oval_object_get_object_contents(object);
+	while (oval_object_content_iterator_has_more(cit)) {
+		struct oval_object_content *content = oval_object_content_iterator_next(cit);
+
+		if (oval_object_content_get_type(content) != OVAL_OBJECTCONTENT_ENTITY) {
+			eligible = false;
+			break;
+		}
+	}
+	oval_object_content_iterator_free(cit);
+
+	if (!eligible)
+		return false;
+
+	vm = oval_string_map_new();
+	oval_obj_collect_var_refs(object, vm);
+	vit = oval_string_map_values(vm);
+	eligible = !oval_collection_iterator_has_more(vit);
+	oval_collection_iterator_free(vit);
+	oval_string_map_free(vm, NULL);
+
+	return eligible;
+}
+
+static void _oval_probe_prefetch_test(struct oval_probe_prefetch *pf, struct oval_test *test)
+{
+	struct oval_object *object;
+	char *oid;
+
+	object = oval_test_get_object(test);
+	if (object == NULL)
+		return;
+	/* incompatible tests are reported by oval_probe_query_test */
+	if (oval_test_get_subtype(test) != oval_object_get_subtype(object))
+		return;
+
+	oid = oval_object_get_id(object);
+	if (oval_string_map_get_value(pf->seen, oid) != NULL)
+		return;
+	oval_string_map_put(pf->seen, oid, object);
+
+	if (!_oval_probe_prefetch_subtype(oval_object_get_subtype(object)))
+		return;
+	if (oval_syschar_model_get_syschar(pf->sess->sys_model, oid) != NULL)
+		return;
+	if (!_oval_probe_prefetch_object_eligible(object))
+		return;
+
+	oscap_list_add(pf->objects, object);
+}
+
+static void _oval_probe_prefetch_definition(struct oval_probe_prefetch *pf, struct oval_definition *definition)
+{
+	struct oval_criteria_node *cnode;
+	char *id;
+
+	if (definition == NULL)
+		return;
+	/* extend_definition may be circular, that is reported by the evaluation */
+	id = oval_definition_get_id(definition);
+	if (oval_string_map_get_value(pf->visited, id) != NULL)
+		return;
+	oval_string_map_put(pf->visited, id, definition);
+
+	cnode = oval_definition_get_criteria(definition);
+	if (cnode == NULL)
+		return;
+	_oval_probe_prefetch_criteria(pf, cnode);
+}
+
+static void _oval_probe_prefetch_criteria(struct oval_probe_prefetch *pf, struct oval_criteria_node *cnode)
+{
+	switch (oval_criteria_node_get_type(cnode)) {
+	case OVAL_NODETYPE_CRITERION:{
+		struct oval_test *test = oval_criteria_node_get_test(cnode);
+		if (test != NULL)
+			_oval_probe_prefetch_test(pf, test);
+		break;
+	}
+	case OVAL_NODETYPE_CRITERIA:{
+		struct oval_criteria_node_iterator *cnode_it = oval_criteria_node_get_subnodes(cnode);
+		if (cnode_it == NULL)
+			break;
+		while (oval_criteria_node_iterator_has_more(cnode_it))
+			_oval_probe_prefetch_criteria(pf, oval_criteria_node_iterator_next(cnode_it));
+		oval_criteria_node_iterator_free(cnode_it);
+		break;
+	}
+	case OVAL_NODETYPE_EXTENDDEF:
+		_oval_probe_prefetch_definition(pf, oval_criteria_node_get_definition(cnode));
+		break;
+	default:
+		break;
+	}
+}
+
+static void _oval_probe_prefetch_batch(struct oval_probe_prefetch *pf, oval_subtype_t type, struct oval_syschar **sysv)
+{
+	struct oscap_iterator *it;
+	oval_ph_t *ph;
+	size_t sysc = 0;
+
+	ph = oval_probe_handler_get(pf->sess->ph, type);
+	if (ph == NULL)
+		return;
+
+	it = oscap_iterator_new(pf->objects);
+	while (oscap_iterator_has_more(it)) {
+		struct oval_object *object = oscap_iterator_next(it);
+
+		if (oval_object_get_subtype(object) == type)
+			sysv[sysc++] = oval_syschar_new(pf->sess->sys_model, object);
+	}
+	oscap_iterator_free(it);
+
+	dI("Prefetching %zu %s objects.", sysc, oval_subtype_get_text(type));
+	if (oval_probe_ext_handler(type, ph->uptr, PROBE_HANDLER_ACT_EVAL_BATCH, sysv, sysc, 0) < 0)
+		dW("Prefetching of %s objects failed, the objects will be queried one by one.",
+		   oval_subtype_get_text(type));
+}
+
+/*
+ * Send the gathered objects to their probes, one batch per probe. Probes
+ * are contacted in the order of their first object in the document.
+ */
+static void _oval_probe_prefetch_run(struct oval_probe_prefetch *pf)
+{
+	bool done[OVAL_PROBE_PREFETCH_SUBTYPES_CNT] = { false };
+	size_t count = oscap_list_get_itemcount(pf->objects);
+	struct oval_syschar **sysv;
+	struct oscap_iterator *it;
+
+	if (count == 0)
+		return;
+
+	sysv = malloc(count * sizeof(struct oval_syschar *));
+	if (sysv == NULL)
+		return;
+
+	it = oscap_iterator_new(pf->objects);
+	while (oscap_iterator_has_more(it)) {
+		oval_subtype_t type = oval_object_get_subtype(oscap_iterator_next(it));
+
+		for (size_t i = 0; i < OVAL_PROBE_PREFETCH_SUBTYPES_CNT; ++i) {
+			if (OVAL_PROBE_PREFETCH_SUBTYPES[i] == type && !done[i]) {
+				_oval_probe_prefetch_batch(pf, type, sysv);
+				done[i] = true;
+			}
+		}
+	}
+	oscap_iterator_free(it);
+
+	free(sysv);
+}
+
+static void _oval_probe_prefetch_init(struct oval_probe_prefetch *pf, oval_probe_session_t *sess)
+{
+	pf->sess = sess;
+	pf->objects = oscap_list_new();
+	pf->seen = oval_string_map_new();
+	pf->visited = oval_string_map_new();
+}
+
+static void _oval_probe_prefetch_free(struct oval_probe_prefetch *pf)
+{
+	oscap_list_free0(pf->objects);
+	oval_string_map_free(pf->seen, NULL);
+	oval_string_map_free(pf->visited, NULL);
+}
+
+/**
+ * Collects the objects needed by the given definition before the definition
+ * is evaluated. Objects which do not depend on variables, sets or filters are
+ * sent to their probes in batches, so that probes can work on several objects
+ * at once. The collected syschars are then found by @ref oval_probe_query_object.
+ * Objects which could not be collected this way are left for the regular query.
+ */
+void oval_probe_prefetch_definition(oval_probe_session_t *sess, struct oval_definition *definition)
+{
+	struct oval_probe_prefetch pf;
+
+	_oval_probe_prefetch_init(&pf, sess);
+	_oval_probe_prefetch_definition(&pf, definition);
+	_oval_probe_prefetch_run(&pf);
+	_oval_probe_prefetch_free(&pf);
+}
+
+/**
+ * Same as @ref oval_probe_prefetch_definition for all the definitions of the model.
+ */
+void oval_probe_prefetch_model(oval_probe_session_t *sess, struct oval_definition_model *model)
+{
+	struct oval_definition_iterator *def_it;
+	struct oval_probe_prefetch pf;
+
+	_oval_probe_prefetch_init(&pf, sess);
+	def_it = oval_definition_model_get_definitions(model);
+	while (oval_definition_iterator_has_more(def_it))
+		_oval_probe_prefetch_definition(&pf, oval_definition_iterator_next(def_it));
+	oval_definition_iterator_free(def_it);
+	_oval_probe_prefetch_run(&pf);
+	_oval_probe_prefetch_free(&pf);
+}
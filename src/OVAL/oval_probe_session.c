@@ -39,6 +39,8 @@
 #include "common/_error.h"
 #include "common/bfind.h"
 #include "common/debug_priv.h"
+#include "common/oscap_profile.h"
+#include "common/util.h"
 
 
 #include "public/oval_definitions.h"
@@ -125,6 +127,173 @@ static void __init_once(void)
         return;
 }
 
+struct oval_probe_stats {
+	oval_subtype_t subtype;
+	uint64_t queries;
+	uint64_t cache_hits;
+	uint64_t collected;
+	uint64_t items;
+	uint64_t bytes_sent;
+	uint64_t bytes_received;
+	uint64_t time_us;
+	uint64_t histogram[OVAL_PROBE_STATS_HISTOGRAM_SIZE];
+	char *slowest_object;
+	uint64_t slowest_us;
+};
+
+/* Upper bounds of the histogram buckets in microseconds */
+static const uint64_t oval_probe_stats_bounds[OVAL_PROBE_STATS_HISTOGRAM_SIZE] = {
+	100, 1000, 10000, 100000, 1000000, 10000000, UINT64_MAX
+};
+
+static void oval_probe_stats_free(struct oval_probe_stats *stats)
+{
+	if (stats == NULL)
+		return;
+	free(stats->slowest_object);
+	free(stats);
+}
+
+static bool oval_probe_stats_cmp_subtype(void *stats, void *subtype)
+{
+	return ((struct oval_probe_stats *) stats)->subtype == *(oval_subtype_t *) subtype;
+}
+
+/* Must be called with stats_lock held */
+static struct oval_probe_stats *oval_probe_session_stats_get(oval_probe_session_t *sess, oval_subtype_t subtype)
+{
+	struct oval_probe_stats *stats = oscap_list_find(sess->stats, &subtype, oval_probe_stats_cmp_subtype);
+
+	if (stats == NULL) {
+		stats = calloc(1, sizeof(struct oval_probe_stats));
+		if (stats == NULL)
+			return NULL;
+		stats->subtype = subtype;
+		oscap_list_add(sess->stats, stats);
+	}
+	return stats;
+}
+
+void oval_probe_session_count_query(oval_probe_session_t *sess, oval_subtype_t subtype, bool cache_hit)
+{
+	pthread_mutex_lock(&sess->stats_lock);
+	struct oval_probe_stats *stats = oval_probe_session_stats_get(sess, subtype);
+	if (stats != NULL) {
+		stats->queries++;
+		if (cache_hit)
+			stats->cache_hits++;
+	}
+	pthread_mutex_unlock(&sess->stats_lock);
+}
+
+void oval_probe_session_count_collection(oval_probe_session_t *sess, oval_subtype_t subtype, struct oval_syschar *syschar,
+					 uint64_t time_ns, size_t bytes_sent, size_t bytes_received)
+{
+	uint64_t time_us = time_ns / 1000;
+	size_t items = 0;
+	unsigned int bucket = 0;
+
+	struct oval_sysitem_iterator *it = oval_syschar_get_sysitem(syschar);
+	while (oval_sysitem_iterator_has_more(it)) {
+		oval_sysitem_iterator_next(it);
+		++items;
+	}
+	oval_sysitem_iterator_free(it);
+
+	while (time_us > oval_probe_stats_bounds[bucket])
+		++bucket;
+
+	pthread_mutex_lock(&sess->stats_lock);
+	struct oval_probe_stats *stats = oval_probe_session_stats_get(sess, subtype);
+	if (stats != NULL) {
+		stats->collected++;
+		stats->items += items;
+		stats->bytes_sent += bytes_sent;
+		stats->bytes_received += bytes_received;
+		stats->time_us += time_us;
+		stats->histogram[bucket]++;
+		if (stats->slowest_object == NULL || time_us > stats->slowest_us) {
+			free(stats->slowest_object);
+			stats->slowest_object = oscap_strdup(oval_object_get_id(oval_syschar_get_object(syschar)));
+			stats->slowest_us = time_us;
+		}
+	}
+	pthread_mutex_unlock(&sess->stats_lock);
+
+	oscap_profile_probe(oval_subtype_to_str(subtype), time_ns, items);
+}
+
+OSCAP_ITERATOR_GEN(oval_probe_stats)
+
+struct oval_probe_stats_iterator *oval_probe_session_get_stats(oval_probe_session_t *sess)
+{
+	return (struct oval_probe_stats_iterator *) oscap_iterator_new(sess->stats);
+}
+
+oval_subtype_t oval_probe_stats_get_subtype(const struct oval_probe_stats *stats)
+{
+	return stats->subtype;
+}
+
+uint64_t oval_probe_stats_get_queries(const struct oval_probe_stats *stats)
+{
+	return stats->queries;
+}
+
+uint64_t oval_probe_stats_get_cache_hits(const struct oval_probe_stats *stats)
+{
+	return stats->cache_hits;
+}
+
+uint64_t oval_probe_stats_get_collected(const struct oval_probe_stats *stats)
+{
+	return stats->collected;
+}
+
+uint64_t oval_probe_stats_get_items(const struct oval_probe_stats *stats)
+{
+	return stats->items;
+}
+
+uint64_t oval_probe_stats_get_bytes_sent(const struct oval_probe_stats *stats)
+{
+	return stats->bytes_sent;
+}
+
+uint64_t oval_probe_stats_get_bytes_received(const struct oval_probe_stats *stats)
+{
+	return stats->bytes_received;
+}
+
+uint64_t oval_probe_stats_get_time(const struct oval_probe_stats *stats)
+{
+	return stats->time_us;
+}
+
+uint64_t oval_probe_stats_get_histogram(const struct oval_probe_stats *stats, unsigned int bucket)
+{
+	if (bucket >= OVAL_PROBE_STATS_HISTOGRAM_SIZE)
+		return 0;
+	return stats->histogram[bucket];
+}
+
+uint64_t oval_probe_stats_histogram_bound(unsigned int bucket)
+{
+	if (bucket >= OVAL_PROBE_STATS_HISTOGRAM_SIZE)
+		return UINT64_MAX;
+	return oval_probe_stats_bounds[bucket];
+}
+
+const char *oval_probe_stats_get_slowest_object(const struct oval_probe_stats *stats)
+{
+	return stats->slowest_object;
+}
+
+uint64_t oval_probe_stats_get_slowest_time(const struct oval_probe_stats *stats)
+{
+	return stats->slowest_us;
+}
+
 static void oval_probe_session_init(oval_probe_session_t *sess, struct oval_syschar_model *model)
 {
         sess->ph = oval_phtbl_new();
@@ -155,6 +324,9 @@ oval_probe_session_t *oval_probe_session_new(struct oval_syschar_model *model)
 {
         oval_probe_session_t *sess = malloc(sizeof(oval_probe_session_t));
         oval_probe_session_init(sess, model);
+        /* The counters are kept by oval_probe_session_reinit() */
+        sess->stats = oscap_list_new();
+        pthread_mutex_init(&sess->stats_lock, NULL);
         return sess;
 }
 
@@ -179,6 +351,10 @@ void oval_probe_session_reinit(oval_probe_session_t *sess, struct oval_syschar_m
 void oval_probe_session_destroy(oval_probe_session_t *sess)
 {
 	oval_probe_session_free(sess);
+	if (sess != NULL) {
+		oscap_list_free(sess->stats, (oscap_destruct_func) oval_probe_stats_free);
+		pthread_mutex_destroy(&sess->stats_lock);
+	}
 	free(sess);
 }
 
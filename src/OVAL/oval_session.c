@@ -38,6 +38,7 @@
 #include "common/util.h"
 #include "common/_error.h"
 #include "common/oscapxml.h"
+#include "common/oscap_profile.h"
 #include "source/xslt_priv.h"
 #include "public/oval_agent_api.h"
 #include "public/oval_session.h"
@@ -349,7 +350,10 @@ int oval_session_evaluate_id(struct oval_session *session, const char *id, oval_
 		return 1;
 	}
 
+	struct oscap_profile_span span;
+	oscap_profile_begin(&span, OSCAP_PROFILE_EVALUATION);
 	oval_agent_eval_definition(session->sess, id);
+	oscap_profile_end(&span);
 	*result = OVAL_RESULT_NOT_EVALUATED;
 	oval_agent_get_definition_result(session->sess, id, result);
 	if (oscap_err()) {
@@ -369,7 +373,10 @@ int oval_session_evaluate(struct oval_session *session, agent_reporter fn, void
 		return 1;
 	}
 
+	struct oscap_profile_span span;
+	oscap_profile_begin(&span, OSCAP_PROFILE_EVALUATION);
 	oval_agent_eval_system(session->sess, fn, arg);
+	oscap_profile_end(&span);
 	if (oscap_err()) {
 		return 1;
 	}
@@ -388,6 +395,9 @@ int oval_session_export(struct oval_session *session)
 	struct oscap_source *result = NULL;		/* OVAL Results */
 	const char *filename = NULL;
 	int ret = 0;
+	struct oscap_profile_span span;
+
+	oscap_profile_begin(&span, OSCAP_PROFILE_EXPORT);
 
 	/* Import OVAL Directives if any */
 	if (session->oval.directives && session->res_model) {
@@ -444,6 +454,7 @@ cleanup:
 		oscap_source_free(result);
 	if (dir_model)
 		oval_directives_model_free(dir_model);
+	oscap_profile_end(&span);
 	return ret;
 }
 
@@ -452,6 +463,15 @@ void oval_session_set_export_system_characteristics(struct oval_session *session
 	session->export_sys_chars = export;
 }
 
+struct oval_probe_session *oval_session_get_probe_session(struct oval_session *session)
+{
+	__attribute__nonnull__(session);
+
+	if (session->sess == NULL)
+		return NULL;
+	return oval_agent_get_probe_session(session->sess);
+}
+
 void oval_session_configure_remote_resources(struct oval_session *session, bool allowed, const char *local_files, download_progress_calllback_t callback)
 {
 	session->fetch_remote_resources = allowed;
@@ -34,6 +34,9 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#if defined(OSCAP_THREAD_SAFE)
+# include <pthread.h>
+#endif
 
 #include "oval_definitions_impl.h"
 #include "adt/oval_collection_impl.h"
@@ -414,18 +417,31 @@ oval_syschar_collection_flag_t oval_variable_get_collection_flag(struct oval_var
 	return variable->flag;
 }
 
-int oval_syschar_model_compute_variable(struct oval_syschar_model *sysmod, struct oval_variable *variable)
+#if defined(OSCAP_THREAD_SAFE)
+/*
+ * Local variables are computed lazily during test evaluation, which can
+ * run on several threads at once (see oval_agent_eval_system()). The lock
+ * is recursive because a component may refer to other local variables.
+ */
+static pthread_once_t __compute_lock_once = PTHREAD_ONCE_INIT;
+static pthread_mutex_t __compute_lock;
+
+static void __compute_lock_init(void)
 {
-	oval_variable_LOCAL_t *var;
-	struct oval_component *component;
-	struct oval_value_iterator *val_itr;
+	pthread_mutexattr_t attr;
 
-	__attribute__nonnull__(variable);
+	pthread_mutexattr_init(&attr);
+	pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+	pthread_mutex_init(&__compute_lock, &attr);
+	pthread_mutexattr_destroy(&attr);
+}
+#endif
 
-	if (variable->type != OVAL_VARIABLE_LOCAL)
-		return 0;
+static int _oval_syschar_model_compute_variable(struct oval_syschar_model *sysmod, oval_variable_LOCAL_t *var)
+{
+	struct oval_component *component;
+	struct oval_value_iterator *val_itr;
 
-	var = (oval_variable_LOCAL_t *) variable;
 	if (var->flag != SYSCHAR_FLAG_UNKNOWN)
 		return 0;
 
@@ -447,7 +463,7 @@ int oval_syschar_model_compute_variable(struct oval_syschar_model *sysmod, struc
 		return 0;
 	}
 
-	val_itr = oval_variable_get_values(variable);
+	val_itr = oval_variable_get_values((struct oval_variable *) var);
 	if (!oval_value_iterator_has_more(val_itr))
 		var->flag = SYSCHAR_FLAG_ERROR;
 	oval_value_iterator_free(val_itr);
@@ -455,6 +471,27 @@ int oval_syschar_model_compute_variable(struct oval_syschar_model *sysmod, struc
         return 0;
 }
 
+int oval_syschar_model_compute_variable(struct oval_syschar_model *sysmod, struct oval_variable *variable)
+{
+	int ret;
+
+	__attribute__nonnull__(variable);
+
+	if (variable->type != OVAL_VARIABLE_LOCAL)
+		return 0;
+
+#if defined(OSCAP_THREAD_SAFE)
+	pthread_once(&__compute_lock_once, __compute_lock_init);
+	pthread_mutex_lock(&__compute_lock);
+#endif
+	ret = _oval_syschar_model_compute_variable(sysmod, (oval_variable_LOCAL_t *) variable);
+#if defined(OSCAP_THREAD_SAFE)
+	pthread_mutex_unlock(&__compute_lock);
+#endif
+
+	return ret;
+}
+
 static int _dump_variable_values(struct oval_variable *variable)
 {
 	if (variable->flag != SYSCHAR_FLAG_COMPLETE && variable->flag != SYSCHAR_FLAG_INCOMPLETE) {
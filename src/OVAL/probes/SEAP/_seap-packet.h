@@ -48,12 +48,15 @@ struct SEAP_packet {
                 SEAP_msg_t msg;
                 SEAP_err_t err;
                 SEAP_cmd_t cmd;
+                SEXP_t    *raw; /* packet S-exp, see SEAP_packet_send */
         } data;
 };
 typedef struct SEAP_packet SEAP_packet_t;
 
 SEAP_packet_t *SEAP_packet_new(void);
 void SEAP_packet_free(SEAP_packet_t *packet);
+/* Free the packet together with the data it holds */
+void SEAP_packet_dispose(SEAP_packet_t *packet);
 
 void *SEAP_packet_settype(SEAP_packet_t *packet, uint8_t type);
 uint8_t SEAP_packet_gettype(SEAP_packet_t *packet);
@@ -35,4 +35,14 @@ typedef struct {
  */
 SEXP_ID_t SEXP_ID_v(const SEXP_t *s);
 
+typedef struct {
+	uint64_t h[2];
+} SEXP_ID128_t;
+
+/**
+ * Compute a 128-bit S-exp value identifier. Two S-exps which
+ * are equal according to SEXP_deepcmp have the same identifier.
+ */
+void SEXP_ID128_v(const SEXP_t *s, SEXP_ID128_t *id);
+
 #endif /* _SEXP_ID_H */
@@ -86,6 +86,7 @@ SEXP_DEFNUM(u64, uint64_t);
 struct SEXP_val_list {
         void    *b_addr;
         uint16_t offset;
+        struct SEXP_val_lidx *lidx;
 };
 
 #define SEXP_LCASTP(p) ((struct SEXP_val_list *)(p))
@@ -97,8 +98,40 @@ struct SEXP_val_lblk {
 	SEXP_t *memb;
 };
 
+/*
+ * Block index of a long list. Only the blocks before the last one are
+ * full, so the position of every block in the list is fixed and a list
+ * member is found by a binary search over the blocks. The index belongs
+ * to the list value and is rebuilt by the functions which change the
+ * chain of blocks, readers never modify it.
+ */
+struct SEXP_val_lidx {
+        size_t count;
+        size_t alloc;
+        /*
+         * Non-zero if some block may be referenced by another list. Set
+         * atomically by SEXP_list_rest_r, which may run on a list read by
+         * other threads, and recomputed from the block reference counters
+         * by SEXP_rawval_list_reindex, so it is cleared by the first append
+         * after the other lists are gone.
+         */
+        volatile uint32_t shared;
+        struct {
+                struct SEXP_val_lblk *blk;
+                size_t base; /* number of members in the previous blocks */
+        } ent[];
+};
+
+/* Lists with less blocks are not indexed */
+#define SEXP_LIDX_MINBLK 8
+
 size_t    SEXP_rawval_list_length (struct SEXP_val_list *list);
 uintptr_t SEXP_rawval_list_copy (uintptr_t s_valp);
+SEXP_t   *SEXP_rawval_list_nth (struct SEXP_val_list *list, uint32_t n);
+SEXP_t   *SEXP_rawval_list_last (struct SEXP_val_list *list);
+void      SEXP_rawval_list_add (struct SEXP_val_list *list, const SEXP_t *s_exp);
+void      SEXP_rawval_list_reindex (struct SEXP_val_list *list);
+void      SEXP_rawval_list_free (struct SEXP_val_list *list, void (*func) (SEXP_t *));
 
 uintptr_t SEXP_rawval_lblk_copy (uintptr_t lblkp, uint16_t n_skip);
 uintptr_t SEXP_rawval_lblk_new  (uint8_t sz);
@@ -50,6 +50,7 @@ int sch_queue_connect(SEAP_desc_t *desc)
 	pthread_mutex_init(&data->to_probe_mutex, NULL);
 
 	data->parent_thread_id = pthread_self();
+	data->marshal = getenv("OSCAP_SEAP_MARSHAL") != NULL;
 
 	struct probe_common_main_argument *arg = malloc(sizeof(struct probe_common_main_argument));
 	arg->subtype = desc->subtype;
@@ -69,7 +70,7 @@ int sch_queue_connect(SEAP_desc_t *desc)
 	return 0;
 }
 
-SEXP_t *sch_queue_recvsexp(SEAP_desc_t *desc)
+SEAP_packet_t *sch_queue_recvpacket(SEAP_desc_t *desc)
 {
 	sch_queuedata_t *data = (sch_queuedata_t *)desc->scheme_data;
 	struct oscap_queue *queue;
@@ -91,13 +92,13 @@ SEXP_t *sch_queue_recvsexp(SEAP_desc_t *desc)
 	while (*cnt == 0) {
 		pthread_cond_wait(cond, mutex);
 	}
-	SEXP_t *sexp = oscap_queue_remove(queue);
+	SEAP_packet_t *packet = oscap_queue_remove(queue);
 	(*cnt)--;
 	pthread_mutex_unlock(mutex);
-	return sexp;
+	return packet;
 }
 
-ssize_t sch_queue_sendsexp(SEAP_desc_t *desc, SEXP_t *sexp, uint32_t flags)
+int sch_queue_sendpacket(SEAP_desc_t *desc, SEAP_packet_t *packet)
 {
 	sch_queuedata_t *data = (sch_queuedata_t *) desc->scheme_data;
 	struct oscap_queue *queue;
@@ -115,16 +116,20 @@ ssize_t sch_queue_sendsexp(SEAP_desc_t *desc, SEXP_t *sexp, uint32_t flags)
 		cond = &data->from_probe_cond;
 		cnt = &data->from_probe_cnt;
 	}
-	/* We want to send a SEXP, but the receiver expects a list of SEXPs. */
-	SEXP_t *sexp_list = SEXP_list_new(sexp, NULL);
 	pthread_mutex_lock(mutex);
-	oscap_queue_add(queue, (void *) sexp_list);
+	oscap_queue_add(queue, (void *) packet);
 	(*cnt)++;
-	pthread_cond_broadcast(cond);
+	/* There is exactly one receiving thread on each side of the channel */
+	pthread_cond_signal(cond);
 	pthread_mutex_unlock(mutex);
 	return 0;
 }
 
+static void sch_queue_packet_free(void *packet)
+{
+	SEAP_packet_dispose((SEAP_packet_t *) packet);
+}
+
 int sch_queue_close(SEAP_desc_t *desc, uint32_t flags)
 {
 	int ret = 0;
@@ -141,8 +146,8 @@ int sch_queue_close(SEAP_desc_t *desc, uint32_t flags)
 		dE("Return code of %s_probe main thread is %d.", subtype_str, ret);
 	}
 cleanup:
-	oscap_queue_free(data->to_probe_queue, NULL);
-	oscap_queue_free(data->from_probe_queue, NULL);
+	oscap_queue_free(data->to_probe_queue, sch_queue_packet_free);
+	oscap_queue_free(data->from_probe_queue, sch_queue_packet_free);
 	free(data);
 	free(desc->arg);
 	return ret;
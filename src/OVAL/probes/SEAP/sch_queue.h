@@ -26,6 +26,7 @@
 #include "util.h"
 #include "oscap_queue.h"
 #include "seap-descriptor.h"
+#include "_seap-packet.h"
 
 typedef struct {
 	pthread_t probe_thread_id;
@@ -38,11 +39,18 @@ typedef struct {
 	pthread_mutex_t from_probe_mutex;
 	int to_probe_cnt;
 	int from_probe_cnt;
+	/*
+	 * Packets are passed between the threads by pointer. If set (by the
+	 * OSCAP_SEAP_MARSHAL environment variable), every packet is converted
+	 * to its S-exp representation and back instead, as the packets used
+	 * to be sent between separate processes.
+	 */
+	bool marshal;
 } sch_queuedata_t;
 
 int sch_queue_connect(SEAP_desc_t *desc);
-ssize_t sch_queue_sendsexp(SEAP_desc_t *desc, SEXP_t *sexp, uint32_t flags);
-SEXP_t *sch_queue_recvsexp(SEAP_desc_t *desc);
+int sch_queue_sendpacket(SEAP_desc_t *desc, SEAP_packet_t *packet);
+SEAP_packet_t *sch_queue_recvpacket(SEAP_desc_t *desc);
 int sch_queue_close(SEAP_desc_t *desc, uint32_t flags);
 
 #endif /* OPENSCAP_SCH_QUEUE_H */
@@ -128,6 +128,21 @@ int SEAP_msgattr_set (SEAP_msg_t *msg, const char *attr, SEXP_t *value)
         return (0);
 }
 
+SEXP_t *SEAP_msgattr_get (SEAP_msg_t *msg, const char *name)
+{
+        uint16_t i;
+
+        _A(msg  != NULL);
+        _A(name != NULL);
+
+        for (i = 0; i < msg->attrs_cnt; ++i) {
+                if (strcmp (name, msg->attrs[i].name) == 0)
+                        return (msg->attrs[i].value != NULL ? SEXP_ref (msg->attrs[i].value) : NULL);
+        }
+
+        return (NULL);
+}
+
 bool SEAP_msgattr_exists (SEAP_msg_t *msg, const char *name)
 {
         uint16_t i;
@@ -51,6 +51,100 @@ void SEAP_packet_free (SEAP_packet_t *packet)
 	free(packet);
 }
 
+void SEAP_packet_dispose (SEAP_packet_t *packet)
+{
+	if (packet == NULL)
+		return;
+
+	switch (packet->type) {
+	case SEAP_PACKET_MSG:
+		for (uint32_t i = 0; i < packet->data.msg.attrs_cnt; ++i) {
+			free(packet->data.msg.attrs[i].name);
+			SEXP_free(packet->data.msg.attrs[i].value);
+		}
+		free(packet->data.msg.attrs);
+		SEXP_free(packet->data.msg.sexp);
+		break;
+	case SEAP_PACKET_CMD:
+		SEXP_free(packet->data.cmd.args);
+		break;
+	case SEAP_PACKET_ERR:
+		SEXP_free(packet->data.err.data);
+		break;
+	case SEAP_PACKET_RAW:
+		SEXP_free(packet->data.raw);
+		break;
+	}
+
+	SEAP_packet_free(packet);
+}
+
+/*
+ * Create the packet which is handed over to the receiving thread. The
+ * receiver gets the same data as if the packet was converted to an S-exp
+ * and back, but the S-exp values are shared instead of being wrapped
+ * in packet lists.
+ */
+static SEAP_packet_t *SEAP_packet_clone (SEAP_packet_t *packet)
+{
+	SEAP_packet_t *clone = SEAP_packet_new ();
+
+	clone->type = packet->type;
+
+	switch (packet->type) {
+	case SEAP_PACKET_MSG: {
+		SEAP_msg_t *src = SEAP_packet_msg (packet);
+		SEAP_msg_t *dst = SEAP_packet_msg (clone);
+
+		dst->id = src->id;
+		dst->attrs_cnt = src->attrs_cnt;
+		dst->attrs = NULL;
+
+		if (src->attrs_cnt > 0) {
+			dst->attrs = malloc(sizeof(SEAP_attr_t) * src->attrs_cnt);
+
+			for (uint32_t i = 0; i < src->attrs_cnt; ++i) {
+				dst->attrs[i].name  = strdup(src->attrs[i].name);
+				dst->attrs[i].value = src->attrs[i].value != NULL ?
+					SEXP_ref(src->attrs[i].value) : NULL;
+			}
+		}
+
+		/* A message without data is received with an empty list */
+		dst->sexp = src->sexp != NULL ? SEXP_ref(src->sexp) : SEXP_list_new(NULL);
+		break;
+	}
+	case SEAP_PACKET_CMD: {
+		SEAP_cmd_t *src = SEAP_packet_cmd (packet);
+		SEAP_cmd_t *dst = SEAP_packet_cmd (clone);
+
+		dst->id    = src->id;
+		dst->flags = src->flags & (SEAP_CMDFLAG_SYNC | SEAP_CMDFLAG_REPLY);
+		dst->rid   = dst->flags & SEAP_CMDFLAG_REPLY ? src->rid : 0;
+		dst->class = src->class;
+		dst->code  = src->code;
+		dst->args  = src->args != NULL ? SEXP_ref(src->args) : NULL;
+		break;
+	}
+	case SEAP_PACKET_ERR: {
+		SEAP_err_t *src = SEAP_packet_err (packet);
+		SEAP_err_t *dst = SEAP_packet_err (clone);
+
+		dst->id   = src->id;
+		dst->code = src->code;
+		dst->type = src->type;
+		dst->data = src->data != NULL ? SEXP_ref(src->data) : NULL;
+		break;
+	}
+	default:
+		SEAP_packet_free (clone);
+		errno = EINVAL;
+		return (NULL);
+	}
+
+	return (clone);
+}
+
 void *SEAP_packet_settype (SEAP_packet_t *packet, uint8_t type)
 {
         _A(packet != NULL);
@@ -166,7 +260,7 @@ static int SEAP_packet_sexp2msg (SEXP_t *sexp_msg, SEAP_msg_t *seap_msg)
 
                                 SEXP_free (attr_val);
                         } else {
-                                seap_msg->attrs[attr_i].name  = SEXP_string_subcstr (attr_name, 1, 0);
+                                seap_msg->attrs[attr_i].name  = SEXP_string_subcstr (attr_name, 1, SEXP_string_length (attr_name) - 1);
                                 seap_msg->attrs[attr_i].value = SEXP_list_nth (sexp_msg, msg_n + 1);
 
                                 if (seap_msg->attrs[attr_i].value == NULL) {
@@ -603,18 +697,140 @@ static SEXP_t *SEAP_packet2sexp (SEAP_packet_t *packet)
         return (sexp);
 }
 
-int SEAP_packet_recv (SEAP_CTX_t *ctx, int sd, SEAP_packet_t **packet)
+/*
+ * Convert an S-exp created by SEAP_packet2sexp back to a packet
+ */
+static int SEAP_packet_sexp2packet (SEXP_t *sexp_packet, SEAP_packet_t **packet)
 {
-        SEAP_desc_t *dsc;
-        SEXP_t      *sexp_buffer;
-        SEXP_t      *sexp_packet;
-
         SEXP_t     *psym_sexp;
         char        psym_cstr_b[16+1];
         char       *psym_cstr;
 
 	SEAP_packet_t *_packet;
 
+	(*packet) = NULL;
+
+	if (!SEXP_listp(sexp_packet)) {
+		dD("Invalid SEAP packet received: %s.", "not a list");
+
+		errno = EINVAL;
+		return (-1);
+	} else if (SEXP_list_length (sexp_packet) < 2) {
+		dD("Invalid SEAP packet received: %s.", "list length < 2");
+
+		errno = EINVAL;
+		return (-1);
+	}
+
+	psym_sexp = SEXP_list_first (sexp_packet);
+
+	if (!SEXP_stringp(psym_sexp)) {
+		dD("Invalid SEAP packet received: %s.", "first list item is not a string");
+
+		SEXP_free (psym_sexp);
+
+		errno = EINVAL;
+		return (-1);
+	} else if (SEXP_string_length (psym_sexp) != (strlen (SEAP_SYM_PREFIX) + 3)) {
+		dD("Invalid SEAP packet received: %s.", "invalid packet type symbol length");
+
+		SEXP_free (psym_sexp);
+
+		errno = EINVAL;
+		return (-1);
+	} else if (SEXP_strncmp (psym_sexp, SEAP_SYM_PREFIX, strlen (SEAP_SYM_PREFIX)) != 0) {
+		dD("Invalid SEAP packet received: %s.", "invalid prefix");
+
+		SEXP_free (psym_sexp);
+
+		errno = EINVAL;
+		return (-1);
+	}
+
+	SEXP_string_cstr_r (psym_sexp, psym_cstr_b, sizeof psym_cstr_b);
+	psym_cstr = psym_cstr_b + strlen (SEAP_SYM_PREFIX);
+	SEXP_free (psym_sexp);
+
+	switch (psym_cstr[0]) {
+	case 'm':
+		if (psym_cstr[1] == 's' &&
+		    psym_cstr[2] == 'g')
+		{
+			_packet = SEAP_packet_new ();
+			_packet->type = SEAP_PACKET_MSG;
+
+			if (SEAP_packet_sexp2msg (sexp_packet, &(_packet->data.msg)) != 0) {
+				/* error */
+				dD("Invalid SEAP packet received: %s.", "can't translate to msg struct");
+
+				SEAP_packet_free(_packet);
+
+				errno = EINVAL;
+				return (-1);
+			}
+			break;
+		}
+		goto invalid;
+	case 'c':
+		if (psym_cstr[1] == 'm' &&
+		    psym_cstr[2] == 'd')
+		{
+			_packet = SEAP_packet_new ();
+			_packet->type = SEAP_PACKET_CMD;
+
+			if (SEAP_packet_sexp2cmd (sexp_packet, &(_packet->data.cmd)) != 0) {
+				/* error */
+				dD("Invalid SEAP packet received: %s.", "can't translate to cmd struct");
+				SEAP_packet_free(_packet);
+
+				errno = EINVAL;
+				return (-1);
+			}
+			break;
+		}
+		goto invalid;
+	case 'e':
+		if (psym_cstr[1] == 'r' &&
+		    psym_cstr[2] == 'r')
+		{
+			_packet = SEAP_packet_new ();
+			_packet->type = SEAP_PACKET_ERR;
+
+			if (SEAP_packet_sexp2err (sexp_packet, &(_packet->data.err)) != 0) {
+				/* error */
+				dD("Invalid SEAP packet received: %s.", "can't translate to err struct");
+				SEAP_packet_free(_packet);
+
+				errno = EINVAL;
+				return (-1);
+			}
+			break;
+		}
+		/* FALLTHROUGH */
+	default:
+	invalid:
+		dD("Invalid SEAP packet received: %s.", "invalid packet type symbol");
+		errno = EINVAL;
+		return (-1);
+	}
+
+
+	dD("Received packet");
+	dO(OSCAP_DEBUGOBJ_SEXP, sexp_packet);
+	dD("packet size: %zu", SEXP_sizeof(sexp_packet));
+
+	(*packet) = _packet;
+
+        return (0);
+}
+
+int SEAP_packet_recv (SEAP_CTX_t *ctx, int sd, SEAP_packet_t **packet)
+{
+        SEAP_desc_t *dsc;
+        SEXP_t      *sexp_packet;
+	SEAP_packet_t *_packet;
+	int ret;
+
         dsc = SEAP_desc_get (ctx->sd_table, sd);
 
         if (dsc == NULL) {
@@ -665,154 +881,22 @@ int SEAP_packet_recv (SEAP_CTX_t *ctx, int sd, SEAP_packet_t **packet)
         }
 eloop_exit:
 
-	sexp_buffer = sch_queue_recvsexp(dsc);
-	SEXP_VALIDATE(sexp_buffer);
-
-	(*packet) = NULL;
-
-        while((sexp_packet = SEXP_list_pop (sexp_buffer)) != NULL) {
-		if (!SEXP_listp(sexp_packet)) {
-			dD("Invalid SEAP packet received: %s.", "not a list");
-
-			SEXP_free (sexp_packet);
-			SEXP_free (sexp_buffer);
-
-			errno = EINVAL;
-			return (-1);
-		} else if (SEXP_list_length (sexp_packet) < 2) {
-			dD("Invalid SEAP packet received: %s.", "list length < 2");
-
-			SEXP_free (sexp_packet);
-			SEXP_free (sexp_buffer);
-
-			errno = EINVAL;
-			return (-1);
-		}
-
-		psym_sexp = SEXP_list_first (sexp_packet);
-
-		if (!SEXP_stringp(psym_sexp)) {
-			dD("Invalid SEAP packet received: %s.", "first list item is not a string");
-
-			SEXP_free (psym_sexp);
-			SEXP_free (sexp_packet);
-			SEXP_free (sexp_buffer);
-
-			errno = EINVAL;
-			return (-1);
-		} else if (SEXP_string_length (psym_sexp) != (strlen (SEAP_SYM_PREFIX) + 3)) {
-			dD("Invalid SEAP packet received: %s.", "invalid packet type symbol length");
-
-			SEXP_free (psym_sexp);
-			SEXP_free (sexp_packet);
-			SEXP_free (sexp_buffer);
-
-			errno = EINVAL;
-			return (-1);
-		} else if (SEXP_strncmp (psym_sexp, SEAP_SYM_PREFIX, strlen (SEAP_SYM_PREFIX)) != 0) {
-			dD("Invalid SEAP packet received: %s.", "invalid prefix");
-
-			SEXP_free (psym_sexp);
-			SEXP_free (sexp_packet);
-			SEXP_free (sexp_buffer);
-
-			errno = EINVAL;
-			return (-1);
-		}
-
-		SEXP_string_cstr_r (psym_sexp, psym_cstr_b, sizeof psym_cstr_b);
-		psym_cstr = psym_cstr_b + strlen (SEAP_SYM_PREFIX);
-		SEXP_free (psym_sexp);
-
-		switch (psym_cstr[0]) {
-		case 'm':
-			if (psym_cstr[1] == 's' &&
-			    psym_cstr[2] == 'g')
-			{
-				_packet = SEAP_packet_new ();
-				_packet->type = SEAP_PACKET_MSG;
-
-				if (SEAP_packet_sexp2msg (sexp_packet, &(_packet->data.msg)) != 0) {
-					/* error */
-					dD("Invalid SEAP packet received: %s.", "can't translate to msg struct");
-
-					SEXP_free (sexp_packet);
-					SEAP_packet_free(_packet);
-					SEXP_free (sexp_buffer);
-
-					errno = EINVAL;
-					return (-1);
-				}
-				break;
-			}
-			goto invalid;
-		case 'c':
-			if (psym_cstr[1] == 'm' &&
-			    psym_cstr[2] == 'd')
-			{
-				_packet = SEAP_packet_new ();
-				_packet->type = SEAP_PACKET_CMD;
-
-				if (SEAP_packet_sexp2cmd (sexp_packet, &(_packet->data.cmd)) != 0) {
-					/* error */
-					dD("Invalid SEAP packet received: %s.", "can't translate to cmd struct");
-					SEXP_free (sexp_packet);
-					SEAP_packet_free(_packet);
-					SEXP_free (sexp_buffer);
-
-					errno = EINVAL;
-					return (-1);
-				}
-				break;
-			}
-			goto invalid;
-		case 'e':
-			if (psym_cstr[1] == 'r' &&
-			    psym_cstr[2] == 'r')
-			{
-				_packet = SEAP_packet_new ();
-				_packet->type = SEAP_PACKET_ERR;
-
-				if (SEAP_packet_sexp2err (sexp_packet, &(_packet->data.err)) != 0) {
-					/* error */
-					dD("Invalid SEAP packet received: %s.", "can't translate to err struct");
-					SEXP_free (sexp_packet);
-					SEAP_packet_free(_packet);
-					SEXP_free (sexp_buffer);
-
-					errno = EINVAL;
-					return (-1);
-				}
-				break;
-			}
-			/* FALLTHROUGH */
-		default:
-		invalid:
-			dD("Invalid SEAP packet received: %s.", "invalid packet type symbol");
-			SEXP_free (sexp_packet);
-			SEXP_free (sexp_buffer);
-			errno = EINVAL;
-			return (-1);
-		}
-
+	_packet = sch_queue_recvpacket(dsc);
 
+	if (_packet->type != SEAP_PACKET_RAW) {
 		dD("Received packet");
-		dO(OSCAP_DEBUGOBJ_SEXP, sexp_packet);
-		dD("packet size: %zu", SEXP_sizeof(sexp_packet));
-
-		SEXP_free(sexp_packet);
-
-		if (*packet == NULL)
-			(*packet) = _packet;
-		else
-			SEAP_packetq_put(&dsc->pck_queue, _packet);
-
-		_packet = NULL;
+		(*packet) = _packet;
+		return (0);
 	}
 
-        SEXP_free(sexp_buffer);
+	sexp_packet = _packet->data.raw;
+	SEAP_packet_free(_packet);
+	SEXP_VALIDATE(sexp_packet);
 
-        return (0);
+	ret = SEAP_packet_sexp2packet(sexp_packet, packet);
+	SEXP_free(sexp_packet);
+
+	return (ret);
 }
 
 int SEAP_packet_recv_bytype (SEAP_CTX_t *ctx, int sd, SEAP_packet_t **packet, uint8_t type)
@@ -851,8 +935,9 @@ int SEAP_packet_recv_bytype (SEAP_CTX_t *ctx, int sd, SEAP_packet_t **packet, ui
 
 int SEAP_packet_send (SEAP_CTX_t *ctx, int sd, SEAP_packet_t *packet)
 {
-        SEXP_t *packet_sexp;
+        SEAP_packet_t *out;
         SEAP_desc_t *dsc;
+        sch_queuedata_t *data;
         int ret;
 
         ret = -1;
@@ -861,17 +946,32 @@ int SEAP_packet_send (SEAP_CTX_t *ctx, int sd, SEAP_packet_t *packet)
         if (dsc == NULL)
                 return (-1);
 
-        packet_sexp = SEAP_packet2sexp (packet);
+        data = (sch_queuedata_t *) dsc->scheme_data;
 
-        if (packet_sexp == NULL) {
-                dD("Can't convert S-exp to packet");
-                return (-1);
+        if (data->marshal) {
+                SEXP_t *packet_sexp = SEAP_packet2sexp (packet);
+
+                if (packet_sexp == NULL) {
+                        dD("Can't convert S-exp to packet");
+                        return (-1);
+                }
+
+                out = SEAP_packet_new ();
+                out->type = SEAP_PACKET_RAW;
+                out->data.raw = packet_sexp;
+        } else {
+                out = SEAP_packet_clone (packet);
+
+                if (out == NULL) {
+                        dD("Can't copy the packet");
+                        return (-1);
+                }
         }
 
 	if (DESC_WLOCK(dsc) == 1) {
                 ret = 0;
 
-		if (sch_queue_sendsexp(dsc, packet_sexp, 0) < 0) {
+		if (sch_queue_sendpacket(dsc, out) < 0) {
                         ret = -1;
 
                         protect_errno {
@@ -888,9 +988,10 @@ int SEAP_packet_send (SEAP_CTX_t *ctx, int sd, SEAP_packet_t *packet)
 		ret = -1;
 	}
 
-
-        protect_errno {
-                SEXP_free (packet_sexp);
+        if (ret != 0) {
+                protect_errno {
+                        SEAP_packet_dispose (out);
+                }
         }
 
         return (ret);
@@ -43,6 +43,7 @@
 #include "_sexp-value.h"
 #include "_sexp-rawptr.h"
 #include "_sexp-ID.h"
+#include "public/sexp-manip.h"
 
 #include "MurmurHash3.h"
 
@@ -111,4 +112,77 @@ SEXP_ID_t SEXP_ID_v(const SEXP_t *s)
         return (pair.hash);
 }
 
+/*
+ * Fold one value into the 128-bit state. The value is hashed on its own
+ * first, then the state, the value hash and the value length are hashed
+ * together, so that the result depends on the order of the values.
+ */
+static void SEXP_ID128_mix(SEXP_ID128_t *id, uint32_t tag, const void *buf, size_t len)
+{
+	uint64_t blk[5];
+
+	blk[0] = id->h[0];
+	blk[1] = id->h[1];
+	MurmurHash3_x64_128(buf, (int)len, tag, blk + 2);
+	blk[4] = (uint64_t)len;
+
+	MurmurHash3_x64_128(blk, sizeof blk, 0x7C0FFEE7, id->h);
+}
+
+static int SEXP_ID128_v_callback(const SEXP_t *sexp, SEXP_ID128_t *id)
+{
+	SEXP_val_t v_dsc;
+
+	if (sexp == NULL || id == NULL) {
+		return -1;
+	}
+
+	SEXP_val_dsc(&v_dsc, sexp->s_valp);
+
+	switch (v_dsc.type) {
+	case SEXP_VALTYPE_NUMBER:
+		/*
+		 * SEXP_deepcmp compares integers by their value regardless
+		 * of their type, the identifier has to do the same.
+		 */
+		if (SEXP_number_type(sexp) == SEXP_NUM_DOUBLE) {
+			double f = SEXP_number_getf(sexp);
+			if (f == 0.0)
+				f = 0.0; /* -0.0 == 0.0 */
+			SEXP_ID128_mix(id, 'f', &f, sizeof f);
+		} else {
+			uint64_t u = SEXP_number_getu_64(sexp);
+			SEXP_ID128_mix(id, 'i', &u, sizeof u);
+		}
+		break;
+	case SEXP_VALTYPE_STRING:
+		SEXP_ID128_mix(id, v_dsc.type, v_dsc.mem, v_dsc.hdr->size);
+		break;
+	case SEXP_VALTYPE_LIST:
+		SEXP_ID128_mix(id, '(', "", 0);
+		SEXP_rawval_lblk_cb ((uintptr_t)SEXP_LCASTP(v_dsc.mem)->b_addr,
+				     (int (*)(SEXP_t *, void *)) SEXP_ID128_v_callback,
+				     (void *) id,
+				     SEXP_LCASTP(v_dsc.mem)->offset + 1);
+		SEXP_ID128_mix(id, ')', "", 0);
+		break;
+	case SEXP_VALTYPE_EMPTY:
+		SEXP_ID128_mix(id, v_dsc.type, "", 0);
+		break;
+	default:
+		/* Unknown S-exp value type */
+		abort ();
+	}
+
+	return (0);
+}
+
+void SEXP_ID128_v(const SEXP_t *s, SEXP_ID128_t *id)
+{
+	id->h[0] = 0xAD30917100C0FFEE;
+	id->h[1] = 0x5EED0F0CAC4E0001;
+
+	SEXP_ID128_v_callback(s, id);
+}
+
 /// @}
@@ -844,7 +844,6 @@ char *SEXP_string_subcstr (const SEXP_t *s_exp, size_t beg, size_t len)
                 s_len = len;
 
         if (s_len > 0) {
-                s_len = v_dsc.hdr->size / sizeof (char);
 		s_str = malloc(s_len + 1);
 
                 memcpy (s_str, ((char *) v_dsc.mem) + beg, sizeof (char) * s_len);
@@ -997,8 +996,7 @@ SEXP_t *SEXP_list_first (const SEXP_t *list)
                 return (NULL);
         }
 
-        s_exp = SEXP_rawval_lblk_nth ((uintptr_t)SEXP_LCASTP(v_dsc.mem)->b_addr,
-                                      SEXP_LCASTP(v_dsc.mem)->offset + 1);
+        s_exp = SEXP_rawval_list_nth (SEXP_LCASTP(v_dsc.mem), 1);
 
         return (s_exp == NULL ? NULL : SEXP_ref (s_exp));
 }
@@ -1025,8 +1023,7 @@ SEXP_t *SEXP_listref_first (SEXP_t *list)
                 return (NULL);
         }
 
-        s_exp = SEXP_rawval_lblk_nth ((uintptr_t)SEXP_LCASTP(v_dsc.mem)->b_addr,
-                                      SEXP_LCASTP(v_dsc.mem)->offset + 1);
+        s_exp = SEXP_rawval_list_nth (SEXP_LCASTP(v_dsc.mem), 1);
 
         return (s_exp == NULL ? NULL : SEXP_softref (s_exp));
 }
@@ -1053,7 +1050,7 @@ SEXP_t *SEXP_listref_rest (SEXP_t *list)
 SEXP_t *SEXP_list_last (const SEXP_t *list)
 {
         SEXP_val_t v_dsc;
-        struct SEXP_val_lblk *l_blk;
+        SEXP_t    *s_exp;
 
         if (list == NULL) {
                 errno = EFAULT;
@@ -1069,12 +1066,9 @@ SEXP_t *SEXP_list_last (const SEXP_t *list)
                 return (NULL);
         }
 
-        l_blk = SEXP_VALP_LBLK(SEXP_rawval_lblk_last ((uintptr_t)SEXP_LCASTP(v_dsc.mem)->b_addr));
-
-        if (l_blk == NULL)
-                return (NULL);
+        s_exp = SEXP_rawval_list_last (SEXP_LCASTP(v_dsc.mem));
 
-        return (SEXP_ref (l_blk->memb + (l_blk->real - 1)));
+        return (s_exp == NULL ? NULL : SEXP_ref (s_exp));
 }
 
 SEXP_t *SEXP_list_replace (SEXP_t *list, uint32_t n, const SEXP_t *n_val)
@@ -1114,6 +1108,10 @@ SEXP_t *SEXP_list_replace (SEXP_t *list, uint32_t n, const SEXP_t *n_val)
                                                                             SEXP_LCASTP(v_dsc.mem)->offset + n,
                                                                             n_val, &o_val);
 
+        /* Shared blocks were replaced by copies */
+        if (SEXP_LCASTP(v_dsc.mem)->lidx == NULL || SEXP_LCASTP(v_dsc.mem)->lidx->shared)
+                SEXP_rawval_list_reindex (SEXP_LCASTP(v_dsc.mem));
+
         return (o_val);
 }
 
@@ -1142,8 +1140,7 @@ SEXP_t *SEXP_list_nth (const SEXP_t *list, uint32_t n)
                 return (NULL);
         }
 
-        s_exp = SEXP_rawval_lblk_nth ((uintptr_t)SEXP_LCASTP(v_dsc.mem)->b_addr,
-                                      SEXP_LCASTP(v_dsc.mem)->offset + n);
+        s_exp = SEXP_rawval_list_nth (SEXP_LCASTP(v_dsc.mem), n);
 
 #if !defined(NDEBUG)
         if (s_exp != NULL)
@@ -1172,8 +1169,7 @@ SEXP_t *SEXP_listref_nth (SEXP_t *list, uint32_t n)
                 return (NULL);
         }
 
-        s_exp = SEXP_rawval_lblk_nth ((uintptr_t)SEXP_LCASTP(v_dsc.mem)->b_addr,
-                                      SEXP_LCASTP(v_dsc.mem)->offset + n);
+        s_exp = SEXP_rawval_list_nth (SEXP_LCASTP(v_dsc.mem), n);
 
 #if !defined(NDEBUG)
         if (s_exp != NULL)
@@ -1217,20 +1213,17 @@ SEXP_t *SEXP_list_add (SEXP_t *list, const SEXP_t *s_exp)
 
                 list->s_valp = uptr;
                 SEXP_val_dsc (&v_dsc, list->s_valp);
-
-                uptr = SEXP_rawval_lblk_last ((uintptr_t)SEXP_LCASTP(v_dsc.mem)->b_addr);
-                SEXP_rawval_lblk_add1 (uptr, s_exp);
-        } else {
-                /*
-                 * Only one reference exists to the value.
-                 * However, list blocks have their own
-                 * reference counter and some blocks can
-                 * be shared. This case is handled by the
-                 * function SEXP_rawval_list_add.
-                 */
-                SEXP_LCASTP(v_dsc.mem)->b_addr = (void *)SEXP_rawval_lblk_add ((uintptr_t)SEXP_LCASTP(v_dsc.mem)->b_addr, s_exp);
         }
 
+        /*
+         * Only one reference exists to the value.
+         * However, list blocks have their own
+         * reference counter and some blocks can
+         * be shared. This case is handled by the
+         * function SEXP_rawval_list_add.
+         */
+        SEXP_rawval_list_add (SEXP_LCASTP(v_dsc.mem), s_exp);
+
         return (list);
 }
 
@@ -1303,6 +1296,7 @@ SEXP_t *SEXP_list_pop (SEXP_t *list)
                 }
 
                 SEXP_rawval_lblk_free1 ((uintptr_t)lblk, SEXP_free_lmemb);
+                SEXP_rawval_list_reindex (SEXP_LCASTP(v_dsc.mem));
         }
 
 #if !defined(NDEBUG)
@@ -1558,8 +1552,7 @@ SEXP_t *SEXP_unref (SEXP_t *s_exp_o)
 				oscap_aligned_free(v_dsc.hdr);
                                 break;
                         case SEXP_VALTYPE_LIST:
-                                if (SEXP_LCASTP(v_dsc.mem)->b_addr != NULL)
-                                        SEXP_rawval_lblk_free ((uintptr_t)SEXP_LCASTP(v_dsc.mem)->b_addr, SEXP_free_lmemb);
+                                SEXP_rawval_list_free (SEXP_LCASTP(v_dsc.mem), SEXP_free_lmemb);
 
 				oscap_aligned_free(v_dsc.hdr);
                                 break;
@@ -1753,8 +1746,7 @@ static void SEXP_free_lmemb (SEXP_t *s_exp)
 				oscap_aligned_free(v_dsc.hdr);
                                 break;
                         case SEXP_VALTYPE_LIST:
-                                if (SEXP_LCASTP(v_dsc.mem)->b_addr != NULL)
-                                        SEXP_rawval_lblk_free ((uintptr_t)SEXP_LCASTP(v_dsc.mem)->b_addr, SEXP_free_lmemb);
+                                SEXP_rawval_list_free (SEXP_LCASTP(v_dsc.mem), SEXP_free_lmemb);
 
 				oscap_aligned_free(v_dsc.hdr);
                                 break;
@@ -24,6 +24,7 @@
 #include <string.h>
 #include <errno.h>
 
+#include "_sexp-atomic.h"
 #include "_sexp-types.h"
 #include "_sexp-value.h"
 #include "_sexp-rawptr.h"
@@ -300,13 +301,15 @@ SEXP_t *SEXP_list_new_rv (SEXP_t *sexp_mem, SEXP_t *memb, va_list alist)
                 s_ptr[++s_cur] = va_arg (alist, SEXP_t *);
         }
 
-        if (SEXP_val_new (&v_dsc, sizeof (void *) + sizeof (uint16_t),
+        if (SEXP_val_new (&v_dsc, sizeof (struct SEXP_val_list),
                           SEXP_VALTYPE_LIST) != 0)
         {
                 /* TODO: handle this */
                 return (NULL);
         }
 
+        SEXP_LCASTP(v_dsc.mem)->lidx = NULL;
+
         if (s_cur > 0) {
                 for (b_exp = 0; (size_t)(1 << b_exp) < s_cur; ++b_exp);
 
@@ -369,7 +372,7 @@ SEXP_t *SEXP_list_rest_r (SEXP_t *rest, const SEXP_t *list)
                 return (NULL);
         }
 
-        if (SEXP_val_new (&v_dsc_r, sizeof (void *) + sizeof (uint16_t),
+        if (SEXP_val_new (&v_dsc_r, sizeof (struct SEXP_val_list),
                           SEXP_VALTYPE_LIST) != 0)
         {
                 /* TODO: handle this */
@@ -387,10 +390,18 @@ SEXP_t *SEXP_list_rest_r (SEXP_t *rest, const SEXP_t *list)
                         SEXP_LCASTP(v_dsc_r.mem)->b_addr = SEXP_VALP_LBLK(lblk->nxsz);
                 }
 
-                if (SEXP_VALP_LBLK(SEXP_LCASTP(v_dsc_r.mem)->b_addr) != NULL)
+                if (SEXP_VALP_LBLK(SEXP_LCASTP(v_dsc_r.mem)->b_addr) != NULL) {
                         SEXP_LCASTP(v_dsc_r.mem)->b_addr = (void *)SEXP_rawval_lblk_incref ((uintptr_t) SEXP_LCASTP(v_dsc_r.mem)->b_addr);
+
+                        /* The original list can't append to the shared blocks anymore */
+                        if (SEXP_LCASTP(v_dsc_o.mem)->lidx != NULL)
+                                SEXP_atomic_cas_u32 (&SEXP_LCASTP(v_dsc_o.mem)->lidx->shared, 0, 1);
+                }
         }
 
+        SEXP_LCASTP(v_dsc_r.mem)->lidx = NULL;
+        SEXP_rawval_list_reindex (SEXP_LCASTP(v_dsc_r.mem));
+
         SEXP_init(rest);
         rest->s_type = NULL;
         rest->s_valp = SEXP_val_ptr (&v_dsc_r);
@@ -436,8 +447,7 @@ void __SEXP_free_r (SEXP_t *s_exp, const char *file, uint32_t line, const char *
 				oscap_aligned_free(v_dsc.hdr);
                                 break;
                         case SEXP_VALTYPE_LIST:
-                                if (SEXP_LCASTP(v_dsc.mem)->b_addr != NULL)
-                                        SEXP_rawval_lblk_free ((uintptr_t)SEXP_LCASTP(v_dsc.mem)->b_addr, SEXP_free_r);
+                                SEXP_rawval_list_free (SEXP_LCASTP(v_dsc.mem), SEXP_free_r);
 
 				oscap_aligned_free(v_dsc.hdr);
                                 break;
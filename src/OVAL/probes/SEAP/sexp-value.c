@@ -25,6 +25,7 @@
 //#endif
 
 #include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "_sexp-atomic.h"
@@ -91,6 +92,13 @@ size_t SEXP_rawval_list_length (struct SEXP_val_list *list)
         size_t length;
         register struct SEXP_val_lblk *lblk;
 
+        if (list->lidx != NULL) {
+                struct SEXP_val_lidx *lidx = list->lidx;
+
+                return (lidx->ent[lidx->count - 1].base
+                        + lidx->ent[lidx->count - 1].blk->real - list->offset);
+        }
+
         length = 0;
         lblk   = SEXP_VALP_LBLK(list->b_addr);
 
@@ -199,7 +207,7 @@ uintptr_t SEXP_rawval_lblk_add (uintptr_t lblkp, const SEXP_t *s_exp)
                                  * than one list so we have to create a copy of the
                                  * rest of the list.
                                  */
-                                lb_ptr = SEXP_rawval_lblk_copy (lblkp, 0);
+                                lb_ptr = SEXP_rawval_lblk_copy ((uintptr_t)lblk, 0);
 
                                 if (lb_prev == 0)
                                         lb_head = lb_ptr;
@@ -212,7 +220,7 @@ uintptr_t SEXP_rawval_lblk_add (uintptr_t lblkp, const SEXP_t *s_exp)
                                 if (lb_prev != 0)
                                         SEXP_VALP_LBLK(lb_prev)->nxsz = (lb_ptr & SEXP_LBLKP_MASK) | (SEXP_VALP_LBLK(lb_prev)->nxsz & SEXP_LBLKS_MASK);
 
-                                SEXP_rawval_lblk_decref (lblkp);
+                                SEXP_rawval_lblk_decref ((uintptr_t)lblk);
 
                                 /*
                                  * Get the last block without checking refs
@@ -306,6 +314,161 @@ SEXP_t *SEXP_rawval_lblk_nth (uintptr_t lblkp, uint32_t n)
         return (NULL);
 }
 
+SEXP_t *SEXP_rawval_list_nth (struct SEXP_val_list *list, uint32_t n)
+{
+        struct SEXP_val_lidx *lidx;
+        struct SEXP_val_lblk *lblk;
+        size_t lo, hi, mid;
+
+        lidx = list->lidx;
+        n   += list->offset;
+
+        if (lidx == NULL)
+                return (SEXP_rawval_lblk_nth ((uintptr_t)list->b_addr, n));
+
+        /* find the last block which starts before the n-th member */
+        lo = 0;
+        hi = lidx->count - 1;
+
+        if (n > lidx->ent[hi].base) {
+                lo = hi;
+        } else {
+                while (lo < hi) {
+                        mid = lo + (hi - lo + 1) / 2;
+
+                        if (lidx->ent[mid].base < n)
+                                lo = mid;
+                        else
+                                hi = mid - 1;
+                }
+        }
+
+        lblk = lidx->ent[lo].blk;
+        n   -= lidx->ent[lo].base;
+
+        return (n <= lblk->real ? lblk->memb + (n - 1) : NULL);
+}
+
+SEXP_t *SEXP_rawval_list_last (struct SEXP_val_list *list)
+{
+        struct SEXP_val_lblk *lblk;
+
+        if (list->lidx != NULL)
+                lblk = list->lidx->ent[list->lidx->count - 1].blk;
+        else if (list->b_addr != NULL)
+                lblk = SEXP_VALP_LBLK(SEXP_rawval_lblk_last ((uintptr_t)list->b_addr));
+        else
+                return (NULL);
+
+        return (lblk->real > 0 ? lblk->memb + (lblk->real - 1) : NULL);
+}
+
+void SEXP_rawval_list_reindex (struct SEXP_val_list *list)
+{
+        struct SEXP_val_lidx *lidx;
+        struct SEXP_val_lblk *lblk;
+        size_t count, base;
+        bool   shared;
+
+        count  = 0;
+        shared = false;
+
+        for (lblk = SEXP_VALP_LBLK(list->b_addr); lblk != NULL; lblk = SEXP_VALP_LBLK(lblk->nxsz)) {
+                shared |= lblk->refs > 1;
+                ++count;
+        }
+
+        if (count < SEXP_LIDX_MINBLK) {
+                free (list->lidx);
+                list->lidx = NULL;
+                return;
+        }
+
+        lidx = list->lidx;
+
+        if (lidx == NULL || lidx->alloc < count) {
+                lidx = realloc (list->lidx, sizeof (struct SEXP_val_lidx) + sizeof lidx->ent[0] * count * 2);
+
+                if (lidx == NULL) {
+                        /* the list works without the index, only slower */
+                        free (list->lidx);
+                        list->lidx = NULL;
+                        return;
+                }
+
+                lidx->alloc = count * 2;
+        }
+
+        lidx->count  = 0;
+        lidx->shared = shared ? 1 : 0;
+        base = 0;
+
+        for (lblk = SEXP_VALP_LBLK(list->b_addr); lblk != NULL; lblk = SEXP_VALP_LBLK(lblk->nxsz)) {
+                lidx->ent[lidx->count].blk  = lblk;
+                lidx->ent[lidx->count].base = base;
+                ++lidx->count;
+                base += lblk->real;
+        }
+
+        list->lidx = lidx;
+}
+
+void SEXP_rawval_list_add (struct SEXP_val_list *list, const SEXP_t *s_exp)
+{
+        struct SEXP_val_lidx *lidx;
+        struct SEXP_val_lblk *last, *next;
+
+        lidx = list->lidx;
+
+        if (lidx == NULL || lidx->shared) {
+                struct SEXP_val_lblk *head = SEXP_VALP_LBLK(list->b_addr);
+
+                if (head != NULL && head->refs > 1 && list->offset > 0) {
+                        /*
+                         * The offset doesn't apply to a copy of the first
+                         * block, copy only the members of this list.
+                         */
+                        list->b_addr = (void *)SEXP_rawval_lblk_copy ((uintptr_t)head, list->offset);
+                        list->offset = 0;
+                        SEXP_rawval_lblk_decref ((uintptr_t)head);
+                }
+
+                /*
+                 * SEXP_rawval_lblk_add checks the reference counter
+                 * of every block and copies the blocks shared with
+                 * other lists.
+                 */
+                list->b_addr = (void *)SEXP_rawval_lblk_add ((uintptr_t)list->b_addr, s_exp);
+                SEXP_rawval_list_reindex (list);
+                return;
+        }
+
+        /* None of the blocks is shared, append to the last one */
+        last = lidx->ent[lidx->count - 1].blk;
+        SEXP_rawval_lblk_add1 ((uintptr_t)last, s_exp);
+        next = SEXP_VALP_LBLK(last->nxsz);
+
+        if (next == NULL)
+                return;
+
+        if (lidx->count == lidx->alloc) {
+                SEXP_rawval_list_reindex (list);
+                return;
+        }
+
+        lidx->ent[lidx->count].blk  = next;
+        lidx->ent[lidx->count].base = lidx->ent[lidx->count - 1].base + last->real;
+        ++lidx->count;
+}
+
+void SEXP_rawval_list_free (struct SEXP_val_list *list, void (*func) (SEXP_t *))
+{
+        if (list->b_addr != NULL)
+                SEXP_rawval_lblk_free ((uintptr_t)list->b_addr, func);
+
+        free (list->lidx);
+}
+
 uintptr_t SEXP_rawval_lblk_replace (uintptr_t lblkp, uint32_t n, const SEXP_t *n_val, SEXP_t **o_val)
 {
         uintptr_t lb_prev;
@@ -426,7 +589,7 @@ uintptr_t SEXP_rawval_list_copy (uintptr_t s_valp)
 {
         SEXP_val_t v_dsc_o, v_dsc_c;
 
-        if (SEXP_val_new (&v_dsc_c, sizeof (void *) + sizeof (uint16_t),
+        if (SEXP_val_new (&v_dsc_c, sizeof (struct SEXP_val_list),
                           SEXP_VALTYPE_LIST) != 0)
         {
                 /* TODO: handle this */
@@ -438,6 +601,8 @@ uintptr_t SEXP_rawval_list_copy (uintptr_t s_valp)
         SEXP_LCASTP(v_dsc_c.mem)->b_addr = (void *) SEXP_rawval_lblk_copy ((uintptr_t)SEXP_LCASTP(v_dsc_o.mem)->b_addr,
                                                                            (uintptr_t)SEXP_LCASTP(v_dsc_o.mem)->offset);
         SEXP_LCASTP(v_dsc_c.mem)->offset = 0;
+        SEXP_LCASTP(v_dsc_c.mem)->lidx   = NULL;
+        SEXP_rawval_list_reindex (SEXP_LCASTP(v_dsc_c.mem));
 
         return (SEXP_val_ptr (&v_dsc_c));
 }
@@ -480,7 +645,8 @@ uintptr_t SEXP_rawval_lblk_copy (uintptr_t lblkp, uint16_t n_skip)
                  * allocate new block
                  */
                 if (lb_new->real >= (1 << (cur_sz))) {
-                        lb_next = SEXP_rawval_lblk_new (++cur_sz);
+                        cur_sz  = cur_sz == 15 ? 6 : cur_sz + 1;
+                        lb_next = SEXP_rawval_lblk_new (cur_sz);
                         lb_new->nxsz = (lb_next & SEXP_LBLKP_MASK) | (lb_new->nxsz & SEXP_LBLKS_MASK);
                         lb_new  = SEXP_VALP_LBLK(lb_next);
                         off_n   = 0;
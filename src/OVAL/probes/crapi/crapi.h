@@ -24,6 +24,8 @@
 #define CRAPI_H
 
 #define CRAPI_IO_BUFSZ 4096
+/* Read buffer of crapi_mdigest_fd(), a multiple of CRAPI_IO_BUFSZ */
+#define CRAPI_MDIGEST_BUFSZ (128 * 1024)
 
 #ifndef _FILE_OFFSET_BITS
 # define _FILE_OFFSET_BITS 32
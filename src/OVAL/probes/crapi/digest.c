@@ -30,6 +30,7 @@
 #include <unistd.h>
 #include <errno.h>
 #include <stdlib.h>
+#include <fcntl.h>
 #include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/types.h>
@@ -272,89 +273,129 @@ static void crapi_digest_free(struct crapi_digest_ctx *ctx)
 {
 #if defined(HAVE_NSS3)
 	HASH_Destroy(ctx->ctx);
-	free(ctx);
+#elif defined(HAVE_GCRYPT)
+	gcry_md_close(ctx->ctx);
 #endif
-	return;
+	free(ctx);
 }
 
-int crapi_mdigest_fd (int fd, int num, ... /* crapi_alg_t alg, void *dst, size_t *size, ...*/)
+int crapi_mdigest_fdv(int fd, int num, const crapi_alg_t *alg, void **dst, size_t *size)
 {
 	register int i;
-	va_list ap;
-	struct digest_ctbl_t *ctbl = malloc(num * sizeof(struct digest_ctbl_t));
-
-	crapi_alg_t alg;
-	void *dst;
-	size_t *size;
-
-	uint8_t fd_buf[CRAPI_IO_BUFSZ];
+	struct crapi_digest_ctx **ctbl;
+	uint8_t *fd_buf;
 	ssize_t ret;
 
 	if (num <= 0 || fd <= 0) {
 		errno = EINVAL;
-		free(ctbl);
 		return -1;
 	}
-	for (i = 0; i < num; ++i)
-		ctbl[i].ctx = NULL;
 
-	va_start(ap, num);
+	ctbl = calloc(num, sizeof(struct crapi_digest_ctx *));
+	if (ctbl == NULL)
+		return -1;
+#if defined(HAVE_POSIX_MEMALIGN)
+	if (posix_memalign((void **)&fd_buf, CRAPI_IO_BUFSZ, CRAPI_MDIGEST_BUFSZ) != 0)
+		fd_buf = NULL;
+#else
+	fd_buf = malloc(CRAPI_MDIGEST_BUFSZ);
+#endif
+	if (fd_buf == NULL) {
+		free(ctbl);
+		errno = ENOMEM;
+		return -1;
+	}
 
 	for (i = 0; i < num; ++i) {
-		alg  = va_arg(ap, crapi_alg_t);
-		dst  = va_arg(ap, void *);
-		size = va_arg(ap, size_t *);
-
-		ctbl[i].alg = alg;
-		if ((ctbl[i].ctx = crapi_digest_init(dst, size, alg)) == NULL)
-			*size = 0;
+		if ((ctbl[i] = crapi_digest_init(dst[i], &size[i], alg[i])) == NULL)
+			size[i] = 0;
 	}
 
-	va_end (ap);
+#if defined(HAVE_POSIX_FADVISE)
+	/* The file is read once from start to end */
+	(void) posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
 
-	while ((ret = read(fd, fd_buf, sizeof fd_buf)) == sizeof fd_buf) {
-		for (i = 0; i < num; ++i) {
-			if (ctbl[i].ctx == NULL)
+	for (;;) {
+		ret = read(fd, fd_buf, CRAPI_MDIGEST_BUFSZ);
+		if (ret == 0)
+			break;
+		if (ret < 0) {
+			if (errno == EINTR)
 				continue;
-			if (crapi_digest_update(ctbl[i].ctx, fd_buf, sizeof fd_buf) != 0) {
-				goto fail;
-			}
-		}
-	}
-
-	switch (ret) {
-	case 0:
-		break;
-	case -1:
-		goto fail;
-	default:
-		if (ret <= 0) {
-			free(ctbl);
-			return -1;
+			goto fail;
 		}
 
 		for (i = 0; i < num; ++i) {
-			if (ctbl[i].ctx == NULL)
+			if (ctbl[i] == NULL)
 				continue;
-			if (crapi_digest_update(ctbl[i].ctx, fd_buf, (size_t)ret) != 0) {
+			if (crapi_digest_update(ctbl[i], fd_buf, (size_t)ret) != 0) {
 				goto fail;
 			}
 		}
 	}
 
 	for (i = 0; i < num; ++i) {
-		if (ctbl[i].ctx == NULL)
+		if (ctbl[i] == NULL)
 			continue;
-		crapi_digest_fini(ctbl[i].ctx, ctbl[i].alg);
+		crapi_digest_fini(ctbl[i], alg[i]);
 	}
+	free(fd_buf);
 	free(ctbl);
 	return (0);
 fail:
 	for (i = 0; i < num; ++i) {
-		if (ctbl[i].ctx != NULL)
-			crapi_digest_free(ctbl[i].ctx);
+		if (ctbl[i] != NULL)
+			crapi_digest_free(ctbl[i]);
 	}
 
+	free(fd_buf);
 	free(ctbl);
 	return (-1);
 }
+
+int crapi_mdigest_fd (int fd, int num, ... /* crapi_alg_t alg, void *dst, size_t *size, ...*/)
+{
+	register int i;
+	va_list ap;
+	crapi_alg_t *alg;
+	void **dst;
+	size_t **size_ptr, *size;
+	int ret;
+
+	if (num <= 0 || fd <= 0) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	alg = malloc(num * sizeof(crapi_alg_t));
+	dst = malloc(num * sizeof(void *));
+	size_ptr = malloc(num * sizeof(size_t *));
+	size = malloc(num * sizeof(size_t));
+	if (alg == NULL || dst == NULL || size_ptr == NULL || size == NULL) {
+		ret = -1;
+		goto cleanup;
+	}
+
+	va_start(ap, num);
+
+	for (i = 0; i < num; ++i) {
+		alg[i] = va_arg(ap, crapi_alg_t);
+		dst[i] = va_arg(ap, void *);
+		size_ptr[i] = va_arg(ap, size_t *);
+		size[i] = *size_ptr[i];
+	}
+
+	va_end (ap);
+
+	ret = crapi_mdigest_fdv(fd, num, alg, dst, size);
+
+	for (i = 0; i < num; ++i)
+		*size_ptr[i] = size[i];
+cleanup:
+	free(alg);
+	free(dst);
+	free(size_ptr);
+	free(size);
+	return ret;
+}
@@ -44,4 +44,11 @@ int crapi_digest_fd (int fd, crapi_alg_t alg, void *dst, size_t *size);
 
 int crapi_mdigest_fd (int fd, int num, ... /*crapi_alg_t alg, void *dst, size_t *size, ...*/);
 
+/*
+ * Compute num digests of the file in one pass. The algorithms, destination
+ * buffers and their sizes are passed in arrays of num elements. A size is
+ * set to 0 when its digest could not be computed.
+ */
+int crapi_mdigest_fdv (int fd, int num, const crapi_alg_t *alg, void **dst, size_t *size);
+
 #endif /* CRAPI_DIGEST_H */
@@ -38,7 +38,11 @@
 #include "_seap.h"
 #include <probe-api.h>
 #include <stdlib.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdbool.h>
 #include <string.h>
+#include <unistd.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
@@ -55,6 +59,8 @@
 #include "probe/entcmp.h"
 #include "filehash58_probe.h"
 #include "oscap_helpers.h"
+#include "oscap_parallel.h"
+#include "list.h"
 
 #define FILE_SEPARATOR '/'
 
@@ -121,17 +127,121 @@ static int mem2hex (uint8_t *mem, size_t mlen, char *str, size_t slen)
 	return (0);
 }
 
-static int filehash58_cb(const char *prefix, const char *p, const char *f, const char *h, probe_ctx *ctx)
-{
-	SEXP_t *itm;
+/* Number of entries in OVAL_FILEHASH58_HASH_TYPES */
+#define FILEHASH58_HASH_TYPE_CNT 6
+
+/* Files hashed in parallel before their items are collected */
+#define FILEHASH58_BATCH 64
+
+/* Default upper bound of hashing threads, see OSCAP_PROBE_HASH_THREADS */
+#define FILEHASH58_THREADS_MAX 4
 
+#define FILEHASH58_MEMO_HSIZE 4093
+
+struct filehash58_state {
+	pthread_mutex_t mutex;
+	/*
+	 * Hex digests of the files hashed so far, keyed by device, inode,
+	 * modification and change times and size, and indexed like
+	 * OVAL_FILEHASH58_HASH_TYPES.
+	 * Entries live until the probe is finalized.
+	 */
+	pthread_mutex_t memo_lock;
+	struct oscap_htable *memo;
+	unsigned int threads;
+};
+
+struct filehash58_memo {
+	char *hash[FILEHASH58_HASH_TYPE_CNT];
+};
+
+enum {
+	FILEHASH58_OK = 0,
+	FILEHASH58_SKIP,   /* no item is collected */
+	FILEHASH58_EOPEN,  /* the file can't be opened, see err */
+	FILEHASH58_EHASH   /* the file can't be read */
+};
+
+struct filehash58_file {
+	OVAL_FTSENT *ent;
 	char   pbuf[PATH_MAX+1];
-	size_t plen, flen;
+	int    status;
+	int    err;
+	const char *hash[FILEHASH58_HASH_TYPE_CNT];
+	/* digests which couldn't be memoized */
+	char  *own[FILEHASH58_HASH_TYPE_CNT];
+};
 
-	int fd;
+struct filehash58_batch {
+	const char *prefix;
+	probe_ctx *ctx;
+	struct filehash58_state *state;
+	/* requested hash types, algorithms of the supported ones */
+	bool requested[FILEHASH58_HASH_TYPE_CNT];
+	bool any_requested;
+	crapi_alg_t alg[FILEHASH58_HASH_TYPE_CNT];
+	struct filehash58_file files[FILEHASH58_BATCH];
+};
+
+/*
+ * Memo key of the version of a file. The change time is included because
+ * the modification time can be set back, and both are compared with
+ * nanoseconds so that writes within one second are told apart.
+ */
+static void filehash58_memo_key(const struct stat *st, char *key, size_t size)
+{
+#if defined(OS_FREEBSD)
+	const struct timespec *mtim = &st->st_mtimespec, *ctim = &st->st_ctimespec;
+#elif defined(OS_LINUX) || defined(OS_SOLARIS)
+	const struct timespec *mtim = &st->st_mtim, *ctim = &st->st_ctim;
+#else /* Use the legacy fields */
+	const struct timespec mtim_s = { st->st_mtime, 0 }, ctim_s = { st->st_ctime, 0 };
+	const struct timespec *mtim = &mtim_s, *ctim = &ctim_s;
+#endif
+
+	snprintf(key, size, "%ju:%ju:%jd.%09ld:%jd.%09ld:%jd",
+	         (uintmax_t) st->st_dev, (uintmax_t) st->st_ino,
+	         (intmax_t) mtim->tv_sec, (long) mtim->tv_nsec,
+	         (intmax_t) ctim->tv_sec, (long) ctim->tv_nsec,
+	         (intmax_t) st->st_size);
+}
+
+static void filehash58_memo_free(void *ptr)
+{
+	struct filehash58_memo *memo = ptr;
 
-	if (f == NULL)
-		return (0);
+	for (int i = 0; i < FILEHASH58_HASH_TYPE_CNT; ++i)
+		free(memo->hash[i]);
+	free(memo);
+}
+
+/*
+ * Compute the digests of the requested hash types of one file, reading it
+ * at most once. Digests already known for the same version of the file are
+ * taken from the memo. Called concurrently for the files of a batch.
+ */
+static void filehash58_hash(size_t index, void *arg)
+{
+	struct filehash58_batch *batch = arg;
+	struct filehash58_file *file = &batch->files[index];
+	struct filehash58_memo *memo;
+	const char *p = file->ent->path, *f = file->ent->file;
+	size_t plen, flen;
+	struct stat st;
+	char key[128];
+	crapi_alg_t alg[FILEHASH58_HASH_TYPE_CNT];
+	void *dst[FILEHASH58_HASH_TYPE_CNT];
+	size_t dstlen[FILEHASH58_HASH_TYPE_CNT];
+	uint8_t hash_dst[FILEHASH58_HASH_TYPE_CNT][64];
+	int idx[FILEHASH58_HASH_TYPE_CNT];
+	int fd, num = 0;
+
+	file->status = FILEHASH58_SKIP;
+	memset(file->hash, 0, sizeof(file->hash));
+	memset(file->own, 0, sizeof(file->own));
+
+	if (f == NULL || !batch->any_requested)
+		return;
 
 	/*
 	 * Prepare path
@@ -140,109 +250,213 @@ static int filehash58_cb(const char *prefix, const char *p, const char *f, const
 	flen = strlen (f);
 
 	if (plen + flen + 1 > PATH_MAX)
-		return (-1);
+		return;
 
-	memcpy (pbuf, p, sizeof (char) * plen);
+	memcpy (file->pbuf, p, sizeof (char) * plen);
 
 	if (p[plen - 1] != FILE_SEPARATOR) {
-		pbuf[plen] = FILE_SEPARATOR;
+		file->pbuf[plen] = FILE_SEPARATOR;
 		++plen;
 	}
 
-	memcpy (pbuf + plen, f, sizeof (char) * flen);
-	pbuf[plen+flen] = '\0';
+	memcpy (file->pbuf + plen, f, sizeof (char) * flen);
+	file->pbuf[plen+flen] = '\0';
 
-	if (probe_path_is_blocked(pbuf, ctx->blocked_paths)) {
-		return 0;
-	}
+	if (probe_path_is_blocked(file->pbuf, batch->ctx->blocked_paths))
+		return;
 
 	/*
 	 * Open the file
 	 */
-	if (prefix == NULL) {
-		fd = open(pbuf, O_RDONLY);
+	if (batch->prefix == NULL) {
+		fd = open(file->pbuf, O_RDONLY);
 	} else {
-		char *path_with_prefix = oscap_path_join(prefix, pbuf);
+		char *path_with_prefix = oscap_path_join(batch->prefix, file->pbuf);
 		fd = open(path_with_prefix, O_RDONLY);
 		free(path_with_prefix);
 	}
 
 	if (fd < 0) {
-		strerror_r (errno, pbuf, PATH_MAX);
-		pbuf[PATH_MAX] = '\0';
-
-		itm = probe_item_create (OVAL_INDEPENDENT_FILE_HASH58, NULL,
-					"filepath", OVAL_DATATYPE_STRING, pbuf,
-					"path",     OVAL_DATATYPE_STRING, p,
-					"filename", OVAL_DATATYPE_STRING, f,
-					"hash_type",OVAL_DATATYPE_STRING, h,
-					NULL);
-		probe_item_add_msg(itm, OVAL_MESSAGE_LEVEL_ERROR,
-			"Can't open \"%s\": errno=%d, %s.", pbuf, errno, strerror (errno));
-		probe_item_setstatus(itm, SYSCHAR_STATUS_ERROR);
-
-		probe_item_collect(ctx, itm);
-		return 0;
+		file->status = FILEHASH58_EOPEN;
+		file->err = errno;
+		return;
 	}
 
-	uint8_t hash_dst[1025];
-	size_t hash_dstlen = sizeof(hash_dst);
-	char hash_str[2051];
-	crapi_alg_t hash_type;
-
-	hash_type = oscap_string_to_enum(CRAPI_ALG_MAP, h);
-	if (hash_type == 0) {
-		char *msg = oscap_sprintf("This version of OpenSCAP doesn't support the '%s' hash algorithm.", h);
-		dW(msg);
-		itm = probe_item_create (OVAL_INDEPENDENT_FILE_HASH58, NULL,
-			"filepath", OVAL_DATATYPE_STRING, pbuf,
-			"path", OVAL_DATATYPE_STRING, p,
-			"filename", OVAL_DATATYPE_STRING, f,
-			"hash_type", OVAL_DATATYPE_STRING, h,
-			NULL);
-		probe_item_add_msg(itm, OVAL_MESSAGE_LEVEL_ERROR, msg);
-		free(msg);
-		probe_item_setstatus(itm, SYSCHAR_STATUS_ERROR);
-		probe_item_collect(ctx, itm);
+	if (fstat(fd, &st) != 0) {
+		file->status = FILEHASH58_EHASH;
 		close(fd);
-		return 0;
+		return;
 	}
 
-	hash_dstlen = oscap_string_to_enum(CRAPI_ALG_MAP_SIZE, h);
+	filehash58_memo_key(&st, key, sizeof key);
 
 	/*
-	 * Compute hash value
+	 * Look up known digests, memo entries are never removed and their
+	 * digests never change once set, so the pointers stay valid.
 	 */
-	if (crapi_mdigest_fd(fd, 1, hash_type, hash_dst, &hash_dstlen) != 0) {
-		close (fd);
-		return (-1);
+	pthread_mutex_lock(&batch->state->memo_lock);
+	memo = oscap_htable_get(batch->state->memo, key);
+	for (int i = 0; i < FILEHASH58_HASH_TYPE_CNT; ++i) {
+		if (!batch->requested[i] || batch->alg[i] == 0)
+			continue;
+		if (memo != NULL && memo->hash[i] != NULL) {
+			file->hash[i] = memo->hash[i];
+		} else {
+			idx[num] = i;
+			alg[num] = batch->alg[i];
+			dst[num] = hash_dst[num];
+			dstlen[num] = oscap_string_to_enum(CRAPI_ALG_MAP_SIZE, OVAL_FILEHASH58_HASH_TYPES[i]);
+			++num;
+		}
 	}
-
-	close (fd);
-
-	hash_str[0] = '\0';
-	mem2hex(hash_dst, hash_dstlen, hash_str, sizeof(hash_str));
+	pthread_mutex_unlock(&batch->state->memo_lock);
 
 	/*
-	 * Create and add the item
+	 * Compute the missing hash values
 	 */
-	itm = probe_item_create(OVAL_INDEPENDENT_FILE_HASH58, NULL,
-		"filepath", OVAL_DATATYPE_STRING, pbuf,
-		"path", OVAL_DATATYPE_STRING, p,
-		"filename", OVAL_DATATYPE_STRING, f,
-		"hash_type",OVAL_DATATYPE_STRING, h,
-		"hash", OVAL_DATATYPE_STRING, hash_str,
-		NULL);
-
-	if (hash_dstlen == 0) {
-		probe_item_add_msg(itm, OVAL_MESSAGE_LEVEL_ERROR,
-			"Unable to compute %s hash value of \"%s\".", h, pbuf);
-		probe_item_setstatus(itm, SYSCHAR_STATUS_ERROR);
+	if (num > 0 && crapi_mdigest_fdv(fd, num, alg, dst, dstlen) != 0) {
+		file->status = FILEHASH58_EHASH;
+		close(fd);
+		return;
 	}
 
-	probe_item_collect(ctx, itm);
+	close(fd);
+	file->status = FILEHASH58_OK;
 
-	return (0);
+	if (num == 0)
+		return;
+
+	pthread_mutex_lock(&batch->state->memo_lock);
+	memo = oscap_htable_get(batch->state->memo, key);
+	if (memo == NULL) {
+		memo = calloc(1, sizeof(struct filehash58_memo));
+		if (memo != NULL && !oscap_htable_add(batch->state->memo, key, memo)) {
+			free(memo);
+			memo = NULL;
+		}
+	}
+	for (int j = 0; j < num; ++j) {
+		int i = idx[j];
+		char *hash_str = malloc(dstlen[j] * 2 + 1);
+
+		if (hash_str == NULL) {
+			file->status = FILEHASH58_EHASH;
+			continue;
+		}
+		hash_str[0] = '\0';
+		mem2hex(hash_dst[j], dstlen[j], hash_str, dstlen[j] * 2 + 1);
+
+		if (memo == NULL) {
+			file->hash[i] = file->own[i] = hash_str;
+			continue;
+		}
+		/* Another thread may have hashed the same file meanwhile */
+		if (memo->hash[i] == NULL)
+			memo->hash[i] = hash_str;
+		else
+			free(hash_str);
+		file->hash[i] = memo->hash[i];
+	}
+	pthread_mutex_unlock(&batch->state->memo_lock);
+}
+
+static void filehash58_collect(struct filehash58_batch *batch, struct filehash58_file *file)
+{
+	probe_ctx *ctx = batch->ctx;
+	const char *p = file->ent->path, *f = file->ent->file;
+	SEXP_t *itm;
+
+	for (int i = 0; i < FILEHASH58_HASH_TYPE_CNT; ++i) {
+		const char *h = OVAL_FILEHASH58_HASH_TYPES[i];
+
+		if (!batch->requested[i])
+			continue;
+
+		switch (file->status) {
+		case FILEHASH58_EOPEN: {
+			char ebuf[PATH_MAX+1];
+
+			memcpy(ebuf, file->pbuf, sizeof ebuf);
+			strerror_r (file->err, ebuf, PATH_MAX);
+			ebuf[PATH_MAX] = '\0';
+
+			itm = probe_item_create (OVAL_INDEPENDENT_FILE_HASH58, NULL,
+						"filepath", OVAL_DATATYPE_STRING, ebuf,
+						"path",     OVAL_DATATYPE_STRING, p,
+						"filename", OVAL_DATATYPE_STRING, f,
+						"hash_type",OVAL_DATATYPE_STRING, h,
+						NULL);
+			probe_item_add_msg(itm, OVAL_MESSAGE_LEVEL_ERROR,
+				"Can't open \"%s\": errno=%d, %s.", ebuf, file->err, strerror (file->err));
+			probe_item_setstatus(itm, SYSCHAR_STATUS_ERROR);
+
+			probe_item_collect(ctx, itm);
+			continue;
+		}
+		case FILEHASH58_OK:
+		case FILEHASH58_EHASH:
+			break;
+		default:
+			return;
+		}
+
+		if (batch->alg[i] == 0) {
+			char *msg = oscap_sprintf("This version of OpenSCAP doesn't support the '%s' hash algorithm.", h);
+			dW(msg);
+			itm = probe_item_create (OVAL_INDEPENDENT_FILE_HASH58, NULL,
+				"filepath", OVAL_DATATYPE_STRING, file->pbuf,
+				"path", OVAL_DATATYPE_STRING, p,
+				"filename", OVAL_DATATYPE_STRING, f,
+				"hash_type", OVAL_DATATYPE_STRING, h,
+				NULL);
+			probe_item_add_msg(itm, OVAL_MESSAGE_LEVEL_ERROR, msg);
+			free(msg);
+			probe_item_setstatus(itm, SYSCHAR_STATUS_ERROR);
+			probe_item_collect(ctx, itm);
+			continue;
+		}
+
+		if (file->status == FILEHASH58_EHASH)
+			continue;
+
+		/*
+		 * Create and add the item
+		 */
+		itm = probe_item_create(OVAL_INDEPENDENT_FILE_HASH58, NULL,
+			"filepath", OVAL_DATATYPE_STRING, file->pbuf,
+			"path", OVAL_DATATYPE_STRING, p,
+			"filename", OVAL_DATATYPE_STRING, f,
+			"hash_type",OVAL_DATATYPE_STRING, h,
+			"hash", OVAL_DATATYPE_STRING, file->hash[i],
+			NULL);
+
+		if (file->hash[i][0] == '\0') {
+			probe_item_add_msg(itm, OVAL_MESSAGE_LEVEL_ERROR,
+				"Unable to compute %s hash value of \"%s\".", h, file->pbuf);
+			probe_item_setstatus(itm, SYSCHAR_STATUS_ERROR);
+		}
+
+		probe_item_collect(ctx, itm);
+	}
+}
+
+/*
+ * Hash the files of the batch in parallel and collect their items in the
+ * order the files were found.
+ */
+static void filehash58_flush(struct filehash58_batch *batch, size_t count)
+{
+	oscap_parallel_for(count, batch->state->threads, filehash58_hash, batch);
+
+	for (size_t i = 0; i < count; ++i) {
+		struct filehash58_file *file = &batch->files[i];
+
+		filehash58_collect(batch, file);
+
+		for (int j = 0; j < FILEHASH58_HASH_TYPE_CNT; ++j)
+			free(file->own[j]);
+		oval_ftsent_free(file->ent);
+	}
 }
 
 int filehash58_probe_offline_mode_supported()
@@ -252,29 +466,46 @@ int filehash58_probe_offline_mode_supported()
 
 void *filehash58_probe_init(void)
 {
+	struct filehash58_state *state = malloc(sizeof(struct filehash58_state));
+	unsigned int ncpus = oscap_parallel_ncpus();
+
+	if (state == NULL)
+		return (NULL);
+
 	/*
 	 * Initialize mutex.
 	 */
-	pthread_mutex_t *filehash58_probe_mutex = malloc(sizeof(pthread_mutex_t));
-	switch (pthread_mutex_init(filehash58_probe_mutex, NULL)) {
+	switch (pthread_mutex_init(&state->mutex, NULL)) {
 	case 0:
-		return ((void *)filehash58_probe_mutex);
+		break;
 	default:
 		dD("Can't initialize mutex: errno=%u, %s.", errno, strerror (errno));
-		free(filehash58_probe_mutex);
+		free(state);
+		return (NULL);
 	}
 
-	return (NULL);
+	pthread_mutex_init(&state->memo_lock, NULL);
+	state->memo = oscap_htable_new1(strcmp, FILEHASH58_MEMO_HSIZE);
+	state->threads = oscap_parallel_jobs_from_env("OSCAP_PROBE_HASH_THREADS",
+		ncpus < FILEHASH58_THREADS_MAX ? ncpus : FILEHASH58_THREADS_MAX);
+
+	return ((void *)state);
 }
 
 void filehash58_probe_fini(void *arg)
 {
+	struct filehash58_state *state = (struct filehash58_state *)arg;
+
+	if (state == NULL)
+		return;
+
 	/*
 	 * Destroy mutex.
 	 */
-	pthread_mutex_t *filehash58_probe_mutex = (pthread_mutex_t *)arg;
-	(void) pthread_mutex_destroy(filehash58_probe_mutex);
-	free(filehash58_probe_mutex);
+	(void) pthread_mutex_destroy(&state->mutex);
+	(void) pthread_mutex_destroy(&state->memo_lock);
+	oscap_htable_free(state->memo, filehash58_memo_free);
+	free(state);
 }
 
 int filehash58_probe_main(probe_ctx *ctx, void *arg)
@@ -283,12 +514,14 @@ int filehash58_probe_main(probe_ctx *ctx, void *arg)
 	SEXP_t *path, *filename, *behaviors, *filepath, *hash_type;
 	char hash_type_str[128];
 	int err = 0;
+	size_t count = 0;
+	struct filehash58_batch *batch = NULL;
 
 	OVAL_FTS    *ofts;
 	OVAL_FTSENT *ofts_ent;
 
-	pthread_mutex_t *filehash58_probe_mutex = (pthread_mutex_t *)arg;
-	if (filehash58_probe_mutex == NULL) {
+	struct filehash58_state *state = (struct filehash58_state *)arg;
+	if (state == NULL || state->memo == NULL) {
 		return (PROBE_EINIT);
 	}
 
@@ -314,50 +547,70 @@ int filehash58_probe_main(probe_ctx *ctx, void *arg)
 
 	probe_filebehaviors_canonicalize(&behaviors);
 
-	switch (pthread_mutex_lock(filehash58_probe_mutex)) {
+	batch = malloc(sizeof(struct filehash58_batch));
+	if (batch == NULL) {
+		err = PROBE_ENOMEM;
+		goto cleanup;
+	}
+
+	/* find hash types to compare with entity, think "not satisfy" */
+	batch->any_requested = false;
+	for (int i = 0; OVAL_FILEHASH58_HASH_TYPES[i] != NULL; i++) {
+		const char *oval_filehash58_hash_type = OVAL_FILEHASH58_HASH_TYPES[i];
+		SEXP_t *oval_filehash58_hash_type_sexp = SEXP_string_new(oval_filehash58_hash_type, strlen(oval_filehash58_hash_type));
+
+		batch->requested[i] = probe_entobj_cmp(hash_type, oval_filehash58_hash_type_sexp) == OVAL_RESULT_TRUE;
+		batch->alg[i] = oscap_string_to_enum(CRAPI_ALG_MAP, oval_filehash58_hash_type);
+		batch->any_requested |= batch->requested[i];
+
+		SEXP_free(oval_filehash58_hash_type_sexp);
+	}
+
+	switch (pthread_mutex_lock(&state->mutex)) {
 	case 0:
 		break;
 	default:
-		dD("Can't lock mutex(%p): %u, %s.", filehash58_probe_mutex, errno, strerror(errno));
+		dD("Can't lock mutex(%p): %u, %s.", &state->mutex, errno, strerror(errno));
 
 		err = PROBE_EFATAL;
 		goto cleanup;
 	}
 
 	const char *prefix = getenv("OSCAP_PROBE_ROOT");
+
+	batch->prefix = prefix;
+	batch->ctx = ctx;
+	batch->state = state;
+
 	if ((ofts = oval_fts_open_prefixed(prefix, path, filename, filepath, behaviors, probe_ctx_getresult(ctx))) != NULL) {
 		while ((ofts_ent = oval_fts_read(ofts)) != NULL) {
-			/* find hash types to compare with entity, think "not satisfy" */
-			for (int i = 0; OVAL_FILEHASH58_HASH_TYPES[i] != NULL; i++) {
-				const char *oval_filehash58_hash_type = OVAL_FILEHASH58_HASH_TYPES[i];
-				SEXP_t *oval_filehash58_hash_type_sexp = SEXP_string_new(oval_filehash58_hash_type, strlen(oval_filehash58_hash_type));
-				if (probe_entobj_cmp(hash_type, oval_filehash58_hash_type_sexp) == OVAL_RESULT_TRUE) {
-					filehash58_cb(prefix, ofts_ent->path, ofts_ent->file, oval_filehash58_hash_type, ctx);
-				}
-
-				SEXP_free(oval_filehash58_hash_type_sexp);
+			batch->files[count++].ent = ofts_ent;
+			if (count == FILEHASH58_BATCH) {
+				filehash58_flush(batch, count);
+				count = 0;
 			}
-			oval_ftsent_free(ofts_ent);
 		}
+		filehash58_flush(batch, count);
 
 		oval_fts_close(ofts);
 	}
 
-cleanup:
-	SEXP_free (behaviors);
-	SEXP_free (path);
-	SEXP_free (filename);
-	SEXP_free (filepath);
-        SEXP_free (hash_type);
-
-	switch (pthread_mutex_unlock(filehash58_probe_mutex)) {
+	switch (pthread_mutex_unlock(&state->mutex)) {
 	case 0:
 		break;
 	default:
-		dD("Can't unlock mutex(%p): %u, %s.", filehash58_probe_mutex, errno, strerror(errno));
+		dD("Can't unlock mutex(%p): %u, %s.", &state->mutex, errno, strerror(errno));
 
 		err = PROBE_EFATAL;
 	}
 
+cleanup:
+	SEXP_free (behaviors);
+	SEXP_free (path);
+	SEXP_free (filename);
+	SEXP_free (filepath);
+        SEXP_free (hash_type);
+	free(batch);
+
 	return err;
 }
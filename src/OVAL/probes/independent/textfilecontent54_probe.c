@@ -43,6 +43,9 @@
 #include <fcntl.h>
 #include <unistd.h>
 #include <limits.h>
+#include <ctype.h>
+#include <stdbool.h>
+#include <time.h>
 
 #include "_seap.h"
 #include <probe-api.h>
@@ -112,25 +115,408 @@ static SEXP_t *create_item(const char *path, const char *filename, char *pattern
 	return item;
 }
 
+/*
+ * Files are read in blocks of whole lines, at least this big, when the
+ * pattern can't match across lines. Memory use then doesn't depend on the
+ * size of the file, only on the length of its longest line.
+ */
+#ifndef TFC54_BLOCK_SIZE
+#define TFC54_BLOCK_SIZE (64 * 1024)
+#endif
+
 struct pfdata {
 	char *pattern;
 	oscap_pcre_options_t re_opts;
 	SEXP_t *instance_ent;
 	probe_ctx *ctx;
 	oscap_pcre_t *compiled_regex;
+	bool line_local;
+	bool one_line;
 };
 
+struct pfmatch {
+	struct pfdata *pfd;
+	const char *path;
+	const char *file;
+	oval_schema_version_t over;
+	SEXP_t **items;
+	int item_cnt;
+	int item_max;
+	bool resume;
+	int pcre_rc;
+};
+
+static bool posix_class_is_line_local(const char *name, size_t len)
+{
+	static const char *const classes[] = {
+		"alnum", "alpha", "blank", "digit", "graph", "lower",
+		"print", "punct", "upper", "word", "xdigit", NULL
+	};
+
+	for (int i = 0; classes[i] != NULL; ++i) {
+		if (strlen(classes[i]) == len && strncmp(classes[i], name, len) == 0)
+			return true;
+	}
+	return false;
+}
+
+/*
+ * Check whether no match of the pattern can contain a newline, so that
+ * a file can be matched one block of lines at a time with the same result
+ * as when it is matched as a whole. Only a conservative subset of the PCRE
+ * syntax is recognized, anything else makes the pattern match the whole file.
+ * One exception is \s, which matches a newline too. Patterns using it are
+ * accepted, but *one_line is set and they have to be matched one line at
+ * a time, so that the whitespace stays within the line.
+ */
+static bool pattern_is_line_local(const char *pattern, oscap_pcre_options_t re_opts, bool *one_line)
+{
+	const char *p;
+	bool in_class = false;
+
+	*one_line = false;
+
+	/* ^ and $ have to match at line boundaries and . must not match a newline */
+	if (!(re_opts & OSCAP_PCRE_OPTS_MULTILINE) || (re_opts & OSCAP_PCRE_OPTS_DOTALL))
+		return false;
+
+	for (p = pattern; *p != '\0'; ++p) {
+		if ((unsigned char)*p < 0x20 && *p != '\t')
+			return false;
+
+		if (*p == '\\') {
+			++p;
+			if (*p == '\0' || (unsigned char)*p < 0x20)
+				return false;
+			if (!isalnum((unsigned char)*p))
+				continue;
+			if (strchr("dwSV", *p) != NULL)
+				continue;
+			if (*p == 's') {
+				*one_line = true;
+				continue;
+			}
+			if (in_class)
+				return false;
+			if (strchr("bBKtefagk", *p) != NULL)
+				continue;
+			/* \N is "not a newline", but \N{U+...} is a code point */
+			if (*p == 'N' && p[1] != '{')
+				continue;
+			/* back reference, not an octal escape */
+			if (*p >= '1' && *p <= '9' && !isdigit((unsigned char)p[1]))
+				continue;
+			return false;
+		}
+
+		if (in_class) {
+			if (*p == ']') {
+				in_class = false;
+			} else if (*p == '[') {
+				const char *end;
+
+				if (p[1] != ':' || p[2] == '^')
+					return false;
+				end = strstr(p + 2, ":]");
+				if (end == NULL || !posix_class_is_line_local(p + 2, end - p - 2))
+					return false;
+				p = end + 1;
+			}
+			continue;
+		}
+
+		switch (*p) {
+		case '[':
+			if (p[1] == '^')
+				return false;
+			/* ] right after the opening bracket is a literal */
+			if (p[1] == ']')
+				++p;
+			in_class = true;
+			break;
+		case '(':
+			/* verbs like (*CRLF) change what a newline is */
+			if (p[1] == '*')
+				return false;
+			if (p[1] == '?') {
+				const char *opt = p + 2;
+
+				/* comments aren't parsed */
+				if (*opt == '#')
+					return false;
+				/* option settings can't turn on DOTALL or turn off MULTILINE */
+				while (isalpha((unsigned char)*opt) || *opt == '-' || *opt == '^') {
+					if (*opt == 's' || *opt == 'm' || *opt == '^')
+						return false;
+					++opt;
+				}
+			}
+			break;
+		}
+	}
+
+	return !in_class;
+}
+
+static int add_match(struct pfmatch *pfm, char **substrs, int substr_cnt)
+{
+	if (pfm->item_cnt == pfm->item_max) {
+		int item_max = pfm->item_max > 0 ? pfm->item_max * 2 : 16;
+		SEXP_t **items = realloc(pfm->items, item_max * sizeof(SEXP_t *));
+
+		if (items == NULL)
+			return PROBE_ENOMEM;
+		pfm->items = items;
+		pfm->item_max = item_max;
+	}
+
+	pfm->items[pfm->item_cnt] = create_item(pfm->path, pfm->file, pfm->pfd->pattern,
+		pfm->item_cnt + 1, substrs, substr_cnt, pfm->over);
+	pfm->item_cnt++;
+
+	return 0;
+}
+
+/*
+ * Add all matches in str that start at ofs or later but not past limit;
+ * positions past the limit belong to the next block of the file. The offset
+ * is advanced the same way as by oscap_pcre_get_substrings() over the whole
+ * file: pfm->resume tells that the previous search went past the end of the
+ * previous block, so the first match in this one mustn't be skipped even if
+ * it is empty.
+ */
+static int match_block(struct pfmatch *pfm, const char *str, int str_len, int ofs, int limit)
+{
+	oscap_pcre_options_t opts = 0;
+	int ret, k, match[2], substr_cnt;
+	char **substrs;
+
+	while (ofs <= limit) {
+		substr_cnt = oscap_pcre_get_substrings_n(str, str_len, ofs, pfm->pfd->compiled_regex,
+		                                         opts, 1, match, &substrs);
+		if (substr_cnt < 0) {
+			pfm->pcre_rc = substr_cnt;
+			return -3;
+		}
+		if (substr_cnt == 0) {
+			pfm->resume = true;
+			return 0;
+		}
+
+		ret = match[0] > limit ? 0 : add_match(pfm, substrs, substr_cnt);
+
+		for (k = 0; k < substr_cnt; ++k)
+			free(substrs[k]);
+		free(substrs);
+
+		if (match[0] > limit) {
+			pfm->resume = true;
+			return 0;
+		}
+		if (ret != 0)
+			return ret;
+
+		ofs = (!pfm->resume && ofs == match[1]) ? match[1] + 1 : match[1];
+		pfm->resume = false;
+
+		/*
+		 * The whole subject was checked by the first match, only an offset
+		 * in the middle of a UTF-8 sequence has to be caught by PCRE again.
+		 */
+		if (ofs < str_len && ((unsigned char)str[ofs] & 0xC0) == 0x80)
+			opts = 0;
+		else
+			opts = OSCAP_PCRE_OPTS_NO_UTF8_CHECK;
+	}
+
+	return 0;
+}
+
+/*
+ * Match each line of a block on its own, the subject ends before the newline.
+ * Every line but the first one of the file is preceded by the newline that
+ * ends the previous line, so that ^ and lookbehinds see the same context as
+ * in the whole file.
+ */
+static int match_block_lines(struct pfmatch *pfm, const char *data, size_t len, bool first)
+{
+	const char *line = data, *end = data + len, *nl;
+	int ofs, ret;
+
+	while (line < end) {
+		nl = memchr(line, '\n', end - line);
+		if (nl == NULL)
+			nl = end;
+		ofs = (first && line == data) ? 0 : 1;
+		pfm->resume = false;
+		ret = match_block(pfm, line - ofs, nl - line + ofs, ofs, nl - line + ofs);
+		if (ret != 0)
+			return ret;
+		line = nl + 1;
+	}
+
+	return 0;
+}
+
+/*
+ * Match the file one block of whole lines at a time. A block is preceded by
+ * the newline that ends the previous block, so that ^ and lookbehinds see
+ * the same context as in the whole file, and the search stops at the newline
+ * that ends the block.
+ */
+static int match_lines(int fd, struct pfmatch *pfm)
+{
+	size_t size = TFC54_BLOCK_SIZE, used = 0, end;
+	bool first = true, eof = false;
+	char *buf, *data, *nul;
+	ssize_t n;
+	int ret = 0;
+
+	buf = malloc(size + 1);
+	if (buf == NULL)
+		return PROBE_ENOMEM;
+
+	while (!eof) {
+		data = buf + 1;
+
+		while (used < size) {
+			n = read(fd, data + used, size - used);
+			if (n == -1) {
+				if (errno == EINTR)
+					continue;
+				ret = -2;
+				goto cleanup;
+			}
+			if (n == 0) {
+				eof = true;
+				break;
+			}
+			/* The content ends with the first NUL byte */
+			nul = memchr(data + used, '\0', n);
+			if (nul != NULL) {
+				used = nul - data;
+				eof = true;
+				break;
+			}
+			used += n;
+		}
+
+		if (eof) {
+			end = used;
+		} else {
+			for (end = used; end > 0 && data[end - 1] != '\n'; --end)
+				;
+			if (end == 0) {
+				/* The line doesn't fit into the buffer */
+				char *new_buf;
+
+				if (size > INT_MAX / 2 - 1) {
+					errno = EFBIG;
+					ret = -2;
+					goto cleanup;
+				}
+				new_buf = realloc(buf, 2 * size + 1);
+				if (new_buf == NULL) {
+					dE("Can't re-allocate memory for file-processing buffer");
+					ret = PROBE_ENOMEM;
+					goto cleanup;
+				}
+				buf = new_buf;
+				size *= 2;
+				continue;
+			}
+		}
+
+		if (pfm->pfd->one_line)
+			ret = match_block_lines(pfm, data, end, first);
+		else if (first)
+			ret = match_block(pfm, data, end, 0, eof ? end : end - 1);
+		else
+			ret = match_block(pfm, buf, end + 1, 1, eof ? end + 1 : end);
+		if (ret != 0)
+			goto cleanup;
+
+		first = false;
+		buf[0] = '\n';
+		memmove(data, data + end, used - end);
+		used -= end;
+	}
+
+ cleanup:
+	free(buf);
+	return ret;
+}
+
+/*
+ * Read the whole file into memory and match it at once, for patterns
+ * that can match across lines.
+ */
+static int match_file(int fd, struct pfmatch *pfm, off_t st_size)
+{
+	size_t size, used = 0;
+	char *buf, *nul;
+	ssize_t n;
+	int ret;
+
+	/* One byte more than the size, so that the end of file is hit without growing the buffer */
+	size = st_size > 0 && st_size < INT_MAX ? (size_t)st_size + 1 : TFC54_BLOCK_SIZE;
+	buf = malloc(size);
+	if (buf == NULL) {
+		dE("Can't allocate memory for file-processing buffer");
+		return PROBE_ENOMEM;
+	}
+
+	for (;;) {
+		if (used == size) {
+			char *new_buf;
+
+			if (size > INT_MAX / 2) {
+				errno = EFBIG;
+				ret = -2;
+				goto cleanup;
+			}
+			new_buf = realloc(buf, size * 2);
+			if (new_buf == NULL) {
+				dE("Can't re-allocate memory for file-processing buffer");
+				ret = PROBE_ENOMEM;
+				goto cleanup;
+			}
+			buf = new_buf;
+			size *= 2;
+		}
+		n = read(fd, buf + used, size - used);
+		if (n == -1) {
+			if (errno == EINTR)
+				continue;
+			ret = -2;
+			goto cleanup;
+		}
+		if (n == 0)
+			break;
+		used += n;
+	}
+
+	/* The content ends with the first NUL byte */
+	nul = memchr(buf, '\0', used);
+	if (nul != NULL)
+		used = nul - buf;
+
+	ret = match_block(pfm, buf, used, 0, used);
+ cleanup:
+	free(buf);
+	return ret;
+}
+
 static int process_file(const char *prefix, const char *path, const char *file, struct pfdata *pfd, oval_schema_version_t over, struct oscap_list *blocked_paths)
 {
-	int ret = 0, path_len, file_len, cur_inst = 0, fd = -1, substr_cnt,
-		buf_size = 0, buf_used = 0, ofs = 0, buf_inc = 4096, instance_count = 0,
+	int ret = 0, path_len, file_len, cur_inst = 0, fd = -1,
 		want_instance = 1, negative_instance_value = 0;
-	char **substrs = NULL;
-	char *whole_path = NULL, *whole_path_with_prefix = NULL, *buf = NULL;
-	SEXP_t *next_inst = NULL, *items = SEXP_list_new(NULL), *instance_value_list = NULL,
-		*instance_value = NULL;
+	char *whole_path = NULL, *whole_path_with_prefix = NULL;
+	SEXP_t *next_inst = NULL, *instance_value_list = NULL, *instance_value = NULL;
+	struct pfmatch pfm;
 	struct stat st;
 
+	memset(&pfm, 0, sizeof(pfm));
 
 	if (file == NULL)
 		goto cleanup;
@@ -178,67 +564,36 @@ static int process_file(const char *prefix, const char *path, const char *file,
 		goto cleanup;
 	}
 
-	do {
-		buf_size += buf_inc;
-		void *new_buf = realloc(buf, buf_size);
-		if (new_buf == NULL) {
-			dE("Can't re-allocate memory for file-processing buffer");
-			ret = PROBE_ENOMEM;
-			goto cleanup;
-		}
-		buf = new_buf;
-		ret = read(fd, buf + buf_used, buf_inc);
-		if (ret == -1) {
-			SEXP_t *msg;
-
-			msg = probe_msg_creatf(OVAL_MESSAGE_LEVEL_ERROR, "read(): '%s' %s.", whole_path, strerror(errno));
-			probe_cobj_add_msg(probe_ctx_getresult(pfd->ctx), msg);
-			SEXP_free(msg);
-			probe_cobj_set_flag(probe_ctx_getresult(pfd->ctx), SYSCHAR_FLAG_ERROR);
-			ret = -2;
-			goto cleanup;
-		}
-		buf_used += ret;
-	} while (ret == buf_inc);
-
-	if (buf_used == buf_size) {
-		void *new_buf = realloc(buf, ++buf_size);
-		if (new_buf == NULL) {
-			dE("Can't re-allocate memory");
-			ret = PROBE_ENOMEM;
-			goto cleanup;
-		}
-		buf = new_buf;
-	}
-	buf[buf_used++] = '\0';
+	pfm.pfd  = pfd;
+	pfm.path = path;
+	pfm.file = file;
+	pfm.over = over;
 
-	do {
-		substr_cnt = oscap_pcre_get_substrings(buf, &ofs, pfd->compiled_regex, want_instance, &substrs);
+	if (pfd->line_local)
+		ret = match_lines(fd, &pfm);
+	else
+		ret = match_file(fd, &pfm, st.st_size);
 
-		if (substr_cnt < 0) {
-			SEXP_t *msg;
-			msg = probe_msg_creatf(OVAL_MESSAGE_LEVEL_ERROR,
-				"Regular expression pattern match failed in file %s with error %d.",
-				whole_path, substr_cnt);
-			probe_cobj_add_msg(probe_ctx_getresult(pfd->ctx), msg);
-			SEXP_free(msg);
-			probe_cobj_set_flag(probe_ctx_getresult(pfd->ctx), SYSCHAR_FLAG_ERROR);
-			ret = -3;
-			goto cleanup;
-		}
-
-		if (substr_cnt > 0) {
-			int k;
-			instance_count++;
-
-			SEXP_list_add(items, create_item(path, file, pfd->pattern,
-				instance_count, substrs, substr_cnt, over));
+	if (ret == -2) {
+		SEXP_t *msg;
 
-			for (k = 0; k < substr_cnt; ++k)
-				free(substrs[k]);
-			free(substrs);
-		}
-	} while (substr_cnt > 0 && ofs < buf_used);
+		msg = probe_msg_creatf(OVAL_MESSAGE_LEVEL_ERROR, "read(): '%s' %s.", whole_path, strerror(errno));
+		probe_cobj_add_msg(probe_ctx_getresult(pfd->ctx), msg);
+		SEXP_free(msg);
+		probe_cobj_set_flag(probe_ctx_getresult(pfd->ctx), SYSCHAR_FLAG_ERROR);
+		goto cleanup;
+	} else if (ret == -3) {
+		SEXP_t *msg;
+		msg = probe_msg_creatf(OVAL_MESSAGE_LEVEL_ERROR,
+			"Regular expression pattern match failed in file %s with error %d.",
+			whole_path, pfm.pcre_rc);
+		probe_cobj_add_msg(probe_ctx_getresult(pfd->ctx), msg);
+		SEXP_free(msg);
+		probe_cobj_set_flag(probe_ctx_getresult(pfd->ctx), SYSCHAR_FLAG_ERROR);
+		goto cleanup;
+	} else if (ret != 0) {
+		goto cleanup;
+	}
 
 	probe_ent_getvals(pfd->instance_ent, &instance_value_list);
 	instance_value = SEXP_list_first(instance_value_list);
@@ -246,9 +601,9 @@ static int process_file(const char *prefix, const char *path, const char *file,
 	SEXP_free(instance_value_list);
 	SEXP_free(instance_value);
 
-	for(cur_inst = 0; cur_inst < instance_count; cur_inst++){
+	for(cur_inst = 0; cur_inst < pfm.item_cnt; cur_inst++){
 		if (negative_instance_value)
-			next_inst = SEXP_number_newi_32(cur_inst - instance_count);
+			next_inst = SEXP_number_newi_32(cur_inst - pfm.item_cnt);
 
 		else
 			next_inst = SEXP_number_newi_32(cur_inst + 1);
@@ -260,26 +615,26 @@ static int process_file(const char *prefix, const char *path, const char *file,
 
 		SEXP_free(next_inst);
 
-		if (want_instance) {
-			int pic_ret = probe_item_collect(pfd->ctx, SEXP_list_nth(items, cur_inst + 1));
+		if (want_instance && pfm.items[cur_inst] != NULL) {
+			int pic_ret = probe_item_collect(pfd->ctx, pfm.items[cur_inst]);
+			pfm.items[cur_inst] = NULL;
 			if (pic_ret == 2 || pic_ret == -1) {
 				ret = -4;
 				break;
 			}
 		}
-		else
-			SEXP_free(SEXP_list_nth(items, cur_inst + 1));
 	}
 
  cleanup:
 	if (fd != -1)
 		close(fd);
-	free(buf);
+	for (cur_inst = 0; cur_inst < pfm.item_cnt; cur_inst++)
+		SEXP_free(pfm.items[cur_inst]);
+	free(pfm.items);
 	if (whole_path != NULL)
 		free(whole_path);
 	free(whole_path_with_prefix);
 
-	/* coverity[leaked_storage] - substrs is not leaked */
 	return ret;
 }
 
@@ -299,6 +654,9 @@ int textfilecontent54_probe_main(probe_ctx *ctx, void *arg)
 	char *error;
 	OVAL_FTS    *ofts;
 	OVAL_FTSENT *ofts_ent;
+	unsigned long exec_cnt, prefiltered_cnt, exec_last, prefiltered_last;
+	unsigned int file_cnt = 0, excluded_cnt = 0;
+	struct timespec t0, t1;
 
         (void)arg;
 
@@ -361,6 +719,10 @@ int textfilecontent54_probe_main(probe_ctx *ctx, void *arg)
 			pfd.re_opts |= OSCAP_PCRE_OPTS_DOTALL;
 	}
 
+	pfd.line_local = pattern_is_line_local(pfd.pattern, pfd.re_opts, &pfd.one_line);
+	dD("Pattern '%s' is matched %s.", pfd.pattern,
+	   !pfd.line_local ? "against whole files" : pfd.one_line ? "one line at a time" : "line by line");
+
 	pfd.compiled_regex = oscap_pcre_compile(pfd.pattern, pfd.re_opts, &error, &errorffset);
 	if (pfd.compiled_regex == NULL) {
 		SEXP_t *msg;
@@ -372,15 +734,27 @@ int textfilecontent54_probe_main(probe_ctx *ctx, void *arg)
 		oscap_pcre_err_free(error);
 		goto cleanup;
 	}
+	oscap_pcre_optimize(pfd.compiled_regex);
 
 	const char *prefix = getenv("OSCAP_PROBE_ROOT");
 
+	clock_gettime(CLOCK_MONOTONIC, &t0);
+	oscap_pcre_get_stats(pfd.compiled_regex, &exec_last, &prefiltered_last);
+
 	if ((ofts = oval_fts_open_prefixed(prefix, path_ent, file_ent, filepath_ent, bh_ent, probe_ctx_getresult(ctx))) != NULL) {
 		while ((ofts_ent = oval_fts_read(ofts)) != NULL) {
 			if (ofts_ent->fts_info == FTS_F
 			    || ofts_ent->fts_info == FTS_SL) {
 				// todo: handle return code
 				process_file(prefix, ofts_ent->path, ofts_ent->file, &pfd, over, ctx->blocked_paths);
+
+				/* The file was excluded if the prefilter rejected every match attempt */
+				oscap_pcre_get_stats(pfd.compiled_regex, &exec_cnt, &prefiltered_cnt);
+				++file_cnt;
+				if (exec_cnt > exec_last && exec_cnt - exec_last == prefiltered_cnt - prefiltered_last)
+					++excluded_cnt;
+				exec_last = exec_cnt;
+				prefiltered_last = prefiltered_cnt;
 			}
 			oval_ftsent_free(ofts_ent);
 		}
@@ -388,6 +762,13 @@ int textfilecontent54_probe_main(probe_ctx *ctx, void *arg)
 		oval_fts_close(ofts);
 	}
 
+	clock_gettime(CLOCK_MONOTONIC, &t1);
+	oscap_pcre_get_stats(pfd.compiled_regex, &exec_cnt, &prefiltered_cnt);
+	dI("Pattern '%s': %u files in %ld us, %u files excluded by the literal prefilter, %lu of %lu matches prefiltered.",
+	   pfd.pattern, file_cnt,
+	   (long) ((t1.tv_sec - t0.tv_sec) * 1000000 + (t1.tv_nsec - t0.tv_nsec) / 1000),
+	   excluded_cnt, prefiltered_cnt, exec_cnt);
+
  cleanup:
         SEXP_free(file_ent);
         SEXP_free(path_ent);
@@ -132,6 +132,7 @@ static SEXP_t *create_item(const char *path, const char *filename, char *pattern
 
 struct pfdata {
 	char *pattern;
+	oscap_pcre_t *compiled_regex;
 	SEXP_t *filename_ent;
         probe_ctx *ctx;
 };
@@ -146,17 +147,6 @@ static int process_file(const char *prefix, const char *path, const char *filena
 	char **substrs = NULL;
 	int substr_cnt = 0;
 
-// todo: move to probe_main()?
-	int erroffset = -1;
-	oscap_pcre_t *re = NULL;
-	char *error;
-
-	re = oscap_pcre_compile(pfd->pattern, OSCAP_PCRE_OPTS_UTF8, &error, &erroffset);
-	if (re == NULL) {
-		oscap_pcre_err_free(error);
-		return -1;
-	}
-
 	if (filename == NULL)
 		goto cleanup;
 
@@ -200,7 +190,7 @@ static int process_file(const char *prefix, const char *path, const char *filena
 	int ofs = 0;
 
 	while (fgets(line, sizeof(line), fp) != NULL) {
-		substr_cnt = oscap_pcre_get_substrings(line, &ofs, re, 1, &substrs);
+		substr_cnt = oscap_pcre_get_substrings(line, &ofs, pfd->compiled_regex, 1, &substrs);
 		if (substr_cnt > 0) {
 			int k;
 			SEXP_t *item;
@@ -213,8 +203,9 @@ static int process_file(const char *prefix, const char *path, const char *filena
 
 			for (k = 0; k < substr_cnt; ++k)
 				free(substrs[k]);
+			free(substrs);
+			substrs = NULL;
 		}
-		free(substrs);
 	}
 
  cleanup:
@@ -222,8 +213,6 @@ static int process_file(const char *prefix, const char *path, const char *filena
 		fclose(fp);
 	if (whole_path != NULL)
 		free(whole_path);
-	if (re != NULL)
-		oscap_pcre_free(re);
 	free(whole_path_with_prefix);
 
 	return ret;
@@ -238,6 +227,8 @@ int textfilecontent_probe_main(probe_ctx *ctx, void *arg)
 {
 	SEXP_t *path_ent, *filename_ent, *line_ent, *behaviors_ent, *filepath_ent, *probe_in;
 	char *pattern;
+	int erroffset = -1;
+	char *error;
 
 	OVAL_FTS    *ofts;
 	OVAL_FTSENT *ofts_ent;
@@ -291,6 +282,13 @@ int textfilecontent_probe_main(probe_ctx *ctx, void *arg)
 	pfd.filename_ent = filename_ent;
 	pfd.ctx = ctx;
 
+	pfd.compiled_regex = oscap_pcre_compile(pattern, OSCAP_PCRE_OPTS_UTF8, &error, &erroffset);
+	if (pfd.compiled_regex == NULL) {
+		oscap_pcre_err_free(error);
+		goto cleanup;
+	}
+	oscap_pcre_optimize(pfd.compiled_regex);
+
 	const char *prefix = getenv("OSCAP_PROBE_ROOT");
 
 	if ((ofts = oval_fts_open_prefixed(prefix, path_ent, filename_ent, filepath_ent, behaviors_ent, probe_ctx_getresult(ctx))) != NULL) {
@@ -306,6 +304,8 @@ int textfilecontent_probe_main(probe_ctx *ctx, void *arg)
 		oval_fts_close(ofts);
 	}
 
+	oscap_pcre_free(pfd.compiled_regex);
+ cleanup:
 	SEXP_free(path_ent);
 	SEXP_free(filename_ent);
 	SEXP_free(behaviors_ent);
@@ -53,12 +53,17 @@
 #include <config.h>
 #endif
 
+#include <stdbool.h>
 #include <stdlib.h>
 #include <string.h>
 #include <limits.h>
+#include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
 
 #include <libxml/tree.h>
 #include <libxml/parser.h>
+#include <libxml/xmlreader.h>
 #include <libxml/xpath.h>
 #include <libxml/xpathInternals.h>
 #include <libxslt/xslt.h>
@@ -72,13 +77,42 @@
 #include <probe/option.h>
 #include <oval_fts.h>
 #include <common/debug_priv.h>
+#include "list.h"
 #include "xmlfilecontent_probe.h"
 
 #define FILE_SEPARATOR '/'
 
+#define XMLFILECONTENT_XPATH_HSIZE 61
+
+struct xmlfilecontent_state {
+	/* Removes namespaces from the examined documents, see strip_ns() */
+	xsltStylesheetPtr strip_ns;
+	/*
+	 * Compiled XPath expressions keyed by their text. Entries live
+	 * until the probe is finalized.
+	 */
+	pthread_mutex_t lock;
+	struct oscap_htable *xpaths;
+};
+
+struct xmlfilecontent_xpath {
+	/* Older libxml2 releases cache lookups in the compiled expression */
+	pthread_mutex_t lock;
+	xmlXPathCompExprPtr comp;
+	/*
+	 * Local names of the elements of a simple path, see xpath_parse_simple(),
+	 * NULL if the expression has to be evaluated on the whole document.
+	 */
+	char **steps;
+	size_t step_cnt;
+	char *attr;    /* name of the selected attribute, NULL selects text() */
+};
+
 struct pfdata {
 	SEXP_t *filename_ent;
 	char *xpath;
+	struct xmlfilecontent_state *state;
+	struct xmlfilecontent_xpath *xp;
         probe_ctx *ctx;
 };
 
@@ -91,24 +125,7 @@ int xmlfilecontent_probe_offline_mode_supported()
 	return PROBE_OFFLINE_OWN;
 }
 
-void *xmlfilecontent_probe_init(void)
-{
-	/* init libxml */
-	//LIBXML_TEST_VERSION;
-	xmlInitParser();
-	xmlSetGenericErrorFunc(NULL, dummy_err_func);
-
-	return NULL;
-}
-
-void xmlfilecontent_probe_fini(void *arg)
-{
-        (void)arg;
-	/* deinit libxml */
-	xmlCleanupParser();
-}
-
-static xmlDocPtr strip_ns(xmlDocPtr doc)
+static xsltStylesheetPtr strip_ns_stylesheet(void)
 {
 	const char template[] = 
 	"<xsl:stylesheet version=\"1.0\" xmlns:xsl=\"http://www.w3.org/1999/XSL/Transform\">"
@@ -134,25 +151,321 @@ static xmlDocPtr strip_ns(xmlDocPtr doc)
 		xmlFreeDoc(stylesheet_doc);
 		return NULL;
 	}
+	return stylesheet;
+}
+
+static void xpath_free(void *ptr)
+{
+	struct xmlfilecontent_xpath *xp = ptr;
+
+	if (xp == NULL)
+		return;
+	for (size_t i = 0; i < xp->step_cnt; ++i)
+		free(xp->steps[i]);
+	free(xp->steps);
+	free(xp->attr);
+	if (xp->comp != NULL)
+		xmlXPathFreeCompExpr(xp->comp);
+	pthread_mutex_destroy(&xp->lock);
+	free(xp);
+}
+
+void *xmlfilecontent_probe_init(void)
+{
+	/* init libxml */
+	//LIBXML_TEST_VERSION;
+	xmlInitParser();
+	xmlSetGenericErrorFunc(NULL, dummy_err_func);
+
+	struct xmlfilecontent_state *state = malloc(sizeof(struct xmlfilecontent_state));
+	if (state == NULL)
+		return NULL;
+	state->xpaths = oscap_htable_new1(strcmp, XMLFILECONTENT_XPATH_HSIZE);
+	if (state->xpaths == NULL) {
+		free(state);
+		return NULL;
+	}
+	/* The stylesheet is only read by the transformations, it can be shared by the threads */
+	state->strip_ns = strip_ns_stylesheet();
+	pthread_mutex_init(&state->lock, NULL);
+
+	return state;
+}
+
+void xmlfilecontent_probe_fini(void *arg)
+{
+	struct xmlfilecontent_state *state = arg;
+
+	if (state != NULL) {
+		if (state->strip_ns != NULL)
+			xsltFreeStylesheet(state->strip_ns);
+		pthread_mutex_destroy(&state->lock);
+		oscap_htable_free(state->xpaths, xpath_free);
+		free(state);
+	}
+	/* deinit libxml */
+	xmlCleanupParser();
+}
+
+static bool is_name_char(char c, bool first)
+{
+	if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_')
+		return true;
+	return !first && ((c >= '0' && c <= '9') || c == '-' || c == '.');
+}
+
+static char *parse_name(const char **p)
+{
+	const char *start = *p;
+
+	if (!is_name_char(**p, true))
+		return NULL;
+	while (is_name_char(**p, false))
+		++(*p);
+	return strndup(start, *p - start);
+}
+
+/*
+ * Recognize absolute location paths made of child steps with plain element
+ * names which end by an attribute or a text() step, e.g. /a/b/@c or /a/b/text().
+ * Such paths can be matched while the file is read, without building the
+ * document and removing its namespaces.
+ */
+static bool xpath_parse_simple(struct xmlfilecontent_xpath *xp, const char *xpath)
+{
+	const char *p = xpath;
+
+	while (*p == '/') {
+		++p;
+		if (*p == '@') {
+			++p;
+			xp->attr = parse_name(&p);
+			break;
+		}
+		if (strcmp(p, "text()") == 0) {
+			p += strlen("text()");
+			break;
+		}
+		char *name = parse_name(&p);
+		if (name == NULL)
+			break;
+		xp->steps = realloc(xp->steps, (xp->step_cnt + 1) * sizeof(char *));
+		xp->steps[xp->step_cnt++] = name;
+	}
+	if (*p == '\0' && *xpath == '/' && xp->step_cnt > 0 && (p[-1] == ')' || xp->attr != NULL))
+		return true;
+
+	for (size_t i = 0; i < xp->step_cnt; ++i)
+		free(xp->steps[i]);
+	free(xp->steps);
+	free(xp->attr);
+	xp->steps = NULL;
+	xp->step_cnt = 0;
+	xp->attr = NULL;
+	return false;
+}
+
+static struct xmlfilecontent_xpath *xpath_get(struct xmlfilecontent_state *state, const char *xpath)
+{
+	struct xmlfilecontent_xpath *xp;
+
+	pthread_mutex_lock(&state->lock);
+	xp = oscap_htable_get(state->xpaths, xpath);
+	if (xp == NULL) {
+		xp = calloc(1, sizeof(struct xmlfilecontent_xpath));
+		if (xp == NULL) {
+			pthread_mutex_unlock(&state->lock);
+			return NULL;
+		}
+		pthread_mutex_init(&xp->lock, NULL);
+		/* A NULL expression is reported for every examined file */
+		xp->comp = xmlXPathCompile(BAD_CAST xpath);
+		xpath_parse_simple(xp, xpath);
+		if (!oscap_htable_add(state->xpaths, xpath, xp)) {
+			xpath_free(xp);
+			xp = NULL;
+		}
+	}
+	pthread_mutex_unlock(&state->lock);
+	return xp;
+}
+
+static xmlDocPtr strip_ns(xsltStylesheetPtr stylesheet, xmlDocPtr doc)
+{
+	if (stylesheet == NULL)
+		return NULL;
 	xmlDocPtr result = xsltApplyStylesheet(stylesheet, doc, NULL);
 	if (result == NULL) {
 		fprintf(stderr, "Can't apply XSLT on the document\n");
 	}
-	xsltFreeStylesheet(stylesheet);
 	return result;
 }
 
+static void report_error(struct pfdata *pfd, const char *fmt, const char *arg)
+{
+	SEXP_t *msg;
+
+	msg = probe_msg_creatf(OVAL_MESSAGE_LEVEL_ERROR, fmt, arg);
+	probe_cobj_add_msg(probe_ctx_getresult(pfd->ctx), msg);
+	SEXP_free(msg);
+	probe_cobj_set_flag(probe_ctx_getresult(pfd->ctx), SYSCHAR_FLAG_ERROR);
+}
+
+static SEXP_t *create_item(const char *path, const char *filename, const char *xpath)
+{
+	char filepath[PATH_MAX+1];
+	size_t path_len = strlen(path);
+
+	/* Avoid 2 slashes */
+	if (path_len >= 1 && path[path_len - 1] == FILE_SEPARATOR) {
+		snprintf(filepath, PATH_MAX, "%s%s", path, filename);
+	} else {
+		snprintf(filepath, PATH_MAX, "%s%c%s", path, FILE_SEPARATOR, filename);
+	}
+
+	return probe_item_create(OVAL_INDEPENDENT_XML_FILE_CONTENT, NULL,
+	                         "filepath", OVAL_DATATYPE_STRING, filepath,
+	                         "path",     OVAL_DATATYPE_STRING, path,
+	                         "filename", OVAL_DATATYPE_STRING, filename,
+	                         "xpath",    OVAL_DATATYPE_STRING, xpath,
+	                         NULL);
+}
+
+static void add_value(SEXP_t **item, const char *path, const char *filename, const char *xpath, const xmlChar *value)
+{
+	SEXP_t *val;
+
+	if (*item == NULL)
+		*item = create_item(path, filename, xpath);
+	val = SEXP_string_newf("%s", value != NULL ? (const char *) value : "");
+	probe_item_ent_add(*item, "value_of", NULL, val);
+	SEXP_free(val);
+}
+
+/*
+ * Evaluate a simple path while the file is read. Elements are matched by
+ * their local names, the text of an element is joined across comments and
+ * CDATA sections, and the last of the attributes with the same local name
+ * wins, as if the namespaces were removed by strip_ns().
+ *
+ * @return 0 on success, -1 if the file can't be parsed, 1 if the file has
+ * to be evaluated as a whole document
+ */
+static int process_simple(const char *file, const char *path, const char *filename, struct pfdata *pfd, SEXP_t **item)
+{
+	const struct xmlfilecontent_xpath *xp = pfd->xp;
+	xmlTextReaderPtr reader;
+	int fd, ret;
+
+	/* The file is pulled through the reader, no document is built */
+	fd = open(file, O_RDONLY | O_CLOEXEC);
+	if (fd < 0)
+		return -1;
+	reader = xmlReaderForFd(fd, file, NULL, 0);
+	if (reader == NULL) {
+		close(fd);
+		return -1;
+	}
+
+	ret = xmlTextReaderRead(reader);
+	while (ret == 1) {
+		int type = xmlTextReaderNodeType(reader);
+		if (type == XML_READER_TYPE_ENTITY_REFERENCE) {
+			ret = 2;
+			break;
+		}
+		if (type != XML_READER_TYPE_ELEMENT) {
+			ret = xmlTextReaderRead(reader);
+			continue;
+		}
+
+		/* Subtrees which don't match are skipped, so all the ancestors match */
+		int depth = xmlTextReaderDepth(reader);
+		if (depth < 0 || (size_t) depth >= xp->step_cnt ||
+		    !xmlStrEqual(xmlTextReaderConstLocalName(reader), BAD_CAST xp->steps[depth])) {
+			ret = xmlTextReaderNext(reader);
+			continue;
+		}
+		if ((size_t) depth + 1 < xp->step_cnt) {
+			ret = xmlTextReaderRead(reader);
+			continue;
+		}
+
+		if (xp->attr != NULL) {
+			xmlChar *value = NULL;
+			bool found = false;
+
+			while (xmlTextReaderMoveToNextAttribute(reader) == 1) {
+				if (xmlTextReaderIsNamespaceDecl(reader) == 1 ||
+				    !xmlStrEqual(xmlTextReaderConstLocalName(reader), BAD_CAST xp->attr))
+					continue;
+				xmlFree(value);
+				value = xmlTextReaderValue(reader);
+				found = true;
+			}
+			xmlTextReaderMoveToElement(reader);
+			if (found)
+				add_value(item, path, filename, pfd->xpath, value);
+			xmlFree(value);
+			ret = xmlTextReaderNext(reader);
+			continue;
+		}
+
+		if (xmlTextReaderIsEmptyElement(reader) == 1) {
+			ret = xmlTextReaderNext(reader);
+			continue;
+		}
+		xmlChar *text = NULL;
+		ret = xmlTextReaderRead(reader);
+		while (ret == 1 && xmlTextReaderDepth(reader) > depth) {
+			switch (xmlTextReaderNodeType(reader)) {
+			case XML_READER_TYPE_TEXT:
+			case XML_READER_TYPE_CDATA:
+			case XML_READER_TYPE_WHITESPACE:
+			case XML_READER_TYPE_SIGNIFICANT_WHITESPACE:
+				text = xmlStrcat(text, xmlTextReaderConstValue(reader));
+				ret = xmlTextReaderRead(reader);
+				break;
+			case XML_READER_TYPE_ELEMENT:
+				if (text != NULL)
+					add_value(item, path, filename, pfd->xpath, text);
+				xmlFree(text);
+				text = NULL;
+				ret = xmlTextReaderNext(reader);
+				break;
+			case XML_READER_TYPE_ENTITY_REFERENCE:
+				ret = 2;
+				break;
+			default:
+				ret = xmlTextReaderRead(reader);
+				break;
+			}
+		}
+		if (ret == 1 && text != NULL)
+			add_value(item, path, filename, pfd->xpath, text);
+		xmlFree(text);
+	}
+	xmlFreeTextReader(reader);
+	close(fd);
+
+	if (ret != 0 && *item != NULL) {
+		SEXP_free(*item);
+		*item = NULL;
+	}
+	return ret == 0 ? 0 : (ret == 2 ? 1 : -1);
+}
+
 static int process_file(const char *prefix, const char *path, const char *filename, struct pfdata *pfd, struct oscap_list *blocked_paths)
 {
 	int ret = 0, path_len, filename_len;
 	char *whole_path = NULL;
+	char *file = NULL;
 	xmlDoc *doc = NULL;
 	xmlDoc *doc_no_ns = NULL;
 	xmlXPathContext *xpath_ctx = NULL;
 	xmlXPathObject *xpath_obj = NULL;
 	SEXP_t *item = NULL;
         SEXP_t *r0;
-        char filepath[PATH_MAX+1];
 
 	if (filename == NULL)
 		goto cleanup;
@@ -174,21 +487,32 @@ static int process_file(const char *prefix, const char *path, const char *filena
 		goto cleanup;
 	}
 
-	if (prefix == NULL) {
-		doc = xmlParseFile(whole_path);
-	} else {
-		char *path_with_prefix = oscap_path_join(prefix, whole_path);
-		doc = xmlParseFile(path_with_prefix);
-		free(path_with_prefix);
+	if (prefix == NULL)
+		file = strdup(whole_path);
+	else
+		file = oscap_path_join(prefix, whole_path);
+
+	if (pfd->xp != NULL && pfd->xp->steps != NULL) {
+		ret = process_simple(file, path, filename, pfd, &item);
+		if (ret == 0) {
+			if (item == NULL) {
+				ret = -5;
+				goto cleanup;
+			}
+			goto collect;
+		}
+		if (ret < 0) {
+			report_error(pfd, "Can't parse '%s'.", whole_path);
+			goto cleanup;
+		}
+		/* Entity references are left to the XSLT transformation */
+		ret = 0;
 	}
 
-	if (doc == NULL) {
-                SEXP_t *msg;
-                msg = probe_msg_creatf(OVAL_MESSAGE_LEVEL_ERROR, "Can't parse '%s'.", whole_path);
-                probe_cobj_add_msg(probe_ctx_getresult(pfd->ctx), msg);
-                SEXP_free(msg);
-                probe_cobj_set_flag(probe_ctx_getresult(pfd->ctx), SYSCHAR_FLAG_ERROR);
+	doc = xmlParseFile(file);
 
+	if (doc == NULL) {
+		report_error(pfd, "Can't parse '%s'.", whole_path);
 		ret = -1;
 		goto cleanup;
 	}
@@ -198,14 +522,9 @@ static int process_file(const char *prefix, const char *path, const char *filena
 	 * xmlfilecontent should use standardized XPath, existing content expects
 	 * this behavior.
 	 */
-	doc_no_ns = strip_ns(doc);
+	doc_no_ns = strip_ns(pfd->state->strip_ns, doc);
 	if (doc_no_ns == NULL) {
-		SEXP_t *msg;
-		msg = probe_msg_creatf(OVAL_MESSAGE_LEVEL_ERROR,
-			"Can't remove namespaces from '%s'.", whole_path);
-		probe_cobj_add_msg(probe_ctx_getresult(pfd->ctx), msg);
-		SEXP_free(msg);
-		probe_cobj_set_flag(probe_ctx_getresult(pfd->ctx), SYSCHAR_FLAG_ERROR);
+		report_error(pfd, "Can't remove namespaces from '%s'.", whole_path);
 		ret = -1;
 		goto cleanup;
 	}
@@ -213,41 +532,23 @@ static int process_file(const char *prefix, const char *path, const char *filena
 	/* evaluate xpath */
 	xpath_ctx = xmlXPathNewContext(doc_no_ns);
 	if (xpath_ctx == NULL) {
-                SEXP_t *msg;
-                msg = probe_msg_creatf(OVAL_MESSAGE_LEVEL_ERROR, "xmlXPathNewContext() error.");
-                probe_cobj_add_msg(probe_ctx_getresult(pfd->ctx), msg);
-                SEXP_free(msg);
-                probe_cobj_set_flag(probe_ctx_getresult(pfd->ctx), SYSCHAR_FLAG_ERROR);
-
+		report_error(pfd, "%s", "xmlXPathNewContext() error.");
 		ret = -2;
 		goto cleanup;
 	}
 
-	xpath_obj = xmlXPathEvalExpression(BAD_CAST pfd->xpath, xpath_ctx);
+	if (pfd->xp != NULL && pfd->xp->comp != NULL) {
+		pthread_mutex_lock(&pfd->xp->lock);
+		xpath_obj = xmlXPathCompiledEval(pfd->xp->comp, xpath_ctx);
+		pthread_mutex_unlock(&pfd->xp->lock);
+	}
 	if (xpath_obj == NULL) {
-                SEXP_t *msg;
-                msg = probe_msg_creatf(OVAL_MESSAGE_LEVEL_ERROR, "xmlXPathEvalExpression() error");
-                probe_cobj_add_msg(probe_ctx_getresult(pfd->ctx), msg);
-                SEXP_free(msg);
-                probe_cobj_set_flag(probe_ctx_getresult(pfd->ctx), SYSCHAR_FLAG_ERROR);
-
+		report_error(pfd, "%s", "xmlXPathEvalExpression() error");
 		ret = -3;
 		goto cleanup;
 	}
 
-	/* Avoid 2 slashes */
-	if (path_len >= 1 && path[path_len - 1] == FILE_SEPARATOR) {
-		snprintf(filepath, PATH_MAX, "%s%s", path, filename);
-	} else {
-		snprintf(filepath, PATH_MAX, "%s%c%s", path, FILE_SEPARATOR, filename);
-	}
-
-        item = probe_item_create(OVAL_INDEPENDENT_XML_FILE_CONTENT, NULL,
-                                 "filepath", OVAL_DATATYPE_STRING, filepath,
-                                 "path",     OVAL_DATATYPE_STRING, path,
-                                 "filename", OVAL_DATATYPE_STRING, filename,
-                                 "xpath",    OVAL_DATATYPE_STRING, pfd->xpath,
-                                 NULL);
+        item = create_item(path, filename, pfd->xpath);
 
 	dD("xpath obj type: %d.", xpath_obj->type);
 	switch(xpath_obj->type) {
@@ -327,6 +628,7 @@ static int process_file(const char *prefix, const char *path, const char *filena
 		break;
 	}
 
+ collect:
         probe_item_collect(pfd->ctx, item);
         item = NULL;
  cleanup:
@@ -342,6 +644,7 @@ static int process_file(const char *prefix, const char *path, const char *filena
 		xmlFreeDoc(doc_no_ns);
 	if (whole_path != NULL)
 		free(whole_path);
+	free(file);
 
 	return ret;
 }
@@ -354,7 +657,8 @@ int xmlfilecontent_probe_main(probe_ctx *ctx, void *arg)
 	OVAL_FTS    *ofts;
 	OVAL_FTSENT *ofts_ent;
 
-        (void)arg;
+	if (arg == NULL)
+		return PROBE_EINIT;
 
         probe_in = probe_ctx_getobject(ctx);
 
@@ -390,6 +694,8 @@ int xmlfilecontent_probe_main(probe_ctx *ctx, void *arg)
         SEXP_free (r0);
 
 	pfd.filename_ent = filename_ent;
+	pfd.state = arg;
+	pfd.xp = pfd.xpath != NULL ? xpath_get(pfd.state, pfd.xpath) : NULL;
         pfd.ctx = ctx;
 
 	const char *prefix = getenv("OSCAP_PROBE_ROOT");
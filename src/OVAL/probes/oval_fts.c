@@ -69,6 +69,7 @@ static void OVAL_FTS_free(OVAL_FTS *ofts)
 		fts_close(ofts->ofts_match_path_fts);
 	if (ofts->ofts_recurse_path_fts != NULL)
 		fts_close(ofts->ofts_recurse_path_fts);
+	oval_fts_walk_close(ofts->ofts_recurse_path_walk);
 
 	free(ofts);
 	return;
@@ -409,9 +410,9 @@ static int process_pattern_match(const char *path, oscap_pcre_t **regex_out)
 		pattern = strdup(path);
 	}
 
-	regex = oscap_pcre_compile(pattern, 0, &errptr, &errofs);
+	regex = oscap_pcre_cache_get(pattern, 0, &errptr, &errofs);
 	if (regex == NULL) {
-		dE("Failed to validate the pattern: oscap_pcre_compile(): "
+		dE("Failed to validate the pattern: oscap_pcre_cache_get(): "
 		   "error offset: %d, error: '%s', pattern: '%s'.\n",
 		   errofs, errptr, pattern);
 		free(pattern);
@@ -455,7 +456,7 @@ static int process_pattern_match(const char *path, oscap_pcre_t **regex_out)
 		   "PCRE_ERROR_NOMATCH for pattern '%s' and a test path '%s'. "
 		   "This indicates the pattern doesn't match a leading '/'.\n",
 		   pattern, test_path1);
-		oscap_pcre_free(regex);
+		oscap_pcre_cache_release(regex);
 		free(pattern);
 		return -2;
 	default:
@@ -487,7 +488,7 @@ static int process_pattern_match(const char *path, oscap_pcre_t **regex_out)
 		dE("Failed to validate the pattern: oscap_pcre_exec() return "
 		   "code: %d, pattern '%s', test path '%s'.\n", ret,
 		   pattern, test_path1);
-		oscap_pcre_free(regex);
+		oscap_pcre_cache_release(regex);
 		free(pattern);
 		return -1;
 	}
@@ -500,7 +501,7 @@ static int process_pattern_match(const char *path, oscap_pcre_t **regex_out)
 		if (regex_out != NULL)
 			*regex_out = regex;
 		else
-			oscap_pcre_free(regex);
+			oscap_pcre_cache_release(regex);
 	}
 
 	free(pattern);
@@ -697,7 +698,7 @@ OVAL_FTS *oval_fts_open_prefixed(const char *prefix, SEXP_t *path, SEXP_t *filen
 			   errno, strerror(errno));
 		}
 		free((void *) paths[0]);
-		oscap_pcre_free(regex);
+		oscap_pcre_cache_release(regex);
 		return NULL;
 	}
 
@@ -713,16 +714,14 @@ OVAL_FTS *oval_fts_open_prefixed(const char *prefix, SEXP_t *path, SEXP_t *filen
 	if (ofts->ofts_match_path_fts == NULL || errno != 0) {
 		dE("fts_open() failed, errno: %d \"%s\".", errno, strerror(errno));
 		OVAL_FTS_free(ofts);
-		oscap_pcre_free(regex);
+		oscap_pcre_cache_release(regex);
 		return (NULL);
 	}
 
 	ofts->ofts_recurse_path_fts_opts = rec_fts_options;
 	ofts->ofts_path_op = path_op;
-	if (regex != NULL) {
+	if (regex != NULL)
 		ofts->ofts_path_regex = regex;
-		oscap_pcre_optimize(regex);
-	}
 
 	if (filesystem == OVAL_RECURSE_FS_LOCAL) {
 #if defined(OS_SOLARIS)
@@ -909,6 +908,27 @@ static FTSENT *oval_fts_read_match_path(OVAL_FTS *ofts)
 	return fts_ent;
 }
 
+/*
+ * Tell the walk which directories oval_fts_read_recurse_path() is going to
+ * descend into, so that they can be read ahead. Runs in the walk threads.
+ */
+static bool oval_fts_prefetch(const FTSENT *dir, void *arg)
+{
+	OVAL_FTS *ofts = arg;
+
+	if (ofts->direction != OVAL_RECURSE_DIRECTION_DOWN || !(ofts->recurse & OVAL_RECURSE_DIRS))
+		return false;
+	if (ofts->max_depth != -1 && dir->fts_level > ofts->max_depth)
+		return false;
+	if (_oval_fts_is_local(ofts, (FTSENT *) dir))
+		return false;
+	if (ofts->filesystem == OVAL_RECURSE_FS_DEFINED
+	    && ofts->ofts_recurse_path_devid != dir->fts_statp->st_dev)
+		return false;
+
+	return true;
+}
+
 /* find the first matching file or directory */
 static FTSENT *oval_fts_read_recurse_path(OVAL_FTS *ofts)
 {
@@ -928,32 +948,22 @@ static FTSENT *oval_fts_read_recurse_path(OVAL_FTS *ofts)
 			break;
 		}
 
-		/* initialize separate fts for recursion */
-		if (ofts->ofts_recurse_path_fts == NULL) {
-			char * const paths[2] = { ofts->ofts_match_path_fts_ent->fts_path, NULL };
-
+		/* initialize separate walk for recursion */
+		if (ofts->ofts_recurse_path_walk == NULL) {
 #if defined(OSCAP_FTS_DEBUG)
-			dD("fts_open args: path: \"%s\", options: %d.",
-				paths[0], ofts->ofts_recurse_path_fts_opts);
+			dD("oval_fts_walk_open args: path: \"%s\", options: %d.",
+				ofts->ofts_match_path_fts_ent->fts_path, ofts->ofts_recurse_path_fts_opts);
 #endif
-			/* reset errno as fts_open() doesn't do it itself. */
-			errno = 0;
-			ofts->ofts_recurse_path_fts = fts_open(paths,
-				ofts->ofts_recurse_path_fts_opts, NULL);
-			/* fts_open() doesn't return NULL for all errors
-			   (e.g. nonexistent paths), so check errno to detect it.
-			   Far from being perfect. */
-			if (ofts->ofts_recurse_path_fts == NULL || errno != 0) {
-				dE("fts_open() failed, errno: %d \"%s\".",
+			ofts->ofts_recurse_path_walk = oval_fts_walk_open(ofts->ofts_match_path_fts_ent->fts_path,
+				ofts->ofts_recurse_path_fts_opts, oval_fts_walk_threads(),
+				oval_fts_prefetch, ofts);
+			if (ofts->ofts_recurse_path_walk == NULL) {
+				dE("oval_fts_walk_open() failed, errno: %d \"%s\".",
 					errno, strerror(errno));
 #if !defined(OSCAP_FTS_DEBUG)
-				dE("fts_open args: path: \"%s\", options: %d.",
-					paths[0], ofts->ofts_recurse_path_fts_opts);
+				dE("oval_fts_walk_open args: path: \"%s\", options: %d.",
+					ofts->ofts_match_path_fts_ent->fts_path, ofts->ofts_recurse_path_fts_opts);
 #endif
-				if (ofts->ofts_recurse_path_fts != NULL) {
-					fts_close(ofts->ofts_recurse_path_fts);
-					ofts->ofts_recurse_path_fts = NULL;
-				}
 				return (NULL);
 			}
 		}
@@ -962,10 +972,10 @@ static FTSENT *oval_fts_read_recurse_path(OVAL_FTS *ofts)
 		while (out_fts_ent == NULL) {
 			FTSENT *fts_ent;
 
-			fts_ent = fts_read(ofts->ofts_recurse_path_fts);
+			fts_ent = oval_fts_walk_read(ofts->ofts_recurse_path_walk);
 			if (fts_ent == NULL) {
-				fts_close(ofts->ofts_recurse_path_fts);
-				ofts->ofts_recurse_path_fts = NULL;
+				oval_fts_walk_close(ofts->ofts_recurse_path_walk);
+				ofts->ofts_recurse_path_walk = NULL;
 
 				return NULL;
 			}
@@ -975,7 +985,7 @@ static FTSENT *oval_fts_read_recurse_path(OVAL_FTS *ofts)
 				continue;
 			case FTS_DC:
 				dW("Filesystem tree cycle detected at '%s'.", fts_ent->fts_path);
-				fts_set(ofts->ofts_recurse_path_fts, fts_ent, FTS_SKIP);
+				oval_fts_walk_set(ofts->ofts_recurse_path_walk, fts_ent, FTS_SKIP);
 				continue;
 			}
 
@@ -1018,7 +1028,7 @@ static FTSENT *oval_fts_read_recurse_path(OVAL_FTS *ofts)
 				/* limit recursion depth */
 				if (ofts->direction == OVAL_RECURSE_DIRECTION_NONE
 				    || (ofts->max_depth != -1 && fts_ent->fts_level > ofts->max_depth)) {
-					fts_set(ofts->ofts_recurse_path_fts, fts_ent, FTS_SKIP);
+					oval_fts_walk_set(ofts->ofts_recurse_path_walk, fts_ent, FTS_SKIP);
 					continue;
 				}
 
@@ -1026,17 +1036,17 @@ static FTSENT *oval_fts_read_recurse_path(OVAL_FTS *ofts)
 				switch (fts_ent->fts_info) {
 				case FTS_D:
 					if (!(ofts->recurse & OVAL_RECURSE_DIRS) && !(ofts->recurse & OVAL_RECURSE_SYMLINKS && ofts->following)) {
-						fts_set(ofts->ofts_recurse_path_fts, fts_ent, FTS_SKIP);
+						oval_fts_walk_set(ofts->ofts_recurse_path_walk, fts_ent, FTS_SKIP);
 						continue;
 					}
 					ofts->following = 0;
 					break;
 				case FTS_SL:
 					if (!(ofts->recurse & OVAL_RECURSE_SYMLINKS)) {
-						fts_set(ofts->ofts_recurse_path_fts, fts_ent, FTS_SKIP);
+						oval_fts_walk_set(ofts->ofts_recurse_path_walk, fts_ent, FTS_SKIP);
 						continue;
 					}
-					fts_set(ofts->ofts_recurse_path_fts, fts_ent, FTS_FOLLOW);
+					oval_fts_walk_set(ofts->ofts_recurse_path_walk, fts_ent, FTS_FOLLOW);
 					ofts->following = 1;
 					break;
 				default:
@@ -1044,14 +1054,14 @@ static FTSENT *oval_fts_read_recurse_path(OVAL_FTS *ofts)
 				}
 			}
 			if (_oval_fts_is_local(ofts, fts_ent)) {
-				fts_set(ofts->ofts_recurse_path_fts, fts_ent, FTS_SKIP);
+				oval_fts_walk_set(ofts->ofts_recurse_path_walk, fts_ent, FTS_SKIP);
 				continue;
 			}
 			/* don't recurse beyond the initial filesystem */
 			if (ofts->filesystem == OVAL_RECURSE_FS_DEFINED
 			    && (fts_ent->fts_info == FTS_D || fts_ent->fts_info == FTS_SL)
 			    && ofts->ofts_recurse_path_devid != fts_ent->fts_statp->st_dev) {
-				fts_set(ofts->ofts_recurse_path_fts, fts_ent, FTS_SKIP);
+				oval_fts_walk_set(ofts->ofts_recurse_path_walk, fts_ent, FTS_SKIP);
 				continue;
 			}
 		}
@@ -1234,7 +1244,7 @@ int oval_fts_close(OVAL_FTS *ofts)
 		free(ofts->ofts_recurse_path_pthcpy);
 
 	if (ofts->ofts_path_regex)
-		oscap_pcre_free(ofts->ofts_path_regex);
+		oscap_pcre_cache_release(ofts->ofts_path_regex);
 
 	if (ofts->ofts_spath != NULL)
 		SEXP_free(ofts->ofts_spath);
@@ -31,6 +31,7 @@
 #include <fts.h>
 #endif
 #include "fsdev.h"
+#include "oval_fts_walk.h"
 #include "common/oscap_pcre.h"
 
 #define ENT_GET_AREF(ent, dst, attr_name, mandatory)			\
@@ -72,6 +73,7 @@ typedef struct {
 	FTSENT *ofts_match_path_fts_ent;
 	/* oval_fts_read_recurse_path() state */
 	FTS *ofts_recurse_path_fts;
+	OVAL_FTS_WALK *ofts_recurse_path_walk;
 	int ofts_recurse_path_fts_opts;
 	int ofts_recurse_path_curdepth;
 	char *ofts_recurse_path_pthcpy;
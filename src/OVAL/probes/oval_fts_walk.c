@@ -0,0 +1,736 @@
+/**
+ * @file   oval_fts_walk.c
+ * @brief  Parallel directory tree walker with an fts(3) compatible interface
+ */
+/*
+ * Copyright 2026 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <limits.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include "debug_priv.h"
+#include "oscap_parallel.h"
+#include "oval_fts_walk.h"
+
+/* Upper bound of entries read ahead and not yet left by the walk */
+#define OVAL_FTS_WALK_BUDGET 65536
+
+/* Default upper bound of threads walking a tree, see OSCAP_PROBE_FTS_THREADS */
+#define OVAL_FTS_WALK_THREADS_MAX 4
+
+#define WALK_ALIGN(n) (((n) + 15) & ~(size_t) 15)
+
+struct walk_devino {
+	dev_t dev;
+	ino_t ino;
+};
+
+enum {
+	WALK_DIR_PENDING, /* queued for reading ahead */
+	WALK_DIR_RUNNING, /* being read */
+	WALK_DIR_DONE     /* the children are read */
+};
+
+/*
+ * A directory to be read. Everything a thread needs to read it is copied
+ * here, because the entry of the directory may be freed meanwhile.
+ */
+struct walk_dir {
+	char *path;
+	size_t pathlen;
+	short level;
+	/* the directory and its ancestors, for cycle detection */
+	struct walk_devino *ancestors;
+	int depth;
+	/* fts_parent of the children, never dereferenced by the pool */
+	FTSENT *ent;
+
+	int state;
+	int refs;
+	bool released; /* the walk doesn't need the children anymore */
+	int err;
+	FTSENT **children;
+	size_t count;
+
+	struct walk_dir *next;
+};
+
+struct walk_frame {
+	FTSENT *dir;
+	FTSENT **children;
+	size_t count;
+	size_t idx;
+};
+
+struct oval_fts_walk {
+	FTSENT *root;
+	FTSENT *rootparent;
+	FTSENT *cur;
+	int options;
+	bool done;
+
+	/* directories the walk is in */
+	struct walk_frame *frames;
+	size_t frame_cnt;
+	size_t frame_max;
+
+	oval_fts_walk_prefetch_func prefetch;
+	void *arg;
+
+	pthread_mutex_t lock;
+	pthread_cond_t work_cond;
+	pthread_cond_t done_cond;
+	/* directories to read ahead, the next one the walk needs is on top */
+	struct walk_dir *stack;
+	size_t buffered;
+	bool stop;
+	unsigned int threads;
+	unsigned int started;
+	pthread_t *workers;
+};
+
+static FTSENT *walk_ent_new(const char *dirpath, size_t dirlen, const char *name, size_t namelen)
+{
+	size_t pathlen, stat_ofs, path_ofs;
+	FTSENT *p;
+
+	if (dirpath != NULL) {
+		/* don't double the slash of "/" */
+		if (dirlen > 0 && dirpath[dirlen - 1] == '/')
+			--dirlen;
+		pathlen = dirlen + 1 + namelen;
+	} else {
+		pathlen = namelen;
+	}
+
+	if (pathlen > USHRT_MAX) {
+		errno = ENAMETOOLONG;
+		return NULL;
+	}
+
+	/* The stat buffer and the path are allocated together with the entry */
+	stat_ofs = WALK_ALIGN(sizeof(FTSENT) + namelen);
+	path_ofs = stat_ofs + sizeof(struct stat);
+	p = calloc(1, path_ofs + pathlen + 1);
+	if (p == NULL)
+		return NULL;
+
+	memcpy(p->fts_name, name, namelen);
+	p->fts_name[namelen] = '\0';
+	p->fts_namelen = namelen;
+	p->fts_statp = (struct stat *) ((char *) p + stat_ofs);
+	p->fts_path = (char *) p + path_ofs;
+	if (dirpath != NULL) {
+		memcpy(p->fts_path, dirpath, dirlen);
+		p->fts_path[dirlen] = '/';
+		memcpy(p->fts_path + dirlen + 1, name, namelen + 1);
+	} else {
+		memcpy(p->fts_path, name, namelen + 1);
+	}
+	p->fts_pathlen = pathlen;
+	p->fts_accpath = p->fts_path;
+	p->fts_instr = FTS_NOINSTR;
+
+	return p;
+}
+
+/* Classify an entry by its stat buffer like fts_stat() */
+static unsigned short walk_ent_info(FTSENT *p)
+{
+	struct stat *sb = p->fts_statp;
+
+	if (S_ISDIR(sb->st_mode)) {
+		p->fts_dev = sb->st_dev;
+		p->fts_ino = sb->st_ino;
+		p->fts_nlink = sb->st_nlink;
+		return FTS_D;
+	}
+	if (S_ISLNK(sb->st_mode))
+		return FTS_SL;
+	if (S_ISREG(sb->st_mode))
+		return FTS_F;
+	return FTS_DEFAULT;
+}
+
+/* stat() an entry the walk owns, with its ancestors for cycle detection */
+static unsigned short walk_ent_stat(FTSENT *p, bool follow)
+{
+	unsigned short info;
+
+	if (follow) {
+		if (stat(p->fts_accpath, p->fts_statp) != 0) {
+			int saved_errno = errno;
+
+			if (lstat(p->fts_accpath, p->fts_statp) == 0) {
+				errno = 0;
+				return FTS_SLNONE;
+			}
+			p->fts_errno = saved_errno;
+			memset(p->fts_statp, 0, sizeof(struct stat));
+			return FTS_NS;
+		}
+	} else if (lstat(p->fts_accpath, p->fts_statp) != 0) {
+		p->fts_errno = errno;
+		memset(p->fts_statp, 0, sizeof(struct stat));
+		return FTS_NS;
+	}
+
+	info = walk_ent_info(p);
+	if (info == FTS_D) {
+		for (FTSENT *t = p->fts_parent; t->fts_level >= FTS_ROOTLEVEL; t = t->fts_parent) {
+			if (p->fts_ino == t->fts_ino && p->fts_dev == t->fts_dev) {
+				p->fts_cycle = t;
+				return FTS_DC;
+			}
+		}
+	}
+
+	return info;
+}
+
+static struct walk_dir *walk_dir_new(FTSENT *ent, const struct walk_devino *ancestors, int depth)
+{
+	struct walk_dir *dir = calloc(1, sizeof(struct walk_dir));
+
+	if (dir == NULL)
+		return NULL;
+
+	dir->path = strdup(ent->fts_path);
+	dir->pathlen = ent->fts_pathlen;
+	dir->level = ent->fts_level;
+	dir->ancestors = malloc((depth + 1) * sizeof(struct walk_devino));
+	if (dir->path == NULL || dir->ancestors == NULL) {
+		free(dir->path);
+		free(dir->ancestors);
+		free(dir);
+		return NULL;
+	}
+	dir->ancestors[0].dev = ent->fts_dev;
+	dir->ancestors[0].ino = ent->fts_ino;
+	if (depth > 0)
+		memcpy(dir->ancestors + 1, ancestors, depth * sizeof(struct walk_devino));
+	dir->depth = depth + 1;
+	dir->ent = ent;
+	dir->refs = 1;
+
+	return dir;
+}
+
+/* Describe a directory the walk is entering, its ancestors are the open directories */
+static struct walk_dir *walk_dir_from_ent(FTSENT *ent)
+{
+	struct walk_devino *ancestors;
+	struct walk_dir *dir;
+	int depth = 0;
+
+	for (FTSENT *t = ent->fts_parent; t != NULL && t->fts_level >= FTS_ROOTLEVEL; t = t->fts_parent)
+		++depth;
+
+	ancestors = malloc((depth + 1) * sizeof(struct walk_devino));
+	if (ancestors == NULL)
+		return NULL;
+
+	depth = 0;
+	for (FTSENT *t = ent->fts_parent; t != NULL && t->fts_level >= FTS_ROOTLEVEL; t = t->fts_parent) {
+		ancestors[depth].dev = t->fts_dev;
+		ancestors[depth].ino = t->fts_ino;
+		++depth;
+	}
+
+	dir = walk_dir_new(ent, ancestors, depth);
+	free(ancestors);
+
+	return dir;
+}
+
+static void walk_ents_free(OVAL_FTS_WALK *walk, FTSENT **ents, size_t count);
+
+/* Called with the lock held */
+static void walk_dir_unref(struct walk_dir *dir)
+{
+	if (--dir->refs > 0)
+		return;
+
+	free(dir->path);
+	free(dir->ancestors);
+	free(dir);
+}
+
+/* The owner of the directory entry gives it up, called with the lock held */
+static void walk_dir_release(OVAL_FTS_WALK *walk, struct walk_dir *dir)
+{
+	dir->released = true;
+	if (dir->state == WALK_DIR_DONE && dir->children != NULL) {
+		walk_ents_free(walk, dir->children, dir->count);
+		dir->children = NULL;
+	}
+	walk_dir_unref(dir);
+}
+
+/* Called with the lock held */
+static void walk_ents_free(OVAL_FTS_WALK *walk, FTSENT **ents, size_t count)
+{
+	for (size_t i = 0; i < count; ++i) {
+		if (ents[i]->fts_pointer != NULL)
+			walk_dir_release(walk, ents[i]->fts_pointer);
+		free(ents[i]);
+	}
+	free(ents);
+
+	if (walk->buffered >= OVAL_FTS_WALK_BUDGET && walk->buffered - count < OVAL_FTS_WALK_BUDGET)
+		pthread_cond_broadcast(&walk->work_cond);
+	walk->buffered -= count;
+}
+
+/*
+ * Read the children of a directory, lstat() them and queue those the walk
+ * is going to descend into. Called without the lock by the pool threads
+ * and by the walk itself.
+ */
+static void walk_dir_read(OVAL_FTS_WALK *walk, struct walk_dir *dir)
+{
+	FTSENT **children = NULL;
+	size_t count = 0, max = 0;
+	struct walk_dir *queue = NULL;
+	struct dirent *dp;
+	DIR *dirp;
+	int fd, err = 0;
+
+	fd = open(dir->path, O_RDONLY | O_DIRECTORY | O_NONBLOCK | O_CLOEXEC);
+	if (fd < 0 || (dirp = fdopendir(fd)) == NULL) {
+		err = errno;
+		if (fd >= 0)
+			close(fd);
+		goto publish;
+	}
+
+	while ((dp = readdir(dirp)) != NULL) {
+		size_t namelen = strlen(dp->d_name);
+		FTSENT *p;
+
+		if (dp->d_name[0] == '.' && (namelen == 1 || (namelen == 2 && dp->d_name[1] == '.')))
+			continue;
+
+		p = walk_ent_new(dir->path, dir->pathlen, dp->d_name, namelen);
+		if (p == NULL) {
+			dW("Skipping '%s' in '%s': %s.", dp->d_name, dir->path, strerror(errno));
+			continue;
+		}
+		p->fts_level = dir->level + 1;
+		p->fts_parent = dir->ent;
+
+		if (fstatat(fd, dp->d_name, p->fts_statp, AT_SYMLINK_NOFOLLOW) != 0) {
+			p->fts_errno = errno;
+			memset(p->fts_statp, 0, sizeof(struct stat));
+			p->fts_info = FTS_NS;
+		} else {
+			p->fts_info = walk_ent_info(p);
+			if (p->fts_info == FTS_D) {
+				for (int i = 0; i < dir->depth; ++i) {
+					if (p->fts_ino == dir->ancestors[i].ino && p->fts_dev == dir->ancestors[i].dev) {
+						p->fts_info = FTS_DC;
+						break;
+					}
+				}
+			}
+		}
+
+		if (count == max) {
+			FTSENT **tmp;
+
+			max = max ? max * 2 : 32;
+			tmp = realloc(children, max * sizeof(FTSENT *));
+			if (tmp == NULL) {
+				free(p);
+				break;
+			}
+			children = tmp;
+		}
+		children[count++] = p;
+	}
+	closedir(dirp);
+
+	/* Describe the subdirectories to read ahead, in reverse to have the first one on top */
+	if (walk->threads > 0) {
+		for (size_t i = count; i-- > 0;) {
+			struct walk_dir *sub;
+
+			if (children[i]->fts_info != FTS_D || !walk->prefetch(children[i], walk->arg))
+				continue;
+
+			sub = walk_dir_new(children[i], dir->ancestors, dir->depth);
+			if (sub == NULL)
+				continue;
+			sub->refs = 2; /* the entry and the stack */
+			children[i]->fts_pointer = sub;
+			sub->next = queue;
+			queue = sub;
+		}
+	}
+
+publish:
+	pthread_mutex_lock(&walk->lock);
+	walk->buffered += count;
+	while (queue != NULL) {
+		struct walk_dir *sub = queue;
+
+		queue = sub->next;
+		sub->next = walk->stack;
+		walk->stack = sub;
+		pthread_cond_signal(&walk->work_cond);
+	}
+	dir->children = children;
+	dir->count = count;
+	dir->err = err;
+	dir->state = WALK_DIR_DONE;
+	if (dir->released) {
+		/* The walk left the parent directory meanwhile */
+		walk_ents_free(walk, dir->children, dir->count);
+		dir->children = NULL;
+	}
+	pthread_cond_broadcast(&walk->done_cond);
+	pthread_mutex_unlock(&walk->lock);
+}
+
+static void *walk_worker(void *arg)
+{
+	OVAL_FTS_WALK *walk = arg;
+
+#if defined(HAVE_PTHREAD_SETNAME_NP)
+# if defined(OS_APPLE)
+	pthread_setname_np("oval_fts_walk");
+# else
+	pthread_setname_np(pthread_self(), "oval_fts_walk");
+# endif
+#endif
+
+	pthread_mutex_lock(&walk->lock);
+	while (!walk->stop) {
+		struct walk_dir *dir;
+
+		if (walk->stack == NULL || walk->buffered >= OVAL_FTS_WALK_BUDGET) {
+			pthread_cond_wait(&walk->work_cond, &walk->lock);
+			continue;
+		}
+
+		dir = walk->stack;
+		walk->stack = dir->next;
+		dir->next = NULL;
+
+		/* Skip directories the walk has read itself or doesn't need */
+		if (dir->state != WALK_DIR_PENDING || dir->released) {
+			walk_dir_unref(dir);
+			continue;
+		}
+
+		dir->state = WALK_DIR_RUNNING;
+		pthread_mutex_unlock(&walk->lock);
+		walk_dir_read(walk, dir);
+		pthread_mutex_lock(&walk->lock);
+		walk_dir_unref(dir);
+	}
+	pthread_mutex_unlock(&walk->lock);
+
+	return NULL;
+}
+
+static void walk_start_workers(OVAL_FTS_WALK *walk)
+{
+	walk->workers = malloc(walk->threads * sizeof(pthread_t));
+	if (walk->workers == NULL) {
+		walk->threads = 0;
+		return;
+	}
+
+	for (unsigned int i = 0; i < walk->threads; ++i) {
+		if (pthread_create(&walk->workers[walk->started], NULL, walk_worker, walk) != 0) {
+			dW("Unable to start a read ahead thread, continuing with %u threads.", walk->started);
+			break;
+		}
+		++walk->started;
+	}
+}
+
+/* Get the children of the directory the walk is entering */
+static int walk_children(OVAL_FTS_WALK *walk, FTSENT *p, FTSENT ***children, size_t *count)
+{
+	struct walk_dir *dir = p->fts_pointer;
+	int err;
+
+	if (dir == NULL) {
+		dir = walk_dir_from_ent(p);
+		if (dir == NULL) {
+			*children = NULL;
+			*count = 0;
+			return errno;
+		}
+		dir->state = WALK_DIR_RUNNING;
+		walk_dir_read(walk, dir);
+	} else {
+		pthread_mutex_lock(&walk->lock);
+		if (dir->state == WALK_DIR_PENDING) {
+			/* Not read ahead yet, don't wait for it */
+			dir->state = WALK_DIR_RUNNING;
+			pthread_mutex_unlock(&walk->lock);
+			walk_dir_read(walk, dir);
+		} else {
+			while (dir->state != WALK_DIR_DONE)
+				pthread_cond_wait(&walk->done_cond, &walk->lock);
+			pthread_mutex_unlock(&walk->lock);
+		}
+	}
+
+	pthread_mutex_lock(&walk->lock);
+	*children = dir->children;
+	*count = dir->count;
+	err = dir->err;
+	dir->children = NULL;
+	p->fts_pointer = NULL;
+	walk_dir_release(walk, dir);
+
+	if (walk->threads > walk->started && walk->started == 0 && walk->stack != NULL)
+		walk_start_workers(walk);
+	pthread_mutex_unlock(&walk->lock);
+
+	return err;
+}
+
+OVAL_FTS_WALK *oval_fts_walk_open(const char *path, int options, unsigned int threads,
+                                  oval_fts_walk_prefetch_func prefetch, void *arg)
+{
+	OVAL_FTS_WALK *walk;
+
+	walk = calloc(1, sizeof(OVAL_FTS_WALK));
+	if (walk == NULL)
+		return NULL;
+
+	walk->rootparent = calloc(1, sizeof(FTSENT));
+	walk->root = walk_ent_new(NULL, 0, path, strlen(path));
+	if (walk->rootparent == NULL || walk->root == NULL) {
+		free(walk->rootparent);
+		free(walk->root);
+		free(walk);
+		return NULL;
+	}
+	/* fts names the root by the last component of the path, except "/" */
+	const char *base = strrchr(path, '/');
+	if (base != NULL && walk->root->fts_pathlen > 1) {
+		walk->root->fts_namelen = strlen(base + 1);
+		memmove(walk->root->fts_name, base + 1, walk->root->fts_namelen + 1);
+	}
+	walk->rootparent->fts_level = FTS_ROOTPARENTLEVEL;
+	walk->root->fts_level = FTS_ROOTLEVEL;
+	walk->root->fts_parent = walk->rootparent;
+	walk->root->fts_info = walk_ent_stat(walk->root, true);
+
+	walk->options = options;
+	walk->prefetch = prefetch;
+	walk->arg = arg;
+	walk->threads = prefetch != NULL ? threads : 0;
+
+	pthread_mutex_init(&walk->lock, NULL);
+	pthread_cond_init(&walk->work_cond, NULL);
+	pthread_cond_init(&walk->done_cond, NULL);
+
+	return walk;
+}
+
+FTSENT *oval_fts_walk_read(OVAL_FTS_WALK *walk)
+{
+	FTSENT *p = walk->cur;
+	unsigned short instr;
+
+	if (walk->done)
+		return NULL;
+
+	if (p == NULL)
+		return (walk->cur = walk->root);
+
+	instr = p->fts_instr;
+	p->fts_instr = FTS_NOINSTR;
+
+	if (instr == FTS_AGAIN) {
+		p->fts_info = walk_ent_stat(p, false);
+		return p;
+	}
+
+	if (instr == FTS_FOLLOW && (p->fts_info == FTS_SL || p->fts_info == FTS_SLNONE)) {
+		p->fts_info = walk_ent_stat(p, true);
+		return p;
+	}
+
+	/* Directory in pre-order */
+	if (p->fts_info == FTS_D) {
+		FTSENT **children;
+		size_t count;
+		int err;
+
+		/* If skipped or crossed mount point, do post-order visit */
+		if (instr == FTS_SKIP
+		    || ((walk->options & FTS_XDEV) && p->fts_dev != walk->root->fts_dev)) {
+			if (p->fts_pointer != NULL) {
+				pthread_mutex_lock(&walk->lock);
+				walk_dir_release(walk, p->fts_pointer);
+				pthread_mutex_unlock(&walk->lock);
+				p->fts_pointer = NULL;
+			}
+			p->fts_info = FTS_DP;
+			return p;
+		}
+
+		err = walk_children(walk, p, &children, &count);
+		if (err != 0 || count == 0) {
+			if (children != NULL) {
+				pthread_mutex_lock(&walk->lock);
+				walk_ents_free(walk, children, count);
+				pthread_mutex_unlock(&walk->lock);
+			}
+			if (err != 0) {
+				p->fts_errno = err;
+				p->fts_info = FTS_DNR;
+			} else {
+				p->fts_info = FTS_DP;
+			}
+			return p;
+		}
+
+		if (walk->frame_cnt == walk->frame_max) {
+			struct walk_frame *tmp;
+			size_t max = walk->frame_max ? walk->frame_max * 2 : 16;
+
+			tmp = realloc(walk->frames, max * sizeof(struct walk_frame));
+			if (tmp == NULL) {
+				pthread_mutex_lock(&walk->lock);
+				walk_ents_free(walk, children, count);
+				pthread_mutex_unlock(&walk->lock);
+				p->fts_errno = ENOMEM;
+				p->fts_info = FTS_ERR;
+				return p;
+			}
+			walk->frames = tmp;
+			walk->frame_max = max;
+		}
+		walk->frames[walk->frame_cnt].dir = p;
+		walk->frames[walk->frame_cnt].children = children;
+		walk->frames[walk->frame_cnt].count = count;
+		walk->frames[walk->frame_cnt].idx = 0;
+		++walk->frame_cnt;
+
+		return (walk->cur = children[0]);
+	}
+
+	/* Move to the next sibling */
+	if (walk->frame_cnt == 0) {
+		/* the root was the last one */
+		walk->done = true;
+		return NULL;
+	}
+
+	struct walk_frame *frame = &walk->frames[walk->frame_cnt - 1];
+
+	if (++frame->idx < frame->count)
+		return (walk->cur = frame->children[frame->idx]);
+
+	/* All children were visited, directory in post-order */
+	p = frame->dir;
+	pthread_mutex_lock(&walk->lock);
+	walk_ents_free(walk, frame->children, frame->count);
+	pthread_mutex_unlock(&walk->lock);
+	--walk->frame_cnt;
+
+	p->fts_info = FTS_DP;
+	return (walk->cur = p);
+}
+
+int oval_fts_walk_set(OVAL_FTS_WALK *walk, FTSENT *ent, int instr)
+{
+	(void) walk;
+
+	if (instr != 0 && instr != FTS_AGAIN && instr != FTS_FOLLOW
+	    && instr != FTS_NOINSTR && instr != FTS_SKIP) {
+		errno = EINVAL;
+		return 1;
+	}
+	ent->fts_instr = instr;
+
+	return 0;
+}
+
+void oval_fts_walk_close(OVAL_FTS_WALK *walk)
+{
+	if (walk == NULL)
+		return;
+
+	pthread_mutex_lock(&walk->lock);
+	walk->stop = true;
+	pthread_cond_broadcast(&walk->work_cond);
+	pthread_mutex_unlock(&walk->lock);
+
+	for (unsigned int i = 0; i < walk->started; ++i)
+		pthread_join(walk->workers[i], NULL);
+
+	while (walk->frame_cnt > 0) {
+		--walk->frame_cnt;
+		walk_ents_free(walk, walk->frames[walk->frame_cnt].children,
+		               walk->frames[walk->frame_cnt].count);
+	}
+	if (walk->root->fts_pointer != NULL)
+		walk_dir_release(walk, walk->root->fts_pointer);
+
+	while (walk->stack != NULL) {
+		struct walk_dir *dir = walk->stack;
+
+		walk->stack = dir->next;
+		walk_dir_unref(dir);
+	}
+
+	pthread_cond_destroy(&walk->done_cond);
+	pthread_cond_destroy(&walk->work_cond);
+	pthread_mutex_destroy(&walk->lock);
+	free(walk->workers);
+	free(walk->frames);
+	free(walk->root);
+	free(walk->rootparent);
+	free(walk);
+}
+
+unsigned int oval_fts_walk_threads(void)
+{
+	unsigned int ncpus = oscap_parallel_ncpus();
+	unsigned int jobs;
+
+	jobs = oscap_parallel_jobs_from_env("OSCAP_PROBE_FTS_THREADS",
+		ncpus < OVAL_FTS_WALK_THREADS_MAX ? ncpus : OVAL_FTS_WALK_THREADS_MAX);
+
+	/* The thread walking the tree is one of them */
+	return jobs > 1 ? jobs - 1 : 0;
+}
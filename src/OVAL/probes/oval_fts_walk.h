@@ -0,0 +1,70 @@
+/**
+ * @file   oval_fts_walk.h
+ * @brief  Parallel directory tree walker with an fts(3) compatible interface
+ */
+/*
+ * Copyright 2026 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#pragma once
+#ifndef OVAL_FTS_WALK_H
+#define OVAL_FTS_WALK_H
+
+#include <stdbool.h>
+#include "oscap_platforms.h"
+#if defined(OS_SOLARIS) || defined(OS_AIX)
+#include "fts_sun.h"
+#else
+#include <fts.h>
+#endif
+
+/*
+ * The walker returns the same entries in the same order as fts_read() on
+ * a tree opened with FTS_PHYSICAL | FTS_COMFOLLOW | FTS_NOCHDIR, and
+ * understands FTS_XDEV and the FTS_AGAIN, FTS_FOLLOW and FTS_SKIP
+ * instructions. Entries are only valid until the walker leaves their
+ * directory, like with fts.
+ *
+ * Directories the caller is going to descend into are read ahead by
+ * a pool of threads, the children are stat'ed with fstatat() relative
+ * to the directory file descriptor. The prefetch callback decides which
+ * directories are worth reading ahead, it is called from the pool
+ * threads and must not modify anything.
+ */
+typedef struct oval_fts_walk OVAL_FTS_WALK;
+
+typedef bool (*oval_fts_walk_prefetch_func)(const FTSENT *dir, void *arg);
+
+/*
+ * Open a walk of the tree rooted at path with at most threads threads
+ * reading ahead. With threads == 0 every directory is read when the
+ * walk enters it.
+ */
+OVAL_FTS_WALK *oval_fts_walk_open(const char *path, int options, unsigned int threads,
+                                  oval_fts_walk_prefetch_func prefetch, void *arg);
+FTSENT *oval_fts_walk_read(OVAL_FTS_WALK *walk);
+int oval_fts_walk_set(OVAL_FTS_WALK *walk, FTSENT *ent, int instr);
+void oval_fts_walk_close(OVAL_FTS_WALK *walk);
+
+/*
+ * Number of read ahead threads for a walk, OSCAP_PROBE_FTS_THREADS
+ * overrides the default.
+ */
+unsigned int oval_fts_walk_threads(void);
+
+#endif /* OVAL_FTS_WALK_H */
@@ -257,13 +257,13 @@ static const probe_table_entry_t probe_table[] = {
 	{OVAL_INDEPENDENT_YAML_FILE_CONTENT, NULL, yamlfilecontent_probe_main, NULL, yamlfilecontent_probe_offline_mode_supported},
 #endif
 #ifdef OPENSCAP_PROBE_LINUX_DPKGINFO
-	{OVAL_LINUX_DPKG_INFO, NULL, dpkginfo_probe_main, NULL, dpkginfo_probe_offline_mode_supported},
+	{OVAL_LINUX_DPKG_INFO, dpkginfo_probe_init, dpkginfo_probe_main, dpkginfo_probe_fini, dpkginfo_probe_offline_mode_supported},
 #endif
 #ifdef OPENSCAP_PROBE_LINUX_IFLISTENERS
-	{OVAL_LINUX_IFLISTENERS, NULL, iflisteners_probe_main, NULL, NULL},
+	{OVAL_LINUX_IFLISTENERS, iflisteners_probe_init, iflisteners_probe_main, iflisteners_probe_fini, NULL},
 #endif
 #ifdef OPENSCAP_PROBE_LINUX_INETLISTENINGSERVERS
-	{OVAL_LINUX_INET_LISTENING_SERVERS, NULL, inetlisteningservers_probe_main, NULL, NULL},
+	{OVAL_LINUX_INET_LISTENING_SERVERS, inetlisteningservers_probe_init, inetlisteningservers_probe_main, inetlisteningservers_probe_fini, NULL},
 #endif
 #ifdef OPENSCAP_PROBE_LINUX_PARTITION
 	{OVAL_LINUX_PARTITION, NULL, partition_probe_main, NULL, patition_probe_offline_mode_supported},
@@ -317,10 +317,10 @@ static const probe_table_entry_t probe_table[] = {
 	{OVAL_UNIX_PASSWORD, NULL, password_probe_main, NULL, password_probe_offline_mode_supported},
 #endif
 #ifdef OPENSCAP_PROBE_UNIX_PROCESS
-	{OVAL_UNIX_PROCESS, NULL, process_probe_main, NULL, NULL},
+	{OVAL_UNIX_PROCESS, process_probe_init, process_probe_main, process_probe_fini, NULL},
 #endif
 #ifdef OPENSCAP_PROBE_UNIX_PROCESS58
-	{OVAL_UNIX_PROCESS58, NULL, process58_probe_main, NULL, process58_probe_offline_mode_supported},
+	{OVAL_UNIX_PROCESS58, process58_probe_init, process58_probe_main, process58_probe_fini, process58_probe_offline_mode_supported},
 #endif
 #ifdef OPENSCAP_PROBE_UNIX_ROUTINGTABLE
 	{OVAL_UNIX_ROUTINGTABLE, NULL, routingtable_probe_main, NULL, NULL},
@@ -35,7 +35,6 @@
 #include <pthread_np.h>
 #endif
 
-#include "../SEAP/generic/rbt/rbt.h"
 #include "probe-api.h"
 #include "common/debug_priv.h"
 #include "common/memusage.h"
@@ -51,7 +50,7 @@ static volatile uint32_t next_ID = 0;
 pthread_mutex_t next_ID_mutex = PTHREAD_MUTEX_INITIALIZER;
 #endif
 
-static void probe_icache_item_setID(SEXP_t *item, SEXP_ID_t item_ID)
+static void probe_icache_item_setID(SEXP_t *item)
 {
         SEXP_t  *name_ref, *prev_id;
         SEXP_t   uniq_id;
@@ -93,91 +92,132 @@ static void probe_icache_item_setID(SEXP_t *item, SEXP_ID_t item_ID)
         return;
 }
 
-static int icache_lookup(rbt_t *tree, int64_t item_id, probe_iqpair_t *pair) {
+static void probe_icache_grow(probe_icache_t *cache)
+{
+        probe_icache_entry_t *table;
+        size_t size = cache->size * 2;
 
-	probe_citem_t *cached = NULL;
+        table = calloc(size, sizeof(probe_icache_entry_t));
+        if (table == NULL) {
+                dE("Unable to re-allocate memory for cache");
+                return;
+        }
 
-	if (rbt_i64_get(tree, item_id, (void**)&cached) != 0) {
-		return -1;
-	}
+        for (size_t i = 0; i < cache->size; ++i) {
+                probe_icache_entry_t *entry = &cache->table[i];
+                size_t j;
 
-	/*
-	* Maybe a cache HIT
-	*/
-	dD("cache HIT #1");
-
-	register uint16_t i;
-	for (i = 0; i < cached->count; ++i) {
-		SEXP_t rest1;
-		SEXP_t* rest_r1 = SEXP_list_rest_r(&rest1, pair->p.item);
-
-		SEXP_t rest2;
-		SEXP_t* rest_r2 = SEXP_list_rest_r(&rest2, cached->item[i]);
-
-		if (SEXP_deepcmp(rest_r1, rest_r2)) {
-			SEXP_free_r(&rest1);
-			SEXP_free_r(&rest2);
-			break;
-		}
+                if (entry->item == NULL)
+                        continue;
 
-		SEXP_free_r(&rest1);
-		SEXP_free_r(&rest2);
-	}
+                for (j = entry->id.h[0] & (size - 1); table[j].item != NULL; j = (j + 1) & (size - 1))
+                        ;
+                table[j] = *entry;
+        }
 
-	if (i == cached->count) {
-		/*
-		* Cache MISS
-		*/
-		dD("cache MISS");
+        free(cache->table);
+        cache->table = table;
+        cache->size  = size;
+}
 
-		void *new_item = realloc(cached->item, sizeof(SEXP_t *) * (cached->count + 1));
-		if (new_item == NULL) {
-			dE("Unable to re-allocate memory for cache");
-			return -1;
-		}
-		cached->count++;
-		cached->item = new_item;
-		cached->item[cached->count - 1] = pair->p.item;
-
-		/* Assign an unique item ID */
-		probe_icache_item_setID(pair->p.item, item_id);
-	} else {
-		/*
-		* Cache HIT
-		*/
-		dD("cache HIT #2 -> real HIT");
-		SEXP_free(pair->p.item);
-		pair->p.item = cached->item[i];
-	}
-	return 0;
+/*
+ * Returns the cached item equal to the given one or stores the item in the
+ * cache and returns it, if there is no such item yet. Items are looked up
+ * by a 128-bit hash of their content, SEXP_deepcmp is called only to
+ * confirm a hash match.
+ */
+static SEXP_t *probe_icache_lookup(probe_icache_t *cache, SEXP_t *item)
+{
+        probe_icache_entry_t *entry;
+        SEXP_ID128_t id;
+        SEXP_t  rest, *rest_r;
+        size_t  i;
+
+        rest_r = SEXP_list_rest_r(&rest, item);
+        SEXP_ID128_v(rest_r, &id);
+
+        /* Keep the load factor under 1/2 */
+        if ((cache->count + 1) * 2 > cache->size)
+                probe_icache_grow(cache);
+
+        for (i = id.h[0] & (cache->size - 1); ; i = (i + 1) & (cache->size - 1)) {
+                entry = &cache->table[i];
+
+                if (entry->item == NULL)
+                        break;
+
+                if (entry->id.h[0] == id.h[0] && entry->id.h[1] == id.h[1]) {
+                        SEXP_t  rest2, *rest_r2;
+                        bool    equal;
+
+                        rest_r2 = SEXP_list_rest_r(&rest2, entry->item);
+                        equal   = SEXP_deepcmp(rest_r, rest_r2);
+                        SEXP_free_r(&rest2);
+
+                        if (equal) {
+                                dD("cache HIT");
+                                ++cache->hits;
+                                SEXP_free_r(&rest);
+                                return (entry->item);
+                        }
+
+                        dD("cache COLLISION");
+                        ++cache->collisions;
+                }
+        }
+
+        dD("cache MISS");
+        SEXP_free_r(&rest);
+        ++cache->misses;
+
+        /* Assign an unique item ID */
+        probe_icache_item_setID(item);
+
+        /*
+         * If the table couldn't grow, keep at least one slot empty
+         * so that the lookup loop above always terminates.
+         */
+        if (cache->count + 1 >= cache->size)
+                return (NULL);
+
+        ++cache->count;
+        entry->id   = id;
+        entry->item = item;
+
+        return (item);
 }
 
-static void icache_add_to_tree(rbt_t *tree, int64_t item_id, probe_iqpair_t *pair) {
+static void probe_icache_handle(probe_icache_t *cache, probe_iqpair_t *pair)
+{
+        SEXP_t *cached;
 
-	probe_citem_t *cached = malloc(sizeof(probe_citem_t));
-	cached->item = malloc(sizeof(SEXP_t *));
-	cached->item[0] = pair->p.item;
-	cached->count = 1;
+        if (pair->cobj == NULL) {
+                /*
+                 * Handle NOP case (synchronization)
+                 */
+                dD("Handling NOP");
+                probe_iqueue_nop_done(&cache->queue, pair->p.done);
+                return;
+        }
 
-	/* Assign an unique item ID */
-	probe_icache_item_setID(pair->p.item, item_id);
+        dD("Handling cache request");
 
-	if (rbt_i64_add(tree, (int64_t)item_id, (void **)cached, NULL) != 0) {
-		dE("Can't add item (k=%"PRIi64" to the cache (%p)", item_id, tree);
+        cached = probe_icache_lookup(cache, pair->p.item);
 
-		free(cached->item);
-		free(cached);
+        if (probe_cobj_add_item(pair->cobj, cached != NULL ? cached : pair->p.item) != 0) {
+                dW("An error ocured while adding the item to the collected object");
+        }
 
-		/* now what? */
-		abort();
-	}
+        /* The item is either owned by the cache now or it's not needed anymore */
+        if (cached != pair->p.item)
+                SEXP_free(pair->p.item);
 }
 
 static void *probe_icache_worker(void *arg)
 {
         probe_icache_t *cache = (probe_icache_t *)(arg);
-        probe_iqpair_t *pair, pair_mem;
-        SEXP_ID_t       item_ID;
+        probe_iqpair_t  batch[PROBE_IQUEUE_BATCH];
+        size_t          count;
 
 	if (cache == NULL) {
 		return NULL;
@@ -192,13 +232,6 @@ const char* thread_name = "icache_worker";
 # endif
 #endif
 
-        if (pthread_mutex_lock(&cache->queue_mutex) != 0) {
-                dE("An error ocured while locking the queue mutex: %u, %s",
-                   errno, strerror(errno));
-                return (NULL);
-        }
-
-	pair = &pair_mem;
         dD("icache worker ready");
 
         switch (errno = pthread_barrier_wait(cache->th_barrier))
@@ -209,101 +242,18 @@ const char* thread_name = "icache_worker";
         default:
 	        dE("pthread_barrier_wait: %d, %s.",
 	           errno, strerror(errno));
-	        pthread_mutex_unlock(&cache->queue_mutex);
 	        return (NULL);
         }
 
-        while(pthread_cond_wait(&cache->queue_notempty, &cache->queue_mutex) == 0) {
-			if (cache->queue_cnt <= 0) {
-				pthread_mutex_unlock(&cache->queue_mutex);
-				return NULL;
-			}
-        do {
-                dD("Extracting item from the cache queue: cnt=%"PRIu16", beg=%"PRIu16"", cache->queue_cnt, cache->queue_beg);
-                /*
-                 * Extract an item from the queue and update queue beg, end & cnt
-                 */
-                pair_mem = cache->queue[cache->queue_beg];
-#ifndef NDEBUG
-		memset(cache->queue + cache->queue_beg, 0, sizeof(probe_iqpair_t));
-#endif
-                --cache->queue_cnt;
-		++cache->queue_beg;
-
-		if (cache->queue_beg == cache->queue_max)
-			cache->queue_beg = 0;
+        /*
+         * Take the items out of the queue in batches, so that the
+         * producers are woken up at most once per batch.
+         */
+        while ((count = probe_iqueue_pop_batch(&cache->queue, batch, PROBE_IQUEUE_BATCH)) > 0) {
+                dD("Extracted %zu items from the cache queue", count);
 
-		if (cache->queue_cnt == 0 ?
-			cache->queue_end != cache->queue_beg :
-			cache->queue_end == cache->queue_beg) {
-			pthread_mutex_unlock(&cache->queue_mutex);
-			return NULL;
-		}
-
-
-                dD("Signaling `notfull'");
-
-                if (pthread_cond_signal(&cache->queue_notfull) != 0) {
-                        dE("An error ocured while signaling the `notfull' condition: %u, %s",
-                           errno, strerror(errno));
-                        abort();
-                }
-                /*
-                 * Release the mutex
-                 */
-                if (pthread_mutex_unlock(&cache->queue_mutex) != 0) {
-                        dE("An error ocured while unlocking the queue mutex: %u, %s",
-                           errno, strerror(errno));
-                        abort();
-                }
-
-                if (pair->cobj == NULL) {
-                        /*
-                         * Handle NOP case (synchronization)
-                         */
-					if (pair->p.cond == NULL) {
-						return NULL;
-					}
-
-                        dD("Handling NOP");
-
-                        if (pthread_cond_signal(pair->p.cond) != 0) {
-                                dE("An error ocured while signaling NOP condition: %u, %s",
-                                   errno, strerror(errno));
-                                abort();
-                        }
-                } else {
-
-                        dD("Handling cache request");
-
-                        /*
-                         * Compute item ID
-                         */
-			dD("pair address: %"PRIu64, (uint64_t) pair);
-			dD("item address: %"PRIu64, (uint64_t) pair->p.item);
-                        item_ID = SEXP_ID_v(pair->p.item);
-                        dD("item ID=%"PRIu64"", item_ID);
-
-                        if (icache_lookup(cache->tree, item_ID, pair) != 0) {
-                                /*
-                                 * Cache MISS
-                                 */
-                                dD("cache MISS");
-                                icache_add_to_tree(cache->tree, item_ID, pair);
-                        }
-
-                        if (probe_cobj_add_item(pair->cobj, pair->p.item) != 0) {
-                            dW("An error ocured while adding the item to the collected object");
-                        }
-                }
-
-                if (pthread_mutex_lock(&cache->queue_mutex) != 0) {
-                        dE("An error ocured while re-locking the queue mutex: %u, %s",
-                           errno, strerror(errno));
-                        abort();
-                }
-
-                } while (cache->queue_cnt > 0);
+                for (size_t i = 0; i < count; ++i)
+                        probe_icache_handle(cache, &batch[i]);
         }
 
         return (NULL);
@@ -312,29 +262,22 @@ const char* thread_name = "icache_worker";
 probe_icache_t *probe_icache_new(pthread_barrier_t *th_barrier)
 {
         probe_icache_t *cache = malloc(sizeof(probe_icache_t));
-        cache->tree = rbt_i64_new();
-
-        if (pthread_mutex_init(&cache->queue_mutex, NULL) != 0) {
-                dE("Can't initialize icache mutex: %u, %s", errno, strerror(errno));
-                goto fail;
-        }
-
-        cache->queue_beg = 0;
-        cache->queue_end = 0;
-        cache->queue_cnt = 0;
-        cache->queue_max = PROBE_IQUEUE_CAPACITY;
+        cache->size  = PROBE_ICACHE_INITIAL_SIZE;
+        cache->count = 0;
+        cache->hits  = 0;
+        cache->misses     = 0;
+        cache->collisions = 0;
+        cache->table = calloc(cache->size, sizeof(probe_icache_entry_t));
         cache->th_barrier = th_barrier;
 
-        if (pthread_cond_init(&cache->queue_notempty, NULL) != 0) {
-                dE("Can't initialize icache queue condition variable (notempty): %u, %s",
-                   errno, strerror(errno));
-                goto fail;
+        if (cache->table == NULL) {
+                dE("Can't allocate the icache table");
+                goto fail_queue;
         }
 
-        if (pthread_cond_init(&cache->queue_notfull, NULL) != 0) {
-                dE("Can't initialize icache queue condition variable (notfull): %u, %s",
-                   errno, strerror(errno));
-                goto fail;
+        if (probe_iqueue_init(&cache->queue, PROBE_IQUEUE_CAPACITY) != 0) {
+                dE("Can't initialize icache queue: %u, %s", errno, strerror(errno));
+                goto fail_queue;
         }
 
         if (pthread_create(&cache->thid, NULL,
@@ -346,151 +289,52 @@ probe_icache_t *probe_icache_new(pthread_barrier_t *th_barrier)
 
         return (cache);
 fail:
-        if (cache->tree != NULL)
-                rbt_i64_free(cache->tree);
+        probe_iqueue_destroy(&cache->queue);
+fail_queue:
+        free(cache->table);
 
-        pthread_mutex_destroy(&cache->queue_mutex);
-        pthread_cond_destroy(&cache->queue_notempty);
         free(cache);
 
         return (NULL);
 }
 
-static int __probe_icache_add_nolock(probe_icache_t *cache, SEXP_t *cobj, SEXP_t *item, pthread_cond_t *cond)
-{
-	if (!((cond == NULL) ^ (item == NULL))) {
-		return -1;
-	}
-retry:
-        if (cache->queue_cnt < cache->queue_max) {
-                cache->queue[cache->queue_end].cobj = cobj;
-
-                if (item != NULL) {
-					if (cobj == NULL) {
-						return -1;
-					}
-                        cache->queue[cache->queue_end].p.item = item;
-                } else {
-					if (item != NULL || cobj != NULL) {
-						return -1;
-					}
-                        cache->queue[cache->queue_end].p.cond = cond;
-		}
-
-                ++cache->queue_cnt;
-		++cache->queue_end;
-
-                if (cache->queue_end == cache->queue_max)
-                        cache->queue_end = 0;
-        } else {
-                /*
-                 * The queue is full, we have to wait
-                 */
-                if (pthread_cond_wait(&cache->queue_notfull, &cache->queue_mutex) == 0)
-                        goto retry;
-                else {
-                        dE("An error ocured while waiting for the `notfull' queue condition: %u, %s",
-                           errno, strerror(errno));
-                        return (-1);
-                }
-        }
-
-        return (0);
-}
-
 int probe_icache_add(probe_icache_t *cache, SEXP_t *cobj, SEXP_t *item)
 {
-        int ret;
+        probe_iqpair_t pair;
 
         if (cache == NULL || cobj == NULL || item == NULL)
                 return (-1); /* XXX: EFAULT */
 
-        if (pthread_mutex_lock(&cache->queue_mutex) != 0) {
-                dE("An error ocured while locking the queue mutex: %u, %s",
-                   errno, strerror(errno));
-                return (-1);
-        }
-
-        ret = __probe_icache_add_nolock(cache, cobj, item, NULL);
+        pair.cobj   = cobj;
+        pair.p.item = item;
 
-        if (pthread_cond_signal(&cache->queue_notempty) != 0) {
-                dE("An error ocured while signaling the `notempty' condition: %u, %s",
-                   errno, strerror(errno));
-                pthread_mutex_unlock(&cache->queue_mutex);
+        if (probe_iqueue_push(&cache->queue, &pair) != 0) {
+                dE("An error ocured while adding an item to the icache queue");
                 return (-1);
         }
 
-        if (pthread_mutex_unlock(&cache->queue_mutex) != 0) {
-                dE("An error ocured while unlocking the queue mutex: %u, %s",
-                   errno, strerror(errno));
-                abort();
-        }
-
-        if (ret != 0)
-                return (-1);
-
         return (0);
 }
 
 int probe_icache_nop(probe_icache_t *cache)
 {
-        pthread_cond_t cond;
+        volatile uint32_t done = 0;
+        probe_iqpair_t pair;
 
         dD("NOP");
 
-        if (pthread_mutex_lock(&cache->queue_mutex) != 0) {
-                dE("An error ocured while locking the queue mutex: %u, %s",
-                   errno, strerror(errno));
-                return (-1);
-        }
-
-        if (pthread_cond_init(&cond, NULL) != 0) {
-                dE("Can't initialize icache queue condition variable (NOP): %u, %s",
-                   errno, strerror(errno));
-                pthread_mutex_unlock(&cache->queue_mutex);
-                return (-1);
-        }
-
-        if (__probe_icache_add_nolock(cache, NULL, NULL, &cond) != 0) {
-                if (pthread_mutex_unlock(&cache->queue_mutex) != 0) {
-                        dE("An error ocured while unlocking the queue mutex: %u, %s",
-                           errno, strerror(errno));
-                        abort();
-                }
+        pair.cobj   = NULL;
+        pair.p.done = &done;
 
-                pthread_cond_destroy(&cond);
-                return (-1);
-        }
-
-        dD("Signaling `notempty'");
-
-        if (pthread_cond_signal(&cache->queue_notempty) != 0) {
-                dE("An error ocured while signaling the `notempty' condition: %u, %s",
-                   errno, strerror(errno));
-
-                pthread_cond_destroy(&cond);
-                pthread_mutex_unlock(&cache->queue_mutex);
+        if (probe_iqueue_push(&cache->queue, &pair) != 0) {
+                dE("An error ocured while adding a NOP to the icache queue");
                 return (-1);
         }
 
         dD("Waiting for icache worker to handle the NOP");
-
-        if (pthread_cond_wait(&cond, &cache->queue_mutex) != 0) {
-                dE("An error ocured while waiting for the `NOP' queue condition: %u, %s",
-                   errno, strerror(errno));
-                return (-1);
-        }
-
+        probe_iqueue_nop_wait(&cache->queue, &done);
         dD("Sync");
 
-        if (pthread_mutex_unlock(&cache->queue_mutex) != 0) {
-                dE("An error ocured while unlocking the queue mutex: %u, %s",
-                   errno, strerror(errno));
-                abort();
-        }
-
-        pthread_cond_destroy(&cond);
-
         return (0);
 }
 
@@ -616,30 +460,24 @@ int probe_item_collect(struct probe_ctx *ctx, SEXP_t *item)
         return (0);
 }
 
-static void probe_icache_free_node(struct rbt_i64_node *n)
-{
-        probe_citem_t *ci = (probe_citem_t *)n->data;
-
-	for ( ; ci->count > 0 ; --ci->count ) {
-		SEXP_free(ci->item[ci->count - 1]);
-	}
-
-        free(ci->item);
-        free(ci);
-        return;
-}
-
 void probe_icache_free(probe_icache_t *cache)
 {
         void *ret = NULL;
 
-        pthread_cancel(cache->thid);
+        /* The worker handles the queued items and exits */
+        probe_iqueue_shutdown(&cache->queue);
         pthread_join(cache->thid, &ret);
-        pthread_mutex_destroy(&cache->queue_mutex);
-        pthread_cond_destroy(&cache->queue_notempty);
-        pthread_cond_destroy(&cache->queue_notfull);
+        probe_iqueue_destroy(&cache->queue);
+
+        dI("icache: %zu items, %zu hits, %zu misses, %zu collisions",
+           cache->count, cache->hits, cache->misses, cache->collisions);
+
+        for (size_t i = 0; i < cache->size; ++i) {
+                if (cache->table[i].item != NULL)
+                        SEXP_free(cache->table[i].item);
+        }
 
-        rbt_i64_free_cb(cache->tree, &probe_icache_free_node);
+        free(cache->table);
         free(cache);
         return;
 }
@@ -24,42 +24,34 @@
 
 #include <stddef.h>
 #include <sexp.h>
-#include "../SEAP/generic/rbt/rbt.h"
+#include "_sexp-ID.h"
 #include "common/compat_pthread_barrier.h"
+#include "iqueue.h"
 
-#ifndef PROBE_IQUEUE_CAPACITY
-#define PROBE_IQUEUE_CAPACITY 1024
+#ifndef PROBE_ICACHE_INITIAL_SIZE
+#define PROBE_ICACHE_INITIAL_SIZE 1024 /* must be a power of two */
 #endif
 
 typedef struct {
-        SEXP_t *cobj;
-        union {
-                SEXP_t         *item;
-                pthread_cond_t *cond;
-        } p;
-} probe_iqpair_t;
+        SEXP_ID128_t id;
+        SEXP_t      *item; /* NULL if the slot is empty */
+} probe_icache_entry_t;
 
 typedef struct {
-        rbt_t    *tree; /* XXX: rewrite to extensible or linear hashing */
+        /* open addressing hash set of the items, used by the worker thread only */
+        probe_icache_entry_t *table;
+        size_t    size;
+        size_t    count;
+        size_t    hits;
+        size_t    misses;
+        size_t    collisions; /* hash matches of different items */
+
         pthread_t thid;
         pthread_barrier_t *th_barrier;
 
-        pthread_mutex_t queue_mutex;
-        pthread_cond_t  queue_notempty;
-        pthread_cond_t  queue_notfull;
-
-        probe_iqpair_t  queue[PROBE_IQUEUE_CAPACITY];
-        uint16_t        queue_beg;
-        uint16_t        queue_end;
-        uint16_t        queue_cnt;
-        uint16_t        queue_max;
+        probe_iqueue_t queue;
 } probe_icache_t;
 
-typedef struct {
-        SEXP_t  **item;
-        uint16_t  count;
-} probe_citem_t;
-
 probe_icache_t *probe_icache_new(pthread_barrier_t *th_barrier);
 int probe_icache_add(probe_icache_t *cache, SEXP_t *cobj, SEXP_t *item);
 int probe_icache_nop(probe_icache_t *cache);
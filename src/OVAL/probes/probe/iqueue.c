@@ -0,0 +1,270 @@
+/*
+ * Copyright 2026 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <errno.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <pthread.h>
+
+#if defined(OS_LINUX)
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#endif
+
+#include "../SEAP/_sexp-atomic.h"
+#include "iqueue.h"
+
+#if defined(HAVE_ATOMIC_BUILTINS)
+# define probe_iqueue_barrier() __sync_synchronize()
+#else
+static pthread_mutex_t probe_iqueue_barrier_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static void probe_iqueue_barrier(void)
+{
+        pthread_mutex_lock(&probe_iqueue_barrier_mutex);
+        pthread_mutex_unlock(&probe_iqueue_barrier_mutex);
+}
+#endif
+
+/*
+ * Event counter: a waiter reads the counter, re-checks its condition and
+ * sleeps only while the counter still has the value it has read. Every
+ * signal bumps the counter, so a wake-up can't get lost in between.
+ */
+static int probe_ievent_init(probe_ievent_t *ev)
+{
+        ev->seq = 0;
+#if !defined(OS_LINUX)
+        if (pthread_mutex_init(&ev->mutex, NULL) != 0)
+                return (-1);
+        if (pthread_cond_init(&ev->cond, NULL) != 0) {
+                pthread_mutex_destroy(&ev->mutex);
+                return (-1);
+        }
+#endif
+        return (0);
+}
+
+static void probe_ievent_destroy(probe_ievent_t *ev)
+{
+#if !defined(OS_LINUX)
+        pthread_mutex_destroy(&ev->mutex);
+        pthread_cond_destroy(&ev->cond);
+#else
+        (void)ev;
+#endif
+}
+
+static void probe_ievent_wait(probe_ievent_t *ev, uint32_t key)
+{
+#if defined(OS_LINUX)
+        while (ev->seq == key)
+                syscall(SYS_futex, &ev->seq, FUTEX_WAIT_PRIVATE, key, NULL, NULL, 0);
+#else
+        pthread_mutex_lock(&ev->mutex);
+        while (ev->seq == key)
+                pthread_cond_wait(&ev->cond, &ev->mutex);
+        pthread_mutex_unlock(&ev->mutex);
+#endif
+}
+
+static void probe_ievent_signal(probe_ievent_t *ev)
+{
+#if defined(OS_LINUX)
+        SEXP_atomic_inc_u32(&ev->seq);
+        syscall(SYS_futex, &ev->seq, FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0);
+#else
+        pthread_mutex_lock(&ev->mutex);
+        SEXP_atomic_inc_u32(&ev->seq);
+        pthread_cond_broadcast(&ev->cond);
+        pthread_mutex_unlock(&ev->mutex);
+#endif
+}
+
+int probe_iqueue_init(probe_iqueue_t *queue, uint32_t capacity)
+{
+        if (capacity < 2 || (capacity & (capacity - 1)) != 0) {
+                errno = EINVAL;
+                return (-1);
+        }
+
+        queue->slot = malloc(sizeof(probe_iqslot_t) * capacity);
+        if (queue->slot == NULL)
+                return (-1);
+
+        for (uint32_t i = 0; i < capacity; ++i)
+                queue->slot[i].seq = i;
+
+        queue->mask = capacity - 1;
+        queue->tail = 0;
+        queue->head = 0;
+        queue->consumer_waiting  = 0;
+        queue->producers_waiting = 0;
+        queue->shutdown = 0;
+
+        if (probe_ievent_init(&queue->notempty) != 0)
+                goto fail_notempty;
+        if (probe_ievent_init(&queue->notfull) != 0)
+                goto fail_notfull;
+        if (probe_ievent_init(&queue->nop) != 0)
+                goto fail_nop;
+
+        return (0);
+fail_nop:
+        probe_ievent_destroy(&queue->notfull);
+fail_notfull:
+        probe_ievent_destroy(&queue->notempty);
+fail_notempty:
+        free(queue->slot);
+        return (-1);
+}
+
+void probe_iqueue_destroy(probe_iqueue_t *queue)
+{
+        probe_ievent_destroy(&queue->notempty);
+        probe_ievent_destroy(&queue->notfull);
+        probe_ievent_destroy(&queue->nop);
+        free(queue->slot);
+}
+
+int probe_iqueue_push(probe_iqueue_t *queue, const probe_iqpair_t *pair)
+{
+        probe_iqslot_t *slot;
+        uint32_t pos = queue->tail;
+
+        for (;;) {
+                int32_t dif;
+
+                slot = &queue->slot[pos & queue->mask];
+                dif  = (int32_t)(slot->seq - pos);
+
+                if (dif == 0) {
+                        /* The slot is free, try to claim it */
+                        if (SEXP_atomic_cas_u32(&queue->tail, pos, pos + 1))
+                                break;
+                } else if (dif < 0) {
+                        /* The queue is full, wait until the consumer frees some slots */
+                        uint32_t key = queue->notfull.seq;
+
+                        SEXP_atomic_inc_u32(&queue->producers_waiting);
+                        probe_iqueue_barrier();
+
+                        if ((int32_t)(slot->seq - pos) < 0)
+                                probe_ievent_wait(&queue->notfull, key);
+
+                        SEXP_atomic_dec_u32(&queue->producers_waiting);
+                }
+
+                pos = queue->tail;
+        }
+
+        slot->pair = *pair;
+        probe_iqueue_barrier();
+        slot->seq = pos + 1;
+        probe_iqueue_barrier();
+
+        if (queue->consumer_waiting)
+                probe_ievent_signal(&queue->notempty);
+
+        return (0);
+}
+
+size_t probe_iqueue_pop_batch(probe_iqueue_t *queue, probe_iqpair_t *pairs, size_t max)
+{
+        for (;;) {
+                probe_iqslot_t *slot;
+                uint32_t key;
+                size_t n = 0;
+
+                while (n < max) {
+                        slot = &queue->slot[queue->head & queue->mask];
+
+                        if (slot->seq != queue->head + 1)
+                                break;
+
+                        probe_iqueue_barrier();
+                        pairs[n++] = slot->pair;
+                        probe_iqueue_barrier();
+
+                        slot->seq = queue->head + queue->mask + 1;
+                        ++queue->head;
+                }
+
+                if (n > 0) {
+                        probe_iqueue_barrier();
+
+                        if (queue->producers_waiting)
+                                probe_ievent_signal(&queue->notfull);
+
+                        return (n);
+                }
+
+                /* The queue is empty, wait for a producer */
+                key = queue->notempty.seq;
+                queue->consumer_waiting = 1;
+                probe_iqueue_barrier();
+
+                slot = &queue->slot[queue->head & queue->mask];
+
+                if (slot->seq == queue->head + 1) {
+                        queue->consumer_waiting = 0;
+                        continue;
+                }
+
+                if (queue->shutdown) {
+                        queue->consumer_waiting = 0;
+                        return (0);
+                }
+
+                probe_ievent_wait(&queue->notempty, key);
+                queue->consumer_waiting = 0;
+        }
+}
+
+void probe_iqueue_shutdown(probe_iqueue_t *queue)
+{
+        queue->shutdown = 1;
+        probe_iqueue_barrier();
+        probe_ievent_signal(&queue->notempty);
+}
+
+void probe_iqueue_nop_done(probe_iqueue_t *queue, volatile uint32_t *done)
+{
+        *done = 1;
+        probe_iqueue_barrier();
+        probe_ievent_signal(&queue->nop);
+}
+
+void probe_iqueue_nop_wait(probe_iqueue_t *queue, volatile uint32_t *done)
+{
+        for (;;) {
+                uint32_t key = queue->nop.seq;
+
+                probe_iqueue_barrier();
+
+                if (*done)
+                        break;
+
+                probe_ievent_wait(&queue->nop, key);
+        }
+}
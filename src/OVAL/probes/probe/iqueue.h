@@ -0,0 +1,113 @@
+/*
+ * Copyright 2026 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+#ifndef IQUEUE_H
+#define IQUEUE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <sexp.h>
+#include "oscap_platforms.h"
+
+/*
+ * Bounded multi-producer/single-consumer queue used to hand collected
+ * items from the probe worker threads over to the icache thread.
+ *
+ * Producers claim a slot by advancing the tail with a CAS and publish it
+ * by bumping the per-slot sequence number, so they never block each other
+ * on a lock. The consumer takes items out in batches. Both sides sleep on
+ * an event counter (a futex on Linux) only when the queue is empty or full
+ * and are woken only if somebody is actually sleeping.
+ */
+
+#ifndef PROBE_IQUEUE_CAPACITY
+#define PROBE_IQUEUE_CAPACITY 1024 /* must be a power of two */
+#endif
+
+#ifndef PROBE_IQUEUE_BATCH
+#define PROBE_IQUEUE_BATCH 64
+#endif
+
+typedef struct {
+        SEXP_t *cobj;
+        union {
+                SEXP_t            *item;
+                volatile uint32_t *done; /* NOP: set to 1 once handled */
+        } p;
+} probe_iqpair_t;
+
+typedef struct {
+        volatile uint32_t seq;
+#if !defined(OS_LINUX)
+        pthread_mutex_t   mutex;
+        pthread_cond_t    cond;
+#endif
+} probe_ievent_t;
+
+typedef struct {
+        volatile uint32_t seq;
+        probe_iqpair_t    pair;
+} probe_iqslot_t;
+
+typedef struct {
+        probe_iqslot_t   *slot;
+        uint32_t          mask;
+
+        volatile uint32_t tail;      /* next slot to be claimed by a producer */
+        uint32_t          head;      /* next slot to be read by the consumer */
+
+        volatile uint32_t consumer_waiting;
+        volatile uint32_t producers_waiting;
+        volatile uint32_t shutdown;
+
+        probe_ievent_t    notempty;
+        probe_ievent_t    notfull;
+        probe_ievent_t    nop;
+} probe_iqueue_t;
+
+int probe_iqueue_init(probe_iqueue_t *queue, uint32_t capacity);
+void probe_iqueue_destroy(probe_iqueue_t *queue);
+
+/*
+ * Add a pair to the queue, waiting while the queue is full.
+ * Safe to be called from any number of threads.
+ */
+int probe_iqueue_push(probe_iqueue_t *queue, const probe_iqpair_t *pair);
+
+/*
+ * Move up to max pairs from the queue to pairs, waiting while the queue
+ * is empty. Returns the number of pairs taken out, 0 once the queue was
+ * shut down and fully drained. Must be called from one thread only.
+ */
+size_t probe_iqueue_pop_batch(probe_iqueue_t *queue, probe_iqpair_t *pairs, size_t max);
+
+/*
+ * Make probe_iqueue_pop_batch return 0 after the remaining pairs are consumed.
+ */
+void probe_iqueue_shutdown(probe_iqueue_t *queue);
+
+/*
+ * Mark the NOP pair as handled (consumer side) and wait for that
+ * to happen (producer side).
+ */
+void probe_iqueue_nop_done(probe_iqueue_t *queue, volatile uint32_t *done);
+void probe_iqueue_nop_wait(probe_iqueue_t *queue, volatile uint32_t *done);
+
+#endif /* IQUEUE_H */
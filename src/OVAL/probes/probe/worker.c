@@ -132,7 +132,11 @@ void *probe_worker_runfn(void *arg)
                         SEXP_free(items);
                 }
 
-		if (probe_rcache_sexp_add(pair->probe->rcache, oid, probe_res) != 0) {
+		/*
+		 * Don't cache failed evaluations, a repeated query of the
+		 * object has to report the same error.
+		 */
+		if (probe_ret == 0 && probe_rcache_sexp_add(pair->probe->rcache, oid, probe_res) != 0) {
 			/* TODO */
 			abort();
 		}
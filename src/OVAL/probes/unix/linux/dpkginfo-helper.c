@@ -7,22 +7,41 @@
 #include <string.h>
 #include <ctype.h>
 #include <limits.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 #include "debug_priv.h"
+#include "list.h"
 #include "dpkginfo-helper.h"
 
-#define DPKG_STATUS_BUFFER_SIZE 4096
+/*
+ * The installed packages of one version of the status file. Lookups hold
+ * a reference, so the database can be reloaded while a probe thread still
+ * iterates over the previous snapshot.
+ */
+struct dpkginfo_snapshot {
+	int refs;
+	dev_t dev;
+	ino_t ino;
+	struct timespec mtime;
+	off_t size;
+	/* in the order of the status file */
+	struct dpkginfo_reply_t *pkgs;
+	size_t count;
+	/* name -> the first installed package of that name */
+	struct oscap_htable *index;
+};
 
-static char* trimleft(char *str)
-{
-	while (isspace((unsigned char)*str))
-		str++;
-
-	if (*str == 0)
-		return str;
-
-	return str;
-}
+struct dpkginfo_db {
+	char path[PATH_MAX];
+	pthread_mutex_t mutex;
+	struct dpkginfo_snapshot *snap;
+};
 
 static int version(struct dpkginfo_reply_t *reply)
 {
@@ -65,115 +84,325 @@ err:
 	return -1;
 }
 
-struct dpkginfo_reply_t* dpkginfo_get_by_name(const char *name, int *err)
+static void dpkginfo_reply_clear(struct dpkginfo_reply_t *reply)
+{
+	free(reply->name);
+	free(reply->arch);
+	free(reply->epoch);
+	free(reply->release);
+	free(reply->version);
+	free(reply->evr);
+}
+
+static void dpkginfo_snapshot_unref(struct dpkginfo_snapshot *snap)
+{
+	if (snap == NULL || --snap->refs > 0)
+		return;
+
+	for (size_t i = 0; i < snap->count; ++i)
+		dpkginfo_reply_clear(&snap->pkgs[i]);
+	free(snap->pkgs);
+	oscap_htable_free0(snap->index);
+	free(snap);
+}
+
+/* Add the package described by the fields of one paragraph if it is installed */
+static int dpkginfo_snapshot_add(struct dpkginfo_snapshot *snap, size_t *max,
+                                 const char *name, size_t name_len, const char *arch, size_t arch_len,
+                                 const char *evr, size_t evr_len)
 {
-	FILE *f;
-	char buf[DPKG_STATUS_BUFFER_SIZE], path[PATH_MAX], *root, *key, *value;
 	struct dpkginfo_reply_t *reply;
 
-	*err = 0;
-	reply = NULL;
+	if (snap->count == *max) {
+		size_t new_max = *max ? *max * 2 : 1024;
+		struct dpkginfo_reply_t *tmp = realloc(snap->pkgs, new_max * sizeof(*tmp));
 
-	root = getenv("OSCAP_PROBE_ROOT");
-	if (root != NULL)
-		snprintf(path, PATH_MAX, "%s/var/lib/dpkg/status", root);
-	else
-		snprintf(path, PATH_MAX, "/var/lib/dpkg/status");
+		if (tmp == NULL)
+			return -1;
+		snap->pkgs = tmp;
+		*max = new_max;
+	}
 
-	f = fopen(path, "r");
-	if (f == NULL) {
-		dW("%s not found.", path);
-		*err = -1;
-		return NULL;
+	reply = &snap->pkgs[snap->count];
+	memset(reply, 0, sizeof(*reply));
+	reply->name = strndup(name, name_len);
+	if (reply->name == NULL)
+		return -1;
+	if (arch != NULL) {
+		reply->arch = strndup(arch, arch_len);
+		if (reply->arch == NULL)
+			goto err;
+	}
+	if (evr != NULL) {
+		reply->evr = strndup(evr, evr_len);
+		if (reply->evr == NULL || version(reply) < 0)
+			goto err;
 	}
+	++snap->count;
 
-	dD("Searching package \"%s\".", name);
+	return 0;
+err:
+	dpkginfo_reply_clear(reply);
+	return -1;
+}
 
-	while (fgets(buf, DPKG_STATUS_BUFFER_SIZE, f)) {
-		if (buf[0] == '\n') {
-			// New package entry.
-			if (reply != NULL) {
-				// Package found.
-				goto out;
-			}
+/*
+ * Parse the status file. A paragraph describes an installed package unless
+ * its Status field says otherwise; lines starting with a space continue the
+ * previous field and are ignored, like other fields.
+ */
+static int dpkginfo_snapshot_parse(struct dpkginfo_snapshot *snap, const char *data, size_t size)
+{
+	const char *p = data, *end = data + size;
+	const char *name = NULL, *arch = NULL, *evr = NULL;
+	size_t name_len = 0, arch_len = 0, evr_len = 0, max = 0;
+	bool installed = true;
+
+	while (p < end) {
+		const char *eol = memchr(p, '\n', end - p);
+		const char *line_end = eol != NULL ? eol : end;
+		const char *value;
+		size_t key_len, value_len;
+
+		if (p == line_end) {
+			/* End of the paragraph */
+			if (name != NULL && installed
+			    && dpkginfo_snapshot_add(snap, &max, name, name_len, arch, arch_len, evr, evr_len) != 0)
+				return -1;
+			name = arch = evr = NULL;
+			installed = true;
+			p = line_end + 1;
 			continue;
 		}
-		if (isspace(buf[0])) {
-			// Ignore line beginning by a space.
-			continue;
+
+		value = isspace((unsigned char)*p) ? NULL : memchr(p, ':', line_end - p);
+		if (value != NULL) {
+			key_len = value - p;
+			for (++value; value < line_end && isspace((unsigned char)*value); ++value)
+				;
+			value_len = line_end - value;
+
+			if (key_len == 7 && memcmp(p, "Package", 7) == 0) {
+				name = value;
+				name_len = value_len;
+			} else if (key_len == 6 && memcmp(p, "Status", 6) == 0) {
+				if (value_len < 7 || memcmp(value, "install", 7) != 0)
+					installed = false;
+			} else if (key_len == 12 && memcmp(p, "Architecture", 12) == 0) {
+				arch = value;
+				arch_len = value_len;
+			} else if (key_len == 7 && memcmp(p, "Version", 7) == 0) {
+				evr = value;
+				evr_len = value_len;
+			}
 		}
-		buf[strcspn(buf, "\n")] = 0;
-		key = buf;
-		value = strchr(buf, ':');
-		if (value == NULL) {
-			// Ignore truncated line.
-			continue;
+
+		p = line_end + 1;
+	}
+
+	/* The last paragraph doesn't need to be terminated by an empty line */
+	if (name != NULL && installed
+	    && dpkginfo_snapshot_add(snap, &max, name, name_len, arch, arch_len, evr, evr_len) != 0)
+		return -1;
+
+	return 0;
+}
+
+static struct dpkginfo_snapshot *dpkginfo_snapshot_load(const char *path, int fd, const struct stat *st)
+{
+	struct dpkginfo_snapshot *snap;
+	void *data = NULL;
+
+	snap = calloc(1, sizeof(*snap));
+	if (snap == NULL)
+		return NULL;
+	snap->refs = 1;
+	snap->dev = st->st_dev;
+	snap->ino = st->st_ino;
+	snap->mtime = st->st_mtim;
+	snap->size = st->st_size;
+
+	if (st->st_size > 0) {
+		data = mmap(NULL, st->st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (data == MAP_FAILED) {
+			dW("Unable to map %s: %s.", path, strerror(errno));
+			goto err;
 		}
-		*value++ = '\0';
-		value = trimleft(value);
-		// Package should be the first line.
-		if (strcmp(key, "Package") == 0) {
-			if (strcmp(value, name) == 0) {
-				if (reply != NULL)
-					continue;
-				reply = calloc(1, sizeof(*reply));
-				if (reply == NULL)
-					goto err;
-				reply->name = strdup(value);
-				if (reply->name == NULL)
-					goto err;
-			}
-		} else if (reply != NULL) {
-			if (strcmp(key, "Status") == 0) {
-				if (strncmp(value, "install", 7) != 0) {
-					// Package deinstalled.
-					dD("Package \"%s\" has been deinstalled.", name);
-					dpkginfo_free_reply(reply);
-					reply = NULL;
-					continue;
-				}
-			} else if (strcmp(key, "Architecture") == 0) {
-				reply->arch = strdup(value);
-				if (reply->arch == NULL)
-					goto err;
-			} else if (strcmp(key, "Version") == 0) {
-				reply->evr = strdup(value);
-				if (reply->evr == NULL)
-					goto err;
-				if (version(reply) < 0)
-					goto err;
-			}
+		if (dpkginfo_snapshot_parse(snap, data, st->st_size) != 0) {
+			dW("Insufficient memory available to allocate duplicate string.");
+			munmap(data, st->st_size);
+			goto err;
 		}
+		munmap(data, st->st_size);
 	}
 
-	// Reached end of file.
+	snap->index = oscap_htable_new1(strcmp, snap->count + 1);
+	if (snap->index == NULL)
+		goto err;
+	/* The first installed package of a name wins, oscap_htable_add() keeps it */
+	for (size_t i = 0; i < snap->count; ++i)
+		oscap_htable_add(snap->index, snap->pkgs[i].name, &snap->pkgs[i]);
 
-out:
-	if (reply != NULL) {
-		// Package found.
-		dD("Package \"%s\" found (arch=%s evr=%s epoch=%s version=%s release=%s).",
-			name, reply->arch, reply->evr, reply->epoch, reply->version, reply->release);
-		*err = 1;
+	dD("Loaded %zu installed packages from %s.", snap->count, path);
+	return snap;
+err:
+	dpkginfo_snapshot_unref(snap);
+	return NULL;
+}
+
+/* Get the snapshot of the current status file, reloading it if it has changed */
+static struct dpkginfo_snapshot *dpkginfo_db_get(struct dpkginfo_db *db)
+{
+	struct dpkginfo_snapshot *snap = NULL;
+	struct stat st;
+	int fd;
+
+	pthread_mutex_lock(&db->mutex);
+
+	fd = open(db->path, O_RDONLY | O_CLOEXEC);
+	if (fd < 0 || fstat(fd, &st) != 0) {
+		dW("%s not found.", db->path);
+		goto out;
 	}
-	fclose(f);
+
+	if (db->snap != NULL
+	    && (db->snap->dev != st.st_dev || db->snap->ino != st.st_ino
+	        || db->snap->size != st.st_size
+	        || db->snap->mtime.tv_sec != st.st_mtim.tv_sec
+	        || db->snap->mtime.tv_nsec != st.st_mtim.tv_nsec)) {
+		dD("%s has changed, reloading.", db->path);
+		dpkginfo_snapshot_unref(db->snap);
+		db->snap = NULL;
+	}
+	if (db->snap == NULL)
+		db->snap = dpkginfo_snapshot_load(db->path, fd, &st);
+
+	snap = db->snap;
+	if (snap != NULL)
+		++snap->refs;
+out:
+	if (fd >= 0)
+		close(fd);
+	pthread_mutex_unlock(&db->mutex);
+
+	return snap;
+}
+
+static void dpkginfo_db_put(struct dpkginfo_db *db, struct dpkginfo_snapshot *snap)
+{
+	pthread_mutex_lock(&db->mutex);
+	dpkginfo_snapshot_unref(snap);
+	pthread_mutex_unlock(&db->mutex);
+}
+
+struct dpkginfo_db *dpkginfo_db_new(void)
+{
+	struct dpkginfo_db *db;
+	char *root;
+
+	db = calloc(1, sizeof(*db));
+	if (db == NULL)
+		return NULL;
+
+	root = getenv("OSCAP_PROBE_ROOT");
+	if (root != NULL)
+		snprintf(db->path, PATH_MAX, "%s/var/lib/dpkg/status", root);
+	else
+		snprintf(db->path, PATH_MAX, "/var/lib/dpkg/status");
+	pthread_mutex_init(&db->mutex, NULL);
+
+	return db;
+}
+
+void dpkginfo_db_free(struct dpkginfo_db *db)
+{
+	if (db == NULL)
+		return;
+
+	dpkginfo_snapshot_unref(db->snap);
+	pthread_mutex_destroy(&db->mutex);
+	free(db);
+}
+
+static struct dpkginfo_reply_t *dpkginfo_reply_dup(const struct dpkginfo_reply_t *pkg)
+{
+	struct dpkginfo_reply_t *reply = calloc(1, sizeof(*reply));
+
+	if (reply == NULL)
+		return NULL;
+
+#define DPKGINFO_DUP(field) \
+	if (pkg->field != NULL && (reply->field = strdup(pkg->field)) == NULL) \
+		goto err
+	DPKGINFO_DUP(name);
+	DPKGINFO_DUP(arch);
+	DPKGINFO_DUP(epoch);
+	DPKGINFO_DUP(release);
+	DPKGINFO_DUP(version);
+	DPKGINFO_DUP(evr);
+#undef DPKGINFO_DUP
+
 	return reply;
 err:
-	dW("Insufficient memory available to allocate duplicate string.");
-	fclose(f);
 	dpkginfo_free_reply(reply);
-	*err = -1;
 	return NULL;
 }
 
+struct dpkginfo_reply_t* dpkginfo_get_by_name(struct dpkginfo_db *db, const char *name, int *err)
+{
+	struct dpkginfo_snapshot *snap;
+	struct dpkginfo_reply_t *pkg, *reply = NULL;
+
+	*err = 0;
+
+	snap = dpkginfo_db_get(db);
+	if (snap == NULL) {
+		*err = -1;
+		return NULL;
+	}
+
+	dD("Searching package \"%s\".", name);
+
+	pkg = oscap_htable_get(snap->index, name);
+	if (pkg != NULL) {
+		reply = dpkginfo_reply_dup(pkg);
+		if (reply == NULL) {
+			dW("Insufficient memory available to allocate duplicate string.");
+			*err = -1;
+		} else {
+			dD("Package \"%s\" found (arch=%s evr=%s epoch=%s version=%s release=%s).",
+				name, reply->arch, reply->evr, reply->epoch, reply->version, reply->release);
+			*err = 1;
+		}
+	}
+
+	dpkginfo_db_put(db, snap);
+	return reply;
+}
+
+int dpkginfo_foreach(struct dpkginfo_db *db, dpkginfo_foreach_func func, void *arg)
+{
+	struct dpkginfo_snapshot *snap;
+	int ret = 0;
+
+	snap = dpkginfo_db_get(db);
+	if (snap == NULL)
+		return -1;
+
+	for (size_t i = 0; i < snap->count && ret == 0; ++i) {
+		/* Only the first installed package of a name, like dpkginfo_get_by_name() */
+		if (oscap_htable_get(snap->index, snap->pkgs[i].name) == &snap->pkgs[i])
+			ret = func(&snap->pkgs[i], arg);
+	}
+
+	dpkginfo_db_put(db, snap);
+	return ret;
+}
+
 void dpkginfo_free_reply(struct dpkginfo_reply_t *reply)
 {
 	if (reply) {
-		free(reply->name);
-		free(reply->arch);
-		free(reply->epoch);
-		free(reply->release);
-		free(reply->version);
-		free(reply->evr);
+		dpkginfo_reply_clear(reply);
 		free(reply);
 	}
 }
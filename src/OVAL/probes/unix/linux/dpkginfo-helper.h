@@ -31,7 +31,23 @@ struct dpkginfo_reply_t {
         char *evr;
 };
 
-struct dpkginfo_reply_t * dpkginfo_get_by_name(const char *name, int *err);
+/* Installed packages from the dpkg status file, parsed once and reloaded when it changes */
+struct dpkginfo_db;
+
+struct dpkginfo_db *dpkginfo_db_new(void);
+
+void dpkginfo_db_free(struct dpkginfo_db *db);
+
+struct dpkginfo_reply_t * dpkginfo_get_by_name(struct dpkginfo_db *db, const char *name, int *err);
+
+typedef int (*dpkginfo_foreach_func)(const struct dpkginfo_reply_t *reply, void *arg);
+
+/*
+ * Call func for every installed package in one pass over the database,
+ * until it returns non-zero. Returns -1 if the status file can't be read,
+ * the last value returned by func otherwise.
+ */
+int dpkginfo_foreach(struct dpkginfo_db *db, dpkginfo_foreach_func func, void *arg);
 
 void dpkginfo_free_reply(struct dpkginfo_reply_t *reply);
 
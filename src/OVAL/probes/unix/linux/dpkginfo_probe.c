@@ -55,9 +55,11 @@
 #include <probe-api.h>
 
 #include "common/debug_priv.h"
+#include "common/list.h"
 #include "public/oval_schema_version.h"
 
 #include <probe/probe.h>
+#include "probe/entcmp.h"
 
 #include "dpkginfo-helper.h"
 
@@ -67,100 +69,180 @@ int dpkginfo_probe_offline_mode_supported(void) {
         return PROBE_OFFLINE_OWN;
 }
 
-int dpkginfo_probe_main (probe_ctx *ctx, void *arg)
+void *dpkginfo_probe_init(void)
 {
-	SEXP_t *val, *item, *ent, *obj;
-        char *request_st = NULL;
-        struct dpkginfo_reply_t *dpkginfo_reply = NULL;
-        int errflag;
+	return dpkginfo_db_new();
+}
 
-	obj = probe_ctx_getobject(ctx);
-	ent = probe_obj_getent(obj, "name", 1);
-
-        if (ent == NULL) {
-                return (PROBE_ENOENT);
-        }
-
-        val = probe_ent_getval (ent);
-
-        if (val == NULL) {
-                dD("%s: no value", "name");
-                SEXP_free (ent);
-                return (PROBE_ENOVAL);
-        }
-
-        request_st = SEXP_string_cstr (val);
-        SEXP_free (val);
-
-        if (request_st == NULL) {
-                switch (errno) {
-                case EINVAL:
-                        dD("%s: invalid value type", "name");
-			SEXP_free (ent);
-			return PROBE_EINVAL;
-                        break;
-                case EFAULT:
-                        dD("%s: element not found", "name");
-			SEXP_free (ent);
-			return PROBE_ENOELM;
-                        break;
-		default:
-			SEXP_free (ent);
-			return PROBE_EUNKNOWN;
-                }
-        }
-
-        /* get info from debian apt cache */
-        dpkginfo_reply = dpkginfo_get_by_name(request_st, &errflag);
-
-        if (dpkginfo_reply == NULL) {
-                switch (errflag) {
-		case 0: /* Not found */
-		{
-			dD("Package \"%s\" not found.", request_st);
+void dpkginfo_probe_fini(void *arg)
+{
+	dpkginfo_db_free(arg);
+}
+
+struct dpkginfo_collect {
+	probe_ctx *ctx;
+	SEXP_t *ent;
+	oval_datatype_t evr_string_type;
+};
+
+static int dpkginfo_collect_item(const struct dpkginfo_reply_t *reply, struct dpkginfo_collect *c)
+{
+	SEXP_t *item;
+
+	dD("%s: element found version %s", reply->name, reply->evr);
+	item = probe_item_create(OVAL_LINUX_DPKG_INFO, NULL,
+			"name", OVAL_DATATYPE_STRING, reply->name,
+			"arch", OVAL_DATATYPE_STRING, reply->arch,
+			"epoch", OVAL_DATATYPE_STRING, reply->epoch,
+			"release", OVAL_DATATYPE_STRING, reply->release,
+			"version", OVAL_DATATYPE_STRING, reply->version,
+			"evr", c->evr_string_type, reply->evr,
+			NULL);
+
+	return probe_item_collect(c->ctx, item) == 2 ? 1 : 0;
+}
+
+/* Compare a package against the object entity, used for other operations than equals */
+static int dpkginfo_collect_cmp(const struct dpkginfo_reply_t *reply, void *arg)
+{
+	struct dpkginfo_collect *c = arg;
+	SEXP_t *name;
+	oval_result_t res;
+
+	name = SEXP_string_newf("%s", reply->name);
+	res = probe_entobj_cmp(c->ent, name);
+	SEXP_free(name);
+
+	if (res != OVAL_RESULT_TRUE)
+		return 0;
+
+	return dpkginfo_collect_item(reply, c);
+}
+
+/* Look up every value of the name entity in the index */
+static int dpkginfo_collect_equals(struct dpkginfo_db *db, struct dpkginfo_collect *c)
+{
+	SEXP_t *vals, *val;
+	struct oscap_htable *seen;
+	int ret = 0;
+
+	if (probe_ent_getvals(c->ent, &vals) == 0) {
+		dD("%s: no value", "name");
+		SEXP_free(vals);
+		return PROBE_ENOVAL;
+	}
+
+	seen = oscap_htable_new();
+	if (seen == NULL) {
+		SEXP_free(vals);
+		return PROBE_ENOMEM;
+	}
+
+	SEXP_list_foreach(val, vals) {
+		struct dpkginfo_reply_t *reply;
+		bool stop = false;
+		char *request_st;
+		int errflag;
+
+		request_st = SEXP_string_cstr(val);
+		if (request_st == NULL) {
+			switch (errno) {
+			case EINVAL:
+				dD("%s: invalid value type", "name");
+				ret = PROBE_EINVAL;
+				break;
+			case EFAULT:
+				dD("%s: element not found", "name");
+				ret = PROBE_ENOELM;
+				break;
+			default:
+				ret = PROBE_EUNKNOWN;
+			}
+			SEXP_free(val);
 			break;
 		}
-		case -1: /* Error */
-		{
-			dD("dpkginfo_get_by_name failed.");
-			item = probe_item_create(OVAL_LINUX_DPKG_INFO, NULL,
-					"name", OVAL_DATATYPE_STRING, request_st,
-					NULL);
-			probe_item_setstatus (item, SYSCHAR_STATUS_ERROR);
-			probe_item_collect(ctx, item);
-			break;
+
+		/* A variable can give the same name more than once */
+		if (!oscap_htable_add(seen, request_st, NULL)) {
+			free(request_st);
+			continue;
 		}
-                }
-        } else { /* Ok */
-                int i;
-                int num_items = 1; /* FIXME */
-		oval_datatype_t evr_string_type;
-		oval_schema_version_t oval_version = probe_obj_get_platform_schema_version(obj);
-		if (oval_schema_version_cmp(oval_version, OVAL_SCHEMA_VERSION(5.11.1)) >= 0) {
-			evr_string_type = OVAL_DATATYPE_DEBIAN_EVR_STRING;
+
+		reply = dpkginfo_get_by_name(db, request_st, &errflag);
+		if (reply == NULL) {
+			switch (errflag) {
+			case 0: /* Not found */
+				dD("Package \"%s\" not found.", request_st);
+				break;
+			case -1: /* Error */
+			{
+				SEXP_t *item;
+
+				dD("dpkginfo_get_by_name failed.");
+				item = probe_item_create(OVAL_LINUX_DPKG_INFO, NULL,
+						"name", OVAL_DATATYPE_STRING, request_st,
+						NULL);
+				probe_item_setstatus(item, SYSCHAR_STATUS_ERROR);
+				probe_item_collect(c->ctx, item);
+				break;
+			}
+			}
 		} else {
-			evr_string_type = OVAL_DATATYPE_EVR_STRING;
+			SEXP_t *name = SEXP_string_newf("%s", reply->name);
+
+			/* Stop when the collection is full, like dpkginfo_foreach() */
+			if (probe_entobj_cmp(c->ent, name) == OVAL_RESULT_TRUE)
+				stop = dpkginfo_collect_item(reply, c) != 0;
+			SEXP_free(name);
+			dpkginfo_free_reply(reply);
 		}
+		free(request_st);
+		if (stop) {
+			SEXP_free(val);
+			break;
+		}
+	}
 
-                for (i = 0; i < num_items; ++i) {
-                        dD("%s: element found version %s", dpkginfo_reply->name, dpkginfo_reply->evr);
-                        item = probe_item_create (OVAL_LINUX_DPKG_INFO, NULL,
-                                        "name", OVAL_DATATYPE_STRING, dpkginfo_reply->name,
-                                        "arch", OVAL_DATATYPE_STRING, dpkginfo_reply->arch,
-                                        "epoch", OVAL_DATATYPE_STRING, dpkginfo_reply->epoch,
-                                        "release", OVAL_DATATYPE_STRING, dpkginfo_reply->release,
-                                        "version", OVAL_DATATYPE_STRING, dpkginfo_reply->version,
-					"evr", evr_string_type, dpkginfo_reply->evr,
-                                        NULL);
+	oscap_htable_free0(seen);
+	SEXP_free(vals);
 
-			probe_item_collect(ctx, item);
+	return ret;
+}
 
-                        dpkginfo_free_reply(dpkginfo_reply);
-                }
-        }
+int dpkginfo_probe_main (probe_ctx *ctx, void *arg)
+{
+	SEXP_t *obj;
+	struct dpkginfo_db *db = arg;
+	struct dpkginfo_collect c;
+	oval_schema_version_t oval_version;
+	int ret = 0;
 
-	SEXP_free(ent);
-        free(request_st);
+	if (db == NULL)
+		return PROBE_EINIT;
 
-        return (0);
+	obj = probe_ctx_getobject(ctx);
+	c.ctx = ctx;
+	c.ent = probe_obj_getent(obj, "name", 1);
+
+	if (c.ent == NULL) {
+		return (PROBE_ENOENT);
+	}
+
+	oval_version = probe_obj_get_platform_schema_version(obj);
+	if (oval_schema_version_cmp(oval_version, OVAL_SCHEMA_VERSION(5.11.1)) >= 0) {
+		c.evr_string_type = OVAL_DATATYPE_DEBIAN_EVR_STRING;
+	} else {
+		c.evr_string_type = OVAL_DATATYPE_EVR_STRING;
+	}
+
+	if (probe_ent_getoperation(c.ent, OVAL_OPERATION_EQUALS) == OVAL_OPERATION_EQUALS) {
+		ret = dpkginfo_collect_equals(db, &c);
+	} else if (dpkginfo_foreach(db, dpkginfo_collect_cmp, &c) < 0) {
+		dD("dpkginfo_foreach failed.");
+		probe_cobj_set_flag(probe_ctx_getresult(ctx), SYSCHAR_FLAG_ERROR);
+	}
+
+	SEXP_free(c.ent);
+
+	return ret;
 }
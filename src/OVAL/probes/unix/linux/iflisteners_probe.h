@@ -25,6 +25,8 @@
 
 #include "probe-api.h"
 
+void *iflisteners_probe_init(void);
 int iflisteners_probe_main(probe_ctx *ctx, void *arg);
+void iflisteners_probe_fini(void *arg);
 
 #endif /* OPENSCAP_IFLISTENERS_PROBE_H */
@@ -0,0 +1,447 @@
+/*
+ * Copyright 2026 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdio.h>
+#include <stdio_ext.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <netinet/in.h>
+#include <linux/netlink.h>
+#include <linux/sock_diag.h>
+#include <linux/inet_diag.h>
+
+#include "common/debug_priv.h"
+#include "proc-sockets.h"
+#include "../proc-snapshot.h"
+
+struct proc_socket_entry {
+	unsigned long inode;  /* 0 marks an empty slot */
+	struct proc_socket_owner owner;
+};
+
+struct proc_socket_table {
+	bool loaded;
+	int status;
+	struct proc_inet_socket *socks;
+	size_t count;
+	size_t size;
+};
+
+struct proc_sockets {
+	int refs;
+	pthread_mutex_t lock;
+	struct proc_snapshot *procs;
+	bool owners_loaded;
+	int owners_status;
+	/* open addressing by inode, the first process found keeps the socket */
+	struct proc_socket_entry *owners;
+	size_t owner_cnt;
+	size_t owner_mask;
+	struct proc_socket_table tables[PROC_SOCKETS_TABLE_COUNT];
+};
+
+static const struct {
+	const char *path;
+	int family;
+	int protocol;  /* 0 if the sockets are only listed in the file */
+} proc_socket_tables[PROC_SOCKETS_TABLE_COUNT] = {
+	[PROC_SOCKETS_TCP]  = { "/proc/net/tcp",  AF_INET,  IPPROTO_TCP },
+	[PROC_SOCKETS_TCP6] = { "/proc/net/tcp6", AF_INET6, IPPROTO_TCP },
+	[PROC_SOCKETS_UDP]  = { "/proc/net/udp",  AF_INET,  IPPROTO_UDP },
+	[PROC_SOCKETS_UDP6] = { "/proc/net/udp6", AF_INET6, IPPROTO_UDP },
+	[PROC_SOCKETS_RAW]  = { "/proc/net/raw",  AF_INET,  0 },
+	[PROC_SOCKETS_RAW6] = { "/proc/net/raw6", AF_INET6, 0 },
+};
+
+static pthread_mutex_t shared_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct proc_sockets *shared = NULL;
+
+struct proc_sockets *proc_sockets_acquire(void)
+{
+	pthread_mutex_lock(&shared_lock);
+	if (shared == NULL) {
+		struct proc_sockets *sockets = calloc(1, sizeof(struct proc_sockets));
+		if (sockets == NULL) {
+			pthread_mutex_unlock(&shared_lock);
+			return NULL;
+		}
+		sockets->procs = proc_snapshot_acquire();
+		if (sockets->procs == NULL) {
+			pthread_mutex_unlock(&shared_lock);
+			free(sockets);
+			return NULL;
+		}
+		pthread_mutex_init(&sockets->lock, NULL);
+		shared = sockets;
+	}
+	shared->refs++;
+	pthread_mutex_unlock(&shared_lock);
+	return shared;
+}
+
+void proc_sockets_release(struct proc_sockets *sockets)
+{
+	if (sockets == NULL)
+		return;
+
+	pthread_mutex_lock(&shared_lock);
+	if (--sockets->refs > 0) {
+		pthread_mutex_unlock(&shared_lock);
+		return;
+	}
+	shared = NULL;
+	pthread_mutex_unlock(&shared_lock);
+
+	for (int i = 0; i < PROC_SOCKETS_TABLE_COUNT; ++i)
+		free(sockets->tables[i].socks);
+	free(sockets->owners);
+	proc_snapshot_release(sockets->procs);
+	pthread_mutex_destroy(&sockets->lock);
+	free(sockets);
+}
+
+static inline size_t inode_hash(unsigned long inode)
+{
+	return (size_t) ((uint64_t) inode * UINT64_C(0x9E3779B97F4A7C15) >> 17);
+}
+
+static int owners_insert(struct proc_sockets *sockets, unsigned long inode, const struct proc_socket_owner *owner)
+{
+	if (inode == 0)
+		return 0;
+
+	if (2 * (sockets->owner_cnt + 1) > sockets->owner_mask + 1) {
+		size_t size = sockets->owner_mask ? 2 * (sockets->owner_mask + 1) : 1024;
+		struct proc_socket_entry *owners = calloc(size, sizeof(struct proc_socket_entry));
+		if (owners == NULL)
+			return -1;
+
+		for (size_t i = 0; sockets->owner_mask && i <= sockets->owner_mask; ++i) {
+			if (sockets->owners[i].inode == 0)
+				continue;
+			size_t j = inode_hash(sockets->owners[i].inode) & (size - 1);
+			while (owners[j].inode != 0)
+				j = (j + 1) & (size - 1);
+			owners[j] = sockets->owners[i];
+		}
+		free(sockets->owners);
+		sockets->owners = owners;
+		sockets->owner_mask = size - 1;
+	}
+
+	size_t i = inode_hash(inode) & sockets->owner_mask;
+	while (sockets->owners[i].inode != 0) {
+		if (sockets->owners[i].inode == inode)
+			return 0;
+		i = (i + 1) & sockets->owner_mask;
+	}
+	sockets->owners[i].inode = inode;
+	sockets->owners[i].owner = *owner;
+	sockets->owner_cnt++;
+	return 0;
+}
+
+/* struct linux_dirent64 of getdents64(2) */
+struct proc_dirent64 {
+	uint64_t d_ino;
+	int64_t d_off;
+	unsigned short d_reclen;
+	unsigned char d_type;
+	char d_name[];
+};
+
+static int read_socket_inodes(struct proc_sockets *sockets, int dfd, const struct proc_socket_owner *owner)
+{
+	char buf[8192];
+	long len;
+
+	while ((len = syscall(SYS_getdents64, dfd, buf, sizeof(buf))) > 0) {
+		for (long off = 0; off < len; ) {
+			struct proc_dirent64 *ent = (struct proc_dirent64 *) (buf + off);
+			char line[64], *s, *e;
+			unsigned long inode;
+			ssize_t lnlen;
+
+			off += ent->d_reclen;
+			if (ent->d_name[0] == '.')
+				continue;
+			lnlen = readlinkat(dfd, ent->d_name, line, sizeof(line) - 1);
+			if (lnlen < 0)
+				continue;
+			line[lnlen] = 0;
+
+			// Only look at the socket entries
+			if (memcmp(line, "socket:", 7) == 0) {
+				// Type 1 sockets
+				s = strchr(line+7, '[');
+				if (s == NULL)
+					continue;
+				s++;
+				e = strchr(s, ']');
+				if (e == NULL)
+					continue;
+				*e = 0;
+			} else if (memcmp(line, "[0000]:", 7) == 0) {
+				// Type 2 sockets
+				s = line + 8;
+			} else
+				continue;
+			errno = 0;
+			inode = strtoul(s, NULL, 10);
+			if (errno)
+				continue;
+			if (owners_insert(sockets, inode, owner) != 0)
+				return -1;
+		}
+	}
+	return 0;
+}
+
+static int read_owners(struct proc_sockets *sockets)
+{
+	const struct proc_snapshot_process *proc;
+	char buf[32];
+	int ret = 0;
+
+	if (proc_snapshot_load(sockets->procs) < 0)
+		return -1;
+
+	for (size_t i = 0; (proc = proc_snapshot_get(sockets->procs, i)) != NULL; ++i) {
+		struct proc_socket_owner owner;
+		int dfd;
+
+		owner.pid = proc->pid;
+		owner.uid = proc->euid >= 0 ? proc->euid : 0;
+		memcpy(owner.cmd, proc->comm, sizeof(owner.cmd));
+
+		// Now lets get the inodes each process has open
+		snprintf(buf, sizeof(buf), "/proc/%d/fd", proc->pid);
+		dfd = open(buf, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+		if (dfd < 0) {
+			/* Need DAC_OVERRIDE permission */
+			if (errno == EACCES)
+				ret = 1;
+			// Process might have ended or something - ignore it
+			continue;
+		}
+		if (read_socket_inodes(sockets, dfd, &owner) != 0) {
+			close(dfd);
+			return -1;
+		}
+		close(dfd);
+	}
+	return ret;
+}
+
+int proc_sockets_load_owners(struct proc_sockets *sockets)
+{
+	pthread_mutex_lock(&sockets->lock);
+	if (!sockets->owners_loaded) {
+		sockets->owners_status = read_owners(sockets);
+		sockets->owners_loaded = true;
+		dI("Found %zu sockets open by processes.", sockets->owner_cnt);
+	}
+	pthread_mutex_unlock(&sockets->lock);
+	return sockets->owners_status;
+}
+
+const struct proc_socket_owner *proc_sockets_get_owner(struct proc_sockets *sockets, unsigned long inode)
+{
+	if (proc_sockets_load_owners(sockets) < 0 || sockets->owners == NULL || inode == 0)
+		return NULL;
+
+	size_t i = inode_hash(inode) & sockets->owner_mask;
+	while (sockets->owners[i].inode != 0) {
+		if (sockets->owners[i].inode == inode)
+			return &sockets->owners[i].owner;
+		i = (i + 1) & sockets->owner_mask;
+	}
+	return NULL;
+}
+
+static struct proc_inet_socket *table_add(struct proc_socket_table *table)
+{
+	if (table->count == table->size) {
+		size_t size = table->size ? 2 * table->size : 64;
+		struct proc_inet_socket *socks = realloc(table->socks, size * sizeof(struct proc_inet_socket));
+		if (socks == NULL)
+			return NULL;
+		table->socks = socks;
+		table->size = size;
+	}
+	return &table->socks[table->count++];
+}
+
+static int read_sock_diag(struct proc_socket_table *table, int family, int protocol)
+{
+	struct {
+		struct nlmsghdr nlh;
+		struct inet_diag_req_v2 req;
+	} request;
+	char buf[32768];
+	int fd, ret = -1;
+
+	fd = socket(AF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC, NETLINK_SOCK_DIAG);
+	if (fd < 0)
+		return -1;
+
+	memset(&request, 0, sizeof(request));
+	request.nlh.nlmsg_len = sizeof(request);
+	request.nlh.nlmsg_type = SOCK_DIAG_BY_FAMILY;
+	request.nlh.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+	request.req.sdiag_family = family;
+	request.req.sdiag_protocol = protocol;
+	/* All the states, as listed in /proc/net */
+	request.req.idiag_states = ~0U;
+	if (send(fd, &request, sizeof(request), 0) < 0) {
+		close(fd);
+		return -1;
+	}
+
+	for (;;) {
+		ssize_t len = recv(fd, buf, sizeof(buf), 0);
+		if (len < 0 && errno == EINTR)
+			continue;
+		if (len <= 0)
+			break;
+		for (struct nlmsghdr *nlh = (struct nlmsghdr *) buf; NLMSG_OK(nlh, len); nlh = NLMSG_NEXT(nlh, len)) {
+			if (nlh->nlmsg_type == NLMSG_DONE) {
+				ret = 0;
+				goto finish;
+			}
+			if (nlh->nlmsg_type == NLMSG_ERROR)
+				goto finish;
+			if (nlh->nlmsg_type != SOCK_DIAG_BY_FAMILY)
+				continue;
+
+			struct inet_diag_msg *msg = NLMSG_DATA(nlh);
+			struct proc_inet_socket *sock = table_add(table);
+			if (sock == NULL)
+				goto finish;
+			inet_ntop(family, msg->id.idiag_src, sock->laddr, sizeof(sock->laddr));
+			inet_ntop(family, msg->id.idiag_dst, sock->raddr, sizeof(sock->raddr));
+			sock->lport = ntohs(msg->id.idiag_sport);
+			sock->rport = ntohs(msg->id.idiag_dport);
+			sock->inode = msg->idiag_inode;
+		}
+	}
+ finish:
+	close(fd);
+	if (ret != 0)
+		table->count = 0;
+	return ret;
+}
+
+static void addr_convert(const char *src, char *dest, int size)
+{
+	if (strlen(src) > 8) {
+		struct in6_addr in6;
+		sscanf(src, "%08X%08X%08X%08X",
+			&in6.s6_addr32[0], &in6.s6_addr32[1],
+			&in6.s6_addr32[2], &in6.s6_addr32[3]);
+		inet_ntop(AF_INET6, &in6, dest, size);
+	} else {
+		int localaddr;
+		sscanf(src, "%X",&localaddr);
+		inet_ntop(AF_INET, &localaddr, dest, size);
+	}
+}
+
+static int read_proc_net(struct proc_socket_table *table, const char *proc)
+{
+	int line = 0;
+	FILE *f;
+	char buf[256];
+	unsigned long rxq, txq, time_len, retr, inode;
+	unsigned local_port, rem_port;
+	int d, state, timer_run, uid, timeout;
+	char rem_addr[128], local_addr[128], more[512];
+
+	f = fopen(proc, "rt");
+	if (f == NULL) {
+		if (errno != ENOENT)
+			return -1;
+		else
+			return 0;
+	}
+	__fsetlocking(f, FSETLOCKING_BYCALLER);
+	while (fgets(buf, sizeof(buf), f)) {
+		if (line == 0) {
+			line++;
+			continue;
+		}
+		more[0] = 0;
+		sscanf(buf, "%d: %64[0-9A-Fa-f]:%X %64[0-9A-Fa-f]:%X %X "
+			"%lX:%lX %X:%lX %lX %d %d %lu %511s\n",
+			&d, local_addr, &local_port, rem_addr, &rem_port,
+			&state, &txq, &rxq, &timer_run, &time_len, &retr,
+			&uid, &timeout, &inode, more);
+
+		struct proc_inet_socket *sock = table_add(table);
+		if (sock == NULL) {
+			fclose(f);
+			return -1;
+		}
+		addr_convert(local_addr, sock->laddr, sizeof(sock->laddr));
+		addr_convert(rem_addr, sock->raddr, sizeof(sock->raddr));
+		sock->lport = local_port;
+		sock->rport = rem_port;
+		sock->inode = inode;
+	}
+	fclose(f);
+	return 0;
+}
+
+int proc_sockets_foreach(struct proc_sockets *sockets, proc_sockets_table_t table, proc_sockets_func func, void *arg)
+{
+	struct proc_socket_table *t = &sockets->tables[table];
+	int ret = 0;
+
+	pthread_mutex_lock(&sockets->lock);
+	if (!t->loaded) {
+		/* Dumping the sockets over netlink spares formatting and parsing the text */
+		if (proc_socket_tables[table].protocol != 0 &&
+		    read_sock_diag(t, proc_socket_tables[table].family, proc_socket_tables[table].protocol) == 0) {
+			dD("Read %zu sockets of %s over netlink.", t->count, proc_socket_tables[table].path);
+		} else {
+			t->status = read_proc_net(t, proc_socket_tables[table].path);
+			dD("Read %zu sockets from %s.", t->count, proc_socket_tables[table].path);
+		}
+		t->loaded = true;
+	}
+	pthread_mutex_unlock(&sockets->lock);
+
+	if (t->status != 0)
+		return -1;
+	for (size_t i = 0; i < t->count && ret == 0; ++i)
+		ret = func(&t->socks[i], arg);
+	return ret;
+}
@@ -0,0 +1,89 @@
+/*
+ * Copyright 2026 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef OPENSCAP_PROC_SOCKETS_H
+#define OPENSCAP_PROC_SOCKETS_H
+
+#include <sys/types.h>
+#include <arpa/inet.h>
+
+/* The first process found to have a socket open */
+struct proc_socket_owner {
+	pid_t pid;
+	uid_t uid;      /* effective user ID */
+	char cmd[16];   /* command name from /proc/<pid>/stat */
+};
+
+/* An IPv4 or IPv6 socket */
+struct proc_inet_socket {
+	char laddr[INET6_ADDRSTRLEN];
+	unsigned int lport;
+	char raddr[INET6_ADDRSTRLEN];
+	unsigned int rport;
+	unsigned long inode;
+};
+
+/* Socket tables, named after their files in /proc/net */
+typedef enum {
+	PROC_SOCKETS_TCP = 0,
+	PROC_SOCKETS_TCP6,
+	PROC_SOCKETS_UDP,
+	PROC_SOCKETS_UDP6,
+	PROC_SOCKETS_RAW,
+	PROC_SOCKETS_RAW6,
+	PROC_SOCKETS_TABLE_COUNT
+} proc_sockets_table_t;
+
+/*
+ * Sockets of the system and the processes which have them open, shared by
+ * the listener probes. Every part is read on its first use and kept until
+ * the last probe releases the table.
+ */
+struct proc_sockets;
+
+/*
+ * Get a reference to the shared socket table.
+ * @return NULL if the table can't be allocated
+ */
+struct proc_sockets *proc_sockets_acquire(void);
+
+void proc_sockets_release(struct proc_sockets *sockets);
+
+/*
+ * Read the socket inodes of all the processes, unless it has been done.
+ * @return -1 if /proc can't be read or memory runs out, 1 if the file descriptors of some
+ * process were not accessible, 0 otherwise
+ */
+int proc_sockets_load_owners(struct proc_sockets *sockets);
+
+/*
+ * Find the process which has the socket open.
+ * @return NULL if there is no such process
+ */
+const struct proc_socket_owner *proc_sockets_get_owner(struct proc_sockets *sockets, unsigned long inode);
+
+typedef int (*proc_sockets_func)(const struct proc_inet_socket *sock, void *arg);
+
+/*
+ * Call func for every socket of the table until it returns non-zero.
+ * @return -1 if the table can't be read, the last value returned by func otherwise
+ */
+int proc_sockets_foreach(struct proc_sockets *sockets, proc_sockets_table_t table, proc_sockets_func func, void *arg);
+
+#endif /* OPENSCAP_PROC_SOCKETS_H */
@@ -24,6 +24,10 @@
 #include <config.h>
 #endif
 
+#include <regex.h>
+
+#include "oscap_helpers.h"
+
 #ifdef RPM46_FOUND
 int rpmErrorCb (rpmlogRec rec, rpmlogCallbackData data)
 {
@@ -80,3 +84,275 @@ void set_rpm_db_path()
 	dI("Using %s as rpm database.", dbpath);
 	rpmPushMacro(NULL, "_dbpath", NULL, dbpath, RMIL_CMDLINE);
 }
+
+static const char g_keyid_regex_string[] = "Key ID [a-fA-F0-9]{16}";
+
+static void rpm_package_free(struct rpm_package *pkg)
+{
+	free(pkg->name);
+	free(pkg->arch);
+	free(pkg->epoch);
+	free(pkg->release);
+	free(pkg->version);
+	free(pkg->evr);
+	free(pkg->signature_keyid);
+	free(pkg->extended_name);
+	free(pkg->files);
+}
+
+static void rpm_snapshot_unref(struct rpm_snapshot *snapshot)
+{
+	if (snapshot == NULL || --snapshot->refs > 0)
+		return;
+
+	for (size_t i = 0; i < snapshot->count; ++i)
+		rpm_package_free(&snapshot->pkgs[i]);
+	free(snapshot->pkgs);
+	oscap_htable_free0(snapshot->names);
+	free(snapshot);
+}
+
+static char *rpm_package_keyid(Header h, regex_t *keyid_regex)
+{
+	errmsg_t rpmerr;
+	char *str, *sid = NULL, *keyid;
+	regmatch_t keyid_match[1];
+
+	str = headerFormat(
+	    h,
+	    "%|DSAHEADER?{%{DSAHEADER:pgpsig}}:{%|RSAHEADER?{%{RSAHEADER:pgpsig}}:{%|SIGGPG?{%{SIGGPG:pgpsig}}:{%|SIGPGP?{%{SIGPGP:pgpsig}}:{(none)}|}|}|}|",
+	    &rpmerr);
+	if (str == NULL)
+		return strdup("0");
+
+	if (regexec(keyid_regex, str, 1, keyid_match, 0) != 0) {
+		dD("Failed to extract the Key ID value: regex=\"%s\", string=\"%s\"",
+		   g_keyid_regex_string, str);
+	} else if (keyid_match[0].rm_so >= 0 && keyid_match[0].rm_eo >= 0) {
+		size_t keyid_start = keyid_match[0].rm_so + strlen("Key ID ");
+		size_t keyid_length = keyid_match[0].rm_eo - keyid_start;
+
+		sid = str + keyid_start;
+		sid[keyid_length] = '\0';
+	}
+
+	keyid = strdup(sid != NULL ? sid : "0");
+	free(str);
+	return keyid;
+}
+
+/* Append the paths of the package files and directories, in the order rpmfi gives them */
+static int rpm_package_files(rpmts ts, Header h, struct rpm_package *pkg)
+{
+	rpmTag tag[2] = { RPMTAG_BASENAMES, RPMTAG_DIRNAMES };
+	size_t size = 0, alloc = 0;
+
+	for (int i = 0; i < 2; ++i) {
+		rpmfi fi = rpmfiNew(ts, h, tag[i], 1);
+
+		while (rpmfiNext(fi) != -1) {
+			const char *filepath = rpmfiFN(fi);
+			size_t len = strlen(filepath) + 1;
+
+			if (size + len > alloc) {
+				size_t new_alloc = alloc ? alloc * 2 : 4096;
+				char *tmp;
+
+				while (size + len > new_alloc)
+					new_alloc *= 2;
+				tmp = realloc(pkg->files, new_alloc);
+				if (tmp == NULL) {
+					rpmfiFree(fi);
+					return -1;
+				}
+				pkg->files = tmp;
+				alloc = new_alloc;
+			}
+			memcpy(pkg->files + size, filepath, len);
+			size += len;
+			++pkg->files_count;
+		}
+		rpmfiFree(fi);
+	}
+
+	return 0;
+}
+
+static int rpm_package_from_header(Header h, struct rpm_package *pkg, regex_t *keyid_regex)
+{
+	errmsg_t rpmerr;
+	const char *epoch_override;
+
+	pkg->name = headerFormat(h, "%{NAME}", &rpmerr);
+	pkg->arch = headerFormat(h, "%{ARCH}", &rpmerr);
+	pkg->epoch = headerFormat(h, "%{EPOCH}", &rpmerr);
+	pkg->release = headerFormat(h, "%{RELEASE}", &rpmerr);
+	pkg->version = headerFormat(h, "%{VERSION}", &rpmerr);
+	if (pkg->name == NULL || pkg->arch == NULL || pkg->epoch == NULL
+	    || pkg->release == NULL || pkg->version == NULL)
+		return -1;
+
+	epoch_override = oscap_streq(pkg->epoch, "(none)") ? "0" : pkg->epoch;
+	pkg->evr = oscap_sprintf("%s:%s-%s", epoch_override, pkg->version, pkg->release);
+	pkg->extended_name = oscap_sprintf("%s-%s:%s-%s.%s", pkg->name, epoch_override,
+	                                   pkg->version, pkg->release, pkg->arch);
+	pkg->signature_keyid = rpm_package_keyid(h, keyid_regex);
+	if (pkg->evr == NULL || pkg->extended_name == NULL || pkg->signature_keyid == NULL)
+		return -1;
+
+	return 0;
+}
+
+static struct rpm_snapshot *rpm_snapshot_load(rpmts ts)
+{
+	struct rpm_snapshot *snapshot;
+	rpmdbMatchIterator match;
+	regex_t keyid_regex;
+	Header pkgh;
+	size_t max = 0;
+
+	if (regcomp(&keyid_regex, g_keyid_regex_string, REG_EXTENDED) != 0) {
+		dE("regcomp(%s) failed.", g_keyid_regex_string);
+		return NULL;
+	}
+
+	snapshot = calloc(1, sizeof(*snapshot));
+	if (snapshot == NULL) {
+		regfree(&keyid_regex);
+		return NULL;
+	}
+	snapshot->refs = 1;
+
+	match = rpmtsInitIterator(ts, RPMDBI_PACKAGES, NULL, 0);
+	if (match != NULL) {
+		while ((pkgh = rpmdbNextIterator(match)) != NULL) {
+			struct rpm_package *pkg;
+
+			if (snapshot->count == max) {
+				size_t new_max = max ? max * 2 : 1024;
+				struct rpm_package *tmp = realloc(snapshot->pkgs, new_max * sizeof(*tmp));
+
+				if (tmp == NULL)
+					goto err;
+				snapshot->pkgs = tmp;
+				max = new_max;
+			}
+
+			pkg = &snapshot->pkgs[snapshot->count++];
+			memset(pkg, 0, sizeof(*pkg));
+			pkg->instance = rpmdbGetIteratorOffset(match);
+			if (rpm_package_from_header(pkgh, pkg, &keyid_regex) != 0)
+				goto err;
+		}
+		match = rpmdbFreeIterator(match);
+	}
+
+	snapshot->names = oscap_htable_new1(strcmp, snapshot->count + 1);
+	if (snapshot->names == NULL)
+		goto err;
+	/* Chain packages of the same name in the rpmdb order */
+	for (size_t i = 0; i < snapshot->count; ++i) {
+		struct rpm_package *pkg = &snapshot->pkgs[i];
+		struct rpm_package *prev = oscap_htable_get(snapshot->names, pkg->name);
+
+		if (prev == NULL) {
+			oscap_htable_add(snapshot->names, pkg->name, pkg);
+			continue;
+		}
+		while (prev->next_name != NULL)
+			prev = prev->next_name;
+		prev->next_name = pkg;
+	}
+
+	dD("Loaded %zu packages from the rpmdb.", snapshot->count);
+	regfree(&keyid_regex);
+	return snapshot;
+err:
+	if (match != NULL)
+		rpmdbFreeIterator(match);
+	regfree(&keyid_regex);
+	rpm_snapshot_unref(snapshot);
+	return NULL;
+}
+
+struct rpm_snapshot *rpm_snapshot_get(struct rpm_probe_global *g_rpm)
+{
+	struct rpm_snapshot *snapshot;
+	int prev_cancel_state = -1;
+
+	if (pthread_mutex_lock(&g_rpm->mutex) != 0) {
+		dE("Can't lock mutex");
+		return NULL;
+	}
+	pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, &prev_cancel_state);
+
+	if (g_rpm->snapshot == NULL)
+		g_rpm->snapshot = rpm_snapshot_load(g_rpm->rpmts);
+
+	snapshot = g_rpm->snapshot;
+	if (snapshot != NULL)
+		++snapshot->refs;
+
+	pthread_mutex_unlock(&g_rpm->mutex);
+	pthread_setcancelstate(prev_cancel_state, NULL);
+
+	return snapshot;
+}
+
+int rpm_snapshot_get_files(struct rpm_probe_global *g_rpm, struct rpm_package *pkg)
+{
+	rpmdbMatchIterator match;
+	Header pkgh;
+	int prev_cancel_state = -1;
+	int ret = 0;
+
+	if (pthread_mutex_lock(&g_rpm->mutex) != 0) {
+		dE("Can't lock mutex");
+		return -1;
+	}
+	pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, &prev_cancel_state);
+
+	if (!pkg->files_loaded) {
+		match = rpmtsInitIterator(g_rpm->rpmts, RPMDBI_PACKAGES, &pkg->instance, sizeof(pkg->instance));
+		pkgh = match != NULL ? rpmdbNextIterator(match) : NULL;
+		if (pkgh == NULL) {
+			dW("Package %s is not in the rpmdb anymore.", pkg->extended_name);
+			ret = -1;
+		} else {
+			ret = rpm_package_files(g_rpm->rpmts, pkgh, pkg);
+		}
+		if (match != NULL)
+			rpmdbFreeIterator(match);
+
+		if (ret == 0) {
+			pkg->files_loaded = true;
+			dD("Loaded %zu files of package %s.", pkg->files_count, pkg->extended_name);
+		} else {
+			free(pkg->files);
+			pkg->files = NULL;
+			pkg->files_count = 0;
+		}
+	}
+
+	pthread_mutex_unlock(&g_rpm->mutex);
+	pthread_setcancelstate(prev_cancel_state, NULL);
+
+	return ret;
+}
+
+void rpm_snapshot_put(struct rpm_probe_global *g_rpm, struct rpm_snapshot *snapshot)
+{
+	int prev_cancel_state = -1;
+
+	pthread_mutex_lock(&g_rpm->mutex);
+	pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, &prev_cancel_state);
+	rpm_snapshot_unref(snapshot);
+	pthread_mutex_unlock(&g_rpm->mutex);
+	pthread_setcancelstate(prev_cancel_state, NULL);
+}
+
+void rpm_snapshot_free(struct rpm_probe_global *g_rpm)
+{
+	rpm_snapshot_unref(g_rpm->snapshot);
+	g_rpm->snapshot = NULL;
+}
@@ -34,13 +34,54 @@
 #include <rpm/header.h>
 
 #include <pthread.h>
+#include <stdbool.h>
 #include "common/util.h"
+#include "common/list.h"
 #include "common/debug_priv.h"
 #include "pthread.h"
 
+struct rpm_snapshot;
+
 struct rpm_probe_global {
 	rpmts rpmts;
 	pthread_mutex_t mutex;
+	struct rpm_snapshot *snapshot;
+};
+
+/*
+ * Header fields of an installed package as the rpminfo probe reports them.
+ */
+struct rpm_package {
+	char *name;
+	char *arch;
+	char *epoch;
+	char *release;
+	char *version;
+	char *evr;
+	char *signature_keyid;
+	char *extended_name;
+	/* rpmdb header instance, the file list is read from it when needed */
+	unsigned int instance;
+	/* NUL separated file and directory paths, see rpm_snapshot_get_files() */
+	bool files_loaded;
+	char *files;
+	size_t files_count;
+	/* next package of the same name */
+	struct rpm_package *next_name;
+};
+
+/*
+ * All installed packages read from the rpmdb in one pass. A snapshot is
+ * immutable once built, so it can be used without holding the rpmdb lock.
+ * The only exception are the file lists of the packages, which are read
+ * on demand by rpm_snapshot_get_files().
+ */
+struct rpm_snapshot {
+	int refs;
+	struct rpm_package *pkgs;
+	size_t count;
+	/* name -> the first package of that name */
+	struct oscap_htable *names;
 };
 
 #ifndef HAVE_HEADERFORMAT
@@ -101,5 +142,30 @@ void rpmLibsPreload(void);
 
 void set_rpm_db_path(void);
 
+/**
+ * Get a reference to the snapshot of the rpmdb opened by g_rpm->rpmts,
+ * reading it on the first call.
+ * @return NULL if the rpmdb can't be read
+ */
+struct rpm_snapshot *rpm_snapshot_get(struct rpm_probe_global *g_rpm);
+
+/**
+ * Read the file list of a package of the snapshot, unless it has been read
+ * already. pkg->files and pkg->files_count don't change after a successful
+ * call, so they can be used without holding the rpmdb lock.
+ * @return 0 on success, -1 if the package files can't be read
+ */
+int rpm_snapshot_get_files(struct rpm_probe_global *g_rpm, struct rpm_package *pkg);
+
+/**
+ * Release a reference obtained by rpm_snapshot_get().
+ */
+void rpm_snapshot_put(struct rpm_probe_global *g_rpm, struct rpm_snapshot *snapshot);
+
+/**
+ * Free the snapshot held by g_rpm, to be called from probe fini.
+ */
+void rpm_snapshot_free(struct rpm_probe_global *g_rpm);
+
 
 #endif
@@ -69,217 +69,10 @@
 #include <probe/option.h>
 #include "probe/entcmp.h"
 #include "common/debug_priv.h"
+#include "oscap_helpers.h"
 #include "rpminfo_probe.h"
 
 
-struct rpminfo_req {
-        char *name;
-        oval_operation_t op;
-};
-
-struct rpminfo_rep {
-        char *name;
-        char *arch;
-        char *epoch;
-        char *release;
-        char *version;
-        char *evr;
-        char *signature_keyid;
-	char extended_name[1024];
-};
-
-#define RPMINFO_LOCK	RPM_MUTEX_LOCK(&g_rpm->mutex)
-
-#define RPMINFO_UNLOCK	RPM_MUTEX_UNLOCK(&g_rpm->mutex)
-
-static const char g_keyid_regex_string[] = "Key ID [a-fA-F0-9]{16}";
-
-static void __rpminfo_rep_free (struct rpminfo_rep *ptr)
-{
-        free (ptr->name);
-        free (ptr->arch);
-        free (ptr->epoch);
-        free (ptr->release);
-        free (ptr->version);
-        free (ptr->evr);
-        free (ptr->signature_keyid);
-}
-
-static void pkgh2rep(Header h, struct rpminfo_rep *r, regex_t *keyid_regex)
-{
-        errmsg_t rpmerr;
-        char *str, *sid;
-	char *epoch_override = NULL;
-        size_t len;
-	regmatch_t keyid_match[1];
-
-	if (h == NULL || r == NULL) {
-		return;
-	}
-
-        r->name = headerFormat (h, "%{NAME}", &rpmerr);
-        r->arch = headerFormat (h, "%{ARCH}", &rpmerr);
-        r->epoch = headerFormat (h, "%{EPOCH}", &rpmerr);
-        r->release = headerFormat (h, "%{RELEASE}", &rpmerr);
-        r->version = headerFormat (h, "%{VERSION}", &rpmerr);
-	epoch_override = oscap_streq(r->epoch, "(none)") ? "0" : r->epoch;
-	snprintf(r->extended_name, 1024, "%s-%s:%s-%s.%s", r->name, epoch_override, r->version, r->release, r->arch);
-
-	len = (strlen(epoch_override) +
-               strlen (r->release) +
-               strlen (r->version) + 2);
-
-        str = malloc (sizeof (char) * (len + 1));
-        snprintf (str, len + 1, "%s:%s-%s",
-		epoch_override,
-                  r->version,
-                  r->release);
-
-        r->evr = str;
-
-        str = headerFormat (
-            h,
-            "%|DSAHEADER?{%{DSAHEADER:pgpsig}}:{%|RSAHEADER?{%{RSAHEADER:pgpsig}}:{%|SIGGPG?{%{SIGGPG:pgpsig}}:{%|SIGPGP?{%{SIGPGP:pgpsig}}:{(none)}|}|}|}|",
-            &rpmerr);
-
-	if (regexec(keyid_regex, str, 1, keyid_match, 0) != 0) {
-		sid = NULL;
-		dD("Failed to extract the Key ID value: regex=\"%s\", string=\"%s\"",
-		   g_keyid_regex_string, str);
-	} else {
-		size_t keyid_start, keyid_length;
-
-		if (keyid_match[0].rm_so < 0 || keyid_match[0].rm_eo < 0)
-			sid = NULL;
-		else {
-			keyid_start = keyid_match[0].rm_so + strlen("Key ID ");
-			keyid_length = keyid_match[0].rm_eo - keyid_start;
-			sid = str + keyid_start;
-			sid[keyid_length] = '\0';
-		}
-	}
-
-        r->signature_keyid = strdup(sid != NULL ? sid : "0");
-        free (str);
-}
-
-/*
- * req - Structure containing the name of the package.
- * rep - Pointer to rpminfo_rep structure pointer. An
- *       array of rpminfo_rep structures will be allocated
- *       here.
- *
- * The return value on error is -1. Otherwise the number of
- * rpminfo_rep structures allocated in *rep is returned.
- */
-static int get_rpminfo(struct rpminfo_req *req, struct rpminfo_rep **rep, struct rpm_probe_global *g_rpm)
-{
-	rpmdbMatchIterator match;
-	Header pkgh;
-	int ret = 0, i;
-	regex_t keyid_regex;
-
-	if (regcomp(&keyid_regex, g_keyid_regex_string, REG_EXTENDED) != 0) {
-		dE("regcomp(%s) failed.", g_keyid_regex_string);
-		return -1;
-	}
-
-        RPMINFO_LOCK;
-
-        ret = -1;
-
-        switch (req->op) {
-        case OVAL_OPERATION_EQUALS:
-		match = rpmtsInitIterator(g_rpm->rpmts, RPMTAG_NAME, (const void *)req->name, 0);
-
-                if (match == NULL) {
-                        ret = 0;
-                        goto ret;
-                }
-
-                ret = rpmdbGetIteratorCount (match);
-
-                break;
-	case OVAL_OPERATION_NOT_EQUAL:
-		match = rpmtsInitIterator(g_rpm->rpmts, RPMDBI_PACKAGES, NULL, 0);
-                if (match == NULL) {
-                        ret = 0;
-                        goto ret;
-                }
-
-                if (rpmdbSetIteratorRE (match, RPMTAG_NAME, RPMMIRE_GLOB, "*") != 0)
-                {
-                        ret = -1;
-                        goto ret;
-                }
-
-                break;
-        case OVAL_OPERATION_PATTERN_MATCH:
-		match = rpmtsInitIterator(g_rpm->rpmts, RPMDBI_PACKAGES, NULL, 0);
-
-                if (match == NULL) {
-                        ret = 0;
-                        goto ret;
-                }
-
-                if (rpmdbSetIteratorRE (match, RPMTAG_NAME, RPMMIRE_REGEX,
-                                        (const char *)req->name) != 0)
-                {
-                        ret = -1;
-                        goto ret;
-                }
-
-                break;
-        default:
-                /* not supported */
-                ret = -1;
-                goto ret;
-        }
-
-        if (ret != -1) {
-                /*
-                 * We can allocate all memory needed now because we know the number
-                 * of results.
-                 */
-                void *new_rep = realloc (*rep, sizeof (struct rpminfo_rep) * ret);
-                if (new_rep == NULL) {
-                        ret = -2;
-                        goto ret;
-                }
-                (*rep) = new_rep;
-                for (i = 0; i < ret; ++i) {
-                        pkgh = rpmdbNextIterator (match);
-
-                        if (pkgh != NULL)
-			pkgh2rep(pkgh, (*rep) + i, &keyid_regex);
-                        else {
-                                /* XXX: emit warning */
-                                memset((*rep) + i, 0, sizeof(struct rpminfo_rep));
-                                break;
-                        }
-                }
-        } else {
-                ret = 0;
-
-                while ((pkgh = rpmdbNextIterator (match)) != NULL) {
-                        void *new_rep = realloc (*rep, sizeof (struct rpminfo_rep) * ++ret);
-                        if (new_rep == NULL) {
-                                ret = -2;
-                                goto ret;
-                        }
-                        (*rep) = new_rep;
-                        pkgh2rep(pkgh, (*rep) + (ret - 1), &keyid_regex);
-                }
-        }
-
-	match = rpmdbFreeIterator (match);
-ret:
-        RPMINFO_UNLOCK;
-
-	regfree(&keyid_regex);
-        return (ret);
-}
-
 int rpminfo_probe_offline_mode_supported()
 {
 	return PROBE_OFFLINE_CHROOT;
@@ -290,7 +83,7 @@ void *rpminfo_probe_init(void)
 #ifdef RPM46_FOUND
 	rpmlogSetCallback(rpmErrorCb, NULL);
 #endif
-	struct rpm_probe_global *g_rpm = malloc(sizeof(struct rpm_probe_global));
+	struct rpm_probe_global *g_rpm = calloc(1, sizeof(struct rpm_probe_global));
 	if (rpmReadConfigFiles ((const char *)NULL, (const char *)NULL) != 0) {
 		dD("rpmReadConfigFiles failed: %u, %s.", errno, strerror (errno));
 		g_rpm->rpmts = NULL;
@@ -320,6 +113,7 @@ void rpminfo_probe_fini (void *ptr)
 	if (r->rpmts == NULL)
 		return;
 
+	rpm_snapshot_free(r);
         rpmtsFree(r->rpmts);
         pthread_mutex_destroy (&(r->mutex));
 
@@ -327,79 +121,206 @@ void rpminfo_probe_fini (void *ptr)
         return;
 }
 
-static int collect_rpm_files(SEXP_t *item, const struct rpminfo_rep *rep, struct rpm_probe_global *g_rpm)
+static int collect_rpm_files(SEXP_t *item, struct rpm_probe_global *g_rpm, struct rpm_snapshot *snapshot,
+                             const struct rpm_package *pkg)
 {
-	SEXP_t *value;
-	rpmdbMatchIterator ts;
-	Header pkgh;
-	rpmfi fi;
-	rpmTag tag[2] = { RPMTAG_BASENAMES, RPMTAG_DIRNAMES };
-	int i, ret = 0;
-
-	ts = rpmtsInitIterator(g_rpm->rpmts, RPMDBI_PACKAGES, NULL, 0);
-	if (ts == NULL) {
-		return -1;
+	struct rpm_package *p;
+
+	/* Files of every installed package with the same name, epoch, version, release and arch */
+	for (p = oscap_htable_get(snapshot->names, pkg->name); p != NULL; p = p->next_name) {
+		const char *filepath;
+
+		if (strcmp(p->extended_name, pkg->extended_name) != 0)
+			continue;
+		if (rpm_snapshot_get_files(g_rpm, p) != 0)
+			return -1;
+
+		filepath = p->files;
+		for (size_t i = 0; i < p->files_count; ++i) {
+			size_t len = strlen(filepath);
+			SEXP_t *value;
+
+			value = probe_entval_from_cstr(OVAL_DATATYPE_STRING, filepath, len);
+			if (value != NULL) {
+				probe_item_ent_add(item, "filepath", NULL, value);
+				SEXP_free(value);
+			}
+			filepath += len + 1;
+		}
 	}
 
-	if (rpmdbSetIteratorRE(ts, RPMTAG_NAME, RPMMIRE_STRCMP, rep->name) != 0) {
-		ret = -1;
-		goto cleanup;
-	}
-	char *epoch_override = oscap_streq(rep->epoch, "(none)") ? "0" : rep->epoch;
-	if (rpmdbSetIteratorRE(ts, RPMTAG_EPOCH, RPMMIRE_STRCMP, epoch_override) != 0) {
-		ret = -1;
-		goto cleanup;
-	}
-	if (rpmdbSetIteratorRE(ts, RPMTAG_VERSION, RPMMIRE_STRCMP, rep->version) != 0) {
-		ret = -1;
-		goto cleanup;
+	return 0;
+}
+
+static int collect_rpm_package(probe_ctx *ctx, SEXP_t *ent, struct rpm_probe_global *g_rpm, struct rpm_snapshot *snapshot,
+                               const struct rpm_package *pkg, oval_schema_version_t over, bool filepaths)
+{
+	SEXP_t *item, *name;
+
+	name = SEXP_string_newf("%s", pkg->name);
+
+	if (probe_entobj_cmp(ent, name) != OVAL_RESULT_TRUE) {
+		SEXP_free(name);
+		return 0;
 	}
-	if (rpmdbSetIteratorRE(ts, RPMTAG_RELEASE, RPMMIRE_STRCMP, rep->release) != 0) {
-		ret = -1;
-		goto cleanup;
+
+	item = probe_item_create(OVAL_LINUX_RPM_INFO, NULL,
+	                         "name",    OVAL_DATATYPE_SEXP, name,
+	                         "arch",    OVAL_DATATYPE_STRING, pkg->arch,
+	                         "epoch",   OVAL_DATATYPE_STRING, pkg->epoch,
+	                         "release", OVAL_DATATYPE_STRING, pkg->release,
+	                         "version", OVAL_DATATYPE_STRING, pkg->version,
+	                         "evr",     OVAL_DATATYPE_EVR_STRING, pkg->evr,
+	                         "signature_keyid", OVAL_DATATYPE_STRING, pkg->signature_keyid,
+	                         NULL);
+	SEXP_free(name);
+
+	/* OVAL 5.10 added extended_name and filepaths behavior */
+	if (oval_schema_version_cmp(over, OVAL_SCHEMA_VERSION(5.10)) >= 0) {
+		SEXP_t *value;
+
+		value = probe_entval_from_cstr(OVAL_DATATYPE_STRING,
+		                               pkg->extended_name, strlen(pkg->extended_name));
+		probe_item_ent_add(item, "extended_name", NULL, value);
+		SEXP_free(value);
+
+		if (filepaths && collect_rpm_files(item, g_rpm, snapshot, pkg) != 0)
+			probe_item_setstatus(item, SYSCHAR_STATUS_ERROR);
 	}
-	if (rpmdbSetIteratorRE(ts, RPMTAG_ARCH, RPMMIRE_STRCMP, rep->arch) != 0) {
-		ret = -1;
-		goto cleanup;
+
+	return probe_item_collect(ctx, item) < 0 ? -1 : 0;
+}
+
+/* Look up every value of the name entity in the snapshot */
+static int collect_rpm_equals(probe_ctx *ctx, SEXP_t *ent, struct rpm_probe_global *g_rpm, struct rpm_snapshot *snapshot,
+                              oval_schema_version_t over, bool filepaths)
+{
+	SEXP_t *vals, *val;
+	struct oscap_htable *seen;
+	int ret = 0;
+
+	if (probe_ent_getvals(ent, &vals) == 0) {
+		dD("%s: no value", "name");
+		SEXP_free(vals);
+		return PROBE_ENOVAL;
 	}
 
-	while ((pkgh = rpmdbNextIterator(ts)) != NULL) {
-		/*
-		 * Inspect package files & directories
-		 */
-		for (i = 0; i < 2; ++i) {
-			fi = rpmfiNew(g_rpm->rpmts, pkgh, tag[i], 1);
-
-			while (rpmfiNext(fi) != -1) {
-				const char *filepath;
-				filepath = rpmfiFN(fi);
-				value = probe_entval_from_cstr(
-						OVAL_DATATYPE_STRING,
-						filepath,
-						strlen(filepath)
-						);
-				if (value != NULL) {
-					probe_item_ent_add(item, "filepath", NULL, value);
-					SEXP_free(value);
-				}
+	seen = oscap_htable_new();
+
+	SEXP_list_foreach(val, vals) {
+		const struct rpm_package *pkg;
+		char *name = SEXP_string_cstr(val);
+
+		if (name == NULL) {
+			switch (errno) {
+			case EINVAL:
+				dD("%s: invalid value type", "name");
+				ret = PROBE_EINVAL;
+				break;
+			case EFAULT:
+				dD("%s: element not found", "name");
+				ret = PROBE_ENOELM;
+				break;
+			default:
+				ret = PROBE_EUNKNOWN;
+			}
+			SEXP_free(val);
+			break;
+		}
+
+		/* A variable can give the same name more than once */
+		if (!oscap_htable_add(seen, name, NULL)) {
+			free(name);
+			continue;
+		}
+
+		pkg = oscap_htable_get(snapshot->names, name);
+		if (pkg == NULL)
+			dI("Package \"%s\" not found.", name);
+		free(name);
+
+		for (; pkg != NULL; pkg = pkg->next_name) {
+			if (collect_rpm_package(ctx, ent, g_rpm, snapshot, pkg, over, filepaths) != 0) {
+				ret = PROBE_EUNKNOWN;
+				break;
 			}
-			rpmfiFree(fi);
 		}
+		if (ret != 0) {
+			SEXP_free(val);
+			break;
+		}
+	}
+
+	oscap_htable_free0(seen);
+	SEXP_free(vals);
+
+	return ret;
+}
+
+/*
+ * Compare every package once. With pattern match, names are first matched
+ * against the POSIX regex of the first value like rpmdbSetIteratorRE() did
+ * when iterating the rpmdb, probe_entobj_cmp() decides after that.
+ */
+static int collect_rpm_all(probe_ctx *ctx, SEXP_t *ent, oval_operation_t op, struct rpm_probe_global *g_rpm,
+                           struct rpm_snapshot *snapshot, oval_schema_version_t over, bool filepaths)
+{
+	regex_t name_regex;
+	int ret = 0;
+
+	if (op == OVAL_OPERATION_PATTERN_MATCH) {
+		SEXP_t *val = probe_ent_getval(ent);
+		char *pattern;
+
+		if (val == NULL) {
+			dD("%s: no value", "name");
+			return PROBE_ENOVAL;
+		}
+		pattern = SEXP_string_cstr(val);
+		SEXP_free(val);
+		if (pattern == NULL)
+			return errno == EINVAL ? PROBE_EINVAL : PROBE_EUNKNOWN;
+
+		if (regcomp(&name_regex, pattern, REG_EXTENDED | REG_NOSUB) != 0) {
+			SEXP_t *item;
+
+			dD("regcomp(%s) failed.", pattern);
+			item = probe_item_create(OVAL_LINUX_RPM_INFO, NULL,
+			                         "name", OVAL_DATATYPE_STRING, pattern,
+			                         NULL);
+			probe_item_setstatus(item, SYSCHAR_STATUS_ERROR);
+			probe_item_collect(ctx, item);
+			free(pattern);
+			return 0;
+		}
+		free(pattern);
+	}
+
+	for (size_t i = 0; i < snapshot->count; ++i) {
+		const struct rpm_package *pkg = &snapshot->pkgs[i];
 
+		if (op == OVAL_OPERATION_PATTERN_MATCH && regexec(&name_regex, pkg->name, 0, NULL, 0) != 0)
+			continue;
+		if (collect_rpm_package(ctx, ent, g_rpm, snapshot, pkg, over, filepaths) != 0) {
+			ret = PROBE_EUNKNOWN;
+			break;
+		}
 	}
-cleanup:
-	ts = rpmdbFreeIterator(ts);
+
+	if (op == OVAL_OPERATION_PATTERN_MATCH)
+		regfree(&name_regex);
+
 	return ret;
 }
 
 int rpminfo_probe_main(probe_ctx *ctx, void *arg)
 {
-	SEXP_t *val, *item, *ent, *probe_in;
+	SEXP_t *ent, *probe_in, *bh_ent;
 	oval_schema_version_t over;
-	int rpmret, i;
-
-        struct rpminfo_req request_st;
-        struct rpminfo_rep *reply_st;
+	oval_operation_t op;
+	struct rpm_snapshot *snapshot;
+	bool filepaths = false;
+	int ret = 0;
 
 	// arg is NULL if regex compilation failed
 	if (arg == NULL) {
@@ -431,142 +352,50 @@ int rpminfo_probe_main(probe_ctx *ctx, void *arg)
                 return (PROBE_ENOENT);
         }
 
-        val = probe_ent_getval (ent);
-
-        if (val == NULL) {
-                dD("%s: no value", "name");
-                SEXP_free (ent);
-                return (PROBE_ENOVAL);
-        }
+	op = probe_ent_getoperation(ent, OVAL_OPERATION_EQUALS);
+	switch (op) {
+	case OVAL_OPERATION_EQUALS:
+	case OVAL_OPERATION_NOT_EQUAL:
+	case OVAL_OPERATION_PATTERN_MATCH:
+		break;
+	default:
+		SEXP_free(ent);
+		return (PROBE_EOPNOTSUPP);
+	}
 
-        request_st.name = SEXP_string_cstr (val);
-        SEXP_free (val);
-
-        val = probe_ent_getattrval (ent, "operation");
-
-        if (val == NULL) {
-                request_st.op = OVAL_OPERATION_EQUALS;
-        } else {
-                request_st.op = (oval_operation_t) SEXP_number_geti_32 (val);
-
-                switch (request_st.op) {
-                case OVAL_OPERATION_EQUALS:
-		case OVAL_OPERATION_NOT_EQUAL:
-                case OVAL_OPERATION_PATTERN_MATCH:
-                        break;
-                default:
-                        SEXP_free (val);
-                        SEXP_free (ent);
-                        free (request_st.name);
-                        return (PROBE_EOPNOTSUPP);
-                }
-
-                SEXP_free (val);
-        }
+	/*
+	 * Parse behaviors
+	 */
+	if (oval_schema_version_cmp(over, OVAL_SCHEMA_VERSION(5.10)) >= 0) {
+		bh_ent = probe_obj_getent(probe_in, "behaviors", 1);
+		if (bh_ent != NULL) {
+			SEXP_t *bh_value = probe_ent_getattrval(bh_ent, "filepaths");
+
+			if (bh_value != NULL) {
+				filepaths = SEXP_strcmp(bh_value, "true") == 0;
+				SEXP_free(bh_value);
+			}
+			SEXP_free(bh_ent);
+		}
+	}
 
-        if (request_st.name == NULL) {
-		SEXP_free (ent);
-                switch (errno) {
-                case EINVAL:
-                        dD("%s: invalid value type", "name");
-			return PROBE_EINVAL;
-                        break;
-                case EFAULT:
-                        dD("%s: element not found", "name");
-			return PROBE_ENOELM;
-                        break;
-		default:
-			return PROBE_EUNKNOWN;
-                }
-        }
+	/* get info from the RPM db snapshot */
+	snapshot = rpm_snapshot_get(g_rpm);
+	if (snapshot == NULL) {
+		dD("rpm_snapshot_get failed");
+		probe_cobj_set_flag(probe_ctx_getresult(ctx), SYSCHAR_FLAG_ERROR);
+		SEXP_free(ent);
+		return 0;
+	}
 
-        reply_st  = NULL;
-
-        /* get info from RPM db */
-	switch (rpmret = get_rpminfo(&request_st, &reply_st, g_rpm)) {
-        case 0: /* Not found */
-                dI("Package \"%s\" not found.", request_st.name);
-                break;
-        case -1: /* Error */
-                dD("get_rpminfo failed");
-
-                item = probe_item_create(OVAL_LINUX_RPM_INFO, NULL,
-                                         "name", OVAL_DATATYPE_STRING, request_st.name,
-                                         NULL);
-
-                probe_item_setstatus (item, SYSCHAR_STATUS_ERROR);
-                probe_item_collect(ctx, item);
-                break;
-        default: /* Ok */
-                _A(rpmret   >= 0);
-                _A(reply_st != NULL);
-                {
-                        SEXP_t *name;
-
-                        for (i = 0; i < rpmret; ++i) {
-				name = SEXP_string_newf("%s", reply_st[i].name);
-
-				if (probe_entobj_cmp(ent, name) != OVAL_RESULT_TRUE) {
-					SEXP_free(name);
-					continue;
-				}
-
-                                item = probe_item_create(OVAL_LINUX_RPM_INFO, NULL,
-                                                         "name",    OVAL_DATATYPE_SEXP, name,
-                                                         "arch",    OVAL_DATATYPE_STRING, reply_st[i].arch,
-                                                         "epoch",   OVAL_DATATYPE_STRING, reply_st[i].epoch,
-                                                         "release", OVAL_DATATYPE_STRING, reply_st[i].release,
-                                                         "version", OVAL_DATATYPE_STRING, reply_st[i].version,
-                                                         "evr",     OVAL_DATATYPE_EVR_STRING, reply_st[i].evr,
-                                                         "signature_keyid", OVAL_DATATYPE_STRING, reply_st[i].signature_keyid,
-                                                         NULL);
-
-				/* OVAL 5.10 added extended_name and filepaths behavior */
-				if (oval_schema_version_cmp(over, OVAL_SCHEMA_VERSION(5.10)) >= 0) {
-					SEXP_t *value, *bh_value;
-					value = probe_entval_from_cstr(
-							OVAL_DATATYPE_STRING,
-							reply_st[i].extended_name,
-							strlen(reply_st[i].extended_name)
-					);
-					probe_item_ent_add(item, "extended_name", NULL, value);
-					SEXP_free(value);
-
-					/*
-					 * Parse behaviors
-					 */
-					value = probe_obj_getent(probe_in, "behaviors", 1);
-					if (value != NULL) {
-						bh_value = probe_ent_getattrval(value, "filepaths");
-						if (bh_value != NULL) {
-							if (SEXP_strcmp(bh_value, "true") == 0) {
-								/* collect package files */
-								collect_rpm_files(item, &reply_st[i], g_rpm);
-
-							}
-							SEXP_free(bh_value);
-						}
-						SEXP_free(value);
-					}
-
-				}
-
-
-				SEXP_free(name);
-                                __rpminfo_rep_free (&(reply_st[i]));
-
-				if (probe_item_collect(ctx, item) < 0) {
-					SEXP_free(ent);
-					return PROBE_EUNKNOWN;
-				}
-                        }
-
-                        free (reply_st);
-                }
-        }
+	if (op == OVAL_OPERATION_EQUALS) {
+		ret = collect_rpm_equals(ctx, ent, g_rpm, snapshot, over, filepaths);
+	} else {
+		ret = collect_rpm_all(ctx, ent, op, g_rpm, snapshot, over, filepaths);
+	}
 
+	rpm_snapshot_put(g_rpm, snapshot);
 	SEXP_free(ent);
-        free(request_st.name);
 
-        return 0;
+        return ret;
 }
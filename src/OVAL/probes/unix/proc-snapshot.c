@@ -0,0 +1,598 @@
+/*
+ * Copyright 2026 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#if defined(OS_LINUX)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#ifdef SELINUX_FOUND
+#include <selinux/selinux.h>
+#include <selinux/context.h>
+#endif
+
+#include "_seap.h"
+#include "common/debug_priv.h"
+#include "common/list.h"
+#include "oscap_parallel.h"
+#include "proc-snapshot.h"
+
+#define PROC_SNAPSHOT_THREADS_MAX 4
+/* Processes read by one job of the parallel collection */
+#define PROC_SNAPSHOT_CHUNK 32
+
+/* Parts of a process which are read on first use */
+struct proc_snapshot_lazy {
+	bool exec_shield_loaded;
+	int exec_shield;
+	bool label_loaded;
+	char *label;
+};
+
+struct proc_snapshot {
+	int refs;
+	pthread_mutex_t lock;
+	bool loaded;
+	int status;
+	char *root;
+	unsigned long boot_time;
+	struct proc_snapshot_process *procs;
+	size_t count;
+	/* comm and command line -> the first process of that name */
+	struct oscap_htable *comms;
+	struct oscap_htable *command_lines;
+	struct proc_snapshot_lazy *lazy;
+};
+
+static pthread_mutex_t shared_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct proc_snapshot *shared = NULL;
+
+struct proc_snapshot *proc_snapshot_acquire(void)
+{
+	pthread_mutex_lock(&shared_lock);
+	if (shared == NULL) {
+		shared = calloc(1, sizeof(struct proc_snapshot));
+		if (shared == NULL) {
+			pthread_mutex_unlock(&shared_lock);
+			return NULL;
+		}
+		pthread_mutex_init(&shared->lock, NULL);
+	}
+	shared->refs++;
+	pthread_mutex_unlock(&shared_lock);
+	return shared;
+}
+
+void proc_snapshot_release(struct proc_snapshot *snapshot)
+{
+	if (snapshot == NULL)
+		return;
+
+	pthread_mutex_lock(&shared_lock);
+	if (--snapshot->refs > 0) {
+		pthread_mutex_unlock(&shared_lock);
+		return;
+	}
+	shared = NULL;
+	pthread_mutex_unlock(&shared_lock);
+
+	for (size_t i = 0; i < snapshot->count; ++i) {
+		free(snapshot->procs[i].command_line);
+		if (snapshot->lazy != NULL)
+			free(snapshot->lazy[i].label);
+	}
+	oscap_htable_free(snapshot->comms, free);
+	oscap_htable_free(snapshot->command_lines, free);
+	free(snapshot->lazy);
+	free(snapshot->procs);
+	free(snapshot->root);
+	pthread_mutex_destroy(&snapshot->lock);
+	free(snapshot);
+}
+
+/*
+ * Read the whole file into a NUL terminated buffer.
+ * @return NULL if the file can't be read
+ */
+static char *read_file(const char *path, size_t *length)
+{
+	size_t size = 4096, len = 0;
+	char *buf;
+	int fd;
+
+	fd = open(path, O_RDONLY | O_CLOEXEC, 0);
+	if (fd < 0)
+		return NULL;
+	buf = malloc(size);
+	for (;;) {
+		ssize_t n = read(fd, buf + len, size - len - 1);
+		if (n < 0) {
+			if (errno == EINTR)
+				continue;
+			close(fd);
+			free(buf);
+			return NULL;
+		}
+		if (n == 0)
+			break;
+		len += n;
+		if (len + 1 == size) {
+			size *= 2;
+			buf = realloc(buf, size);
+		}
+	}
+	close(fd);
+	buf[len] = 0;
+	if (length != NULL)
+		*length = len;
+	return buf;
+}
+
+/*
+ * Make the command line look like the ps command shows it: the program
+ * and its arguments separated by spaces, non-printable characters
+ * replaced with '.' (LC_ALL=C).
+ */
+static bool format_cmdline(char *buf, size_t length)
+{
+	if (length == 0)
+		return false;
+
+	// Skip multiple trailing zeros
+	size_t i = length - 1;
+	while (i > 0 && buf[i] == '\0')
+		--i;
+
+	for (;;) {
+		char chr = buf[i];
+		if (chr == '\0' || chr == '\n')
+			buf[i] = ' ';
+		else if (!isprint(chr))
+			buf[i] = '.';
+		if (i == 0)
+			break;
+		--i;
+	}
+	return true;
+}
+
+static bool read_process(const char *root, pid_t pid, struct proc_snapshot_process *proc)
+{
+	char path[PATH_MAX], buf[4096];
+	char *tmp, *data;
+	int fd, len, pgrp, tpgid;
+	unsigned flags;
+	unsigned long minflt, cminflt, majflt, cmajflt;
+	long cutime, cstime, cnice, nthreads, itrealvalue;
+	size_t length;
+
+	// Parse up the stat file for the proc
+	snprintf(path, sizeof(path), "%s/proc/%d/stat", root, pid);
+	fd = open(path, O_RDONLY | O_CLOEXEC, 0);
+	if (fd < 0)
+		return false;
+	len = read(fd, buf, sizeof(buf) - 1);
+	close(fd);
+	if (len < 40)
+		return false;
+	buf[len] = 0;
+	tmp = strrchr(buf, ')');
+	if (tmp)
+		*tmp = 0;
+	else
+		return false;
+	memset(proc->comm, 0, sizeof(proc->comm));
+	sscanf(buf, "%d (%15c", &proc->ppid, proc->comm);
+	sscanf(tmp+2,	"%c %d %d %d %d %d "
+			"%u %lu %lu %lu %lu "
+			"%lu %lu %lu %ld %ld "
+			"%ld %ld %ld %llu",
+		&proc->state, &proc->ppid, &pgrp, &proc->session, &proc->tty_nr, &tpgid,
+		&flags, &minflt, &cminflt, &majflt, &cmajflt,
+		&proc->utime, &proc->stime, &cutime, &cstime, &proc->priority,
+		&cnice, &nthreads, &itrealvalue, &proc->start
+	);
+
+	// Skip kthreads
+	if (proc->ppid == 2)
+		return false;
+	proc->pid = pid;
+
+	if (proc->state == 'Z') { // zombie
+		proc->command_line = malloc(sizeof(proc->comm) + 12);
+		sprintf(proc->command_line, "[%s] <defunct>", proc->comm);
+	} else {
+		snprintf(path, sizeof(path), "%s/proc/%d/cmdline", root, pid);
+		data = read_file(path, &length);
+		if (data != NULL && format_cmdline(data, length)) {
+			proc->command_line = data; // use full cmdline
+		} else {
+			free(data);
+			proc->command_line = strdup(proc->comm);
+		}
+	}
+
+	proc->ruid = -1;
+	proc->euid = -1;
+	snprintf(path, sizeof(path), "%s/proc/%d/status", root, pid);
+	data = read_file(path, NULL);
+	if (data != NULL) {
+		tmp = strstr(data, "\nUid:");
+		if (tmp != NULL)
+			sscanf(tmp + 1, "Uid: %d %d", &proc->ruid, &proc->euid);
+		tmp = strstr(data, "\nCapEff:");
+		if (tmp != NULL)
+			proc->has_cap_eff = sscanf(tmp + 1, "CapEff: %" SCNx64, &proc->cap_eff) == 1;
+		free(data);
+	}
+
+	proc->loginuid = -1;
+	snprintf(path, sizeof(path), "%s/proc/%d/loginuid", root, pid);
+	fd = open(path, O_RDONLY | O_CLOEXEC, 0);
+	if (fd >= 0) {
+		len = read(fd, buf, sizeof(buf) - 1);
+		close(fd);
+		buf[len > 0 ? len : 0] = 0;
+		if (sscanf(buf, "%u", &proc->loginuid) < 1)
+			dW("sscanf failed from %s", path);
+	}
+
+	return true;
+}
+
+struct proc_snapshot_job {
+	const char *root;
+	const pid_t *pids;
+	struct proc_snapshot_process *procs;
+	bool *valid;
+	size_t count;
+};
+
+static void read_processes(size_t index, void *arg)
+{
+	struct proc_snapshot_job *job = arg;
+	size_t end = (index + 1) * PROC_SNAPSHOT_CHUNK;
+
+	if (end > job->count)
+		end = job->count;
+	for (size_t i = index * PROC_SNAPSHOT_CHUNK; i < end; ++i)
+		job->valid[i] = read_process(job->root, job->pids[i], &job->procs[i]);
+}
+
+static unsigned long read_boot_time(const char *root)
+{
+	char path[PATH_MAX];
+	unsigned long boot = 0;
+	char *data, *tmp;
+
+	snprintf(path, sizeof(path), "%s/proc/stat", root);
+	data = read_file(path, NULL);
+	if (data == NULL)
+		return 0;
+	tmp = strstr(data, "\nbtime");
+	if (tmp != NULL)
+		sscanf(tmp + 1, "btime %lu", &boot);
+	free(data);
+	return boot;
+}
+
+static int compare_pid(const void *a, const void *b)
+{
+	const struct proc_snapshot_process *p1 = a, *p2 = b;
+
+	return (p1->pid > p2->pid) - (p1->pid < p2->pid);
+}
+
+/* The processes of one name */
+struct proc_snapshot_chain {
+	struct proc_snapshot_process *first;
+	const struct proc_snapshot_process **last_next;
+};
+
+static void index_add(struct oscap_htable *index, const char *name, struct proc_snapshot_process *proc,
+                      const struct proc_snapshot_process **next)
+{
+	struct proc_snapshot_chain *chain = oscap_htable_get(index, name);
+
+	if (chain == NULL) {
+		chain = malloc(sizeof(struct proc_snapshot_chain));
+		chain->first = proc;
+		oscap_htable_add(index, name, chain);
+	} else {
+		*chain->last_next = proc;
+	}
+	chain->last_next = next;
+}
+
+static unsigned int snapshot_threads(void)
+{
+	unsigned int ncpus = oscap_parallel_ncpus();
+
+	return oscap_parallel_jobs_from_env("OSCAP_PROBE_PROC_THREADS",
+		ncpus < PROC_SNAPSHOT_THREADS_MAX ? ncpus : PROC_SNAPSHOT_THREADS_MAX);
+}
+
+static int read_snapshot(struct proc_snapshot *snapshot)
+{
+	struct proc_snapshot_job job;
+	char path[PATH_MAX];
+	struct dirent *ent;
+	pid_t *pids = NULL;
+	size_t count = 0, size = 0, j = 0;
+	DIR *d;
+
+	const char *prefix = getenv("OSCAP_PROBE_ROOT");
+	snapshot->root = strdup(prefix ? prefix : "");
+	snprintf(path, sizeof(path), "%s/proc", snapshot->root);
+	d = opendir(path);
+	if (d == NULL)
+		return -1;
+
+	while (( ent = readdir(d) )) {
+		pid_t pid;
+
+		// Skip non-process dir entries
+		if(*ent->d_name<'0' || *ent->d_name>'9')
+			continue;
+		errno = 0;
+		pid = strtol(ent->d_name, NULL, 10);
+		if (errno || pid == 2) // skip err & kthreads
+			continue;
+		if (count == size) {
+			size = size ? 2 * size : 1024;
+			pids = realloc(pids, size * sizeof(pid_t));
+		}
+		pids[count++] = pid;
+	}
+	closedir(d);
+
+	snapshot->boot_time = read_boot_time(snapshot->root);
+	snapshot->procs = calloc(count + 1, sizeof(struct proc_snapshot_process));
+	job.root = snapshot->root;
+	job.pids = pids;
+	job.procs = snapshot->procs;
+	job.valid = calloc(count + 1, sizeof(bool));
+	job.count = count;
+	oscap_parallel_for((count + PROC_SNAPSHOT_CHUNK - 1) / PROC_SNAPSHOT_CHUNK,
+		snapshot_threads(), read_processes, &job);
+
+	// Drop the processes which have ended or turned out to be kthreads
+	for (size_t i = 0; i < count; ++i) {
+		if (!job.valid[i]) {
+			free(snapshot->procs[i].command_line);
+			continue;
+		}
+		if (i != j)
+			snapshot->procs[j] = snapshot->procs[i];
+		j++;
+	}
+	snapshot->count = j;
+	free(job.valid);
+	free(pids);
+
+	qsort(snapshot->procs, snapshot->count, sizeof(struct proc_snapshot_process), compare_pid);
+	snapshot->lazy = calloc(snapshot->count + 1, sizeof(struct proc_snapshot_lazy));
+	snapshot->comms = oscap_htable_new1(strcmp, snapshot->count + 1);
+	snapshot->command_lines = oscap_htable_new1(strcmp, snapshot->count + 1);
+	// Chain the processes of the same name in the order of pids
+	for (size_t i = 0; i < snapshot->count; ++i) {
+		struct proc_snapshot_process *proc = &snapshot->procs[i];
+
+		index_add(snapshot->comms, proc->comm, proc, &proc->next_comm);
+		index_add(snapshot->command_lines, proc->command_line, proc, &proc->next_command_line);
+	}
+	return 0;
+}
+
+int proc_snapshot_load(struct proc_snapshot *snapshot)
+{
+	pthread_mutex_lock(&snapshot->lock);
+	if (!snapshot->loaded) {
+		snapshot->status = read_snapshot(snapshot);
+		snapshot->loaded = true;
+		dI("Read %zu processes from '%s/proc'.", snapshot->count, snapshot->root);
+	}
+	pthread_mutex_unlock(&snapshot->lock);
+	return snapshot->status;
+}
+
+unsigned long proc_snapshot_boot_time(struct proc_snapshot *snapshot)
+{
+	proc_snapshot_load(snapshot);
+	return snapshot->boot_time;
+}
+
+size_t proc_snapshot_count(struct proc_snapshot *snapshot)
+{
+	proc_snapshot_load(snapshot);
+	return snapshot->count;
+}
+
+const struct proc_snapshot_process *proc_snapshot_get(struct proc_snapshot *snapshot, size_t index)
+{
+	if (index >= proc_snapshot_count(snapshot))
+		return NULL;
+	return &snapshot->procs[index];
+}
+
+const struct proc_snapshot_process *proc_snapshot_find_pid(struct proc_snapshot *snapshot, pid_t pid)
+{
+	struct proc_snapshot_process key;
+
+	if (proc_snapshot_count(snapshot) == 0)
+		return NULL;
+	key.pid = pid;
+	return bsearch(&key, snapshot->procs, snapshot->count, sizeof(struct proc_snapshot_process), compare_pid);
+}
+
+const struct proc_snapshot_process *proc_snapshot_find_comm(struct proc_snapshot *snapshot, const char *comm)
+{
+	struct proc_snapshot_chain *chain;
+
+	if (proc_snapshot_count(snapshot) == 0)
+		return NULL;
+	chain = oscap_htable_get(snapshot->comms, comm);
+	return chain != NULL ? chain->first : NULL;
+}
+
+const struct proc_snapshot_process *proc_snapshot_find_command_line(struct proc_snapshot *snapshot, const char *command_line)
+{
+	struct proc_snapshot_chain *chain;
+
+	if (proc_snapshot_count(snapshot) == 0)
+		return NULL;
+	chain = oscap_htable_get(snapshot->command_lines, command_line);
+	return chain != NULL ? chain->first : NULL;
+}
+
+/* get exec shield status according to http://people.redhat.com/sgrubb/files/lsexec
+ * return value: -1 - not detected, 0 - disabled, 1 - enabled */
+static int get_exec_shield_status(const char *root, int pid) {
+	char buf[PATH_MAX];
+	FILE *sf;
+	long unsigned low, high, inode;
+	long long unsigned offset;
+	int dev_min, dev_maj;
+	char perm[3], trim;
+	int ret = -1, read_items;
+
+	snprintf(buf, sizeof(buf), "%s/proc/%d/maps", root, pid);
+	sf = fopen(buf, "rt");
+	if (sf) {
+		while (fgets(buf, 500, sf)) {
+			read_items = sscanf(
+				buf, "%lx-%lx rw%s %llx %x:%x %lu %c\n",
+				&low, &high, perm, &offset, &dev_min,
+				&dev_maj, &inode, &trim
+			);
+			if (read_items == 7) {
+				if (perm[0] == 'x' && offset != 0) {
+					ret = 0;
+				}
+				else {
+					ret = 1;
+				}
+			}
+		}
+		fclose(sf);
+	}
+
+	return ret;
+}
+
+int proc_snapshot_exec_shield(struct proc_snapshot *snapshot, const struct proc_snapshot_process *proc)
+{
+	struct proc_snapshot_lazy *lazy = &snapshot->lazy[proc - snapshot->procs];
+	int ret;
+
+	pthread_mutex_lock(&snapshot->lock);
+	if (!lazy->exec_shield_loaded) {
+		lazy->exec_shield = get_exec_shield_status(snapshot->root, proc->pid);
+		lazy->exec_shield_loaded = true;
+	}
+	ret = lazy->exec_shield;
+	pthread_mutex_unlock(&snapshot->lock);
+	return ret;
+}
+
+#ifdef SELINUX_FOUND
+static char *get_selinux_label(int pid) {
+	char *selinux_label;
+	char *pid_context;
+	context_t context;
+
+	if (is_selinux_enabled() == 1) {
+		if (getpidcon(pid, &pid_context) == -1) {
+			/* error getting pid selinux context */
+			dW("Can't get selinux context for process %d", pid);
+			return NULL;
+		}
+		context = context_new(pid_context);
+		if (context == NULL) {
+			// There must be 3 or 4 colon-separated components and no
+			// whitespace in any component other than the MLS
+			// component.
+			freecon(pid_context);
+			return NULL;
+		}
+		selinux_label = strdup(context_type_get(context));
+		context_free(context);
+		freecon(pid_context);
+		return selinux_label;
+	} else {
+		return NULL;
+	}
+}
+#else
+static char *get_selinux_label(int pid) {
+	return NULL;
+}
+#endif /* SELINUX_FOUND */
+
+const char *proc_snapshot_selinux_label(struct proc_snapshot *snapshot, const struct proc_snapshot_process *proc)
+{
+	struct proc_snapshot_lazy *lazy = &snapshot->lazy[proc - snapshot->procs];
+	const char *ret;
+
+	pthread_mutex_lock(&snapshot->lock);
+	if (!lazy->label_loaded) {
+		lazy->label = get_selinux_label(proc->pid);
+		lazy->label_loaded = true;
+	}
+	ret = lazy->label;
+	pthread_mutex_unlock(&snapshot->lock);
+	return ret;
+}
+
+SEXP_t *proc_snapshot_ent_equals(SEXP_t *ent, oval_datatype_t type)
+{
+	SEXP_t *val;
+
+	/* A variable may give more values and var_check decides about them */
+	if (ent == NULL || probe_ent_attrexists(ent, "var_ref"))
+		return NULL;
+	if (probe_ent_getoperation(ent, OVAL_OPERATION_EQUALS) != OVAL_OPERATION_EQUALS ||
+	    probe_ent_getdatatype(ent) != type)
+		return NULL;
+
+	val = probe_ent_getval(ent);
+	if (val == NULL)
+		return NULL;
+	if ((type == OVAL_DATATYPE_STRING && !SEXP_stringp(val)) ||
+	    (type == OVAL_DATATYPE_INTEGER && !SEXP_numberp(val))) {
+		SEXP_free(val);
+		return NULL;
+	}
+	return val;
+}
+
+#endif /* OS_LINUX */
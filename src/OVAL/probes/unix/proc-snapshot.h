@@ -0,0 +1,113 @@
+/*
+ * Copyright 2026 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef OPENSCAP_PROC_SNAPSHOT_H
+#define OPENSCAP_PROC_SNAPSHOT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#include "probe-api.h"
+
+/*
+ * A process as read from /proc/<pid>/stat, status, cmdline and loginuid.
+ * Kernel threads are not part of the snapshot.
+ */
+struct proc_snapshot_process {
+	pid_t pid;
+	pid_t ppid;
+	char state;
+	int session;
+	int tty_nr;
+	long priority;
+	unsigned long utime;       /* clock ticks */
+	unsigned long stime;       /* clock ticks */
+	unsigned long long start;  /* clock ticks after boot */
+	char comm[16];             /* command name from stat */
+	char *command_line;        /* like ps: the cmdline, "[comm] <defunct>" or comm */
+	int ruid;                  /* -1 if unknown */
+	int euid;                  /* -1 if unknown */
+	unsigned int loginuid;     /* (unsigned int) -1 if unknown */
+	bool has_cap_eff;
+	uint64_t cap_eff;          /* effective capabilities */
+	/* next process of the same comm and command line, in the order of pids */
+	const struct proc_snapshot_process *next_comm;
+	const struct proc_snapshot_process *next_command_line;
+};
+
+/*
+ * Processes of the system, shared by the process, process58 and listener
+ * probes. The table is read once, on its first use, and kept until the
+ * last probe releases it. The memory maps and the SELinux label of a
+ * process are only read when a probe asks for them.
+ */
+struct proc_snapshot;
+
+/*
+ * Get a reference to the shared snapshot.
+ * @return NULL if the snapshot can't be allocated
+ */
+struct proc_snapshot *proc_snapshot_acquire(void);
+
+void proc_snapshot_release(struct proc_snapshot *snapshot);
+
+/*
+ * Read the processes, unless it has been done.
+ * @return -1 if /proc can't be read, 0 otherwise
+ */
+int proc_snapshot_load(struct proc_snapshot *snapshot);
+
+/* Boot time in seconds since the epoch, 0 if unknown */
+unsigned long proc_snapshot_boot_time(struct proc_snapshot *snapshot);
+
+size_t proc_snapshot_count(struct proc_snapshot *snapshot);
+
+/* Processes are ordered by pid */
+const struct proc_snapshot_process *proc_snapshot_get(struct proc_snapshot *snapshot, size_t index);
+
+const struct proc_snapshot_process *proc_snapshot_find_pid(struct proc_snapshot *snapshot, pid_t pid);
+
+/* The first process of the command name, continue with next_comm */
+const struct proc_snapshot_process *proc_snapshot_find_comm(struct proc_snapshot *snapshot, const char *comm);
+
+/* The first process of the command line, continue with next_command_line */
+const struct proc_snapshot_process *proc_snapshot_find_command_line(struct proc_snapshot *snapshot, const char *command_line);
+
+/*
+ * Exec shield status of the process, read from its memory maps.
+ * @return -1 if not detected, 0 if disabled, 1 if enabled
+ */
+int proc_snapshot_exec_shield(struct proc_snapshot *snapshot, const struct proc_snapshot_process *proc);
+
+/*
+ * SELinux domain label of the process.
+ * @return NULL if SELinux is disabled or the label can't be read
+ */
+const char *proc_snapshot_selinux_label(struct proc_snapshot *snapshot, const struct proc_snapshot_process *proc);
+
+/*
+ * Value of an object entity which asks for a single value to be equal,
+ * so the matching processes can be looked up in an index.
+ * @return NULL if the entity does something else
+ */
+SEXP_t *proc_snapshot_ent_equals(SEXP_t *ent, oval_datatype_t type);
+
+#endif /* OPENSCAP_PROC_SNAPSHOT_H */
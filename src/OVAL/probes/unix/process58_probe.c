@@ -59,6 +59,7 @@
 #include <string.h>
 #include <stdio.h>
 #include <errno.h>
+#include <limits.h>
 #ifdef HAVE_STDIO_EXT_H
 # include <stdio_ext.h>
 #endif
@@ -72,10 +73,6 @@
  #include <proc/devname.h>
 #endif
 
-#ifdef SELINUX_FOUND
-#include <selinux/selinux.h>
-#include <selinux/context.h>
-#endif
 #ifdef CAP_FOUND
 #include <ctype.h>
 #include <sys/types.h>
@@ -102,12 +99,12 @@ extern char const *_cap_names[];
 #include "probe/entcmp.h"
 #include "common/debug_priv.h"
 #include <ctype.h>
-#include "common/oscap_buffer.h"
 #include "process58_probe.h"
+#if defined(OS_LINUX)
+#include "proc-snapshot.h"
+#endif
 #include "oscap_helpers.h"
 
-#define CHUNK_SIZE 1024
-
 /* Convenience structure for the results being reported */
 struct result_info {
         const char *command_line;
@@ -156,75 +153,6 @@ static void report_finding(struct result_info *res, probe_ctx *ctx)
 
 static unsigned long ticks, boot;
 
-static void get_boot_time(void)
-{
-	char buf[PATH_MAX];
-	FILE *sf;
-	int line;
-
-	boot = 0;
-	const char *prefix = getenv("OSCAP_PROBE_ROOT");
-	snprintf(buf, sizeof(buf), "%s/proc/stat", prefix ? prefix : "");
-	sf = fopen(buf, "rt");
-	if (sf == NULL)
-		return;
-
-	line = 0;
-	__fsetlocking(sf, FSETLOCKING_BYCALLER);
-	while (fgets(buf, sizeof(buf), sf)) {
-		if (line == 0) {
-			line++;
-			continue;
-		}
-		if (memcmp(buf, "btime", 5) == 0) {
-			sscanf(buf, "btime %lu", &boot);
-			break;
-		}
-	}
-	fclose(sf);
-}
-
-static int get_uids(int pid, struct result_info *r)
-{
-	char buf[PATH_MAX];
-	FILE *sf;
-
-	r->ruid = -1;
-	r->user_id = -1;
-	r->loginuid = -1;
-
-	const char *prefix = getenv("OSCAP_PROBE_ROOT");
-
-	snprintf(buf, sizeof(buf), "%s/proc/%d/status", prefix ? prefix : "", pid);
-	sf = fopen(buf, "rt");
-	if (sf) {
-		int line = 0;
-		__fsetlocking(sf, FSETLOCKING_BYCALLER);
-		while (fgets(buf, sizeof(buf), sf)) {
-			if (line == 0) {
-				line++;
-				continue;
-			}
-			if (memcmp(buf, "Uid:", 4) == 0) {
-				sscanf(buf, "Uid: %d %d", &r->ruid, &r->user_id);
-				break;
-			}
-		}
-		fclose(sf);
-	}
-
-	snprintf(buf, sizeof(buf), "%s/proc/%d/loginuid", prefix ? prefix : "", pid);
-	sf = fopen(buf, "rt");
-	if (sf) {
-		if (fscanf(sf, "%u", &r->loginuid) < 1) {
-			dW("fscanf failed from %s", buf);
-		}
-		fclose(sf);
-	}
-
-	return 0;
-}
-
 static char *convert_time(unsigned long long t, char *tbuf, int tb_size)
 {
 	unsigned d,h,m,s;
@@ -243,71 +171,19 @@ static char *convert_time(unsigned long long t, char *tbuf, int tb_size)
 	return tbuf;
 }
 
-#ifdef SELINUX_FOUND
-static char *get_selinux_label(int pid) {
-	char *selinux_label;
-	char *pid_context;
-	context_t context;
-
-	if (is_selinux_enabled() == 1) {
-		if (getpidcon(pid, &pid_context) == -1) {
-			/* error getting pid selinux context */
-			dW("Can't get selinux context for process %d", pid);
-			return NULL;
-		}
-		context = context_new(pid_context);
-		if (context == NULL) {
-			// There must be 3 or 4 colon-separated components and no
-			// whitespace in any component other than the MLS
-			// component.
-			freecon(pid_context);
-			return NULL;
-		}
-		selinux_label = strdup(context_type_get(context));
-		context_free(context);
-		freecon(pid_context);
-		return selinux_label;
-	} else {
-		return NULL;
-	}
-}
-#else
-static char *get_selinux_label(int pid) {
-	return NULL;
-}
-#endif /* SELINUX_FOUND */
-
-static char **get_posix_capability(int pid, int max_cap_id) {
+static char **get_posix_capability(const struct proc_snapshot_process *proc, int max_cap_id) {
 #ifdef CAP_FOUND
-	cap_t pid_caps;
 	char *cap_name, **ret = NULL;
 	unsigned cap_value, ret_index = 0;
-	cap_flag_value_t cap_flag;
 	int cap_id;
 
-#if LIBCAP_VERSION == 1
-	pid_caps = cap_init();
-	if (capgetp(pid, pid_caps) == -1) {
-		dW("Can't get capabilities for process %d", pid);
-		cap_free(pid_caps);
-		return NULL;
-	}
-#elif LIBCAP_VERSION == 2
-	pid_caps = cap_get_pid(pid);
-#else
-	dW("Can't detect libcap version");
-	return NULL;
-#endif
-
-	if (pid_caps == NULL) {
-		dW("Can't get capabilities for process %d", pid);
+	if (!proc->has_cap_eff) {
+		dW("Can't get capabilities for process %d", proc->pid);
 		return NULL;
 	}
 
 	for (cap_value = 0; cap_value < CAP_LAST_CAP; cap_value++) {
-		if (cap_get_flag(pid_caps, cap_value, CAP_EFFECTIVE, &cap_flag) == -1)
-			continue;
-		if (cap_flag == CAP_SET) {
+		if (proc->cap_eff & (UINT64_C(1) << cap_value)) {
 #if LIBCAP_VERSION == 2
 			cap_name = cap_to_name(cap_value);
 #else
@@ -327,8 +203,7 @@ static char **get_posix_capability(int pid, int max_cap_id) {
 						dE("Unable to re-allocate memory for ret");
 						cap_free(cap_name);
 						free(ret);
-						ret = NULL;
-						goto exit;
+						return NULL;
 					}
 					ret = new_ret;
 					ret[ret_index] = strdup(cap_name);
@@ -342,151 +217,139 @@ static char **get_posix_capability(int pid, int max_cap_id) {
 	if (new_ret == NULL) {
 		dE("Unable to re-allocate memory for ret");
 		free(ret);
-		ret = NULL;
-		goto exit;
+		return NULL;
 	}
 	ret = new_ret;
 	ret[ret_index] = NULL;
 
-exit:
-	cap_free(pid_caps);
 	return ret;
 #else
 	return NULL;
 #endif
 }
 
-/* get exec shield status according to http://people.redhat.com/sgrubb/files/lsexec
- * return value: -1 - not detected, 0 - disabled, 1 - enabled */
-static int get_exec_shield_status(int pid) {
-	char buf[PATH_MAX];
-	FILE *sf;
-	long unsigned low, high, inode;
-	long long unsigned offset;
-	int dev_min, dev_maj;
-	char perm[3], trim;
-	int ret = -1, read_items;
-
-	const char *prefix = getenv("OSCAP_PROBE_ROOT");
-	snprintf(buf, sizeof(buf), "%s/proc/%d/maps", prefix ? prefix : "", pid);
-	sf = fopen(buf, "rt");
-	if (sf) {
-		while (fgets(buf, 500, sf)) {
-			read_items = sscanf(
-				buf, "%lx-%lx rw%s %llx %x:%x %lu %c\n",
-				&low, &high, perm, &offset, &dev_min,
-				&dev_maj, &inode, &trim
-			);
-			if (read_items == 7) {
-				if (perm[0] == 'x' && offset != 0) {
-					ret = 0;
-				}
-				else {
-					ret = 1;
-				}
-			}
+static void collect_process(SEXP_t *cmd_ent, SEXP_t *pid_ent, struct proc_snapshot *snapshot,
+                            const struct proc_snapshot_process *proc, int max_cap_id, probe_ctx *ctx)
+{
+	SEXP_t *cmd_sexp = NULL, *pid_sexp = NULL;
+	unsigned sched_policy;
+	char tty_dev[128];
+
+	cmd_sexp = SEXP_string_newf("%s", proc->command_line);
+	pid_sexp = SEXP_number_newu_32(proc->pid);
+	if ((cmd_sexp == NULL || probe_entobj_cmp(cmd_ent, cmd_sexp) == OVAL_RESULT_TRUE) &&
+	    (pid_sexp == NULL || probe_entobj_cmp(pid_ent, pid_sexp) == OVAL_RESULT_TRUE)
+	) {
+		struct result_info r;
+		unsigned long t = proc->utime/ticks + proc->stime/ticks;
+		char tbuf[32], sbuf[32], **posix_capabilities;
+		int tday,tyear;
+		time_t s_time;
+		struct tm *proc_tm, *now;
+		const char *fmt;
+
+		// Now get scheduler policy
+		sched_policy = sched_getscheduler(proc->pid);
+		switch (sched_policy) {
+			case SCHED_OTHER:
+				r.scheduling_class = "TS";
+				break;
+			case SCHED_BATCH:
+				r.scheduling_class = "B";
+				break;
+#ifdef SCHED_IDLE
+			case SCHED_IDLE:
+				r.scheduling_class = "#5";
+				break;
+#endif
+			case SCHED_FIFO:
+				r.scheduling_class = "FF";
+				break;
+			case SCHED_RR:
+				r.scheduling_class = "RR";
+				break;
+			default:
+				r.scheduling_class = "?";
+				break;
 		}
-		fclose(sf);
-	}
-
-	return ret;
-}
-
-/**
- * Parse /proc/%d/cmdline file
- * @param filepath Path to file ~ use preallocated buffer for the path
- * @param buffer output buffer with non-zero size
- * @return ps-like command info or NULL
- */
-static inline bool get_process_cmdline(const char* filepath, struct oscap_buffer* const buffer){
-
-	int fd = open(filepath, O_RDONLY, 0);
-
-	if (fd < 0) {
-		return false;
-	}
-
-	oscap_buffer_clear(buffer);
-
 
+		// Calculate the start time
+		s_time = time(NULL);
+		now = localtime(&s_time);
+		tyear = now->tm_year;
+		tday = now->tm_yday;
+		s_time = boot + (proc->start / ticks);
+		proc_tm = localtime(&s_time);
+
+		// Select format based on how long we've been running
+		//
+		// FROM THE SPEC:
+		// "This is the time of day the process started formatted in HH:MM:SS if
+		// the same day the process started or formatted as MMM_DD (Ex.: Feb_5)
+		// if process started the previous day or further in the past."
+		//
+		if (tday != proc_tm->tm_yday || tyear != proc_tm->tm_year)
+			fmt = "%b_%d";
+		else
+			fmt = "%H:%M:%S";
+		strftime(sbuf, sizeof(sbuf), fmt, proc_tm);
 
-	for(;;) {
-		char chunk[CHUNK_SIZE];
-		// Read data, store to buffer
-		ssize_t read_size = read(fd, chunk, CHUNK_SIZE);
-		if (read_size < 0) {
-			close(fd);
-			return false;
-		}
-		oscap_buffer_append_binary_data(buffer, chunk, read_size);
+		r.command_line = proc->command_line;
+		r.exec_time = convert_time(t, tbuf, sizeof(tbuf));
+		r.pid = proc->pid;
+		r.ppid = proc->ppid;
+		r.priority = proc->priority;
+		r.start_time = sbuf;
 
-		// If reach end of file, then end the loop
-		if (CHUNK_SIZE != read_size) {
-			break;
-		}
-	}
+		dev_to_tty(tty_dev, sizeof(tty_dev), (dev_t) proc->tty_nr, proc->pid, ABBREV_DEV);
+		r.tty = tty_dev;
 
-	close(fd);
+		r.exec_shield = (proc_snapshot_exec_shield(snapshot, proc) > 0);
+		r.selinux_domain_label = proc_snapshot_selinux_label(snapshot, proc);
 
-	int length = oscap_buffer_get_length(buffer);
-	char* buffer_mem = oscap_buffer_get_raw(buffer);
+		posix_capabilities = get_posix_capability(proc, max_cap_id);
+		r.posix_capability = posix_capabilities;
 
-	if ( length == 0 ) { // empty file
-		return false;
-	} else {
+		r.session_id = proc->session;
 
-		// Skip multiple trailing zeros
-		int i = length - 1;
-		while ( (i > 0) && (buffer_mem[i] == '\0') ) {
-			--i;
-		}
+		r.ruid = proc->ruid;
+		r.user_id = proc->euid;
+		r.loginuid = proc->loginuid;
+		report_finding(&r, ctx);
 
-		// Program and args are separated by '\0'
-		// Replace them with spaces ' '
-		while( i >= 0 ){
-			char chr = buffer_mem[i];
-			if ( ( chr == '\0') || ( chr == '\n' ) ) {
-				buffer_mem[i] = ' ';
-			} else if ( !isprint(chr) ) { // "ps" replace non-printable characters with '.' (LC_ALL=C)
-				buffer_mem[i] = '.';
-			}
-			--i;
+		if (posix_capabilities != NULL) {
+			char **posix_capabilities_p = posix_capabilities;
+			while (*posix_capabilities_p)
+				free(*posix_capabilities_p++);
+			free(posix_capabilities);
 		}
 	}
-	return true;
+	SEXP_free(cmd_sexp);
+	SEXP_free(pid_sexp);
 }
 
-/**
- * Make "[%s] <defunct>" from cmd string - inplace
- * @param cmd_buffer @see read_process() > cmd_buffer
- * @return pointer to start of string
- */
-static inline char *make_defunc_str(char* const cmd_buffer){
-	static const char DEFUNC_STR[] = "] <defunct>";
-
-	size_t len = strlen(cmd_buffer);
-	memcpy(cmd_buffer + len, DEFUNC_STR, sizeof(DEFUNC_STR));
-	return cmd_buffer;
-}
-
-static int read_process(SEXP_t *cmd_ent, SEXP_t *pid_ent, probe_ctx *ctx)
+static int read_process(SEXP_t *cmd_ent, SEXP_t *pid_ent, struct proc_snapshot *snapshot, probe_ctx *ctx)
 {
-	char buf[PATH_MAX];
+	const struct proc_snapshot_process *proc;
+	SEXP_t *cmd_val, *pid_val;
 	int max_cap_id;
-	DIR *d;
-	struct dirent *ent;
 	oval_schema_version_t oval_version;
 
 	const char *prefix = getenv("OSCAP_PROBE_ROOT");
-	snprintf(buf, PATH_MAX, "%s/proc", prefix ? prefix : "");
-	d = opendir(buf);
-	if (d == NULL) {
+	if (proc_snapshot_load(snapshot) < 0) {
+		return prefix ? PROBE_ESUCCESS : PROBE_EACCESS;
+	}
+
+	if (proc_snapshot_count(snapshot) == 0) {
+		dW("No data about processes could be read from '%s/proc'.", prefix ? prefix : "");
+		// In offline mode, empty /proc might be a normal situation and doesn't
+		// have to mean permissions problems
 		return prefix ? PROBE_ESUCCESS : PROBE_EACCESS;
 	}
 
 	// Get the time tick hertz
 	ticks = (unsigned long)sysconf(_SC_CLK_TCK);
-	get_boot_time();
+	boot = proc_snapshot_boot_time(snapshot);
 
 	oval_version = probe_obj_get_platform_schema_version(probe_ctx_getobject(ctx));
 	if (oval_schema_version_cmp(oval_version, OVAL_SCHEMA_VERSION(5.11)) < 0) {
@@ -495,182 +358,33 @@ static int read_process(SEXP_t *cmd_ent, SEXP_t *pid_ent, probe_ctx *ctx)
 		max_cap_id = OVAL_5_11_MAX_CAP_ID;
 	}
 
-	struct oscap_buffer *cmdline_buffer = oscap_buffer_new();
-	
-	char cmd_buffer[1 + 15 + 11 + 1]; // Format:" [ cmd:15 ] <defunc>"
-	cmd_buffer[0] = '[';
-
-	// Scan the directories
-	bool any_pid_dir_found = false;
-	while (( ent = readdir(d) )) {
-		int fd, len;
-		char *tmp, state, tty_dev[128];
-		int pid, ppid, pgrp, session, tty_nr, tpgid;
-		unsigned flags, sched_policy;
-		unsigned long minflt, cminflt, majflt, cmajflt, uutime, ustime;
-		long cutime, cstime, priority, cnice, nthreads, itrealvalue;
-		unsigned long long start;
-		SEXP_t *cmd_sexp = NULL, *pid_sexp = NULL;
-
-		// Skip non-process58 dir entries
-		if(*ent->d_name<'0' || *ent->d_name>'9')
-			continue;
-		errno = 0;
-		pid = strtol(ent->d_name, NULL, 10);
-		if (errno || pid == 2) // skip err & kthreads
-			continue;
-
-		// Parse up the stat file for the proc
-		snprintf(buf, PATH_MAX, "%s/proc/%d/stat", prefix ? prefix : "", pid);
-		fd = open(buf, O_RDONLY, 0);
-		if (fd < 0)
-			continue;
-		len = read(fd, buf, sizeof buf - 1);
-		close(fd);
-		if (len < 40)
-			continue;
-		buf[len] = 0;
-		tmp = strrchr(buf, ')');
-		if (tmp)
-			*tmp = 0;
-		else
-			continue;
-		memset(cmd_buffer + 1, 0, sizeof(cmd_buffer)-1); // clear cmd after starting '['
-		sscanf(buf, "%d (%15c", &ppid, cmd_buffer + 1);
-		sscanf(tmp+2,	"%c %d %d %d %d %d "
-				"%u %lu %lu %lu %lu "
-				"%lu %lu %lu %ld %ld "
-				"%ld %ld %ld %llu",
-			&state, &ppid, &pgrp, &session, &tty_nr, &tpgid,
-			&flags, &minflt, &cminflt, &majflt, &cmajflt,
-			&uutime, &ustime, &cutime, &cstime, &priority,
-			&cnice, &nthreads, &itrealvalue, &start
-		);
-
-		// Skip kthreads
-		if (ppid == 2)
-			continue;
-
-		const char* cmd;
-		if (state == 'Z') { // zombie
-			cmd = make_defunc_str(cmd_buffer);
-		} else {
-			snprintf(buf, PATH_MAX, "%s/proc/%d/cmdline", prefix ? prefix : "", pid);
-			if (get_process_cmdline(buf, cmdline_buffer)) {
-				cmd = oscap_buffer_get_raw(cmdline_buffer); // use full cmdline
-			} else {
-				cmd = cmd_buffer + 1;
-			}
-		}
-
-		any_pid_dir_found = true;
-		cmd_sexp = SEXP_string_newf("%s", cmd);
-		pid_sexp = SEXP_number_newu_32(pid);
-		if ((cmd_sexp == NULL || probe_entobj_cmp(cmd_ent, cmd_sexp) == OVAL_RESULT_TRUE) &&
-		    (pid_sexp == NULL || probe_entobj_cmp(pid_ent, pid_sexp) == OVAL_RESULT_TRUE)
-		) {
-			struct result_info r;
-			unsigned long t = uutime/ticks + ustime/ticks;
-			char tbuf[32], sbuf[32], *selinux_domain_label, **posix_capabilities;
-			int tday,tyear;
-			time_t s_time;
-			struct tm *proc, *now;
-			const char *fmt;
-
-			// Now get scheduler policy
-			sched_policy = sched_getscheduler(pid);
-			switch (sched_policy) {
-				case SCHED_OTHER:
-					r.scheduling_class = "TS";
-					break;
-				case SCHED_BATCH:
-					r.scheduling_class = "B";
-					break;
-#ifdef SCHED_IDLE
-				case SCHED_IDLE:
-					r.scheduling_class = "#5";
-					break;
-#endif
-				case SCHED_FIFO:
-					r.scheduling_class = "FF";
-					break;
-				case SCHED_RR:
-					r.scheduling_class = "RR";
-					break;
-				default:
-					r.scheduling_class = "?";
-					break;
-			}
-
-			// Calculate the start time
-			s_time = time(NULL);
-			now = localtime(&s_time);
-			tyear = now->tm_year;
-			tday = now->tm_yday;
-			s_time = boot + (start / ticks);
-			proc = localtime(&s_time);
-
-			// Select format based on how long we've been running
-			//
-			// FROM THE SPEC:
-			// "This is the time of day the process started formatted in HH:MM:SS if
-			// the same day the process started or formatted as MMM_DD (Ex.: Feb_5)
-			// if process started the previous day or further in the past."
-			//
-			if (tday != proc->tm_yday || tyear != proc->tm_year)
-				fmt = "%b_%d";
-			else
-				fmt = "%H:%M:%S";
-			strftime(sbuf, sizeof(sbuf), fmt, proc);
-
-			r.command_line = cmd;
-			r.exec_time = convert_time(t, tbuf, sizeof(tbuf));
-			r.pid = pid;
-			r.ppid = ppid;
-			r.priority = priority;
-			r.start_time = sbuf;
-
-			dev_to_tty(tty_dev, sizeof(tty_dev), (dev_t) tty_nr, pid, ABBREV_DEV);
-			r.tty = tty_dev;
-
-			r.exec_shield = (get_exec_shield_status(pid) > 0);
-
-			selinux_domain_label = get_selinux_label(pid);
-			r.selinux_domain_label = selinux_domain_label;
+	// Look the candidates up in the indexes if the object asks for equality
+	pid_val = proc_snapshot_ent_equals(pid_ent, OVAL_DATATYPE_INTEGER);
+	if (pid_val != NULL) {
+		int64_t pid = SEXP_number_geti_64(pid_val);
 
-			posix_capabilities = get_posix_capability(pid, max_cap_id);
-			r.posix_capability = posix_capabilities;
-
-			r.session_id = session;
-
-			get_uids(pid, &r);
-			report_finding(&r, ctx);
+		proc = pid > 0 && pid <= INT_MAX ? proc_snapshot_find_pid(snapshot, (pid_t) pid) : NULL;
+		if (proc != NULL)
+			collect_process(cmd_ent, pid_ent, snapshot, proc, max_cap_id, ctx);
+		SEXP_free(pid_val);
+		return PROBE_ESUCCESS;
+	}
 
-			if (selinux_domain_label != NULL)
-				free(selinux_domain_label);
+	cmd_val = proc_snapshot_ent_equals(cmd_ent, OVAL_DATATYPE_STRING);
+	if (cmd_val != NULL) {
+		char *cmd = SEXP_string_cstr(cmd_val);
 
-			if (posix_capabilities != NULL) {
-				char **posix_capabilities_p = posix_capabilities;
-				while (*posix_capabilities_p)
-					free(*posix_capabilities_p++);
-				free(posix_capabilities);
-			}
-		}
-		SEXP_free(cmd_sexp);
-		SEXP_free(pid_sexp);
+		for (proc = proc_snapshot_find_command_line(snapshot, cmd); proc != NULL; proc = proc->next_command_line)
+			collect_process(cmd_ent, pid_ent, snapshot, proc, max_cap_id, ctx);
+		free(cmd);
+		SEXP_free(cmd_val);
+		return PROBE_ESUCCESS;
 	}
-        closedir(d);
-	oscap_buffer_free(cmdline_buffer);
 
-	if (!any_pid_dir_found) {
-		dW("No data about processes could be read from '%s'.", buf);
-	}
-	// In offline mode, empty /proc might be a normal situation and doesn't
-	// have to mean permissions problems
-	if (prefix)
-		return PROBE_ESUCCESS;
-	else
-		return any_pid_dir_found ? PROBE_ESUCCESS : PROBE_EACCESS;
+	for (size_t i = 0; (proc = proc_snapshot_get(snapshot, i)) != NULL; ++i)
+		collect_process(cmd_ent, pid_ent, snapshot, proc, max_cap_id, ctx);
+
+	return PROBE_ESUCCESS;
 }
 
 int process58_probe_offline_mode_supported(void)
@@ -680,15 +394,19 @@ int process58_probe_offline_mode_supported(void)
 
 int process58_probe_main(probe_ctx *ctx, void *arg)
 {
+	struct proc_snapshot *snapshot = arg;
 	SEXP_t *command_line_ent, *pid_ent;
 
+	if (snapshot == NULL)
+		return PROBE_EINIT;
+
 	command_line_ent = probe_obj_getent(probe_ctx_getobject(ctx), "command_line", 1);
 	pid_ent = probe_obj_getent(probe_ctx_getobject(ctx), "pid", 1);
 	if (command_line_ent == NULL && pid_ent == NULL) {
 		return PROBE_ENOVAL;
 	}
 
-	int err = read_process(command_line_ent, pid_ent, ctx);
+	int err = read_process(command_line_ent, pid_ent, snapshot, ctx);
 	if (err) {
 		SEXP_free(command_line_ent);
 		SEXP_free(pid_ent);
@@ -858,3 +576,19 @@ int process58_probe_main(probe_ctx *ctx, void *arg)
 	return 0;
 }
 #endif /* __linux */
+
+void *process58_probe_init(void)
+{
+#if defined(OS_LINUX)
+	return proc_snapshot_acquire();
+#else
+	return NULL;
+#endif
+}
+
+void process58_probe_fini(void *arg)
+{
+#if defined(OS_LINUX)
+	proc_snapshot_release(arg);
+#endif
+}
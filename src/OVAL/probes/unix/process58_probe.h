@@ -27,6 +27,10 @@
 
 int process58_probe_offline_mode_supported(void);
 
+void *process58_probe_init(void);
+
 int process58_probe_main(probe_ctx *ctx, void *arg);
 
+void process58_probe_fini(void *arg);
+
 #endif /* OPENSCAP_PROCESS58_PROBE_H */
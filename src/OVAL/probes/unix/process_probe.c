@@ -56,6 +56,9 @@
 #include "probe/entcmp.h"
 #include "common/debug_priv.h"
 #include "process_probe.h"
+#if defined(OS_LINUX)
+#include "proc-snapshot.h"
+#endif
 #include "oscap_helpers.h"
 
 #if defined(OS_FREEBSD)
@@ -122,61 +125,6 @@ static void report_finding(struct result_info *res, probe_ctx *ctx)
 
 static unsigned long ticks, boot;
 
-static void get_boot_time(void)
-{
-	char buf[100];
-	FILE *sf;
-	int line;
-
-	boot = 0;
-	sf = fopen("/proc/stat", "rt");
-	if (sf == NULL)
-		return;
-
-	line = 0;
-	__fsetlocking(sf, FSETLOCKING_BYCALLER);
-	while (fgets(buf, sizeof(buf), sf)) {
-		if (line == 0) {
-			line++;
-			continue;
-		}
-		if (memcmp(buf, "btime", 5) == 0) {
-			sscanf(buf, "btime %lu", &boot);
-			break;
-		}
-	}
-	fclose(sf);
-}
-
-static int get_uids(int pid, struct result_info *r)
-{
-	char buf[100];
-	FILE *sf;
-
-	r->ruid = -1;
-	r->user_id = -1;
-
-	snprintf(buf, sizeof(buf), "/proc/%d/status", pid);
-	sf = fopen(buf, "rt");
-	if (sf) {
-		int line = 0;
-		__fsetlocking(sf, FSETLOCKING_BYCALLER);
-		while (fgets(buf, sizeof(buf), sf)) {
-			if (line == 0) {
-				line++;
-				continue;
-			}
-			if (memcmp(buf, "Uid:", 4) == 0) {
-				sscanf(buf, "Uid: %d %d", &r->ruid, &r->user_id);
-				break;
-			}
-		}
-		fclose(sf);
-	}
-
-	return 0;
-}
-
 static char *convert_time(unsigned long long t, char *tbuf, int tb_size)
 {
 	unsigned d,h,m,s;
@@ -195,159 +143,130 @@ static char *convert_time(unsigned long long t, char *tbuf, int tb_size)
 	return tbuf;
 }
 
-static int read_process(SEXP_t *cmd_ent, probe_ctx *ctx)
+static void collect_process(SEXP_t *cmd_ent, const struct proc_snapshot_process *proc, probe_ctx *ctx)
 {
-	int err = 1;
-	DIR *d;
-	struct dirent *ent;
-
-	d = opendir("/proc");
-	if (d == NULL)
-		return err;
-
-	// Get the time tick hertz
-	ticks = (unsigned long)sysconf(_SC_CLK_TCK);
-	get_boot_time();
-
-	// Scan the directories
-	while (( ent = readdir(d) )) {
-		int fd, len;
-		char buf[256];
-		char *tmp, cmd[16], state, tty_dev[128];
-		int pid, ppid, pgrp, session, tty_nr, tpgid;
-		unsigned flags, sched_policy;
-		unsigned long minflt, cminflt, majflt, cmajflt, uutime, ustime;
-		long cutime, cstime, priority, cnice, nthreads, itrealvalue;
-		unsigned long long start;
-		SEXP_t *cmd_sexp;
-
-		// Skip non-process dir entries
-		if(*ent->d_name<'0' || *ent->d_name>'9')
-			continue;
-		errno = 0;
-		pid = strtol(ent->d_name, NULL, 10);
-		if (errno || pid == 2) // skip err & kthreads
-			continue;
-
-		// Parse up the stat file for the proc
-		snprintf(buf, 32, "/proc/%d/stat", pid);
-		fd = open(buf, O_RDONLY, 0);
-		if (fd < 0)
-			continue;
-		len = read(fd, buf, sizeof buf - 1);
-		close(fd);
-		if (len < 40)
-			continue;
-		buf[len] = 0;
-		tmp = strrchr(buf, ')');
-		if (tmp)
-			*tmp = 0;
-		else
-			continue;
-		memset(cmd, 0, sizeof(cmd));
-		sscanf(buf, "%d (%15c", &ppid, cmd);
-		sscanf(tmp+2,	"%c %d %d %d %d %d "
-				"%u %lu %lu %lu %lu "
-				"%lu %lu %lu %ld %ld "
-				"%ld %ld %ld %llu",
-			&state, &ppid, &pgrp, &session, &tty_nr, &tpgid,
-			&flags, &minflt, &cminflt, &majflt, &cmajflt,
-			&uutime, &ustime, &cutime, &cstime, &priority,
-			&cnice, &nthreads, &itrealvalue, &start
-		);
-
-		// Skip kthreads
-		if (ppid == 2)
-			continue;
-
-		err = 0; // If we get this far, no permission problems
-		dI("Have command: %s", cmd);
-		cmd_sexp = SEXP_string_newf("%s", cmd);
-		if (probe_entobj_cmp(cmd_ent, cmd_sexp) == OVAL_RESULT_TRUE) {
-			struct result_info r;
-			unsigned long t = uutime/ticks + ustime/ticks;
-			char tbuf[32], sbuf[32];
-			int tday,tyear;
-			time_t s_time;
-			struct tm *proc, *now;
-			const char *fmt;
-
-			// Now get scheduler policy
-			sched_policy = sched_getscheduler(pid);
-			switch (sched_policy) {
-				case SCHED_OTHER:
-					r.scheduling_class = "TS";
-					break;
-				case SCHED_BATCH:
-					r.scheduling_class = "B";
-					break;
+	SEXP_t *cmd_sexp;
+	unsigned sched_policy;
+	char tty_dev[128];
+
+	dI("Have command: %s", proc->comm);
+	cmd_sexp = SEXP_string_newf("%s", proc->comm);
+	if (probe_entobj_cmp(cmd_ent, cmd_sexp) == OVAL_RESULT_TRUE) {
+		struct result_info r;
+		unsigned long t = proc->utime/ticks + proc->stime/ticks;
+		char tbuf[32], sbuf[32];
+		int tday,tyear;
+		time_t s_time;
+		struct tm *proc_tm, *now;
+		const char *fmt;
+
+		// Now get scheduler policy
+		sched_policy = sched_getscheduler(proc->pid);
+		switch (sched_policy) {
+			case SCHED_OTHER:
+				r.scheduling_class = "TS";
+				break;
+			case SCHED_BATCH:
+				r.scheduling_class = "B";
+				break;
 #ifdef SCHED_IDLE
-				case SCHED_IDLE:
-					r.scheduling_class = "#5";
-					break;
+			case SCHED_IDLE:
+				r.scheduling_class = "#5";
+				break;
 #endif
-				case SCHED_FIFO:
-					r.scheduling_class = "FF";
-					break;
-				case SCHED_RR:
-					r.scheduling_class = "RR";
-					break;
-				default:
-					r.scheduling_class = "?";
-					break;
-			}
+			case SCHED_FIFO:
+				r.scheduling_class = "FF";
+				break;
+			case SCHED_RR:
+				r.scheduling_class = "RR";
+				break;
+			default:
+				r.scheduling_class = "?";
+				break;
+		}
 
-			// Calculate the start time
-			s_time = time(NULL);
-			now = localtime(&s_time);
-			tyear = now->tm_year;
-			tday = now->tm_yday;
-			s_time = boot + (start / ticks);
-			proc = localtime(&s_time);
+		// Calculate the start time
+		s_time = time(NULL);
+		now = localtime(&s_time);
+		tyear = now->tm_year;
+		tday = now->tm_yday;
+		s_time = boot + (proc->start / ticks);
+		proc_tm = localtime(&s_time);
+
+		// Select format based on how long we've been running
+		//
+		// FROM THE SPEC:
+		// "This is the time of day the process started formatted in HH:MM:SS if
+		// the same day the process started or formatted as MMM_DD (Ex.: Feb_5)
+		// if process started the previous day or further in the past."
+		//
+		if (tday != proc_tm->tm_yday || tyear != proc_tm->tm_year)
+			fmt = "%b_%d";
+		else
+			fmt = "%H:%M:%S";
+		strftime(sbuf, sizeof(sbuf), fmt, proc_tm);
+
+		r.command = proc->comm;
+		r.exec_time = convert_time(t, tbuf, sizeof(tbuf));
+		r.pid = proc->pid;
+		r.ppid = proc->ppid;
+		r.priority = proc->priority;
+		r.start_time = sbuf;
+
+		dev_to_tty(tty_dev, sizeof(tty_dev), (dev_t) proc->tty_nr, proc->pid, ABBREV_DEV);
+		r.tty = tty_dev;
+
+		r.ruid = proc->ruid;
+		r.user_id = proc->euid;
+		report_finding(&r, ctx);
+	}
+	SEXP_free(cmd_sexp);
+}
 
-			// Select format based on how long we've been running
-			//
-			// FROM THE SPEC:
-			// "This is the time of day the process started formatted in HH:MM:SS if
-			// the same day the process started or formatted as MMM_DD (Ex.: Feb_5)
-			// if process started the previous day or further in the past."
-			//
-			if (tday != proc->tm_yday || tyear != proc->tm_year)
-				fmt = "%b_%d";
-			else
-				fmt = "%H:%M:%S";
-			strftime(sbuf, sizeof(sbuf), fmt, proc);
+static int read_process(SEXP_t *cmd_ent, struct proc_snapshot *snapshot, probe_ctx *ctx)
+{
+	const struct proc_snapshot_process *proc;
+	SEXP_t *cmd_val;
 
-			r.command = cmd;
-			r.exec_time = convert_time(t, tbuf, sizeof(tbuf));
-			r.pid = pid;
-			r.ppid = ppid;
-			r.priority = priority;
-			r.start_time = sbuf;
+	// The snapshot has no processes if /proc can't be read
+	if (proc_snapshot_count(snapshot) == 0)
+		return 1;
 
-                        dev_to_tty(tty_dev, sizeof(tty_dev), (dev_t) tty_nr, pid, ABBREV_DEV);
-                        r.tty = tty_dev;
+	// Get the time tick hertz
+	ticks = (unsigned long)sysconf(_SC_CLK_TCK);
+	boot = proc_snapshot_boot_time(snapshot);
 
-			get_uids(pid, &r);
-			report_finding(&r, ctx);
-		}
-		SEXP_free(cmd_sexp);
+	cmd_val = proc_snapshot_ent_equals(cmd_ent, OVAL_DATATYPE_STRING);
+	if (cmd_val != NULL) {
+		char *cmd = SEXP_string_cstr(cmd_val);
+
+		for (proc = proc_snapshot_find_comm(snapshot, cmd); proc != NULL; proc = proc->next_comm)
+			collect_process(cmd_ent, proc, ctx);
+		free(cmd);
+		SEXP_free(cmd_val);
+		return 0;
 	}
-        closedir(d);
 
-	return err;
+	for (size_t i = 0; (proc = proc_snapshot_get(snapshot, i)) != NULL; ++i)
+		collect_process(cmd_ent, proc, ctx);
+
+	return 0;
 }
 
 int process_probe_main(probe_ctx *ctx, void *arg)
 {
+	struct proc_snapshot *snapshot = arg;
 	SEXP_t *ent;
 
+	if (snapshot == NULL)
+		return PROBE_EINIT;
+
 	ent = probe_obj_getent(probe_ctx_getobject(ctx), "command", 1);
 	if (ent == NULL) {
 		return PROBE_ENOVAL;
 	}
 
-	if (read_process(ent, ctx)) {
+	if (read_process(ent, snapshot, ctx)) {
 		SEXP_free(ent);
 		return PROBE_EACCESS;
 	}
@@ -675,3 +594,19 @@ int process_probe_main(probe_ctx *ctx, void *arg)
 	return 0;
 }
 #endif /* __linux */
+
+void *process_probe_init(void)
+{
+#if defined(OS_LINUX)
+	return proc_snapshot_acquire();
+#else
+	return NULL;
+#endif
+}
+
+void process_probe_fini(void *arg)
+{
+#if defined(OS_LINUX)
+	proc_snapshot_release(arg);
+#endif
+}
@@ -45,6 +45,7 @@
 //#include "oval_probe.h"
 
 struct oval_agent_session;
+struct oval_probe_session;
 
 /**
  * @var oval_agent_session_t
@@ -119,10 +120,28 @@ typedef int (*agent_reporter)(const struct oval_result_definition * res_def, voi
  */
 OSCAP_API int oval_agent_eval_system(oval_agent_session_t * ag_sess, agent_reporter cb, void *arg);
 
+/**
+ * Set the number of threads oval_agent_eval_system() uses to evaluate tests.
+ * Objects are still collected in document order and the callback is called
+ * in document order, the results are the same as with a single thread.
+ * With parallel evaluation a non-zero callback return value stops reporting
+ * but the remaining definitions are already evaluated.
+ * The default is taken from the OSCAP_OVAL_EVAL_THREADS environment variable
+ * (0 means one thread per online CPU); 1 disables parallel evaluation.
+ */
+OSCAP_API void oval_agent_set_eval_threads(oval_agent_session_t *ag_sess, unsigned int threads);
+
 /**
  * Get a result model from agent session
  */
 OSCAP_API struct oval_results_model * oval_agent_get_results_model(oval_agent_session_t * ag_sess);
+
+/**
+ * Get the probe session which collects objects for the agent session,
+ * e.g. to read the probe statistics.
+ * @returns NULL if the library is built without probes
+ */
+OSCAP_API struct oval_probe_session *oval_agent_get_probe_session(oval_agent_session_t *ag_sess);
 /**
  * Get a filename under which was created
  */
@@ -32,6 +32,8 @@
 
 typedef struct oval_probe_session oval_probe_session_t;
 
+#include <stdbool.h>
+#include <stdint.h>
 #include "oval_system_characteristics.h"
 #include "oscap_export.h"
 
@@ -42,7 +44,8 @@ typedef struct oval_probe_session oval_probe_session_t;
 OSCAP_API oval_probe_session_t *oval_probe_session_new(struct oval_syschar_model *model);
 
 /**
- * Reinitialize already allocated probe session inplace
+ * Reinitialize already allocated probe session inplace. The probe counters
+ * returned by oval_probe_session_get_stats() are kept.
  * @param model system characteristics model
  */
 OSCAP_API void oval_probe_session_reinit(oval_probe_session_t *sess, struct oval_syschar_model *model);
@@ -74,5 +77,104 @@ OSCAP_API int oval_probe_session_abort(oval_probe_session_t *sess);
  */
 OSCAP_API struct oval_syschar_model *oval_probe_session_getmodel(oval_probe_session_t *sess);
 
+/**
+ * Number of buckets of the collection latency histogram
+ * @see oval_probe_stats_get_histogram
+ */
+#define OVAL_PROBE_STATS_HISTOGRAM_SIZE 7
+
+/**
+ * @struct oval_probe_stats
+ * Counters of one probe (one object type) gathered during the lifetime
+ * of a probe session
+ */
+struct oval_probe_stats;
+
+/**
+ * @struct oval_probe_stats_iterator
+ * @see oval_probe_session_get_stats
+ */
+struct oval_probe_stats_iterator;
+
+/**
+ * Get the counters of all probes which were queried by the session, in the
+ * order of their first use. The counters are kept across session resets and
+ * reinitializations and stay valid until the session is destroyed.
+ * @param sess pointer to the probe session structure
+ */
+OSCAP_API struct oval_probe_stats_iterator *oval_probe_session_get_stats(oval_probe_session_t *sess);
+OSCAP_API bool oval_probe_stats_iterator_has_more(struct oval_probe_stats_iterator *it);
+OSCAP_API struct oval_probe_stats *oval_probe_stats_iterator_next(struct oval_probe_stats_iterator *it);
+OSCAP_API void oval_probe_stats_iterator_free(struct oval_probe_stats_iterator *it);
+OSCAP_API void oval_probe_stats_iterator_reset(struct oval_probe_stats_iterator *it);
+
+/**
+ * Get the object type the counters belong to.
+ */
+OSCAP_API oval_subtype_t oval_probe_stats_get_subtype(const struct oval_probe_stats *stats);
+
+/**
+ * Get the number of objects of this type queried from the session.
+ */
+OSCAP_API uint64_t oval_probe_stats_get_queries(const struct oval_probe_stats *stats);
+
+/**
+ * Get the number of queries answered from system characteristics collected
+ * earlier, without asking the probe.
+ */
+OSCAP_API uint64_t oval_probe_stats_get_cache_hits(const struct oval_probe_stats *stats);
+
+/**
+ * Get the number of objects collected by the probe.
+ */
+OSCAP_API uint64_t oval_probe_stats_get_collected(const struct oval_probe_stats *stats);
+
+/**
+ * Get the number of items produced by the probe.
+ */
+OSCAP_API uint64_t oval_probe_stats_get_items(const struct oval_probe_stats *stats);
+
+/**
+ * Get the size in bytes of the S-expressions sent to the probe.
+ */
+OSCAP_API uint64_t oval_probe_stats_get_bytes_sent(const struct oval_probe_stats *stats);
+
+/**
+ * Get the size in bytes of the S-expressions received from the probe.
+ */
+OSCAP_API uint64_t oval_probe_stats_get_bytes_received(const struct oval_probe_stats *stats);
+
+/**
+ * Get the total time in microseconds spent collecting objects of this type.
+ * The time of an object runs from sending the request to the probe until
+ * its reply is converted to system characteristics.
+ */
+OSCAP_API uint64_t oval_probe_stats_get_time(const struct oval_probe_stats *stats);
+
+/**
+ * Get the number of objects whose collection took at most
+ * oval_probe_stats_histogram_bound(bucket) microseconds and more than the
+ * bound of the previous bucket.
+ * @param bucket index lower than OVAL_PROBE_STATS_HISTOGRAM_SIZE
+ */
+OSCAP_API uint64_t oval_probe_stats_get_histogram(const struct oval_probe_stats *stats, unsigned int bucket);
+
+/**
+ * Get the upper bound in microseconds of a bucket of the latency histogram.
+ * The last bucket has no upper bound and UINT64_MAX is returned for it.
+ */
+OSCAP_API uint64_t oval_probe_stats_histogram_bound(unsigned int bucket);
+
+/**
+ * Get the ID of the object of this type whose collection took the longest.
+ */
+OSCAP_API const char *oval_probe_stats_get_slowest_object(const struct oval_probe_stats *stats);
+
+/**
+ * Get the collection time in microseconds of the slowest object.
+ * @see oval_probe_stats_get_slowest_object
+ */
+OSCAP_API uint64_t oval_probe_stats_get_slowest_time(const struct oval_probe_stats *stats);
+
 #endif /* OVAL_PROBE_SESSION */
 /// @}
@@ -44,6 +44,7 @@
  * A structure encapsulating the context of OVAL operations.
  */
 struct oval_session;
+struct oval_probe_session;
 
 /**
  * Costructor of an \ref oval_session. It attempts to recognize a type of the
@@ -231,6 +232,17 @@ OSCAP_API int oval_session_export(struct oval_session *session);
  */
 OSCAP_API void oval_session_set_export_system_characteristics(struct oval_session *session, bool export);
 
+/**
+ * Get the probe session used to collect the objects of the evaluation. Its
+ * statistics tell which probes and objects the scan time was spent on.
+ *
+ * @memberof oval_session
+ * @param session an \ref oval_session
+ * @returns the probe session
+ * @retval NULL if nothing was evaluated yet or the library is built without probes
+ */
+OSCAP_API struct oval_probe_session *oval_session_get_probe_session(struct oval_session *session);
+
 /**
  * Set property of remote content.
  * @memberof oval_session
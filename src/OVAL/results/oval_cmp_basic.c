@@ -128,10 +128,10 @@ static oval_result_t strregcomp(const char *pattern, const char *test_str)
 	char *err;
 	int errofs;
 
-	re = oscap_pcre_compile(pattern, OSCAP_PCRE_OPTS_UTF8, &err, &errofs);
+	re = oscap_pcre_cache_get(pattern, OSCAP_PCRE_OPTS_UTF8, &err, &errofs);
 	if (re == NULL) {
 		dE("Unable to compile regex pattern '%s', "
-				"oscap_pcre_compile() returned error (offset: %d): '%s'.\n", pattern, errofs, err);
+				"oscap_pcre_cache_get() returned error (offset: %d): '%s'.\n", pattern, errofs, err);
 		oscap_pcre_err_free(err);
 		return OVAL_RESULT_ERROR;
 	}
@@ -147,7 +147,7 @@ static oval_result_t strregcomp(const char *pattern, const char *test_str)
 		result = OVAL_RESULT_ERROR;
 	}
 
-	oscap_pcre_free(re);
+	oscap_pcre_cache_release(re);
 	return result;
 }
 
@@ -50,6 +50,7 @@
 #include "common/debug_priv.h"
 #include "common/_error.h"
 #include "common/elements.h"
+#include "common/oscap_xml_stream.h"
 #include "oscap_source.h"
 #include "source/oscap_source_priv.h"
 
@@ -249,7 +250,8 @@ int oval_results_model_eval(struct oval_results_model *res_model)
 
 static xmlNode *oval_results_to_dom(struct oval_results_model *results_model,
 				    struct oval_directives_model *directives_model, 
-				    xmlDocPtr doc, xmlNode * parent)
+				    xmlDocPtr doc, xmlNode * parent,
+				    struct oscap_xml_stream *stream)
 {
 	xmlNode *root_node;
 	struct oval_result_directives * dirs;
@@ -268,6 +270,7 @@ static xmlNode *oval_results_to_dom(struct oval_results_model *results_model,
 
 	xmlSetNs(root_node, ns_common);
 	xmlSetNs(root_node, ns_results);
+	oscap_xml_stream_open(stream, root_node);
 
 	/* Report generator */
 	oval_generator_to_dom(results_model->generator, doc, root_node);
@@ -282,17 +285,20 @@ static xmlNode *oval_results_to_dom(struct oval_results_model *results_model,
 	/* Report definitions */
 	if(oval_result_directives_get_included(dirs)) {
 		struct oval_definition_model *definition_model = oval_results_model_get_definition_model(results_model);
-		oval_definition_model_to_dom(definition_model, doc, root_node);
+		oval_definition_model_to_dom(definition_model, doc, root_node, stream);
 	}
 
 	xmlNode *results_node = xmlNewTextChild(root_node, ns_results, BAD_CAST "results", NULL);
+	oscap_xml_stream_open(stream, results_node);
 	struct oval_result_system_iterator *systems = oval_results_model_get_systems(results_model);
 	while (oval_result_system_iterator_has_more(systems)) {
 		struct oval_result_system *sys = oval_result_system_iterator_next(systems);
-		oval_result_system_to_dom(sys, results_model, dirs_model, doc, results_node);
+		oval_result_system_to_dom(sys, results_model, dirs_model, doc, results_node, stream);
 	}
 	oval_result_system_iterator_free(systems);
+	oscap_xml_stream_close(stream, results_node);
 
+	oscap_xml_stream_close(stream, root_node);
 	return root_node;
 }
 
@@ -306,7 +312,7 @@ struct oscap_source *oval_results_model_export_source(struct oval_results_model
 		return NULL;
 	}
 
-	oval_results_to_dom(results_model, directives_model, doc, NULL);
+	oval_results_to_dom(results_model, directives_model, doc, NULL, NULL);
 	return oscap_source_new_from_xmlDoc(doc, name);
 }
 
@@ -314,12 +320,23 @@ int oval_results_model_export(struct oval_results_model *results_model,
 			      struct oval_directives_model *directives_model,
 			      const char *file)
 {
-	struct oscap_source *source = oval_results_model_export_source(results_model, directives_model, file);
-	if (source == NULL) {
+	__attribute__nonnull__(results_model);
+
+	/* The results are written out as they are serialized, so that the whole
+	 * document never has to be held in memory at once. */
+	xmlDocPtr doc = xmlNewDoc(BAD_CAST "1.0");
+	if (doc == NULL) {
+		oscap_setxmlerr(xmlGetLastError());
+		return -1;
+	}
+	struct oscap_xml_stream *stream = oscap_xml_stream_new(file, doc);
+	if (stream == NULL) {
+		xmlFreeDoc(doc);
 		return -1;
 	}
-	int ret = oscap_source_save_as(source, NULL);
-	oscap_source_free(source);
+	oval_results_to_dom(results_model, directives_model, doc, NULL, stream);
+	int ret = oscap_xml_stream_free(stream);
+	xmlFreeDoc(doc);
 	return ret;
 }
 
@@ -49,14 +49,18 @@ typedef struct oval_result_item {
 } oval_result_item_t;
 
 struct oval_result_item *oval_result_item_new(struct oval_result_system *sys, char *item_id) {
+	struct oval_syschar_model *syschar_model = oval_result_system_get_syschar_model(sys);
+	struct oval_sysitem *sysitem = oval_syschar_model_get_new_sysitem(syschar_model, item_id);
+
+	return oval_result_item_new_from_sysitem(sys, sysitem);
+}
+
+struct oval_result_item *oval_result_item_new_from_sysitem(struct oval_result_system *sys, struct oval_sysitem *sysitem) {
 	oval_result_item_t *item = (oval_result_item_t *)
 	    malloc(sizeof(oval_result_item_t));
 	if (item == NULL)
 		return NULL;
 
-	struct oval_syschar_model *syschar_model = oval_result_system_get_syschar_model(sys);
-	struct oval_sysitem *sysitem = oval_syschar_model_get_new_sysitem(syschar_model, item_id);
-
 	item->sysitem = sysitem;
 	item->messages = oval_collection_new();
 	item->result = OVAL_RESULT_NOT_EVALUATED;
@@ -59,6 +59,8 @@ typedef struct oval_result_test {
 	struct oval_collection *bindings;
 	int instance;
 	bool bindings_initialized;
+	bool collected;
+	struct oval_syschar *syschar; /* found by oval_result_test_collect() */
 } oval_result_test_t;
 
 struct oval_result_test *oval_result_test_new(struct oval_result_system *sys, char *tstid)
@@ -78,6 +80,8 @@ struct oval_result_test *oval_result_test_new(struct oval_result_system *sys, ch
 	test->items = oval_collection_new();
 	test->bindings = oval_collection_new();
 	test->bindings_initialized = false;
+	test->collected = false;
+	test->syschar = NULL;
 	return test;
 }
 
@@ -863,7 +867,6 @@ _oval_result_test_evaluate_items(struct oval_test *test, struct oval_syschar *sy
 	collected_items_itr = oval_syschar_get_sysitem(syschar_object);
 	while (oval_sysitem_iterator_has_more(collected_items_itr)) {
 		struct oval_sysitem *item;
-		char *item_id;
 		oval_syschar_status_t item_status;
 		struct oval_result_item *ritem;
 
@@ -880,8 +883,8 @@ _oval_result_test_evaluate_items(struct oval_test *test, struct oval_syschar *sy
 		if (item_status == SYSCHAR_STATUS_ERROR)
 			error_cnt++;
 
-		item_id = oval_sysitem_get_id(item);
-		ritem = oval_result_item_new(SYSTEM, item_id);
+		/* the item is already in the model, tests may be evaluated concurrently */
+		ritem = oval_result_item_new_from_sysitem(SYSTEM, item);
 		oval_result_item_set_result(ritem, OVAL_RESULT_NOT_EVALUATED);
 		_oval_test_item_consumer(ritem, args);
 	}
@@ -1006,6 +1009,46 @@ _oval_result_test_evaluate_items(struct oval_test *test, struct oval_syschar *sy
 	return result;
 }
 
+#if defined(OVAL_PROBES_ENABLED)
+/* collect the system characteristics needed by rtest */
+static int _oval_result_test_query(struct oval_result_test *rtest)
+{
+	struct oval_result_system *sys = oval_result_test_get_system(rtest);
+	struct oval_results_model *results_model = oval_result_system_get_results_model(sys);
+	struct oval_probe_session *probe_session = oval_results_model_get_probe_session(results_model);
+
+	if (probe_session == NULL)
+		return 0;
+
+	/* probe test */
+	return oval_probe_query_test(probe_session, oval_result_test_get_test(rtest));
+}
+
+/* find the system characteristics collected for the object of rtest */
+static struct oval_syschar *_oval_result_test_get_syschar(struct oval_result_test *rtest)
+{
+	struct oval_object *object = oval_test_get_object(oval_result_test_get_test(rtest));
+	struct oval_result_system *sys = oval_result_test_get_system(rtest);
+	struct oval_syschar_model *syschar_model = oval_result_system_get_syschar_model(sys);
+
+	return oval_syschar_model_get_syschar(syschar_model, oval_object_get_id(object));
+}
+
+/* evaluate rtest against already collected system characteristics */
+static oval_result_t _oval_result_test_evaluate(struct oval_result_test *rtest, struct oval_syschar *syschar, void **args)
+{
+	struct oval_test *test = oval_result_test_get_test(rtest);
+
+	if (syschar == NULL) {
+		dW("No syschar for object: %s", oval_object_get_id(oval_test_get_object(test)));
+		return OVAL_RESULT_UNKNOWN;
+	}
+
+	/* evaluate items */
+	return _oval_result_test_evaluate_items(test, syschar, args);
+}
+#endif
+
 /* this function will gather all the necessary ingredients and call 'evaluate_items' when it finds them */
 static oval_result_t _oval_result_test_result(struct oval_result_test *rtest, void **args)
 {
@@ -1018,34 +1061,12 @@ static oval_result_t _oval_result_test_result(struct oval_result_test *rtest, vo
 	}
 
 #if defined(OVAL_PROBES_ENABLED)
-	/* get syschar of rtest */
-	struct oval_test *test = oval_result_test_get_test(rtest);
-	struct oval_object * object = oval_test_get_object(test);
-	char * object_id = oval_object_get_id(object);
-
-	struct oval_result_system *sys = oval_result_test_get_system(rtest);
-	struct oval_results_model *results_model = oval_result_system_get_results_model(sys);
-	struct oval_probe_session *probe_session = oval_results_model_get_probe_session(results_model);
-	if (probe_session != NULL) {
-		/* probe test */
-		int ret = oval_probe_query_test(probe_session, test);
-		if (ret != 0) {
-			return ret;
-		}
+	int ret = _oval_result_test_query(rtest);
+	if (ret != 0) {
+		return ret;
 	}
 
-	struct oval_syschar_model *syschar_model = oval_result_system_get_syschar_model(sys);
-
-	struct oval_syschar * syschar = oval_syschar_model_get_syschar(syschar_model, object_id);
-	if (syschar == NULL) {
-		dW("No syschar for object: %s", object_id);
-		return OVAL_RESULT_UNKNOWN;
-	}
-
-	/* evaluate items */
-	oval_result_t result = _oval_result_test_evaluate_items(test, syschar, args);
-
-	return result;
+	return _oval_result_test_evaluate(rtest, _oval_result_test_get_syschar(rtest), args);
 #else
 	return OVAL_RESULT_UNKNOWN;
 #endif
@@ -1161,11 +1182,64 @@ oval_result_t oval_result_test_eval(struct oval_result_test *rtest)
 			rtest->result = OVAL_RESULT_UNKNOWN;
 	}
 
+	/* evaluated by oval_result_test_eval_collected() */
+	if (rtest->collected && !rtest->bindings_initialized) {
+		_oval_result_test_initialize_bindings(rtest);
+	}
+
 	dI("Test '%s' evaluated as %s.", test_id, oval_result_get_text(rtest->result));
 
 	return rtest->result;
 }
 
+bool oval_result_test_collect(struct oval_result_test *rtest)
+{
+	__attribute__nonnull__(rtest);
+
+	if (rtest->collected || rtest->result != OVAL_RESULT_NOT_EVALUATED)
+		return false;
+	rtest->collected = true;
+
+	if (oval_test_get_subtype(oval_result_test_get_test(rtest)) == OVAL_INDEPENDENT_UNKNOWN)
+		return false;
+
+#if defined(OVAL_PROBES_ENABLED)
+	int ret = _oval_result_test_query(rtest);
+	if (ret != 0) {
+		/* same outcome as if the query failed in oval_result_test_eval() */
+		rtest->result = ret;
+		if (!rtest->bindings_initialized) {
+			_oval_result_test_initialize_bindings(rtest);
+		}
+		return false;
+	}
+	/* the model isn't touched by oval_result_test_eval_collected() */
+	rtest->syschar = _oval_result_test_get_syschar(rtest);
+	return true;
+#else
+	return false;
+#endif
+}
+
+void oval_result_test_eval_collected(struct oval_result_test *rtest)
+{
+	__attribute__nonnull__(rtest);
+
+	if (rtest->result != OVAL_RESULT_NOT_EVALUATED)
+		return;
+
+#if defined(OVAL_PROBES_ENABLED)
+	struct oval_test *test = oval_result_test_get_test(rtest);
+	struct oval_string_map *tmp_map = oval_string_map_new();
+	void *args[] = { rtest->system, rtest, tmp_map };
+
+	dI("Evaluating %s test '%s': %s.", oval_subtype_get_text(oval_test_get_subtype(test)),
+	   oval_test_get_id(test), oval_test_get_comment(test));
+	rtest->result = _oval_result_test_evaluate(rtest, rtest->syschar, args);
+	oval_string_map_free(tmp_map, NULL);
+#endif
+}
+
 oval_result_t oval_result_test_get_result(struct oval_result_test * rtest)
 {
 	__attribute__nonnull__(rtest);
@@ -43,7 +43,7 @@
 
 
 int oval_result_system_parse_tag(xmlTextReaderPtr, struct oval_parser_context *, void *);
-xmlNode *oval_result_system_to_dom(struct oval_result_system *, struct oval_results_model *, struct oval_directives_model *, xmlDocPtr, xmlNode *);
+xmlNode *oval_result_system_to_dom(struct oval_result_system *, struct oval_results_model *, struct oval_directives_model *, xmlDocPtr, xmlNode *, struct oscap_xml_stream *);
 
 struct oval_result_test *oval_result_system_get_new_test(struct oval_result_system *, struct oval_test *, int variable_instance);
 
@@ -59,6 +59,13 @@ struct oval_result_test *make_result_test_from_oval_test(struct oval_result_syst
 
 int oval_result_test_parse_tag(xmlTextReaderPtr, struct oval_parser_context *, void *);
 xmlNode *oval_result_test_to_dom(struct oval_result_test *, xmlDocPtr, xmlNode *);
+/* Doesn't look up the item in the system characteristics model */
+struct oval_result_item *oval_result_item_new_from_sysitem(struct oval_result_system *sys, struct oval_sysitem *sysitem);
+/* Collect system characteristics for the test without evaluating it, returns
+ * true if the test shall be finished by oval_result_test_eval_collected(). */
+bool oval_result_test_collect(struct oval_result_test *rtest);
+/* Doesn't query probes, distinct tests may be evaluated from several threads. */
+void oval_result_test_eval_collected(struct oval_result_test *rtest);
 
 
 int oval_result_item_parse_tag(xmlTextReaderPtr, struct oval_parser_context *, struct oval_result_system *, oscap_consumer_func, void *);
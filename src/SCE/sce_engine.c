@@ -61,6 +61,7 @@
 #include <limits.h>
 #include <unistd.h>
 #include <libgen.h>
+#include <pthread.h>
 
 #define SCE_SCRIPT "oscap-run-sce-script"
 
@@ -217,12 +218,14 @@ void sce_check_result_export(struct sce_check_result* v, const char* target_file
 struct sce_session
 {
 	struct oscap_list* results;
+	pthread_mutex_t lock; // checks may be evaluated by several threads
 };
 
 struct sce_session* sce_session_new(void)
 {
 	struct sce_session* ret = malloc(sizeof(struct sce_session));
 	ret->results = oscap_list_new();
+	pthread_mutex_init(&ret->lock, NULL);
 
 	return ret;
 }
@@ -233,6 +236,7 @@ void sce_session_free(struct sce_session* s)
 		return;
 
 	oscap_list_free(s->results, (oscap_destruct_func) sce_check_result_free);
+	pthread_mutex_destroy(&s->lock);
 	free(s);
 }
 
@@ -244,7 +248,9 @@ void sce_session_reset(struct sce_session* s)
 
 void sce_session_add_check_result(struct sce_session* s, struct sce_check_result* result)
 {
+	pthread_mutex_lock(&s->lock);
 	oscap_list_push(s->results, result);
+	pthread_mutex_unlock(&s->lock);
 }
 
 OSCAP_ITERATOR_GEN(sce_check_result)
@@ -519,14 +525,24 @@ xccdf_test_result_type_t sce_engine_eval_rule(struct xccdf_policy *policy, const
 	env_values[env_value_count] = NULL;
 
 	// We open a pipe for communication with the forked process
+	// checks may run concurrently, scripts forked by other threads must not
+	// inherit our pipes, otherwise we would not see EOF until they finish
 	int stdout_pipefd[2];
 	int stderr_pipefd[2];
-	if (pipe(stdout_pipefd) == -1 || pipe(stderr_pipefd) == -1)
+	if (pipe2(stdout_pipefd, O_CLOEXEC) == -1)
 	{
 		dE("Error in pipe");
 		free_env_values(env_values, index_of_first_env_value_not_compiled_in, env_value_count);
 		return XCCDF_RESULT_ERROR;
 	}
+	if (pipe2(stderr_pipefd, O_CLOEXEC) == -1)
+	{
+		dE("Error in pipe");
+		close(stdout_pipefd[0]);
+		close(stdout_pipefd[1]);
+		free_env_values(env_values, index_of_first_env_value_not_compiled_in, env_value_count);
+		return XCCDF_RESULT_ERROR;
+	}
 
 	// FIXME: We definitely want to impose security restrictions in the forked child process in the future.
 	//        This would prevent scripts from writing to files or deleting them.
@@ -725,8 +741,16 @@ xccdf_test_result_type_t sce_engine_eval_rule(struct xccdf_policy *policy, const
 	}
 }
 
+static void *sce_engine_query(void *usr, xccdf_policy_engine_query_t query_type, void *query_data)
+{
+	// every script runs in its own process, checks can be evaluated concurrently
+	if (query_type == POLICY_ENGINE_QUERY_THREAD_SAFE)
+		return usr;
+	return NULL;
+}
+
 bool xccdf_policy_model_register_engine_sce(struct xccdf_policy_model * model, struct sce_parameters *parameters)
 {
 	return xccdf_policy_model_register_engine_and_query_callback(model,
-		"http://open-scap.org/page/SCE", sce_engine_eval_rule, (void*)parameters, NULL);
+		"http://open-scap.org/page/SCE", sce_engine_eval_rule, (void*)parameters, sce_engine_query);
 }
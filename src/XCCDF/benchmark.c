@@ -33,6 +33,7 @@
 #include "common/_error.h"
 #include "common/debug_priv.h"
 #include "common/elements.h"
+#include "common/oscap_profile.h"
 #include "source/public/oscap_source.h"
 #include "source/oscap_source_priv.h"
 
@@ -53,12 +54,15 @@ struct xccdf_backref {
 
 struct xccdf_benchmark *xccdf_benchmark_import_source(struct oscap_source *source)
 {
+	struct oscap_profile_span span;
+	oscap_profile_begin(&span, OSCAP_PROFILE_MODEL_PARSING);
 	xmlTextReader *reader = oscap_source_get_xmlTextReader(source);
 
 	while (xmlTextReaderRead(reader) == 1 && xmlTextReaderNodeType(reader) != XML_READER_TYPE_ELEMENT) ;
 	struct xccdf_benchmark *benchmark = xccdf_benchmark_new();
 	const bool parse_result = xccdf_benchmark_parse(XITEM(benchmark), reader);
 	xmlFreeTextReader(reader);
+	oscap_profile_end(&span);
 
 	if (!parse_result) { // parsing fatal error
 		oscap_seterr(OSCAP_EFAMILY_XML, "Failed to import XCCDF content from '%s'.", oscap_source_readable_origin(source));
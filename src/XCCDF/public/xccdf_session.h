@@ -167,6 +167,15 @@ OSCAP_API void xccdf_session_set_signature_enforcement(struct xccdf_session *ses
  */
 OSCAP_API void xccdf_session_set_thin_results(struct xccdf_session *session, bool thin_result);
 
+/**
+ * Set number of threads used to evaluate rules. Only SCE checks are evaluated
+ * in parallel, OVAL checks are always evaluated serially. Results are still
+ * reported in document order, so remediation applies fixes in the same order.
+ * @memberof xccdf_session
+ * @param jobs number of threads, default is 1
+ */
+OSCAP_API void xccdf_session_set_jobs(struct xccdf_session *session, unsigned int jobs);
+
 /**
  * Set requested datastream_id for this session. This datastream_id is later
  * passed down to @ref ds_sds_index_select_checklist to determine target component.
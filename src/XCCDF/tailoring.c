@@ -32,6 +32,7 @@
 #include "common/_error.h"
 #include "common/debug_priv.h"
 #include "common/elements.h"
+#include "common/oscap_profile.h"
 #include "source/oscap_source_priv.h"
 #include "source/public/oscap_source.h"
 
@@ -206,14 +207,18 @@ struct xccdf_tailoring *xccdf_tailoring_parse(xmlTextReaderPtr reader, struct xc
 
 struct xccdf_tailoring *xccdf_tailoring_import_source(struct oscap_source *source, struct xccdf_benchmark *benchmark)
 {
+	struct oscap_profile_span span;
+	oscap_profile_begin(&span, OSCAP_PROFILE_MODEL_PARSING);
 	xmlTextReaderPtr reader = oscap_source_get_xmlTextReader(source);
 	if (!reader) {
+		oscap_profile_end(&span);
 		return NULL;
 	}
 
 	while (xmlTextReaderRead(reader) == 1 && xmlTextReaderNodeType(reader) != XML_READER_TYPE_ELEMENT) ;
 	struct xccdf_tailoring *tailoring = xccdf_tailoring_parse(reader, XITEM(benchmark));
 	xmlFreeTextReader(reader);
+	oscap_profile_end(&span);
 	if (!tailoring) { // parsing fatal error
 		oscap_seterr(OSCAP_EFAMILY_XML, "Failed to parse tailoring from '%s'.", oscap_source_readable_origin(source));
 	}
@@ -24,6 +24,7 @@
 #include <config.h>
 #endif
 
+#include <pthread.h>
 #include <sys/stat.h>
 #ifdef OS_WINDOWS
 #include <io.h>
@@ -37,6 +38,8 @@
 #include <OVAL/public/oval_agent_api.h>
 #include <OVAL/public/oval_agent_xccdf_api.h>
 #include "common/oscap_acquire.h"
+#include "common/oscap_parallel.h"
+#include "common/oscap_profile.h"
 #include "common/util.h"
 #include "common/list.h"
 #include "common/oscapxml.h"
@@ -49,6 +52,7 @@
 #include "DS/rds_priv.h"
 #include "DS/sds_priv.h"
 #include "OVAL/results/oval_results_impl.h"
+#include "source/oscap_source_priv.h"
 #include "source/xslt_priv.h"
 #include "source/signature_priv.h"
 #include "XCCDF/xccdf_impl.h"
@@ -125,6 +129,7 @@ struct xccdf_session {
 
 	struct oscap_list *check_engine_plugins; ///< Extra non-OVAL check engines that may or may not have been loaded
 	xccdf_session_loading_flags_t loading_flags; ///< Load referenced files while loading XCCDF
+	unsigned int jobs;				///< Number of threads used to evaluate rules
 };
 
 static int _xccdf_session_autonegotiate_tailoring_file(struct xccdf_session *session, const char *original_path);
@@ -135,6 +140,9 @@ static void _xccdf_session_free_oval_result_sources(struct xccdf_session *sessio
 static const char *oscap_productname = "cpe:/a:open-scap:oscap";
 static const char *oval_sysname = "http://oval.mitre.org/XMLSchema/oval-definitions-5";
 
+/* Default upper bound of threads loading OVAL files, see OSCAP_CONTENT_LOAD_THREADS */
+#define XCCDF_SESSION_LOAD_THREADS_MAX 4
+
 struct xccdf_session *xccdf_session_new_from_source(struct oscap_source *source)
 {
 	if (source == NULL) {
@@ -165,6 +173,7 @@ struct xccdf_session *xccdf_session_new_from_source(struct oscap_source *source)
 	session->oval.progress = download_progress_empty_calllback;
 	session->check_engine_plugins = oscap_list_new();
 	session->loading_flags = XCCDF_SESSION_LOAD_ALL;
+	session->jobs = 1;
 	session->rules = oscap_list_new();
 	session->skip_rules = oscap_list_new();
 
@@ -257,74 +266,6 @@ static struct oscap_source* xccdf_session_create_arf_source(struct xccdf_session
 	return session->oval.arf_report;
 }
 
-static struct oscap_source *xccdf_session_extract_arf_source(struct xccdf_session *session)
-{
-	struct oscap_source *rds_source = NULL;
-	char *tailoring_doc_timestamp = NULL;
-	xmlDoc *sds_doc = NULL;
-
-	if (xccdf_session_is_sds(session)) {
-		sds_doc = oscap_source_pop_xmlDoc(session->source);
-	} else {
-		sds_doc = ds_sds_compose_xmlDoc_from_xccdf_source(session->source);
-	}
-	oscap_source_free(session->source);
-	session->source = NULL;
-
-	if (sds_doc == NULL) {
-		goto cleanup;
-	}
-
-	xmlDoc *result_file_doc = oscap_source_get_xmlDoc(session->xccdf.result_source);
-	if (result_file_doc == NULL) {
-		goto cleanup;
-	}
-
-	xmlDoc *tailoring_doc = NULL;
-	const char *tailoring_filepath = NULL;
-	if (session->tailoring.user_file) {
-		tailoring_doc = oscap_source_get_xmlDoc(session->tailoring.user_file);
-		if (tailoring_doc == NULL) {
-			goto cleanup;
-		}
-		tailoring_filepath = oscap_source_get_filepath(session->tailoring.user_file);
-		struct stat file_stat;
-		if (stat(tailoring_filepath, &file_stat) == 0) {
-			const size_t max_timestamp_len = 32;
-			tailoring_doc_timestamp = malloc(max_timestamp_len);
-			if (tailoring_doc_timestamp == NULL) {
-				oscap_seterr(OSCAP_EFAMILY_GLIBC, "Failed to allocate %zu bytes for tailoring_doc_timestamp: %s", max_timestamp_len, strerror(errno));
-				goto cleanup;
-			}
-			struct tm *tm_mtime = malloc(sizeof(struct tm));
-#ifdef OS_WINDOWS
-			localtime_s(tm_mtime, &file_stat.st_mtime);
-#else
-			localtime_r(&file_stat.st_mtime, tm_mtime);
-#endif
-			strftime(tailoring_doc_timestamp, max_timestamp_len,
-					"%Y-%m-%dT%H:%M:%S", tm_mtime);
-			free(tm_mtime);
-		}
-	}
-
-	xmlDocPtr rds_doc = NULL;
-
-	if (ds_rds_create_from_dom(&rds_doc, sds_doc, tailoring_doc,
-			tailoring_filepath, tailoring_doc_timestamp, result_file_doc,
-			session->oval.result_sources, session->oval.results_mapping,
-			session->oval.arf_report_mapping) != 0) {
-		goto cleanup;
-	}
-
-	rds_source = oscap_source_new_from_xmlDoc(rds_doc, session->export.arf_file);
-
-cleanup:
-	free(tailoring_doc_timestamp);
-	xmlFreeDoc(sds_doc);
-	return rds_source;
-}
-
 void xccdf_session_free(struct xccdf_session *session)
 {
 	if (session == NULL)
@@ -445,6 +386,13 @@ void xccdf_session_set_thin_results(struct xccdf_session *session, bool thin_res
 	session->export.thin_results = thin_results;
 }
 
+void xccdf_session_set_jobs(struct xccdf_session *session, unsigned int jobs)
+{
+	session->jobs = jobs;
+	if (session->xccdf.policy_model != NULL)
+		xccdf_policy_model_set_jobs(session->xccdf.policy_model, jobs);
+}
+
 void xccdf_session_set_datastream_id(struct xccdf_session *session, const char *datastream_id)
 {
 	free(session->ds.user_datastream_id);
@@ -792,6 +740,7 @@ static inline int _xccdf_session_load_xccdf_benchmark(struct xccdf_session *sess
 		xccdf_benchmark_free(benchmark);
 		return 1;
 	}
+	xccdf_policy_model_set_jobs(session->xccdf.policy_model, session->jobs);
 	return 0;
 }
 
@@ -887,6 +836,9 @@ int xccdf_session_load_xccdf(struct xccdf_session *session)
 				return 1;
 			}
 		}
+		// Components are cut out of the raw DataStream, DOM of the whole
+		// DataStream is not needed to load them.
+		oscap_source_release_xmlDoc(session->source);
 		session->xccdf.source = ds_sds_session_select_checklist(xccdf_session_get_ds_sds_session(session), session->ds.user_datastream_id,
 				session->ds.user_component_id, session->ds.user_benchmark_id);
 		if (session->xccdf.source == NULL) {
@@ -1170,6 +1122,52 @@ static void _xccdf_session_free_oval_agents(struct xccdf_session *session)
 	}
 }
 
+struct _oval_load_job {
+	struct oval_content_resource **contents;
+	bool validate;
+	struct oval_definition_model **models;
+	bool *invalid;
+	struct err_queue **errors;   /* errors raised while loading each file */
+	pthread_mutex_t lock;
+	size_t first_failed;         /* index of the first file known to fail */
+};
+
+static void _xccdf_session_load_oval_job(size_t idx, void *arg)
+{
+	struct _oval_load_job *job = arg;
+	struct oscap_source *source = job->contents[idx]->source;
+
+	/* Files after one which failed are not loaded, as if loaded one by one */
+	pthread_mutex_lock(&job->lock);
+	bool skip = job->first_failed < idx;
+	pthread_mutex_unlock(&job->lock);
+	if (skip)
+		return;
+
+	if (job->validate && oscap_source_validate(source, _reporter, NULL) != 0) {
+		job->invalid[idx] = true;
+	} else {
+		/* file -> def_model */
+		job->models[idx] = oval_definition_model_import_source(source);
+	}
+	job->errors[idx] = oscap_err_detach();
+
+	if (job->invalid[idx] || job->models[idx] == NULL) {
+		pthread_mutex_lock(&job->lock);
+		if (idx < job->first_failed)
+			job->first_failed = idx;
+		pthread_mutex_unlock(&job->lock);
+	}
+}
+
+static unsigned int _xccdf_session_load_threads(void)
+{
+	unsigned int ncpus = oscap_parallel_ncpus();
+
+	return oscap_parallel_jobs_from_env("OSCAP_CONTENT_LOAD_THREADS",
+		ncpus < XCCDF_SESSION_LOAD_THREADS_MAX ? ncpus : XCCDF_SESSION_LOAD_THREADS_MAX);
+}
+
 int xccdf_session_load_oval(struct xccdf_session *session)
 {
 	struct oval_content_resource **contents = NULL;
@@ -1185,36 +1183,66 @@ int xccdf_session_load_oval(struct xccdf_session *session)
 
 	contents = session->oval.custom_resources != NULL ? session->oval.custom_resources : session->oval.resources;
 
-	/* Validate OVAL files. Only validate if the file doesn't come from a datastream
-	 * or if full validation was explicitly requested.
+	size_t count = 0;
+	while (contents[count])
+		count++;
+
+	/* Validate and parse OVAL files, each of them on its own thread. Only
+	 * validate if the file doesn't come from a datastream or if full
+	 * validation was explicitly requested.
 	 */
-	if (session->validate && (!xccdf_session_is_sds(session) || session->full_validation)) {
-		for (int idx=0; contents[idx]; idx++) {
-			if (oscap_source_validate(contents[idx]->source, _reporter, NULL) != 0) {
-				oscap_seterr(OSCAP_EFAMILY_OSCAP, "Invalid %s (%s) content in %s",
-						oscap_document_type_to_string(oscap_source_get_scap_type(session->source)),
-						oscap_source_get_schema_version(session->source),
-						contents[idx]->href);
-				return 1;
-			}
-		}
+	struct _oval_load_job job = {
+		.contents = contents,
+		.validate = session->validate && (!xccdf_session_is_sds(session) || session->full_validation),
+		.models = calloc(count + 1, sizeof(struct oval_definition_model *)),
+		.invalid = calloc(count + 1, sizeof(bool)),
+		.errors = calloc(count + 1, sizeof(struct err_queue *)),
+		.first_failed = count,
+	};
+	if (job.models == NULL || job.invalid == NULL || job.errors == NULL) {
+		free(job.models);
+		free(job.invalid);
+		free(job.errors);
+		return -1;
 	}
+	pthread_mutex_init(&job.lock, NULL);
+	oscap_parallel_for(count, _xccdf_session_load_threads(), _xccdf_session_load_oval_job, &job);
 
-	for (int idx=0; contents[idx]; idx++) {
-		/* file -> def_model */
-		struct oval_definition_model *tmp_def_model = oval_definition_model_import_source(contents[idx]->source);
-		if (tmp_def_model == NULL) {
+	/* Only the errors of the files up to the first one that failed are
+	 * reported, files after it may have been loaded by other threads meanwhile */
+	int ret = 0;
+	for (size_t idx = 0; idx < count; idx++) {
+		if (idx > job.first_failed) {
+			oscap_err_discard(job.errors[idx]);
+			continue;
+		}
+		oscap_err_attach(job.errors[idx]);
+		if (job.invalid[idx]) {
+			oscap_seterr(OSCAP_EFAMILY_OSCAP, "Invalid %s (%s) content in %s",
+					oscap_document_type_to_string(oscap_source_get_scap_type(session->source)),
+					oscap_source_get_schema_version(session->source),
+					contents[idx]->href);
+			ret = 1;
+		} else if (job.models[idx] == NULL) {
 			oscap_seterr(OSCAP_EFAMILY_OSCAP, "Failed to create OVAL definition model from: '%s'.",
 				oscap_source_readable_origin(contents[idx]->source));
-			return 1;
+			ret = 1;
 		}
+	}
+	if (ret != 0)
+		goto cleanup;
+
+	for (int idx=0; contents[idx]; idx++) {
+		struct oval_definition_model *tmp_def_model = job.models[idx];
+		job.models[idx] = NULL;
 
 		/* def_model -> session */
 		struct oval_agent_session *tmp_sess = oval_agent_new_session(tmp_def_model, contents[idx]->href);
 		if (tmp_sess == NULL) {
 			oscap_seterr(OSCAP_EFAMILY_OSCAP, "Failed to create new OVAL agent session for: '%s'.", contents[idx]->href);
 			oval_definition_model_free(tmp_def_model);
-			return 2;
+			ret = 2;
+			goto cleanup;
 		}
 
 		if (session->export.thin_results) {
@@ -1238,7 +1266,8 @@ int xccdf_session_load_oval(struct xccdf_session *session)
 		void *new_oval_agents = realloc(session->oval.agents, (idx + 2) * sizeof(struct oval_agent_session *));
 		if (new_oval_agents == NULL) {
 			oval_agent_destroy_session(tmp_sess);
-			return -1;
+			ret = -1;
+			goto cleanup;
 		}
 		session->oval.agents = new_oval_agents;
 		session->oval.agents[idx] = tmp_sess;
@@ -1252,7 +1281,15 @@ int xccdf_session_load_oval(struct xccdf_session *session)
 		else
 			xccdf_policy_model_register_engine_oval(session->xccdf.policy_model, tmp_sess);
 	}
-	return 0;
+
+cleanup:
+	for (size_t idx = 0; idx < count; idx++)
+		oval_definition_model_free(job.models[idx]);
+	pthread_mutex_destroy(&job.lock);
+	free(job.models);
+	free(job.invalid);
+	free(job.errors);
+	return ret;
 }
 
 int xccdf_session_load_check_engine_plugin2(struct xccdf_session *session, const char *plugin_name, bool quiet)
@@ -1388,7 +1425,10 @@ int xccdf_session_evaluate(struct xccdf_session *session)
 	if (session->reference_parameter) {
 		xccdf_policy_set_reference_filter(policy, session->reference_parameter);
 	}
+	struct oscap_profile_span span;
+	oscap_profile_begin(&span, OSCAP_PROFILE_EVALUATION);
 	session->xccdf.result = xccdf_policy_evaluate(policy);
+	oscap_profile_end(&span);
 	if (session->xccdf.result == NULL)
 		return 1;
 
@@ -1534,7 +1574,110 @@ static int _build_xccdf_result_source(struct xccdf_session *session)
 	return 0;
 }
 
-int xccdf_session_export_xccdf(struct xccdf_session *session)
+static char *_xccdf_session_get_tailoring_timestamp(const char *tailoring_filepath)
+{
+	struct stat file_stat;
+	if (stat(tailoring_filepath, &file_stat) != 0)
+		return NULL;
+
+	const size_t max_timestamp_len = 32;
+	char *tailoring_doc_timestamp = malloc(max_timestamp_len);
+	if (tailoring_doc_timestamp == NULL) {
+		oscap_seterr(OSCAP_EFAMILY_GLIBC, "Failed to allocate %zu bytes for tailoring_doc_timestamp: %s", max_timestamp_len, strerror(errno));
+		return NULL;
+	}
+	struct tm *tm_mtime = malloc(sizeof(struct tm));
+#ifdef OS_WINDOWS
+	localtime_s(tm_mtime, &file_stat.st_mtime);
+#else
+	localtime_r(&file_stat.st_mtime, tm_mtime);
+#endif
+	strftime(tailoring_doc_timestamp, max_timestamp_len,
+			"%Y-%m-%dT%H:%M:%S", tm_mtime);
+	free(tm_mtime);
+	return tailoring_doc_timestamp;
+}
+
+static int _xccdf_session_get_tailoring(struct xccdf_session *session, xmlDoc **tailoring_doc,
+		const char **tailoring_filepath, char **tailoring_doc_timestamp)
+{
+	*tailoring_doc = NULL;
+	*tailoring_filepath = NULL;
+	*tailoring_doc_timestamp = NULL;
+	if (session->tailoring.user_file == NULL)
+		return 0;
+
+	*tailoring_doc = oscap_source_get_xmlDoc(session->tailoring.user_file);
+	if (*tailoring_doc == NULL)
+		return -1;
+	*tailoring_filepath = oscap_source_get_filepath(session->tailoring.user_file);
+	*tailoring_doc_timestamp = _xccdf_session_get_tailoring_timestamp(*tailoring_filepath);
+	return 0;
+}
+
+static int _xccdf_session_write_arf(struct xccdf_session *session, xmlDoc *sds_doc)
+{
+	if (sds_doc == NULL)
+		return 1;
+
+	xmlDoc *result_file_doc = oscap_source_get_xmlDoc(session->xccdf.result_source);
+	if (result_file_doc == NULL)
+		return 1;
+
+	xmlDoc *tailoring_doc;
+	const char *tailoring_filepath;
+	char *tailoring_doc_timestamp;
+	if (_xccdf_session_get_tailoring(session, &tailoring_doc, &tailoring_filepath, &tailoring_doc_timestamp) != 0)
+		return 1;
+
+	int ret = ds_rds_export_from_dom(session->export.arf_file, sds_doc, tailoring_doc,
+			tailoring_filepath, tailoring_doc_timestamp, result_file_doc,
+			session->oval.result_sources, session->oval.results_mapping,
+			session->oval.arf_report_mapping) != 0;
+	free(tailoring_doc_timestamp);
+
+	if (ret == 0 && session->full_validation) {
+		struct oscap_source *arf_source = oscap_source_new_from_file(session->export.arf_file);
+		ret = oscap_source_validate(arf_source, _reporter, NULL) != 0;
+		oscap_source_free(arf_source);
+	}
+	return ret;
+}
+
+static int _xccdf_session_gen_report_from_index(struct xccdf_session *session, xmlDoc *sds_doc)
+{
+	xmlDoc *result_file_doc = oscap_source_get_xmlDoc(session->xccdf.result_source);
+	if (result_file_doc == NULL)
+		return 1;
+
+	xmlDoc *tailoring_doc;
+	const char *tailoring_filepath;
+	char *tailoring_doc_timestamp;
+	if (_xccdf_session_get_tailoring(session, &tailoring_doc, &tailoring_filepath, &tailoring_doc_timestamp) != 0)
+		return 1;
+
+	xmlDocPtr index_doc = NULL;
+	int ret = ds_rds_create_report_index(&index_doc, sds_doc, tailoring_doc,
+			tailoring_filepath, tailoring_doc_timestamp, result_file_doc,
+			session->oval.result_sources, session->oval.results_mapping,
+			session->oval.arf_report_mapping);
+	free(tailoring_doc_timestamp);
+	if (ret != 0)
+		return 1;
+
+	struct oscap_source *index_source = oscap_source_new_from_xmlDoc(index_doc, NULL);
+	_xccdf_gen_report(index_source,
+			xccdf_result_get_id(session->xccdf.result),
+			session->export.report_file,
+			"",
+			(session->export.check_engine_plugins_results ? "%.result.xml" : ""),
+			session->xccdf.profile_id == NULL ? "" : session->xccdf.profile_id
+	);
+	oscap_source_free(index_source);
+	return 0;
+}
+
+static int _xccdf_session_export_xccdf(struct xccdf_session *session)
 {
 	if (_build_xccdf_result_source(session)) {
 		return 1;
@@ -1560,6 +1703,15 @@ int xccdf_session_export_xccdf(struct xccdf_session *session)
 	return 0;
 }
 
+int xccdf_session_export_xccdf(struct xccdf_session *session)
+{
+	struct oscap_profile_span span;
+	oscap_profile_begin(&span, OSCAP_PROFILE_EXPORT);
+	int ret = _xccdf_session_export_xccdf(session);
+	oscap_profile_end(&span);
+	return ret;
+}
+
 static void _xccdf_session_free_oval_result_sources(struct xccdf_session *session)
 {
 	if (session->oval.result_sources != NULL) {
@@ -1745,7 +1897,7 @@ static int _build_oval_result_sources(struct xccdf_session *session)
 	return 0;
 }
 
-int xccdf_session_export_oval(struct xccdf_session *session)
+static int _xccdf_session_export_oval(struct xccdf_session *session)
 {
 	if (_build_oval_result_sources(session) != 0) {
 		return 1;
@@ -1798,7 +1950,16 @@ int xccdf_session_export_oval(struct xccdf_session *session)
 	return 0;
 }
 
-int xccdf_session_export_check_engine_plugins(struct xccdf_session *session)
+int xccdf_session_export_oval(struct xccdf_session *session)
+{
+	struct oscap_profile_span span;
+	oscap_profile_begin(&span, OSCAP_PROFILE_EXPORT);
+	int ret = _xccdf_session_export_oval(session);
+	oscap_profile_end(&span);
+	return ret;
+}
+
+static int _xccdf_session_export_check_engine_plugins(struct xccdf_session *session)
 {
 	if (!session->export.check_engine_plugins_results)
 		return 0;
@@ -1822,29 +1983,59 @@ int xccdf_session_export_check_engine_plugins(struct xccdf_session *session)
 	return ret;
 }
 
-int xccdf_session_export_arf(struct xccdf_session *session)
+int xccdf_session_export_check_engine_plugins(struct xccdf_session *session)
 {
-	if (session->export.arf_file != NULL) {
-		struct oscap_source* arf_source = xccdf_session_create_arf_source(session);
-		if (arf_source == NULL) {
-			return 1;
-		}
+	struct oscap_profile_span span;
+	oscap_profile_begin(&span, OSCAP_PROFILE_EXPORT);
+	int ret = _xccdf_session_export_check_engine_plugins(session);
+	oscap_profile_end(&span);
+	return ret;
+}
+
+static int _xccdf_session_export_arf(struct xccdf_session *session)
+{
+	if (session->export.arf_file == NULL)
+		return 0;
+
+	if (session->oval.arf_report == NULL) {
+		/* Nothing has needed the ARF in memory, stream it to the file */
+		if (xccdf_session_is_sds(session))
+			return _xccdf_session_write_arf(session, oscap_source_get_xmlDoc(session->source));
+
+		xmlDocPtr sds_doc = ds_sds_compose_xmlDoc_from_xccdf_source(session->source);
+		int ret = _xccdf_session_write_arf(session, sds_doc);
+		xmlFreeDoc(sds_doc);
+		return ret;
+	}
+
+	struct oscap_source* arf_source = xccdf_session_create_arf_source(session);
+	if (arf_source == NULL) {
+		return 1;
+	}
 
-		if (oscap_source_save_as(arf_source, NULL) != 0) {
+	if (oscap_source_save_as(arf_source, NULL) != 0) {
+		oscap_source_free(arf_source);
+		session->oval.arf_report = NULL;
+		return 1;
+	}
+	if (session->full_validation) {
+		if (oscap_source_validate(arf_source, _reporter, NULL) != 0) {
 			oscap_source_free(arf_source);
-			session->oval.arf_report = NULL;
 			return 1;
 		}
-		if (session->full_validation) {
-			if (oscap_source_validate(arf_source, _reporter, NULL) != 0) {
-				oscap_source_free(arf_source);
-				return 1;
-			}
-		}
 	}
 	return 0;
 }
 
+int xccdf_session_export_arf(struct xccdf_session *session)
+{
+	struct oscap_profile_span span;
+	oscap_profile_begin(&span, OSCAP_PROFILE_EXPORT);
+	int ret = _xccdf_session_export_arf(session);
+	oscap_profile_end(&span);
+	return ret;
+}
+
 OSCAP_GENERIC_GETTER(struct xccdf_policy_model *, xccdf_session, policy_model, xccdf.policy_model)
 OSCAP_GENERIC_GETTER(float, xccdf_session, base_score, xccdf.base_score);
 
@@ -2015,52 +2206,47 @@ int xccdf_session_generate_guide(struct xccdf_session *session, const char *outf
 	return 0;
 }
 
-int xccdf_session_export_all(struct xccdf_session *session)
+static int _xccdf_session_export_all(struct xccdf_session *session)
 {
-	int ret = 0;
-	struct oscap_source *arf_source = NULL;
-
 	if (_build_xccdf_result_source(session)) {
-		ret = 1;
-		goto cleanup;
+		return 1;
 	}
 
 	if (session->export.report_file == NULL && session->export.arf_file == NULL) {
-		goto cleanup;
+		return 0;
 	}
 
-	arf_source = xccdf_session_extract_arf_source(session);
-	if (arf_source == NULL) {
-		ret = 1;
-		goto cleanup;
+	int ret = 0;
+	xmlDoc *sds_doc = NULL;
+	if (xccdf_session_is_sds(session)) {
+		sds_doc = oscap_source_pop_xmlDoc(session->source);
+	} else {
+		sds_doc = ds_sds_compose_xmlDoc_from_xccdf_source(session->source);
 	}
+	oscap_source_free(session->source);
+	session->source = NULL;
+	if (sds_doc == NULL)
+		return 1;
 
-	if (session->export.report_file != NULL) {
-		/* generate report */
-		_xccdf_gen_report(arf_source,
-				xccdf_result_get_id(session->xccdf.result),
-				session->export.report_file,
-				"",
-				(session->export.check_engine_plugins_results ? "%.result.xml" : ""),
-				session->xccdf.profile_id == NULL ? "" : session->xccdf.profile_id
-		);
-	}
+	/* The ARF is written out first, straight from the documents of the session */
+	if (session->export.arf_file != NULL && _xccdf_session_write_arf(session, sds_doc) != 0)
+		ret = 1;
 
-	if (session->export.arf_file != NULL) {
-		if (oscap_source_save_as(arf_source, NULL) != 0) {
-			ret = 1;
-			goto cleanup;
-		}
-		if (session->full_validation) {
-			if (oscap_source_validate(arf_source, _reporter, NULL) != 0) {
-				ret = 1;
-				goto cleanup;
-			}
-		}
-	}
+	/* The report is generated from an index which takes over the checklists
+	 * and the OVAL results, the session does not need them any more. */
+	if (session->export.report_file != NULL && _xccdf_session_gen_report_from_index(session, sds_doc) != 0)
+		ret = 1;
 
-cleanup:
-	oscap_source_free(arf_source);
+	xmlFreeDoc(sds_doc);
+	return ret;
+}
+
+int xccdf_session_export_all(struct xccdf_session *session)
+{
+	struct oscap_profile_span span;
+	oscap_profile_begin(&span, OSCAP_PROFILE_EXPORT);
+	int ret = _xccdf_session_export_all(session);
+	oscap_profile_end(&span);
 	return ret;
 }
 
@@ -72,6 +72,7 @@ struct xccdf_policy_iterator;
 typedef enum {
 	POLICY_ENGINE_QUERY_NAMES_FOR_HREF = 1,		/// Considering xccdf:check-content-ref, what are possible @name attributes for given href?
 	POLICY_ENGINE_QUERY_OVAL_DEFS_FOR_HREF = 2,	/// Considering xccdf:check-content-ref, what are OVAL definitions for given href?
+	POLICY_ENGINE_QUERY_THREAD_SAFE = 3,		/// Can the checking engine evaluate several checks concurrently?
 } xccdf_policy_engine_query_t;
 
 /**
@@ -84,10 +85,13 @@ typedef enum {
  * dependent on query and defined as follows:
  *  - (const char *)href -- for POLICY_ENGINE_QUERY_NAMES_FOR_HREF
  *  - (const char *)href -- for POLICY_ENGINE_QUERY_OVAL_DEFS_FOR_HREF
+ *  - NULL -- for POLICY_ENGINE_QUERY_THREAD_SAFE
  *
  * Expected return type depends also on query as follows:
  *  - (struct oscap_stringlist *) -- for POLICY_ENGINE_QUERY_NAMES_FOR_HREF
  *  - (struct oscap_list *) -- for POLICY_ENGINE_QUERY_OVAL_DEFS_FOR_HREF
+ *  - any non-NULL pointer (not freed) -- for POLICY_ENGINE_QUERY_THREAD_SAFE if the
+ *    eval function may be called from several threads at the same time
  *  - NULL shall be returned if the function doesn't understand the query.
  */
 typedef void *(*xccdf_policy_engine_query_fn) (void *, xccdf_policy_engine_query_t, void *);
@@ -239,6 +243,20 @@ OSCAP_API struct oscap_htable_iterator *xccdf_policy_model_get_cpe_oval_sessions
  */
 OSCAP_API bool xccdf_policy_model_register_engine_and_query_callback(struct xccdf_policy_model *model, char *sys, xccdf_policy_engine_eval_fn eval_fn, void *usr, xccdf_policy_engine_query_fn query_fn);
 
+/**
+ * Set number of threads used to evaluate rules. Checks of rules which
+ * are handled by thread safe checking engines (see POLICY_ENGINE_QUERY_THREAD_SAFE)
+ * are then evaluated concurrently. Rule results and output callbacks are still
+ * delivered in document order, so the evaluation result and the order of
+ * remediation do not depend on the number of threads. Of the engines shipped
+ * with OpenSCAP only SCE is thread safe, OVAL checks are evaluated serially.
+ * Default is 1, i.e. serial evaluation.
+ * @memberof xccdf_policy_model
+ * @param model XCCDF Policy Model
+ * @param jobs maximal number of threads
+ */
+OSCAP_API void xccdf_policy_model_set_jobs(struct xccdf_policy_model *model, unsigned int jobs);
+
 typedef int (*policy_reporter_output)(struct xccdf_rule_result *, void *);
 
 /**
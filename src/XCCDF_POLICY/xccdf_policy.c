@@ -51,6 +51,7 @@
 #include "helpers.h"
 #include "common/list.h"
 #include "common/_error.h"
+#include "common/oscap_parallel.h"
 #include "common/debug_priv.h"
 #include "common/text_priv.h"
 #include "XCCDF/result_scoring_priv.h"
@@ -384,6 +385,24 @@ xccdf_policy_evaluate_cb(struct xccdf_policy * policy, const char * sysname, con
     return retval;
 }
 
+/**
+ * Return true if all checking engines for the given system can evaluate
+ * checks concurrently.
+ */
+static bool _xccdf_policy_engines_are_thread_safe(struct xccdf_policy *policy, const char *sysname)
+{
+	bool thread_safe = false;
+	struct oscap_iterator *cb_it = _xccdf_policy_get_engines_by_sysname(policy, sysname);
+	while (oscap_iterator_has_more(cb_it)) {
+		struct xccdf_policy_engine *engine = (struct xccdf_policy_engine *) oscap_iterator_next(cb_it);
+		thread_safe = xccdf_policy_engine_is_thread_safe(engine);
+		if (!thread_safe)
+			break;
+	}
+	oscap_iterator_free(cb_it);
+	return thread_safe;
+}
+
 /**
  * Find all possible names for given check-content-ref/@href, considering also the check/@system.
  * This is useful for multi-check="true" feature.
@@ -715,6 +734,47 @@ static bool _user_specified_rule_mode(struct xccdf_policy *policy) {
 	return oscap_htable_itemcount(policy->rules) > 0;
 }
 
+/**
+ * Rule result or output callback postponed during parallel evaluation.
+ * The events are replayed in the order in which they were recorded,
+ * which is the order of the serial evaluation.
+ */
+struct xccdf_policy_deferred {
+	const char *sysname;            ///< System of output callback, NULL for rule result
+	void *data;                     ///< Argument of output callback
+	const struct xccdf_rule *rule;
+	struct xccdf_check *check;
+	struct oscap_list *bindings;    ///< Value bindings of a check waiting for evaluation
+	xccdf_role_t role;
+	int res;
+	const char *message;
+};
+
+static void xccdf_policy_deferred_free(struct xccdf_policy_deferred *event)
+{
+	if (event == NULL)
+		return;
+	xccdf_check_free(event->check);
+	oscap_list_free(event->bindings, (oscap_destruct_func) xccdf_value_binding_free);
+	free(event);
+}
+
+static int _xccdf_policy_rule_report_cb(struct xccdf_policy *policy, const char *sysname, void *data)
+{
+	if (policy->deferred == NULL)
+		return xccdf_policy_report_cb(policy, sysname, data);
+
+	struct xccdf_policy_deferred *event = calloc(1, sizeof(struct xccdf_policy_deferred));
+	if (event == NULL) {
+		oscap_seterr(OSCAP_EFAMILY_GLIBC, "Insufficient memory for postponed output callback.");
+		return -1;
+	}
+	event->sysname = sysname;
+	event->data = data;
+	oscap_list_add(policy->deferred, event);
+	return 0;
+}
+
 static int _xccdf_policy_report_rule_result(struct xccdf_policy *policy,
 					    struct xccdf_result *result,
 					    const struct xccdf_rule *rule,
@@ -728,6 +788,21 @@ static int _xccdf_policy_report_rule_result(struct xccdf_policy *policy,
 	if (res == -1)
 		return res;
 
+	if (policy->deferred != NULL) {
+		struct xccdf_policy_deferred *event = calloc(1, sizeof(struct xccdf_policy_deferred));
+		if (event == NULL) {
+			oscap_seterr(OSCAP_EFAMILY_GLIBC, "Insufficient memory for postponed rule result.");
+			xccdf_check_free(check);
+			return -1;
+		}
+		event->rule = rule;
+		event->check = check;
+		event->res = res;
+		event->message = message;
+		oscap_list_add(policy->deferred, event);
+		return 0;
+	}
+
 	if (result != NULL) {
 		/* Add result to policy */
 		/* TODO: instance */
@@ -1109,7 +1184,7 @@ _xccdf_policy_rule_evaluate(struct xccdf_policy * policy, const struct xccdf_rul
 	}
 
 	/* Otherwise start reporting */
-	report = xccdf_policy_report_cb(policy, XCCDF_POLICY_OUTCB_START, (void *) rule);
+	report = _xccdf_policy_rule_report_cb(policy, XCCDF_POLICY_OUTCB_START, (void *) rule);
 	if (report)
 		return report;
 
@@ -1148,6 +1223,24 @@ _xccdf_policy_rule_evaluate(struct xccdf_policy * policy, const struct xccdf_rul
 	if (bindings == NULL)
 		return _xccdf_policy_report_rule_result(policy, result, rule, check, XCCDF_RESULT_UNKNOWN, "Value bindings not found.");
 
+	// In parallel mode the check is evaluated later by a worker thread,
+	// see _xccdf_policy_deferred_evaluate.
+	if (policy->deferred != NULL && !xccdf_check_get_multicheck(check) &&
+			_xccdf_policy_engines_are_thread_safe(policy, system_name)) {
+		struct xccdf_policy_deferred *event = calloc(1, sizeof(struct xccdf_policy_deferred));
+		if (event == NULL) {
+			oscap_seterr(OSCAP_EFAMILY_GLIBC, "Insufficient memory for postponed check.");
+			oscap_list_free(bindings, (oscap_destruct_func) xccdf_value_binding_free);
+			xccdf_check_free(check);
+			return -1;
+		}
+		event->rule = rule;
+		event->check = check;
+		event->bindings = bindings;
+		event->role = role;
+		oscap_list_add(policy->deferred, event);
+		return 0;
+	}
 
 	struct xccdf_check_content_ref_iterator *content_it = xccdf_check_get_content_refs(check);
 	struct xccdf_check_content_ref *content;
@@ -1178,7 +1271,7 @@ _xccdf_policy_rule_evaluate(struct xccdf_policy * policy, const struct xccdf_rul
 				}
 				while (oscap_iterator_has_more(oval_definition_iterator)) {
 					struct oval_definition *oval_definition = oscap_iterator_next(oval_definition_iterator);
-					if ((report = xccdf_policy_report_cb(policy, XCCDF_POLICY_OUTCB_MULTICHECK, (void *) oval_definition)) != 0) {
+					if ((report = _xccdf_policy_rule_report_cb(policy, XCCDF_POLICY_OUTCB_MULTICHECK, (void *) oval_definition)) != 0) {
 						break;
 					}
 					struct xccdf_check *cloned_check = xccdf_check_clone(check);
@@ -1192,7 +1285,7 @@ _xccdf_policy_rule_evaluate(struct xccdf_policy * policy, const struct xccdf_rul
 					if ((report = _xccdf_policy_report_rule_result(policy, result, rule, cloned_check, inner_ret, NULL)) != 0)
 						break;
 					if (oscap_iterator_has_more(oval_definition_iterator)) {
-						if ((report = xccdf_policy_report_cb(policy, XCCDF_POLICY_OUTCB_START, (void *) rule)) != 0)
+						if ((report = _xccdf_policy_rule_report_cb(policy, XCCDF_POLICY_OUTCB_START, (void *) rule)) != 0)
 							break;
 					}
 				}
@@ -1233,6 +1326,113 @@ _xccdf_policy_rule_evaluate(struct xccdf_policy * policy, const struct xccdf_rul
 	return _xccdf_policy_report_rule_result(policy, result, rule, check, ret, message);
 }
 
+struct xccdf_policy_deferred_jobs {
+	struct xccdf_policy *policy;
+	struct xccdf_policy_deferred **events;
+};
+
+/**
+ * Evaluate simple check of a rule postponed by _xccdf_policy_rule_evaluate.
+ * This mirrors the evaluation of check-content-refs done there for checks
+ * without @multi-check.
+ */
+static void _xccdf_policy_deferred_evaluate(size_t index, void *arg)
+{
+	struct xccdf_policy_deferred_jobs *jobs = arg;
+	struct xccdf_policy_deferred *event = jobs->events[index];
+	const char *system_name = xccdf_check_get_system(event->check);
+	int ret = XCCDF_RESULT_NOT_CHECKED;
+
+	struct xccdf_check_content_ref_iterator *content_it = xccdf_check_get_content_refs(event->check);
+	while (xccdf_check_content_ref_iterator_has_more(content_it)) {
+		struct xccdf_check_content_ref *content = xccdf_check_content_ref_iterator_next(content_it);
+		struct xccdf_check_import_iterator *check_import_it = xccdf_check_get_imports(event->check);
+		ret = xccdf_policy_evaluate_cb(jobs->policy, system_name, xccdf_check_content_ref_get_name(content),
+				xccdf_check_content_ref_get_href(content), event->bindings, check_import_it);
+		xccdf_check_import_iterator_free(check_import_it);
+		if ((xccdf_test_result_type_t) ret != XCCDF_RESULT_NOT_CHECKED) {
+			xccdf_check_inject_content_ref(event->check, content, NULL);
+			break;
+		}
+	}
+	xccdf_check_content_ref_iterator_free(content_it);
+	if ((xccdf_test_result_type_t) ret == XCCDF_RESULT_NOT_CHECKED)
+		event->message = "None of the check-content-ref elements was resolvable.";
+
+	if (event->role == XCCDF_ROLE_UNSCORED)
+		ret = XCCDF_RESULT_INFORMATIONAL;
+
+	oscap_list_free(event->bindings, (oscap_destruct_func) xccdf_value_binding_free);
+	event->bindings = NULL;
+	event->res = _resolve_negate(ret, event->check);
+}
+
+/**
+ * Evaluate postponed checks concurrently and replay postponed rule results
+ * and output callbacks in document order.
+ */
+static int _xccdf_policy_deferred_flush(struct xccdf_policy *policy, struct xccdf_result *result)
+{
+	struct oscap_list *events = policy->deferred;
+	struct xccdf_policy_deferred_jobs jobs;
+	size_t count = 0;
+	int ret = 0;
+
+	policy->deferred = NULL;
+
+	jobs.policy = policy;
+	jobs.events = NULL;
+	struct oscap_iterator *it = oscap_iterator_new(events);
+	while (oscap_iterator_has_more(it)) {
+		struct xccdf_policy_deferred *event = oscap_iterator_next(it);
+		if (event->bindings != NULL)
+			count++;
+	}
+	oscap_iterator_reset(it);
+	if (count > 0) {
+		jobs.events = malloc(count * sizeof(struct xccdf_policy_deferred *));
+		if (jobs.events == NULL) {
+			oscap_seterr(OSCAP_EFAMILY_GLIBC, "Insufficient memory for postponed checks.");
+			oscap_iterator_free(it);
+			oscap_list_free(events, (oscap_destruct_func) xccdf_policy_deferred_free);
+			return -1;
+		}
+		count = 0;
+		while (oscap_iterator_has_more(it)) {
+			struct xccdf_policy_deferred *event = oscap_iterator_next(it);
+			if (event->bindings != NULL)
+				jobs.events[count++] = event;
+		}
+	}
+	oscap_iterator_free(it);
+
+	if (count > 0) {
+		dI("Evaluating %zu checks using %u threads.", count, policy->model->jobs);
+		oscap_parallel_for(count, policy->model->jobs, _xccdf_policy_deferred_evaluate, &jobs);
+	}
+	free(jobs.events);
+
+	// Rule results are added to the result in document order, so
+	// xccdf_policy_remediate() applies the fixes in the serial order.
+	it = oscap_iterator_new(events);
+	while (oscap_iterator_has_more(it)) {
+		struct xccdf_policy_deferred *event = oscap_iterator_next(it);
+		if (ret != 0)
+			continue;
+		if (event->sysname != NULL) {
+			ret = xccdf_policy_report_cb(policy, event->sysname, event->data);
+		} else {
+			ret = _xccdf_policy_report_rule_result(policy, result, event->rule, event->check, event->res, event->message);
+			// the check is owned by the rule result now
+			if (event->res != -1)
+				event->check = NULL;
+		}
+	}
+	oscap_iterator_free(it);
+	oscap_list_free(events, (oscap_destruct_func) xccdf_policy_deferred_free);
+	return ret;
+}
+
 /** 
  * Evaluate the XCCDF item. If it is group, start recursive cycle, otherwise get XCCDF check
  * and evaluate it.
@@ -1685,6 +1885,12 @@ xccdf_policy_model_register_engine_and_query_callback(struct xccdf_policy_model
 	return oscap_list_add(model->engines, engine);
 }
 
+void xccdf_policy_model_set_jobs(struct xccdf_policy_model *model, unsigned int jobs)
+{
+	__attribute__nonnull__(model);
+	model->jobs = jobs;
+}
+
 void xccdf_policy_model_unregister_engines(struct xccdf_policy_model *model, const char *sys)
 {
 	__attribute__nonnull__(model);
@@ -1773,6 +1979,7 @@ struct xccdf_policy_model * xccdf_policy_model_new(struct xccdf_benchmark * benc
 	model->policies  = oscap_list_new();
         model->callbacks = oscap_list_new();
 	model->engines = oscap_list_new();
+	model->jobs = 1;
 
 	model->cpe = cpe_session_new();
 
@@ -2163,6 +2370,11 @@ struct xccdf_result * xccdf_policy_evaluate(struct xccdf_policy * policy)
 
     free(id);
 
+	/* Rule results are postponed and checks of thread safe engines
+	 * are evaluated concurrently after all items have been processed. */
+	if (policy->model->jobs > 1)
+		policy->deferred = oscap_list_new();
+
 	/** We need to process document top-down order.
 	 * See conflicts/requires and Item Processing Algorithm */
 	struct xccdf_item_iterator *item_it = xccdf_benchmark_get_content(benchmark);
@@ -2171,6 +2383,8 @@ struct xccdf_result * xccdf_policy_evaluate(struct xccdf_policy * policy)
 		ret = xccdf_policy_item_evaluate(policy, item, result, true);
 		if (ret == -1) {
 			xccdf_item_iterator_free(item_it);
+			oscap_list_free(policy->deferred, (oscap_destruct_func) xccdf_policy_deferred_free);
+			policy->deferred = NULL;
 			xccdf_result_free(result);
 			return NULL;
 		}
@@ -2179,6 +2393,11 @@ struct xccdf_result * xccdf_policy_evaluate(struct xccdf_policy * policy)
 	}
 	xccdf_item_iterator_free(item_it);
 
+	if (policy->deferred != NULL && _xccdf_policy_deferred_flush(policy, result) == -1) {
+		xccdf_result_free(result);
+		return NULL;
+	}
+
 	struct oscap_htable_iterator *rit = oscap_htable_iterator_new(policy->rules);
 	while (oscap_htable_iterator_has_more(rit)) {
 		const char *rule_id = oscap_htable_iterator_next_key(rit);
@@ -75,3 +75,10 @@ struct oscap_list *xccdf_policy_engine_query(struct xccdf_policy_engine *engine,
 		return NULL;
 	return (struct oscap_list *) engine->query_fn(engine->usr, query_type, query_data);
 }
+
+bool xccdf_policy_engine_is_thread_safe(struct xccdf_policy_engine *engine)
+{
+	if (engine->query_fn == NULL)
+		return false;
+	return engine->query_fn(engine->usr, POLICY_ENGINE_QUERY_THREAD_SAFE, NULL) != NULL;
+}
@@ -76,5 +76,7 @@ xccdf_test_result_type_t xccdf_policy_engine_eval(struct xccdf_policy_engine *en
  */
 struct oscap_list *xccdf_policy_engine_query(struct xccdf_policy_engine *engine, xccdf_policy_engine_query_t query_type, void *query_data);
 
+bool xccdf_policy_engine_is_thread_safe(struct xccdf_policy_engine *engine);
+
 
 #endif
@@ -42,6 +42,7 @@ struct xccdf_policy_model {
 	struct oscap_list       * policies;     ///< List of xccdf_policy structures
 	struct oscap_list       * callbacks;    ///< Callbacks for output callbacks (see callback_out_t)
 	struct oscap_list       * engines;      ///< Callbacks for checking engines (see xccdf_policy_engine)
+	unsigned int              jobs;         ///< Number of threads used to evaluate rules
 
 	struct cpe_session *cpe;
 };
@@ -77,6 +78,8 @@ struct xccdf_policy {
 		char *href;
 		char *title;
 	} reference_filter;
+	/* Rule results and callbacks postponed during parallel evaluation */
+	struct oscap_list		*deferred;
 };
 
 
@@ -58,4 +58,25 @@ struct oscap_err_t {
 __attribute__((format (printf, 5, 6)))
 void __oscap_seterr(const char *file, uint32_t line, const char *func, oscap_errfamily_t family, const char *fmt, ...);
 
+struct err_queue;
+
+/**
+ * Take over the error queue of the calling thread, leaving it empty.
+ * Returns NULL if no error has been set.
+ */
+struct err_queue *oscap_err_detach(void);
+
+/**
+ * Append errors from a queue obtained by oscap_err_detach() (possibly
+ * in another thread) to the error queue of the calling thread.
+ * The queue is freed.
+ */
+void oscap_err_attach(struct err_queue *errors);
+
+/**
+ * Free errors from a queue obtained by oscap_err_detach() without
+ * reporting them.
+ */
+void oscap_err_discard(struct err_queue *errors);
+
 #endif				/* _OSCAP_ERROR_H */
@@ -301,17 +301,25 @@ void oscap_print_env_vars()
 	const char *known_env_vars[] = {
 		"OSCAP_CHECK_ENGINE_PLUGIN_DIR",
 		"OSCAP_CONTAINER_VARS",
+		"OSCAP_CONTENT_CACHE_DIR",
+		"OSCAP_CONTENT_LOAD_THREADS",
 		"OSCAP_EVALUATION_TARGET",
 		"OSCAP_FULL_VALIDATION",
 		"OSCAP_OVAL_COMMAND_OPTIONS",
+		"OSCAP_OVAL_EVAL_THREADS",
 		"OSCAP_PCRE_EXEC_RECURSION_LIMIT",
 		"OSCAP_PROBE_ROOT",
+		"OSCAP_PROFILE_FILE",
 		"SEXP_VALIDATE_DISABLE",
 		"SOURCE_DATE_EPOCH",
 		"OSCAP_PROBE_MEMORY_USAGE_RATIO",
 		"OSCAP_PROBE_MAX_COLLECTED_ITEMS",
+		"OSCAP_PROBE_FTS_THREADS",
+		"OSCAP_PROBE_HASH_THREADS",
+		"OSCAP_PROBE_PROC_THREADS",
 		"OSCAP_PROBE_IGNORE_PATHS",
 		"OSCAP_PREFERRED_ENGINE",
+		"OSCAP_SEAP_MARSHAL",
 		NULL
 	};
 	dI("Using environment variables:");
@@ -0,0 +1,158 @@
+/*
+ * Copyright 2026 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#ifdef OS_WINDOWS
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "_error.h"
+#include "debug_priv.h"
+#include "oscap_parallel.h"
+
+struct oscap_parallel {
+	pthread_mutex_t lock;
+	size_t next;
+	size_t count;
+	oscap_parallel_func func;
+	void *arg;
+	struct err_queue **errors;
+};
+
+static void *_oscap_parallel_worker(void *arg)
+{
+	struct oscap_parallel *par = arg;
+
+#if defined(HAVE_PTHREAD_SETNAME_NP)
+# if defined(OS_APPLE)
+	pthread_setname_np("oscap_parallel");
+# else
+	pthread_setname_np(pthread_self(), "oscap_parallel");
+# endif
+#endif
+
+	for (;;) {
+		size_t index;
+
+		pthread_mutex_lock(&par->lock);
+		index = par->next;
+		if (index < par->count)
+			par->next++;
+		pthread_mutex_unlock(&par->lock);
+
+		if (index >= par->count)
+			break;
+
+		par->func(index, par->arg);
+		par->errors[index] = oscap_err_detach();
+	}
+
+	return NULL;
+}
+
+void oscap_parallel_for(size_t count, unsigned int jobs, oscap_parallel_func func, void *arg)
+{
+	struct oscap_parallel par;
+	pthread_t *threads;
+	unsigned int started = 0;
+
+	if (jobs > count)
+		jobs = count;
+
+	if (jobs < 2) {
+		for (size_t i = 0; i < count; ++i)
+			func(i, arg);
+		return;
+	}
+
+	par.next = 0;
+	par.count = count;
+	par.func = func;
+	par.arg = arg;
+	par.errors = calloc(count, sizeof(struct err_queue *));
+	threads = malloc(jobs * sizeof(pthread_t));
+	if (par.errors == NULL || threads == NULL) {
+		free(par.errors);
+		free(threads);
+		for (size_t i = 0; i < count; ++i)
+			func(i, arg);
+		return;
+	}
+	pthread_mutex_init(&par.lock, NULL);
+
+	for (unsigned int i = 0; i < jobs; ++i) {
+		if (pthread_create(&threads[started], NULL, _oscap_parallel_worker, &par) != 0) {
+			dW("Unable to start a worker thread, continuing with %u threads.", started);
+			break;
+		}
+		++started;
+	}
+
+	/* No thread could be started, do the work here */
+	if (started == 0)
+		_oscap_parallel_worker(&par);
+
+	for (unsigned int i = 0; i < started; ++i)
+		pthread_join(threads[i], NULL);
+
+	for (size_t i = 0; i < count; ++i)
+		oscap_err_attach(par.errors[i]);
+
+	pthread_mutex_destroy(&par.lock);
+	free(par.errors);
+	free(threads);
+}
+
+unsigned int oscap_parallel_ncpus(void)
+{
+#ifdef OS_WINDOWS
+	SYSTEM_INFO info;
+
+	GetSystemInfo(&info);
+	return info.dwNumberOfProcessors > 0 ? info.dwNumberOfProcessors : 1;
+#else
+	long n = sysconf(_SC_NPROCESSORS_ONLN);
+
+	return n > 0 ? (unsigned int) n : 1;
+#endif
+}
+
+unsigned int oscap_parallel_jobs_from_env(const char *name, unsigned int default_jobs)
+{
+	const char *value = getenv(name);
+	unsigned int jobs;
+
+	if (value == NULL)
+		return default_jobs;
+
+	if (sscanf(value, "%u", &jobs) != 1) {
+		dW("Unable to parse %s value '%s'.", name, value);
+		return default_jobs;
+	}
+
+	return jobs == 0 ? oscap_parallel_ncpus() : jobs;
+}
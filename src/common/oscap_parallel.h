@@ -0,0 +1,49 @@
+/*
+ * Copyright 2026 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef OSCAP_PARALLEL_H
+#define OSCAP_PARALLEL_H
+
+#include <stddef.h>
+
+typedef void (*oscap_parallel_func)(size_t index, void *arg);
+
+/*
+ * Call func(index, arg) for every index in <0, count) using at most
+ * jobs threads and return after all calls have finished. Indexes are
+ * handed out in ascending order. Errors raised by func are moved to
+ * the error queue of the calling thread ordered by index, so the caller
+ * sees the same errors as if the calls were made sequentially.
+ * With jobs < 2 or count < 2 everything runs on the calling thread.
+ */
+void oscap_parallel_for(size_t count, unsigned int jobs, oscap_parallel_func func, void *arg);
+
+/*
+ * Parse a job count from the environment variable name. Returns
+ * default_jobs when the variable is not set or cannot be parsed.
+ * The value "0" stands for the number of online processors.
+ */
+unsigned int oscap_parallel_jobs_from_env(const char *name, unsigned int default_jobs);
+
+/*
+ * Number of online processors, at least 1
+ */
+unsigned int oscap_parallel_ncpus(void);
+
+#endif //OSCAP_PARALLEL_H
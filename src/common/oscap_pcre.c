@@ -25,9 +25,25 @@
 #endif
 
 #include <memory.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <ctype.h>
+#include <pthread.h>
+#if defined(_MSC_VER)
+#include <windows.h>
+#endif
 
 #define OSCAP_PCRE_EXEC_RECURSION_LIMIT_DEFAULT 3500
 
+/* Capacity of the compiled pattern cache, see oscap_pcre_cache_get() */
+#define OSCAP_PCRE_CACHE_SIZE    1024
+#define OSCAP_PCRE_CACHE_BUCKETS 2048
+
+/* Limits of the literal prefilter, see oscap_pcre_literals() */
+#define OSCAP_PCRE_LITERALS_MAX 8
+#define OSCAP_PCRE_LITERAL_MIN  3
+
 #ifdef HAVE_PCRE2
 #define PCRE2_CODE_UNIT_WIDTH 8
 #define PCRE2_ERR_BUF_SIZE 127
@@ -40,16 +56,472 @@
 #include "oscap_pcre.h"
 
 
+#ifdef HAVE_PCRE2
+typedef pcre2_match_context_8 oscap_pcre_match_ctx_t;
+#else
+typedef struct pcre_extra oscap_pcre_match_ctx_t;
+#endif
+
+/* Recursion limit of oscap_pcre_get_substrings_n(), read once from the environment */
+static unsigned long oscap_pcre_recursion_limit = OSCAP_PCRE_EXEC_RECURSION_LIMIT_DEFAULT;
+static pthread_once_t oscap_pcre_recursion_limit_once = PTHREAD_ONCE_INIT;
+
+static void oscap_pcre_recursion_limit_init(void)
+{
+	char *limit_str = getenv("OSCAP_PCRE_EXEC_RECURSION_LIMIT");
+	if (limit_str != NULL)
+		if (sscanf(limit_str, "%lu", &oscap_pcre_recursion_limit) <= 0)
+			dW("Unable to parse OSCAP_PCRE_EXEC_RECURSION_LIMIT value");
+}
+
+struct oscap_pcre_stats {
+	unsigned long           exec_cnt;
+	unsigned long           prefiltered_cnt;
+};
+
+/* Patterns may be matched by several threads at once */
+static inline void oscap_pcre_stats_inc(unsigned long *cnt)
+{
+#if defined(_MSC_VER)
+	InterlockedIncrement((volatile LONG *) cnt);
+#else
+	__atomic_fetch_add(cnt, 1, __ATOMIC_RELAXED);
+#endif
+}
+
+static inline unsigned long oscap_pcre_stats_get(unsigned long *cnt)
+{
+#if defined(_MSC_VER)
+	return *(volatile unsigned long *) cnt;
+#else
+	return __atomic_load_n(cnt, __ATOMIC_RELAXED);
+#endif
+}
+
+struct oscap_pcre_literal {
+	char                   *str;
+	size_t                  len;
+};
+
 struct oscap_pcre {
 #ifdef HAVE_PCRE2
 	pcre2_code_8           *re;
 	pcre2_match_context_8  *re_ctx;
+	/* Limits of oscap_pcre_get_substrings_n() */
+	pcre2_match_context_8  *substr_ctx;
+	uint32_t                max_lookbehind;
 #else
 	pcre                   *re;
 	struct pcre_extra      *re_extra;
 #endif
+	bool                    utf8;
+	/* Every match contains at least one of these, empty if unknown */
+	struct oscap_pcre_literal literals[OSCAP_PCRE_LITERALS_MAX];
+	int                     literal_cnt;
+	/* Statistics, updated by matching which doesn't modify the pattern */
+	struct oscap_pcre_stats *stats;
+	/* Shared by the users of the cache, which hold cache_refs references */
+	unsigned int            cache_refs;
 };
 
+#ifndef HAVE_MEMMEM
+static void *memmem(const void *haystack, size_t haystack_len, const void *needle, size_t needle_len)
+{
+	const char *h = haystack, *end = h + haystack_len;
+
+	if (needle_len == 0)
+		return (void *)h;
+
+	while (haystack_len >= needle_len) {
+		const char *c = memchr(h, *(const char *)needle, haystack_len - needle_len + 1);
+
+		if (c == NULL)
+			return NULL;
+		if (memcmp(c, needle, needle_len) == 0)
+			return (void *)c;
+		h = c + 1;
+		haystack_len = end - h;
+	}
+	return NULL;
+}
+#endif
+
+/*
+ * Literal prefilter
+ *
+ * When the pattern is compiled, literal strings that each match has to
+ * contain are extracted from it: the longest run of plain characters that
+ * is neither optional nor inside of a group, class or lookaround, one for
+ * every top-level alternative. A subject that contains none of them can't
+ * match, so it is rejected by a memmem() scan without running PCRE at all.
+ * The parser understands only a subset of the syntax and gives up on
+ * anything else, the pattern is then matched without the prefilter.
+ */
+
+struct oscap_pcre_lit_state {
+	char   *run;         /* the current run of literal characters */
+	size_t  run_len;
+	size_t  atom_start;  /* where the last literal character starts in run, -1 if none */
+	char   *best;        /* the longest run of the current alternative */
+	size_t  best_len;
+};
+
+static void oscap_pcre_lit_end_run(struct oscap_pcre_lit_state *st)
+{
+	if (st->run_len > st->best_len) {
+		memcpy(st->best, st->run, st->run_len);
+		st->best_len = st->run_len;
+	}
+	st->run_len = 0;
+	st->atom_start = (size_t)-1;
+}
+
+/* Skip a character class starting at p, returns a pointer after its closing bracket */
+static const char *oscap_pcre_lit_skip_class(const char *p)
+{
+	++p;
+	if (*p == '^')
+		++p;
+	if (*p == ']')
+		++p;
+	while (*p != '\0' && *p != ']') {
+		if (*p == '\\') {
+			if (*++p == '\0')
+				return NULL;
+		} else if (*p == '[' && p[1] == ':') {
+			const char *end = strstr(p + 2, ":]");
+
+			if (end == NULL)
+				return NULL;
+			p = end + 1;
+		}
+		++p;
+	}
+	return *p == ']' ? p + 1 : NULL;
+}
+
+/*
+ * Skip a group starting at p, returns a pointer after its closing parenthesis.
+ * has_alt is set if the group has an alternative at its top level.
+ */
+static const char *oscap_pcre_lit_skip_group(const char *p, bool *has_alt)
+{
+	int depth = 0;
+
+	*has_alt = false;
+	for (; *p != '\0'; ++p) {
+		switch (*p) {
+		case '\\':
+			if (*++p == '\0')
+				return NULL;
+			break;
+		case '[':
+			p = oscap_pcre_lit_skip_class(p);
+			if (p == NULL)
+				return NULL;
+			--p;
+			break;
+		case '(':
+			++depth;
+			break;
+		case ')':
+			if (--depth == 0)
+				return p + 1;
+			break;
+		case '|':
+			if (depth == 1)
+				*has_alt = true;
+			break;
+		}
+	}
+	return NULL;
+}
+
+/*
+ * Parse a quantifier at p. Returns a pointer after it and its minimum
+ * repeat count in min, or p itself if there is no quantifier there.
+ * Returns NULL for a brace that can't be told apart from a literal.
+ */
+static const char *oscap_pcre_lit_quantifier(const char *p, unsigned long *min)
+{
+	const char *q;
+
+	switch (*p) {
+	case '*':
+	case '?':
+		*min = 0;
+		q = p + 1;
+		break;
+	case '+':
+		*min = 1;
+		q = p + 1;
+		break;
+	case '{':
+		q = p + 1;
+		if (!isdigit((unsigned char)*q) && *q != ',' && *q != ' ')
+			return p;
+		while (*q == ' ')
+			++q;
+		*min = strtoul(q, (char **)&q, 10);
+		while (*q == ' ' || *q == ',' || isdigit((unsigned char)*q))
+			++q;
+		if (*q != '}')
+			return NULL;
+		++q;
+		break;
+	default:
+		return p;
+	}
+	/* lazy or possessive */
+	if (*q == '?' || *q == '+')
+		++q;
+	return q;
+}
+
+/*
+ * Find the required literal of one alternative, the pattern from p up to
+ * the end or a top-level '|'. Returns a pointer to the end of the
+ * alternative or NULL if the pattern isn't understood.
+ */
+static const char *oscap_pcre_lit_alternative(const char *p, struct oscap_pcre_lit_state *st)
+{
+	const char *q;
+	unsigned long min;
+	bool has_alt;
+
+	st->run_len = st->best_len = 0;
+	st->atom_start = (size_t)-1;
+
+	while (*p != '\0' && *p != '|') {
+		switch (*p) {
+		case '\\':
+			++p;
+			if (*p == '\0')
+				return NULL;
+			if ((unsigned char)*p >= 0x20 && !isalnum((unsigned char)*p)) {
+				/* escaped literal character */
+				st->atom_start = st->run_len;
+				st->run[st->run_len++] = *p++;
+				break;
+			}
+			/* character types and assertions of a single letter */
+			if (strchr("dDwWsShHvVRbBAzZGKXCtnrfea", *p) == NULL || *p == '\0')
+				return NULL;
+			++p;
+			oscap_pcre_lit_end_run(st);
+			break;
+		case '[':
+			p = oscap_pcre_lit_skip_class(p);
+			if (p == NULL)
+				return NULL;
+			oscap_pcre_lit_end_run(st);
+			break;
+		case '(':
+			/* verbs like (*ACCEPT) can end the match early */
+			if (p[1] == '*')
+				return NULL;
+			if (p[1] == '?') {
+				q = p + 2;
+				if (*q == '<' && (q[1] == '=' || q[1] == '!'))
+					++q;
+				if (*q == 'P' && q[1] == '<')
+					++q;
+				if (strchr(":=!>|<'", *q) == NULL) {
+					/*
+					 * Only option letters may follow, anything else is
+					 * a recursion, a subroutine call, a back reference,
+					 * a condition or a callout, which can match text
+					 * the literals around it don't show.
+					 */
+					while (*q != '\0' && strchr("imnsxJU-^", *q) != NULL) {
+						/* caseless or extended mode changes the meaning of literals */
+						if (*q == 'i' || *q == 'x' || *q == '^')
+							return NULL;
+						++q;
+					}
+					if (*q == ')') {
+						/* option setting, e.g. (?s) */
+						p = q + 1;
+						break;
+					}
+					if (*q != ':')
+						return NULL;
+				}
+			}
+			q = oscap_pcre_lit_skip_group(p, &has_alt);
+			if (q == NULL)
+				return NULL;
+			oscap_pcre_lit_end_run(st);
+			p = oscap_pcre_lit_quantifier(q, &min);
+			if (p == NULL)
+				return NULL;
+			break;
+		case ')':
+			return NULL;
+		case '*':
+		case '+':
+		case '?':
+		case '{':
+			q = oscap_pcre_lit_quantifier(p, &min);
+			if (q == NULL)
+				return NULL;
+			if (q == p) {
+				/* a brace that isn't a quantifier is a literal */
+				st->atom_start = st->run_len;
+				st->run[st->run_len++] = *p++;
+				break;
+			}
+			/* an optional character isn't required */
+			if (min == 0 && st->atom_start != (size_t)-1)
+				st->run_len = st->atom_start;
+			oscap_pcre_lit_end_run(st);
+			p = q;
+			break;
+		case '.':
+		case '^':
+		case '$':
+			++p;
+			oscap_pcre_lit_end_run(st);
+			break;
+		default:
+			/* a character, with all bytes of a UTF-8 sequence */
+			st->atom_start = st->run_len;
+			do {
+				st->run[st->run_len++] = *p++;
+			} while (((unsigned char)*p & 0xC0) == 0x80);
+			break;
+		}
+	}
+	oscap_pcre_lit_end_run(st);
+
+	return p;
+}
+
+/*
+ * Extract the literals of the prefilter from the pattern. Leaves
+ * literal_cnt at 0 if there is an alternative without a long enough literal.
+ */
+static void oscap_pcre_literals(oscap_pcre_t *opcre, const char *pattern, oscap_pcre_options_t options)
+{
+	struct oscap_pcre_lit_state st;
+	const char *p = pattern;
+	size_t len = strlen(pattern);
+	int cnt = 0;
+
+	opcre->literal_cnt = 0;
+
+	if (options & OSCAP_PCRE_OPTS_CASELESS)
+		return;
+
+	st.run  = malloc(len + 1);
+	st.best = malloc(len + 1);
+	if (st.run == NULL || st.best == NULL)
+		goto cleanup;
+
+	for (;;) {
+		p = oscap_pcre_lit_alternative(p, &st);
+		if (p == NULL || st.best_len < OSCAP_PCRE_LITERAL_MIN || cnt == OSCAP_PCRE_LITERALS_MAX)
+			goto fail;
+
+		opcre->literals[cnt].str = malloc(st.best_len);
+		if (opcre->literals[cnt].str == NULL)
+			goto fail;
+		memcpy(opcre->literals[cnt].str, st.best, st.best_len);
+		opcre->literals[cnt].len = st.best_len;
+		++cnt;
+
+		if (*p == '\0')
+			break;
+		++p;
+	}
+
+	opcre->literal_cnt = cnt;
+	goto cleanup;
+fail:
+	while (cnt > 0)
+		free(opcre->literals[--cnt].str);
+cleanup:
+	free(st.run);
+	free(st.best);
+}
+
+/*
+ * Strict UTF-8 validation with the same rules as PCRE: no overlong forms,
+ * surrogates or code points above U+10FFFF.
+ */
+static bool oscap_pcre_utf8_valid(const unsigned char *s, size_t len)
+{
+	const unsigned char *end = s + len;
+
+	while (s < end) {
+		unsigned char c = *s;
+		size_t n;
+
+		if (c < 0x80) {
+			++s;
+			continue;
+		} else if (c >= 0xC2 && c <= 0xDF) {
+			n = 1;
+		} else if (c >= 0xE0 && c <= 0xEF) {
+			n = 2;
+		} else if (c >= 0xF0 && c <= 0xF4) {
+			n = 3;
+		} else {
+			return false;
+		}
+		if ((size_t)(end - s) <= n)
+			return false;
+		for (size_t i = 1; i <= n; ++i) {
+			if ((s[i] & 0xC0) != 0x80)
+				return false;
+		}
+		if ((c == 0xE0 && s[1] < 0xA0) || (c == 0xED && s[1] > 0x9F) ||
+		    (c == 0xF0 && s[1] < 0x90) || (c == 0xF4 && s[1] > 0x8F))
+			return false;
+		s += n + 1;
+	}
+	return true;
+}
+
+/*
+ * Returns false if no match can start at startoffset or later in the subject.
+ * The subject must be valid UTF-8 if PCRE is to check it, as PCRE would
+ * report invalid UTF-8 even for a subject without a match.
+ */
+static bool oscap_pcre_prefilter(const oscap_pcre_t *opcre, const char *subject,
+                                 int length, int startoffset, oscap_pcre_options_t options)
+{
+	size_t check_from;
+
+	if (opcre->literal_cnt == 0 || (options & OSCAP_PCRE_OPTS_PARTIAL) ||
+	    startoffset < 0 || startoffset > length)
+		return true;
+
+	for (int i = 0; i < opcre->literal_cnt; ++i) {
+		if (memmem(subject + startoffset, length - startoffset,
+		           opcre->literals[i].str, opcre->literals[i].len) != NULL)
+			return true;
+	}
+
+	if (opcre->utf8 && !(options & OSCAP_PCRE_OPTS_NO_UTF8_CHECK)) {
+		/* Let PCRE report an offset in the middle of a character */
+		if (startoffset < length && ((unsigned char)subject[startoffset] & 0xC0) == 0x80)
+			return true;
+#ifdef HAVE_PCRE2
+		/* PCRE2 checks the subject from where a lookbehind can reach */
+		check_from = (size_t)startoffset > opcre->max_lookbehind * 4 ? startoffset - opcre->max_lookbehind * 4 : 0;
+		while (check_from > 0 && ((unsigned char)subject[check_from] & 0xC0) == 0x80)
+			--check_from;
+#else
+		check_from = 0;
+#endif
+		if (!oscap_pcre_utf8_valid((const unsigned char *)subject + check_from, length - check_from))
+			return true;
+	}
+
+	return false;
+}
+
 
 static inline int _oscap_pcre_opts_to_pcre(oscap_pcre_options_t opts)
 {
@@ -142,6 +614,7 @@ oscap_pcre_t *oscap_pcre_compile(const char *pattern, oscap_pcre_options_t optio
 	int errno;
 	PCRE2_SIZE erroffset2;
 	res->re_ctx = NULL;
+	res->substr_ctx = NULL;
 	res->re = pcre2_compile_8((PCRE2_SPTR)pattern, PCRE2_ZERO_TERMINATED, _oscap_pcre_opts_to_pcre(options), &errno, &erroffset2, NULL);
 	if (res->re == NULL) {
 		PCRE2_UCHAR8 errmsg[PCRE2_ERR_BUF_SIZE];
@@ -159,16 +632,48 @@ oscap_pcre_t *oscap_pcre_compile(const char *pattern, oscap_pcre_options_t optio
 #endif
 	if (res->re == NULL) {
 		free(res);
-		res = NULL;
+		return NULL;
 	}
+	pthread_once(&oscap_pcre_recursion_limit_once, oscap_pcre_recursion_limit_init);
+	res->stats = calloc(1, sizeof(struct oscap_pcre_stats));
+#ifdef HAVE_PCRE2
+	res->substr_ctx = pcre2_match_context_create_8(NULL);
+	if (res->substr_ctx == NULL || res->stats == NULL) {
+		*erroffset = 0;
+		*errptr = strdup("Unable to allocate the match context");
+		pcre2_match_context_free_8(res->substr_ctx);
+		pcre2_code_free_8(res->re);
+		free(res->stats);
+		free(res);
+		return NULL;
+	}
+	pcre2_set_depth_limit_8(res->substr_ctx, oscap_pcre_recursion_limit);
+	res->max_lookbehind = 0;
+	pcre2_pattern_info_8(res->re, PCRE2_INFO_MAXLOOKBEHIND, &res->max_lookbehind);
+#else
+	if (res->stats == NULL) {
+		*erroffset = 0;
+		*errptr = (char *) "Unable to allocate the match statistics";
+		pcre_free(res->re);
+		free(res);
+		return NULL;
+	}
+#endif
+	res->utf8 = (options & OSCAP_PCRE_OPTS_UTF8) != 0;
+	res->cache_refs = 0;
+	oscap_pcre_literals(res, pattern, options);
 	return res;
 }
 
 void oscap_pcre_optimize(oscap_pcre_t *opcre)
 {
 #ifdef HAVE_PCRE2
-	// This is a NOOP for PCRE2 as all patterns are optimized
-	// unless the library configured differently.
+	// Patterns are always studied by PCRE2, compile them to machine code
+	// if the library was built with JIT support. Failure isn't an error,
+	// the interpreter is used then.
+	int rc = pcre2_jit_compile_8(opcre->re, PCRE2_JIT_COMPLETE | PCRE2_JIT_PARTIAL_SOFT);
+	if (rc != 0)
+		dD("pcre2_jit_compile_8: %d, the pattern will be interpreted", rc);
 #else
 	const char *errptr = NULL;
 	pcre_extra *extra = pcre_study(opcre->re, 0, &errptr);
@@ -196,16 +701,28 @@ void oscap_pcre_set_match_limit_recursion(oscap_pcre_t *opcre, unsigned long lim
 #endif
 }
 
-int oscap_pcre_exec(const oscap_pcre_t *opcre, const char *subject,
-                    int length, int startoffset, oscap_pcre_options_t options,
-                    int *ovector, int ovecsize)
+static int _oscap_pcre_exec(const oscap_pcre_t *opcre, const char *subject,
+                            int length, int startoffset, oscap_pcre_options_t options,
+                            int *ovector, int ovecsize, oscap_pcre_match_ctx_t *mctx)
 {
 	int rc = 0;
+
+	oscap_pcre_stats_inc(&opcre->stats->exec_cnt);
+	if (!oscap_pcre_prefilter(opcre, subject, length, startoffset, options)) {
+		oscap_pcre_stats_inc(&opcre->stats->prefiltered_cnt);
+		return OSCAP_PCRE_ERR_NOMATCH;
+	}
 #ifdef HAVE_PCRE2
 	// The ovecsize is multiplied by 3 in the code for compatibility with PCRE1
 	int ovecsize2 = ovecsize/3;
 	pcre2_match_data_8 *mdata = pcre2_match_data_create_8(ovecsize2, NULL);
-	rc = pcre2_match_8(opcre->re, (PCRE2_SPTR8)subject, length, startoffset, _oscap_pcre_opts_to_pcre(options), mdata, opcre->re_ctx);
+	rc = pcre2_match_8(opcre->re, (PCRE2_SPTR8)subject, length, startoffset, _oscap_pcre_opts_to_pcre(options), mdata, mctx);
+	if (rc == PCRE2_ERROR_JIT_STACKLIMIT || rc == PCRE2_ERROR_JIT_BADOPTION) {
+		// The machine code has its own stack limit instead of the
+		// depth limit, let the interpreter decide such cases.
+		rc = pcre2_match_8(opcre->re, (PCRE2_SPTR8)subject, length, startoffset,
+		                   _oscap_pcre_opts_to_pcre(options) | PCRE2_NO_JIT, mdata, mctx);
+	}
 	if (rc > PCRE2_ERROR_NOMATCH) {
 		PCRE2_SIZE *ovecp = pcre2_get_ovector_pointer_8(mdata);
 		for (int i = 0; i < rc; i++) {
@@ -218,29 +735,263 @@ int oscap_pcre_exec(const oscap_pcre_t *opcre, const char *subject,
 	pcre2_match_data_free_8(mdata);
 #else
 	dD("pcre_exec: subj=%s", subject);
-	rc = pcre_exec(opcre->re, opcre->re_extra, subject, length, startoffset, _oscap_pcre_opts_to_pcre(options), ovector, ovecsize);
+	rc = pcre_exec(opcre->re, mctx, subject, length, startoffset, _oscap_pcre_opts_to_pcre(options), ovector, ovecsize);
 	dD("pcre_exec: rc=%d, ", rc);
 #endif
 	return rc >= 0 ? rc : _pcre_error_to_oscap_pcre(rc);
 }
 
+int oscap_pcre_exec(const oscap_pcre_t *opcre, const char *subject,
+                    int length, int startoffset, oscap_pcre_options_t options,
+                    int *ovector, int ovecsize)
+{
+#ifdef HAVE_PCRE2
+	return _oscap_pcre_exec(opcre, subject, length, startoffset, options, ovector, ovecsize, opcre->re_ctx);
+#else
+	return _oscap_pcre_exec(opcre, subject, length, startoffset, options, ovector, ovecsize, opcre->re_extra);
+#endif
+}
+
 void oscap_pcre_free(oscap_pcre_t *opcre)
 {
 	if (opcre != NULL) {
 #ifdef HAVE_PCRE2
 		if (opcre->re_ctx != NULL)
 			pcre2_match_context_free_8(opcre->re_ctx);
+		pcre2_match_context_free_8(opcre->substr_ctx);
 		pcre2_code_free_8(opcre->re);
 #else
 		if (opcre->re_extra != NULL)
 			free(opcre->re_extra);
 		pcre_free(opcre->re);
 #endif
+		for (int i = 0; i < opcre->literal_cnt; ++i)
+			free(opcre->literals[i].str);
+		free(opcre->stats);
 		free(opcre);
 	}
 }
 
+void oscap_pcre_get_stats(const oscap_pcre_t *opcre, unsigned long *exec_cnt, unsigned long *prefiltered_cnt)
+{
+	*exec_cnt = oscap_pcre_stats_get(&opcre->stats->exec_cnt);
+	*prefiltered_cnt = oscap_pcre_stats_get(&opcre->stats->prefiltered_cnt);
+}
+
+/*
+ * Compiled pattern cache
+ *
+ * An OVAL state or object applies the same pattern to every collected item,
+ * so compiled patterns are kept in a process-wide cache keyed by the pattern
+ * and the compile options. When the cache is full the least recently used
+ * pattern is evicted; a pattern still in use is freed by its last user.
+ */
+
+struct oscap_pcre_cache_entry {
+	char                   *pattern;
+	oscap_pcre_options_t    options;
+	unsigned int            hash;
+	oscap_pcre_t           *re;
+	struct oscap_pcre_cache_entry *hnext; /* in the bucket */
+	struct oscap_pcre_cache_entry *prev;  /* more recently used */
+	struct oscap_pcre_cache_entry *next;  /* less recently used */
+};
+
+static struct {
+	pthread_mutex_t         lock;
+	struct oscap_pcre_cache_entry *buckets[OSCAP_PCRE_CACHE_BUCKETS];
+	struct oscap_pcre_cache_entry *head;
+	struct oscap_pcre_cache_entry *tail;
+	size_t                  count;
+	unsigned long           hits;
+	unsigned long           misses;
+	unsigned long           evictions;
+} oscap_pcre_cache = { .lock = PTHREAD_MUTEX_INITIALIZER };
+
+static unsigned int oscap_pcre_cache_hash(const char *pattern, oscap_pcre_options_t options)
+{
+	/* FNV-1a */
+	uint32_t h = 2166136261u ^ (uint32_t)options;
+
+	for (; *pattern != '\0'; ++pattern) {
+		h ^= (unsigned char)*pattern;
+		h *= 16777619u;
+	}
+	return h;
+}
+
+/* The functions below are called with the cache lock held */
+
+static struct oscap_pcre_cache_entry *oscap_pcre_cache_lookup(const char *pattern, oscap_pcre_options_t options, unsigned int hash)
+{
+	struct oscap_pcre_cache_entry *e = oscap_pcre_cache.buckets[hash % OSCAP_PCRE_CACHE_BUCKETS];
+
+	for (; e != NULL; e = e->hnext) {
+		if (e->hash == hash && e->options == options && strcmp(e->pattern, pattern) == 0)
+			return e;
+	}
+	return NULL;
+}
+
+static void oscap_pcre_cache_unlink(struct oscap_pcre_cache_entry *e)
+{
+	if (e->prev != NULL)
+		e->prev->next = e->next;
+	else
+		oscap_pcre_cache.head = e->next;
+	if (e->next != NULL)
+		e->next->prev = e->prev;
+	else
+		oscap_pcre_cache.tail = e->prev;
+	e->prev = e->next = NULL;
+}
+
+static void oscap_pcre_cache_push(struct oscap_pcre_cache_entry *e)
+{
+	e->prev = NULL;
+	e->next = oscap_pcre_cache.head;
+	if (oscap_pcre_cache.head != NULL)
+		oscap_pcre_cache.head->prev = e;
+	oscap_pcre_cache.head = e;
+	if (oscap_pcre_cache.tail == NULL)
+		oscap_pcre_cache.tail = e;
+}
+
+/* Remove the entry and return the pattern if the cache held its last reference */
+static oscap_pcre_t *oscap_pcre_cache_remove(struct oscap_pcre_cache_entry *e)
+{
+	struct oscap_pcre_cache_entry **b = &oscap_pcre_cache.buckets[e->hash % OSCAP_PCRE_CACHE_BUCKETS];
+	oscap_pcre_t *re = e->re;
+
+	while (*b != e)
+		b = &(*b)->hnext;
+	*b = e->hnext;
+	oscap_pcre_cache_unlink(e);
+	--oscap_pcre_cache.count;
+	free(e->pattern);
+	free(e);
+
+	return --re->cache_refs == 0 ? re : NULL;
+}
+
+oscap_pcre_t *oscap_pcre_cache_get(const char *pattern, oscap_pcre_options_t options,
+                                   char **errptr, int *erroffset)
+{
+	unsigned int hash = oscap_pcre_cache_hash(pattern, options);
+	struct oscap_pcre_cache_entry *e;
+	oscap_pcre_t *re, *evicted = NULL;
+
+	pthread_mutex_lock(&oscap_pcre_cache.lock);
+	e = oscap_pcre_cache_lookup(pattern, options, hash);
+	if (e != NULL) {
+		++oscap_pcre_cache.hits;
+		oscap_pcre_cache_unlink(e);
+		oscap_pcre_cache_push(e);
+		re = e->re;
+		++re->cache_refs;
+		pthread_mutex_unlock(&oscap_pcre_cache.lock);
+		return re;
+	}
+	++oscap_pcre_cache.misses;
+	pthread_mutex_unlock(&oscap_pcre_cache.lock);
+
+	re = oscap_pcre_compile(pattern, options, errptr, erroffset);
+	if (re == NULL)
+		return NULL;
+	oscap_pcre_optimize(re);
+
+	e = malloc(sizeof(struct oscap_pcre_cache_entry));
+	if (e == NULL)
+		goto uncached;
+	e->pattern = strdup(pattern);
+	if (e->pattern == NULL) {
+		free(e);
+		goto uncached;
+	}
+	e->options = options;
+	e->hash = hash;
+	e->re = re;
+
+	pthread_mutex_lock(&oscap_pcre_cache.lock);
+	if (oscap_pcre_cache_lookup(pattern, options, hash) != NULL) {
+		/* Compiled by another thread meanwhile, keep ours uncached */
+		pthread_mutex_unlock(&oscap_pcre_cache.lock);
+		free(e->pattern);
+		free(e);
+		goto uncached;
+	}
+	re->cache_refs = 2; /* the cache and the caller */
+	e->hnext = oscap_pcre_cache.buckets[hash % OSCAP_PCRE_CACHE_BUCKETS];
+	oscap_pcre_cache.buckets[hash % OSCAP_PCRE_CACHE_BUCKETS] = e;
+	oscap_pcre_cache_push(e);
+	if (++oscap_pcre_cache.count > OSCAP_PCRE_CACHE_SIZE) {
+		++oscap_pcre_cache.evictions;
+		evicted = oscap_pcre_cache_remove(oscap_pcre_cache.tail);
+	}
+	pthread_mutex_unlock(&oscap_pcre_cache.lock);
+
+	oscap_pcre_free(evicted);
+	return re;
+
+uncached:
+	re->cache_refs = 1;
+	return re;
+}
+
+void oscap_pcre_cache_release(oscap_pcre_t *opcre)
+{
+	bool last;
+
+	if (opcre == NULL)
+		return;
+
+	pthread_mutex_lock(&oscap_pcre_cache.lock);
+	last = --opcre->cache_refs == 0;
+	pthread_mutex_unlock(&oscap_pcre_cache.lock);
+
+	if (last)
+		oscap_pcre_free(opcre);
+}
+
+void oscap_pcre_cache_get_stats(unsigned long *hits, unsigned long *misses, unsigned long *evictions)
+{
+	pthread_mutex_lock(&oscap_pcre_cache.lock);
+	*hits = oscap_pcre_cache.hits;
+	*misses = oscap_pcre_cache.misses;
+	*evictions = oscap_pcre_cache.evictions;
+	pthread_mutex_unlock(&oscap_pcre_cache.lock);
+}
+
+void oscap_pcre_cache_clear(void)
+{
+	pthread_mutex_lock(&oscap_pcre_cache.lock);
+	if (oscap_pcre_cache.hits + oscap_pcre_cache.misses > 0) {
+		dI("Compiled pattern cache: %lu hits, %lu misses, %lu evictions.",
+		   oscap_pcre_cache.hits, oscap_pcre_cache.misses, oscap_pcre_cache.evictions);
+	}
+	while (oscap_pcre_cache.head != NULL)
+		oscap_pcre_free(oscap_pcre_cache_remove(oscap_pcre_cache.head));
+	oscap_pcre_cache.hits = oscap_pcre_cache.misses = oscap_pcre_cache.evictions = 0;
+	pthread_mutex_unlock(&oscap_pcre_cache.lock);
+}
+
 int oscap_pcre_get_substrings(char *str, int *ofs, oscap_pcre_t *re, int want_substrs, char ***substrings) {
+	int ret, match[2];
+
+#if defined(OS_SOLARIS)
+	ret = oscap_pcre_get_substrings_n(str, strlen(str), *ofs, re, OSCAP_PCRE_OPTS_NO_UTF8_CHECK, want_substrs, match, substrings);
+#else
+	ret = oscap_pcre_get_substrings_n(str, strlen(str), *ofs, re, 0, want_substrs, match, substrings);
+#endif
+	if (ret > 0)
+		*ofs = (*ofs == match[1]) ? match[1] + 1 : match[1];
+
+	return ret;
+}
+
+int oscap_pcre_get_substrings_n(const char *str, int str_len, int ofs, oscap_pcre_t *re,
+                                oscap_pcre_options_t options, int want_substrs, int *match, char ***substrings)
+{
 	int i, ret, rc;
 	int ovector[60], ovector_len = sizeof (ovector) / sizeof (ovector[0]);
 	char **substrs;
@@ -251,22 +1002,23 @@ int oscap_pcre_get_substrings(char *str, int *ofs, oscap_pcre_t *re, int want_su
 		ovector[i] = -1;
 	}
 
-	unsigned long limit = OSCAP_PCRE_EXEC_RECURSION_LIMIT_DEFAULT;
-	char *limit_str = getenv("OSCAP_PCRE_EXEC_RECURSION_LIMIT");
-	if (limit_str != NULL)
-		if (sscanf(limit_str, "%lu", &limit) <= 0)
-			dW("Unable to parse OSCAP_PCRE_EXEC_RECURSION_LIMIT value");
-	oscap_pcre_set_match_limit_recursion(re, limit);
-	size_t str_len = strlen(str);
-#if defined(OS_SOLARIS)
-	rc = oscap_pcre_exec(re, str, str_len, *ofs, OSCAP_PCRE_OPTS_NO_UTF8_CHECK, ovector, ovector_len);
+	// The limit is not set on the object, which may be shared by other threads
+#ifdef HAVE_PCRE2
+	rc = _oscap_pcre_exec(re, str, str_len, ofs, options, ovector, ovector_len, re->substr_ctx);
 #else
-	rc = oscap_pcre_exec(re, str, str_len, *ofs, 0, ovector, ovector_len);
+	struct pcre_extra extra;
+	if (re->re_extra != NULL)
+		extra = *re->re_extra;
+	else
+		memset(&extra, 0, sizeof(extra));
+	extra.match_limit_recursion = oscap_pcre_recursion_limit;
+	extra.flags |= PCRE_EXTRA_MATCH_LIMIT_RECURSION;
+	rc = _oscap_pcre_exec(re, str, str_len, ofs, options, ovector, ovector_len, &extra);
 #endif
 
 	if (rc < OSCAP_PCRE_ERR_NOMATCH) {
 		if (str_len < 100)
-			dE("Function oscap_pcre_exec() failed to match a regular expression with return code %d on string '%s'.", rc, str);
+			dE("Function oscap_pcre_exec() failed to match a regular expression with return code %d on string '%.*s'.", rc, str_len, str);
 		else
 			dE("Function oscap_pcre_exec() failed to match a regular expression with return code %d on string '%.100s' (truncated, showing first 100 characters).", rc, str);
 		return rc;
@@ -275,7 +1027,8 @@ int oscap_pcre_get_substrings(char *str, int *ofs, oscap_pcre_t *re, int want_su
 		return 0;
 	}
 
-	*ofs = (*ofs == ovector[1]) ? ovector[1] + 1 : ovector[1];
+	match[0] = ovector[0];
+	match[1] = ovector[1];
 
 	if (!want_substrs) {
 		/* just report successful match */
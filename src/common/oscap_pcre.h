@@ -62,6 +62,8 @@ oscap_pcre_t* oscap_pcre_compile(const char *pattern, oscap_pcre_options_t optio
 /**
  * Execute the compiled regular expression against a string subject and returns
  * matches count (or a negative error code).
+ * A subject that doesn't contain any of the literal strings required by the
+ * pattern is rejected without running PCRE.
  * @param opcre the oscap_pcre_t object
  * @param subject target string
  * @param length target string length
@@ -92,12 +94,63 @@ void oscap_pcre_set_match_limit_recursion(oscap_pcre_t *opcre, unsigned long lim
 
 /**
  * Optimize the compiled regular expression object to increase matching speed.
+ * With PCRE2 the pattern is JIT compiled, which pays off for patterns
+ * matched against many or long subjects.
  * @param opcre the oscap_pcre_t object
  */
 void oscap_pcre_optimize(oscap_pcre_t *opcre);
 
+/**
+ * Get the number of oscap_pcre_exec() calls made with the regular expression
+ * and how many of them were rejected by the literal prefilter. The counters
+ * are updated atomically, calls from all threads using the object are
+ * counted, including all users of an object from oscap_pcre_cache_get().
+ * @param opcre the oscap_pcre_t object
+ * @param exec_cnt number of match attempts
+ * @param prefiltered_cnt number of attempts that didn't need to run PCRE
+ */
+void oscap_pcre_get_stats(const oscap_pcre_t *opcre, unsigned long *exec_cnt, unsigned long *prefiltered_cnt);
+
+/**
+ * Get a compiled and optimized regular expression from the process-wide
+ * cache, compiling it on a miss. The cache is thread-safe and keyed by the
+ * pattern and the options, the least recently used entries are evicted.
+ * The returned object is shared: it must not be modified, e.g. with
+ * oscap_pcre_set_match_limit_recursion(), and has to be released with
+ * oscap_pcre_cache_release() instead of oscap_pcre_free().
+ * @param pattern expresstion string
+ * @param options compile options
+ * @param errptr a return value for a string representation of error
+ * @param erroffset the offset in the expression where the problem was detected
+ * @return a shared PCRE object
+ * NULL on failure
+ */
+oscap_pcre_t *oscap_pcre_cache_get(const char *pattern, oscap_pcre_options_t options,
+                                   char **errptr, int *erroffset);
+
+/**
+ * Release a regular expression returned by oscap_pcre_cache_get().
+ * @param opcre the oscap_pcre_t object
+ */
+void oscap_pcre_cache_release(oscap_pcre_t *opcre);
+
+/**
+ * Get the number of cache lookups that found a compiled pattern, that had to
+ * compile it and the number of patterns evicted to make room for others.
+ */
+void oscap_pcre_cache_get_stats(unsigned long *hits, unsigned long *misses, unsigned long *evictions);
+
+/**
+ * Drop all patterns from the cache and reset its statistics. Patterns still
+ * in use are freed when released.
+ */
+void oscap_pcre_cache_clear(void);
+
 /**
  * Match a regular expression and return substrings.
+ * The recursion depth is limited by OSCAP_PCRE_EXEC_RECURSION_LIMIT, read
+ * from the environment when the first regular expression is compiled,
+ * instead of the limit set by oscap_pcre_set_match_limit_recursion().
  * Caller is responsible for freeing the returned array.
  * @param str subject string
  * @param ofs starting offset in str
@@ -109,6 +162,26 @@ void oscap_pcre_optimize(oscap_pcre_t *opcre);
  */
 int oscap_pcre_get_substrings(char *str, int *ofs, oscap_pcre_t *re, int want_substrs, char ***substrings);
 
+/**
+ * Match a regular expression against a subject of the given length and
+ * return substrings. Unlike oscap_pcre_get_substrings() the subject doesn't
+ * have to be NUL terminated and the offset isn't advanced; the caller gets
+ * the position of the match instead.
+ * Caller is responsible for freeing the returned array.
+ * @param str subject string
+ * @param str_len length of the subject
+ * @param ofs starting offset in str
+ * @param re compiled regular expression
+ * @param options match options
+ * @param want_substrs if non-zero, substrings will be returned
+ * @param match returns the start and end offset of the match
+ * @param substrings contains returned substrings
+ * @return count of matched substrings, 0 if no match
+ * negative value on failure
+ */
+int oscap_pcre_get_substrings_n(const char *str, int str_len, int ofs, oscap_pcre_t *re,
+                                oscap_pcre_options_t options, int want_substrs, int *match, char ***substrings);
+
 /**
  * Free the error message returned by oscap_pcre_compile. DON'T USE REGULAR free()!
  * @param err the message
@@ -0,0 +1,395 @@
+/*
+ * Copyright 2026 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <errno.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#ifndef OS_WINDOWS
+#include <sys/resource.h>
+#endif
+
+#include "debug_priv.h"
+#include "list.h"
+#include "memusage.h"
+#include "oscap.h"
+#include "oscap_profile.h"
+#include "util.h"
+
+#define OSCAP_PROFILE_FILE_ENV "OSCAP_PROFILE_FILE"
+
+static const char *oscap_profile_phase_names[OSCAP_PROFILE_PHASE_COUNT] = {
+	[OSCAP_PROFILE_SOURCE_LOAD]    = "source_load",
+	[OSCAP_PROFILE_VALIDATION]     = "validation",
+	[OSCAP_PROFILE_SDS_EXTRACTION] = "sds_component_extraction",
+	[OSCAP_PROFILE_MODEL_PARSING]  = "model_parsing",
+	[OSCAP_PROFILE_EVALUATION]     = "evaluation",
+	[OSCAP_PROFILE_EXPORT]         = "export",
+	[OSCAP_PROFILE_XSLT]           = "xslt",
+};
+
+struct oscap_profile_phase_stats {
+	uint64_t count;
+	uint64_t wall_ns;
+	uint64_t cpu_ns;
+	size_t peak_rss_kb;
+};
+
+struct oscap_profile_probe_stats {
+	char *name;
+	uint64_t objects;
+	uint64_t items;
+	uint64_t wall_ns;
+};
+
+static bool profile_enabled = false;
+static char *profile_path = NULL;
+static uint64_t profile_start_ns;
+static pthread_mutex_t profile_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct oscap_profile_phase_stats profile_phases[OSCAP_PROFILE_PHASE_COUNT];
+static struct oscap_htable *profile_probes = NULL;
+/* Per-thread depth of every phase, nested phases of the same kind are counted once */
+static pthread_key_t profile_depth_key;
+
+/* Profiling may be disabled by oscap_profile_cleanup() while other threads check it */
+static inline bool _profile_enabled(void)
+{
+#if defined(_MSC_VER)
+	return *(volatile bool *) &profile_enabled;
+#else
+	return __atomic_load_n(&profile_enabled, __ATOMIC_ACQUIRE);
+#endif
+}
+
+static inline void _profile_set_enabled(bool enabled)
+{
+#if defined(_MSC_VER)
+	*(volatile bool *) &profile_enabled = enabled;
+#else
+	__atomic_store_n(&profile_enabled, enabled, __ATOMIC_RELEASE);
+#endif
+}
+
+uint64_t oscap_profile_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static uint64_t _thread_cpu_ns(void)
+{
+#ifdef CLOCK_THREAD_CPUTIME_ID
+	struct timespec ts;
+
+	if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) == 0)
+		return (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+#endif
+	return 0;
+}
+
+static size_t _peak_rss_kb(void)
+{
+	struct proc_memusage mu;
+
+	if (oscap_proc_memusage(&mu) != 0)
+		return 0;
+	return mu.mu_hwm;
+}
+
+void oscap_profile_init(void)
+{
+	const char *path = getenv(OSCAP_PROFILE_FILE_ENV);
+
+	if (path == NULL || *path == '\0')
+		return;
+	pthread_mutex_lock(&profile_lock);
+	if (profile_enabled) {
+		pthread_mutex_unlock(&profile_lock);
+		return;
+	}
+	if (pthread_key_create(&profile_depth_key, free) != 0) {
+		dW("Unable to create a thread key, profiling is disabled.");
+		pthread_mutex_unlock(&profile_lock);
+		return;
+	}
+	profile_path = oscap_strdup(path);
+	profile_probes = oscap_htable_new();
+	if (profile_path == NULL || profile_probes == NULL) {
+		dW("Unable to allocate the profile, profiling is disabled.");
+		free(profile_path);
+		profile_path = NULL;
+		oscap_htable_free0(profile_probes);
+		profile_probes = NULL;
+		pthread_key_delete(profile_depth_key);
+		pthread_mutex_unlock(&profile_lock);
+		return;
+	}
+	profile_start_ns = oscap_profile_now();
+	_profile_set_enabled(true);
+	pthread_mutex_unlock(&profile_lock);
+}
+
+bool oscap_profile_enabled(void)
+{
+	return _profile_enabled();
+}
+
+void oscap_profile_begin(struct oscap_profile_span *span, oscap_profile_phase_t phase)
+{
+	span->phase = phase;
+	span->active = false;
+	if (!_profile_enabled())
+		return;
+
+	unsigned int *depth = pthread_getspecific(profile_depth_key);
+	if (depth == NULL) {
+		depth = calloc(OSCAP_PROFILE_PHASE_COUNT, sizeof(unsigned int));
+		if (depth == NULL || pthread_setspecific(profile_depth_key, depth) != 0) {
+			free(depth);
+			return;
+		}
+	}
+	if (depth[phase]++ > 0)
+		return;
+
+	span->active = true;
+	span->wall_ns = oscap_profile_now();
+	span->cpu_ns = _thread_cpu_ns();
+}
+
+void oscap_profile_end(struct oscap_profile_span *span)
+{
+	if (!_profile_enabled())
+		return;
+
+	unsigned int *depth = pthread_getspecific(profile_depth_key);
+	if (depth != NULL && depth[span->phase] > 0)
+		depth[span->phase]--;
+	if (!span->active)
+		return;
+
+	uint64_t wall_ns = oscap_profile_now() - span->wall_ns;
+	uint64_t cpu_ns = _thread_cpu_ns() - span->cpu_ns;
+	size_t peak_rss_kb = _peak_rss_kb();
+
+	pthread_mutex_lock(&profile_lock);
+	if (!profile_enabled) {
+		pthread_mutex_unlock(&profile_lock);
+		return;
+	}
+	struct oscap_profile_phase_stats *stats = &profile_phases[span->phase];
+	stats->count++;
+	stats->wall_ns += wall_ns;
+	stats->cpu_ns += cpu_ns;
+	if (peak_rss_kb > stats->peak_rss_kb)
+		stats->peak_rss_kb = peak_rss_kb;
+	pthread_mutex_unlock(&profile_lock);
+	span->active = false;
+}
+
+static void _probe_stats_free(void *ptr)
+{
+	struct oscap_profile_probe_stats *stats = ptr;
+
+	if (stats == NULL)
+		return;
+	free(stats->name);
+	free(stats);
+}
+
+void oscap_profile_probe(const char *probe, uint64_t wall_ns, size_t items)
+{
+	if (!_profile_enabled() || probe == NULL)
+		return;
+
+	pthread_mutex_lock(&profile_lock);
+	if (!profile_enabled) {
+		pthread_mutex_unlock(&profile_lock);
+		return;
+	}
+	struct oscap_profile_probe_stats *stats = oscap_htable_get(profile_probes, probe);
+	if (stats == NULL) {
+		stats = calloc(1, sizeof(struct oscap_profile_probe_stats));
+		if (stats != NULL)
+			stats->name = oscap_strdup(probe);
+		if (stats == NULL || stats->name == NULL || !oscap_htable_add(profile_probes, probe, stats)) {
+			_probe_stats_free(stats);
+			pthread_mutex_unlock(&profile_lock);
+			return;
+		}
+	}
+	stats->objects++;
+	stats->items += items;
+	stats->wall_ns += wall_ns;
+	pthread_mutex_unlock(&profile_lock);
+}
+
+static int _probe_stats_cmp(const void *a, const void *b)
+{
+	const struct oscap_profile_probe_stats *sa = *(struct oscap_profile_probe_stats * const *) a;
+	const struct oscap_profile_probe_stats *sb = *(struct oscap_profile_probe_stats * const *) b;
+
+	return strcmp(sa->name, sb->name);
+}
+
+static inline double _ms(uint64_t ns)
+{
+	return ns / 1000000.0;
+}
+
+/* Write a string as a quoted JSON string */
+static void _write_json_string(FILE *f, const char *str)
+{
+	fputc('"', f);
+	for (const unsigned char *c = (const unsigned char *) str; *c != '\0'; ++c) {
+		switch (*c) {
+		case '"':
+			fputs("\\\"", f);
+			break;
+		case '\\':
+			fputs("\\\\", f);
+			break;
+		case '\n':
+			fputs("\\n", f);
+			break;
+		case '\r':
+			fputs("\\r", f);
+			break;
+		case '\t':
+			fputs("\\t", f);
+			break;
+		default:
+			if (*c < 0x20)
+				fprintf(f, "\\u%04x", *c);
+			else
+				fputc(*c, f);
+		}
+	}
+	fputc('"', f);
+}
+
+static void _write_json(FILE *f)
+{
+	uint64_t cpu_ns = 0;
+#ifndef OS_WINDOWS
+	struct rusage ru;
+
+	if (getrusage(RUSAGE_SELF, &ru) == 0) {
+		cpu_ns = ((uint64_t) ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) * 1000000000 +
+			((uint64_t) ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) * 1000;
+	}
+#endif
+
+	fprintf(f, "{\n");
+	fprintf(f, "  \"openscap_version\": ");
+	_write_json_string(f, oscap_get_version());
+	fprintf(f, ",\n");
+	fprintf(f, "  \"wall_ms\": %.3f,\n", _ms(oscap_profile_now() - profile_start_ns));
+	fprintf(f, "  \"cpu_ms\": %.3f,\n", _ms(cpu_ns));
+	fprintf(f, "  \"peak_rss_kb\": %zu,\n", _peak_rss_kb());
+
+	fprintf(f, "  \"phases\": {");
+	for (int i = 0; i < OSCAP_PROFILE_PHASE_COUNT; ++i) {
+		const struct oscap_profile_phase_stats *stats = &profile_phases[i];
+		fprintf(f, "%s\n    ", i > 0 ? "," : "");
+		_write_json_string(f, oscap_profile_phase_names[i]);
+		fprintf(f, ": {\"count\": %"PRIu64", \"wall_ms\": %.3f, \"cpu_ms\": %.3f, \"peak_rss_kb\": %zu}",
+			stats->count, _ms(stats->wall_ns), _ms(stats->cpu_ns), stats->peak_rss_kb);
+	}
+	fprintf(f, "\n  },\n");
+
+	/* Probes are written in the order of their names so that profiles of several runs can be diffed */
+	size_t count = oscap_htable_itemcount(profile_probes);
+	struct oscap_profile_probe_stats **probes = malloc((count + 1) * sizeof(struct oscap_profile_probe_stats *));
+	size_t n = 0;
+	if (probes != NULL) {
+		struct oscap_htable_iterator *it = oscap_htable_iterator_new(profile_probes);
+		while (oscap_htable_iterator_has_more(it) && n < count)
+			probes[n++] = oscap_htable_iterator_next_value(it);
+		oscap_htable_iterator_free(it);
+		qsort(probes, n, sizeof(struct oscap_profile_probe_stats *), _probe_stats_cmp);
+	} else {
+		dW("Unable to sort the probes, they are left out of the profile.");
+	}
+
+	fprintf(f, "  \"probes\": {");
+	for (size_t i = 0; i < n; ++i) {
+		fprintf(f, "%s\n    ", i > 0 ? "," : "");
+		_write_json_string(f, probes[i]->name);
+		fprintf(f, ": {\"objects\": %"PRIu64", \"items\": %"PRIu64", \"wall_ms\": %.3f}",
+			probes[i]->objects, probes[i]->items, _ms(probes[i]->wall_ns));
+	}
+	fprintf(f, "%s}\n", n > 0 ? "\n  " : "");
+	fprintf(f, "}\n");
+	free(probes);
+}
+
+void oscap_profile_write(void)
+{
+	if (!_profile_enabled())
+		return;
+
+	pthread_mutex_lock(&profile_lock);
+	if (!profile_enabled) {
+		pthread_mutex_unlock(&profile_lock);
+		return;
+	}
+	FILE *f = fopen(profile_path, "w");
+	if (f == NULL) {
+		dW("Unable to write the profile to '%s': %s", profile_path, strerror(errno));
+	} else {
+		_write_json(f);
+		fclose(f);
+	}
+	pthread_mutex_unlock(&profile_lock);
+}
+
+void oscap_profile_cleanup(void)
+{
+	if (!_profile_enabled())
+		return;
+
+	pthread_mutex_lock(&profile_lock);
+	if (!profile_enabled) {
+		pthread_mutex_unlock(&profile_lock);
+		return;
+	}
+	_profile_set_enabled(false);
+	oscap_htable_free(profile_probes, _probe_stats_free);
+	profile_probes = NULL;
+	free(profile_path);
+	profile_path = NULL;
+	memset(profile_phases, 0, sizeof(profile_phases));
+	pthread_mutex_unlock(&profile_lock);
+
+	/* Depths of other threads have been freed by the key destructor when
+	 * they exited, the key is created again by the next oscap_profile_init() */
+	free(pthread_getspecific(profile_depth_key));
+	pthread_setspecific(profile_depth_key, NULL);
+	pthread_key_delete(profile_depth_key);
+}
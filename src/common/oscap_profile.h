@@ -0,0 +1,89 @@
+/*
+ * Copyright 2026 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef OSCAP_PROFILE_H
+#define OSCAP_PROFILE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Phases of a run which are timed when OSCAP_PROFILE_FILE is set. The time
+ * of a phase includes the phases nested in it, e.g. model parsing includes
+ * the load of the source it parses. A phase nested in itself on the same
+ * thread is counted once.
+ */
+typedef enum {
+	OSCAP_PROFILE_SOURCE_LOAD,
+	OSCAP_PROFILE_VALIDATION,
+	OSCAP_PROFILE_SDS_EXTRACTION,
+	OSCAP_PROFILE_MODEL_PARSING,
+	OSCAP_PROFILE_EVALUATION,
+	OSCAP_PROFILE_EXPORT,
+	OSCAP_PROFILE_XSLT,
+	OSCAP_PROFILE_PHASE_COUNT
+} oscap_profile_phase_t;
+
+struct oscap_profile_span {
+	oscap_profile_phase_t phase;
+	bool active;
+	uint64_t wall_ns;
+	uint64_t cpu_ns;
+};
+
+/*
+ * Read OSCAP_PROFILE_FILE and start the clock of the whole run.
+ * Called from oscap_init().
+ */
+void oscap_profile_init(void);
+
+/*
+ * Write the collected profile as JSON to the file given by
+ * OSCAP_PROFILE_FILE. Called from oscap_cleanup().
+ */
+void oscap_profile_write(void);
+
+/*
+ * Release the collected profile and stop profiling.
+ * Called from oscap_cleanup() after oscap_profile_write().
+ */
+void oscap_profile_cleanup(void);
+
+bool oscap_profile_enabled(void);
+
+/*
+ * Monotonic time in nanoseconds
+ */
+uint64_t oscap_profile_now(void);
+
+/*
+ * Time a phase on the calling thread. Both calls do nothing when
+ * profiling is disabled.
+ */
+void oscap_profile_begin(struct oscap_profile_span *span, oscap_profile_phase_t phase);
+void oscap_profile_end(struct oscap_profile_span *span);
+
+/*
+ * Account one object collected by the probe of the given name which took
+ * wall_ns nanoseconds and yielded the given number of items.
+ */
+void oscap_profile_probe(const char *probe, uint64_t wall_ns, size_t items);
+
+#endif /* OSCAP_PROFILE_H */
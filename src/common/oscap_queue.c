@@ -87,7 +87,7 @@ void oscap_queue_free(struct oscap_queue *queue, oscap_destruct_func destructor)
 		temp = current;
 		current = current->next;
 		if (destructor != NULL) {
-			free(temp->data);
+			destructor(temp->data);
 		}
 		free(temp);
 	}
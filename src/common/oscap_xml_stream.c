@@ -0,0 +1,354 @@
+/*
+ * Copyright 2026 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef OS_WINDOWS
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+#include <libxml/xmlsave.h>
+#include <libxml/xmlwriter.h>
+
+#include "_error.h"
+#include "debug_priv.h"
+#include "oscap_xml_stream.h"
+#include "util.h"
+
+struct oscap_xml_stream_level {
+	xmlNode *node;
+	int ns_count;       ///< namespaces the start tag was written with
+	bool has_children;  ///< whether anything was written inside
+	bool unformatted;   ///< children are written as they are, without indentation
+};
+
+struct oscap_xml_stream {
+	char *filename;
+	int fd;
+	xmlDoc *doc;
+	xmlOutputBuffer *out;
+	xmlTextWriter *writer;
+	struct oscap_xml_stream_level *levels;
+	size_t depth;
+	size_t size;
+	bool error;
+};
+
+struct oscap_xml_stream *oscap_xml_stream_new(const char *filename, xmlDoc *doc)
+{
+	xmlOutputBuffer *out;
+	int fd = -1;
+
+	if (strcmp(filename, "-") == 0) {
+		out = xmlOutputBufferCreateFile(stdout, NULL);
+	} else {
+		fd = oscap_open_writable(filename);
+		if (fd == -1)
+			return NULL;
+		out = xmlOutputBufferCreateFd(fd, NULL);
+	}
+	if (out == NULL) {
+		oscap_setxmlerr(xmlGetLastError());
+		if (fd != -1)
+			close(fd);
+		return NULL;
+	}
+
+	/* The writer takes over the output buffer */
+	xmlTextWriter *writer = xmlNewTextWriter(out);
+	if (writer == NULL) {
+		oscap_setxmlerr(xmlGetLastError());
+		xmlOutputBufferClose(out);
+		if (fd != -1)
+			close(fd);
+		return NULL;
+	}
+
+	struct oscap_xml_stream *stream = calloc(1, sizeof(struct oscap_xml_stream));
+	if (stream == NULL) {
+		oscap_seterr(OSCAP_EFAMILY_GLIBC, "Insufficient memory to write '%s'.", filename);
+		xmlFreeTextWriter(writer);
+		if (fd != -1)
+			close(fd);
+		return NULL;
+	}
+	stream->filename = oscap_strdup(filename);
+	stream->fd = fd;
+	stream->doc = doc;
+	stream->out = out;
+	stream->writer = writer;
+	if (xmlTextWriterStartDocument(writer, NULL, "UTF-8", NULL) < 0)
+		stream->error = true;
+	return stream;
+}
+
+static void _stream_indent(struct oscap_xml_stream *stream, size_t level)
+{
+	char indent[2 * 32 + 2];
+
+	if (level > 32)
+		level = 32;
+	indent[0] = '\n';
+	memset(indent + 1, ' ', 2 * level);
+	indent[2 * level + 1] = '\0';
+	if (xmlTextWriterWriteRaw(stream->writer, BAD_CAST indent) < 0)
+		stream->error = true;
+}
+
+static xmlChar *_qname(xmlNs *ns, const xmlChar *name)
+{
+	if (ns == NULL || ns->prefix == NULL)
+		return xmlStrdup(name);
+	xmlChar *qname = xmlStrdup(ns->prefix);
+	qname = xmlStrcat(qname, BAD_CAST ":");
+	return xmlStrcat(qname, name);
+}
+
+static int _ns_count(xmlNode *node)
+{
+	int count = 0;
+	for (xmlNs *ns = node->nsDef; ns != NULL; ns = ns->next)
+		count++;
+	return count;
+}
+
+static void _stream_start_tag(struct oscap_xml_stream *stream, xmlNode *node)
+{
+	xmlChar *qname = _qname(node->ns, node->name);
+	if (xmlTextWriterStartElement(stream->writer, qname) < 0)
+		stream->error = true;
+	xmlFree(qname);
+
+	for (xmlNs *ns = node->nsDef; ns != NULL; ns = ns->next) {
+		xmlChar *name = xmlStrdup(BAD_CAST "xmlns");
+		if (ns->prefix != NULL) {
+			name = xmlStrcat(name, BAD_CAST ":");
+			name = xmlStrcat(name, ns->prefix);
+		}
+		if (xmlTextWriterWriteAttribute(stream->writer, name, ns->href) < 0)
+			stream->error = true;
+		xmlFree(name);
+	}
+	for (xmlAttr *attr = node->properties; attr != NULL; attr = attr->next) {
+		xmlChar *name = _qname(attr->ns, attr->name);
+		xmlChar *value = xmlNodeGetContent((xmlNode *) attr);
+		if (xmlTextWriterWriteAttribute(stream->writer, name, value != NULL ? value : BAD_CAST "") < 0)
+			stream->error = true;
+		xmlFree(value);
+		xmlFree(name);
+	}
+}
+
+/*
+ * Some *_to_dom() functions declare a namespace at the root element only
+ * when they need it. Such late declarations did not make it into the start
+ * tags which have been written already, repeat them on the node.
+ */
+static void _stream_declare_late_namespaces(struct oscap_xml_stream *stream, xmlNode *node)
+{
+	for (size_t i = 0; i < stream->depth; ++i) {
+		xmlNs *ns = stream->levels[i].node->nsDef;
+		for (int skip = stream->levels[i].ns_count; ns != NULL && skip > 0; --skip)
+			ns = ns->next;
+		for (; ns != NULL; ns = ns->next) {
+			if (ns->prefix != NULL)
+				xmlNewNs(node, ns->href, ns->prefix);
+		}
+	}
+}
+
+/*
+ * Like xmlSaveFormatFile(), don't indent the children of an element
+ * with mixed content.
+ */
+static bool _has_text_children(xmlNode *node)
+{
+	for (xmlNode *child = node->children; child != NULL; child = child->next) {
+		if (child->type == XML_TEXT_NODE || child->type == XML_CDATA_SECTION_NODE ||
+		    child->type == XML_ENTITY_REF_NODE)
+			return true;
+	}
+	return false;
+}
+
+static void _stream_dump(struct oscap_xml_stream *stream, xmlDoc *doc, xmlNode *node, size_t level)
+{
+	bool unformatted = stream->levels[level - 1].unformatted;
+
+	if (node->type == XML_ELEMENT_NODE && doc == stream->doc)
+		_stream_declare_late_namespaces(stream, node);
+	/* An empty write still makes the writer finish the start tag of the parent */
+	if (!unformatted)
+		_stream_indent(stream, level);
+	else if (xmlTextWriterWriteRaw(stream->writer, BAD_CAST "") < 0)
+		stream->error = true;
+	xmlNodeDumpOutput(stream->out, doc, node, level, unformatted ? 0 : 1, "UTF-8");
+	if (stream->out->error != 0)
+		stream->error = true;
+	stream->levels[level - 1].has_children = true;
+}
+
+/*
+ * Write and free the children of the open element at the given level
+ * up to the stop node. The open child is left alone.
+ */
+static void _stream_flush_children(struct oscap_xml_stream *stream, size_t level, xmlNode *stop)
+{
+	xmlNode *child = stream->levels[level].node->children;
+	while (child != NULL && child != stop) {
+		xmlNode *next = child->next;
+		if (level + 1 < stream->depth && stream->levels[level + 1].node == child) {
+			child = next;
+			continue;
+		}
+		_stream_dump(stream, stream->doc, child, level + 1);
+		xmlUnlinkNode(child);
+		xmlFreeNode(child);
+		child = next;
+	}
+}
+
+int oscap_xml_stream_open(struct oscap_xml_stream *stream, xmlNode *node)
+{
+	if (stream == NULL)
+		return 0;
+
+	if (stream->depth > 0) {
+		struct oscap_xml_stream_level *parent = &stream->levels[stream->depth - 1];
+		if (node->parent != parent->node) {
+			oscap_seterr(OSCAP_EFAMILY_OSCAP, "Element '%s' is not a child of the open element '%s'.",
+				node->name, parent->node->name);
+			stream->error = true;
+			return -1;
+		}
+		_stream_flush_children(stream, stream->depth - 1, node);
+		if (!parent->unformatted)
+			_stream_indent(stream, stream->depth);
+		parent->has_children = true;
+	}
+
+	if (stream->depth == stream->size) {
+		size_t size = stream->size ? 2 * stream->size : 8;
+		struct oscap_xml_stream_level *levels = realloc(stream->levels, size * sizeof(struct oscap_xml_stream_level));
+		if (levels == NULL) {
+			oscap_seterr(OSCAP_EFAMILY_GLIBC, "Insufficient memory to open element '%s'.", node->name);
+			stream->error = true;
+			return -1;
+		}
+		stream->levels = levels;
+		stream->size = size;
+	}
+	_stream_start_tag(stream, node);
+	stream->levels[stream->depth].node = node;
+	stream->levels[stream->depth].ns_count = _ns_count(node);
+	stream->levels[stream->depth].has_children = false;
+	stream->levels[stream->depth].unformatted = false;
+	stream->depth++;
+	return stream->error ? -1 : 0;
+}
+
+int oscap_xml_stream_flush(struct oscap_xml_stream *stream, xmlNode *node)
+{
+	if (stream == NULL)
+		return 0;
+
+	if (stream->depth == 0 || stream->levels[stream->depth - 1].node != node) {
+		oscap_seterr(OSCAP_EFAMILY_OSCAP, "Element '%s' is not the innermost open element.", node->name);
+		stream->error = true;
+		return -1;
+	}
+	_stream_flush_children(stream, stream->depth - 1, NULL);
+	return stream->error ? -1 : 0;
+}
+
+int oscap_xml_stream_write(struct oscap_xml_stream *stream, xmlDoc *doc, xmlNode *node)
+{
+	if (stream == NULL)
+		return 0;
+
+	if (stream->depth == 0) {
+		oscap_seterr(OSCAP_EFAMILY_OSCAP, "There is no open element to write '%s' into.", node->name);
+		stream->error = true;
+		return -1;
+	}
+	_stream_flush_children(stream, stream->depth - 1, NULL);
+	struct oscap_xml_stream_level *parent = &stream->levels[stream->depth - 1];
+	if (!parent->has_children && node->parent != NULL && node->parent->type == XML_ELEMENT_NODE)
+		parent->unformatted = _has_text_children(node->parent);
+	_stream_dump(stream, doc, node, stream->depth);
+	return stream->error ? -1 : 0;
+}
+
+int oscap_xml_stream_close(struct oscap_xml_stream *stream, xmlNode *node)
+{
+	if (stream == NULL)
+		return 0;
+
+	if (stream->depth == 0 || stream->levels[stream->depth - 1].node != node) {
+		oscap_seterr(OSCAP_EFAMILY_OSCAP, "Element '%s' is not the innermost open element.", node->name);
+		stream->error = true;
+		return -1;
+	}
+	_stream_flush_children(stream, stream->depth - 1, NULL);
+	stream->depth--;
+	if (stream->levels[stream->depth].has_children && !stream->levels[stream->depth].unformatted)
+		_stream_indent(stream, stream->depth);
+	if (xmlTextWriterEndElement(stream->writer) < 0)
+		stream->error = true;
+
+	if (stream->depth > 0) {
+		xmlUnlinkNode(node);
+		xmlFreeNode(node);
+	}
+	return stream->error ? -1 : 0;
+}
+
+int oscap_xml_stream_free(struct oscap_xml_stream *stream)
+{
+	if (stream == NULL)
+		return -1;
+
+	if (stream->depth > 0) {
+		dW("Stream of '%s' finished with %zu open elements.", stream->filename, stream->depth);
+		stream->error = true;
+	}
+	if (xmlTextWriterEndDocument(stream->writer) < 0 || stream->out->error != 0)
+		stream->error = true;
+	if (xmlTextWriterFlush(stream->writer) < 0)
+		stream->error = true;
+	/* Frees the output buffer as well */
+	xmlFreeTextWriter(stream->writer);
+	if (stream->fd != -1 && close(stream->fd) != 0)
+		stream->error = true;
+
+	int ret = stream->error ? -1 : 0;
+	if (stream->error)
+		oscap_seterr(OSCAP_EFAMILY_OSCAP, "Could not write '%s'.", stream->filename);
+	free(stream->levels);
+	free(stream->filename);
+	free(stream);
+	return ret;
+}
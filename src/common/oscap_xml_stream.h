@@ -0,0 +1,77 @@
+/*
+ * Copyright 2026 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef OSCAP_XML_STREAM_H
+#define OSCAP_XML_STREAM_H
+
+#include <libxml/tree.h>
+
+/*
+ * Incremental writer of a document which is built by the usual *_to_dom()
+ * functions. The document is kept as a skeleton of open elements only:
+ * every finished child of an open element is written out and freed.
+ *
+ * The caller builds the tree as it would for an in-memory export and
+ * marks the elements with many children by open() and close(). All the
+ * functions do nothing when given a NULL stream, so the same *_to_dom()
+ * code serves both the in-memory and the streaming export.
+ *
+ * The output is formatted the same way as oscap_xml_save_filename() does.
+ */
+struct oscap_xml_stream;
+
+/*
+ * Start writing a document to the given file, "-" stands for stdout.
+ * The elements passed to the stream are expected to belong to doc.
+ */
+struct oscap_xml_stream *oscap_xml_stream_new(const char *filename, xmlDoc *doc);
+
+/*
+ * Write the start tag of the element. The element has to be the root
+ * of the document or a child of the innermost open element. Its earlier
+ * siblings are written first. Namespaces and attributes added to the
+ * element later on are not written.
+ */
+int oscap_xml_stream_open(struct oscap_xml_stream *stream, xmlNode *node);
+
+/*
+ * Write and free all the children of the innermost open element.
+ */
+int oscap_xml_stream_flush(struct oscap_xml_stream *stream, xmlNode *node);
+
+/*
+ * Write a node of another document as the next child of the innermost open
+ * element. The node is left untouched, so large documents can be copied to
+ * the output without cloning them into the streamed document first.
+ */
+int oscap_xml_stream_write(struct oscap_xml_stream *stream, xmlDoc *doc, xmlNode *node);
+
+/*
+ * Write the remaining children and the end tag of the innermost open
+ * element. The element is freed unless it is the root of the document.
+ */
+int oscap_xml_stream_close(struct oscap_xml_stream *stream, xmlNode *node);
+
+/*
+ * Finish the document and free the stream.
+ * @return 0 if the whole document was written, -1 otherwise
+ */
+int oscap_xml_stream_free(struct oscap_xml_stream *stream);
+
+#endif /* OSCAP_XML_STREAM_H */
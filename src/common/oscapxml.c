@@ -53,6 +53,8 @@
 #include "source/validate_priv.h"
 #include "source/xslt_priv.h"
 #include "oscap_helpers.h"
+#include "oscap_pcre.h"
+#include "oscap_profile.h"
 
 const char *const OSCAP_SCHEMA_PATH = OSCAP_DEFAULT_SCHEMA_PATH;
 const char *const OSCAP_XSLT_PATH = OSCAP_DEFAULT_XSLT_PATH;
@@ -114,11 +116,15 @@ void oscap_init(void)
     xmlInitParser();
     xsltInit();
     exsltRegisterAll();
+    oscap_profile_init();
 }
 
 void oscap_cleanup(void)
 {
+	oscap_profile_write();
+	oscap_profile_cleanup();
 	oscap_clearerr();
+	oscap_pcre_cache_clear();
 	xsltCleanupGlobals();
 	xmlCleanupParser();
 }
@@ -0,0 +1,155 @@
+/*
+ * Copyright 2026 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifndef OS_WINDOWS
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+#endif
+#include <openssl/evp.h>
+
+#include "common/debug_priv.h"
+#include "common/util.h"
+#include "oscap.h"
+#include "oscap_helpers.h"
+#include "source/content_cache_priv.h"
+#include "source/oscap_source_priv.h"
+
+#define CONTENT_CACHE_DIR_ENV "OSCAP_CONTENT_CACHE_DIR"
+
+#ifndef OS_WINDOWS
+static const char *_content_cache_dir(void)
+{
+	const char *dir = getenv(CONTENT_CACHE_DIR_ENV);
+	if (dir == NULL || *dir == '\0')
+		return NULL;
+	return dir;
+}
+
+/* Hexadecimal SHA-256 of the raw content or NULL if it can't be computed */
+static char *_content_cache_key(struct oscap_source *source)
+{
+	size_t size;
+	const char *buffer = oscap_source_get_raw_buffer(source, &size);
+	if (buffer == NULL)
+		return NULL;
+
+	// OpenSSL is always linked, unlike the crypto library behind crapi
+	unsigned char digest[EVP_MAX_MD_SIZE];
+	unsigned int digest_len = 0;
+	if (EVP_Digest(buffer, size, digest, &digest_len, EVP_sha256(), NULL) != 1)
+		return NULL;
+
+	char *key = malloc(2 * digest_len + 1);
+	if (key == NULL)
+		return NULL;
+	for (unsigned int i = 0; i < digest_len; ++i)
+		sprintf(key + 2 * i, "%02x", digest[i]);
+	return key;
+}
+
+static char *_content_cache_record(const char *schema_path)
+{
+	return oscap_sprintf("openscap %s\nschema %s\n", oscap_get_version(), schema_path);
+}
+#endif
+
+bool oscap_content_cache_is_valid(struct oscap_source *source, const char *schema_path)
+{
+#ifdef OS_WINDOWS
+	return false;
+#else
+	const char *dir = _content_cache_dir();
+	if (dir == NULL)
+		return false;
+	char *key = _content_cache_key(source);
+	if (key == NULL)
+		return false;
+
+	bool valid = false;
+	char *entry_path = oscap_sprintf("%s/%s", dir, key);
+	FILE *entry = fopen(entry_path, "r");
+	if (entry != NULL) {
+		char *record = _content_cache_record(schema_path);
+		size_t record_len = strlen(record);
+		char *stored = malloc(record_len + 1);
+		if (stored != NULL) {
+			// one more byte than the record to notice a longer entry
+			size_t stored_len = fread(stored, 1, record_len + 1, entry);
+			valid = stored_len == record_len && memcmp(stored, record, record_len) == 0;
+		}
+		if (!valid)
+			dD("Content cache entry %s is stale.", entry_path);
+		free(stored);
+		free(record);
+		fclose(entry);
+	}
+	free(entry_path);
+	free(key);
+	return valid;
+#endif
+}
+
+void oscap_content_cache_set_valid(struct oscap_source *source, const char *schema_path)
+{
+#ifndef OS_WINDOWS
+	const char *dir = _content_cache_dir();
+	if (dir == NULL)
+		return;
+	char *key = _content_cache_key(source);
+	if (key == NULL)
+		return;
+
+	if (mkdir(dir, S_IRWXU) != 0 && errno != EEXIST) {
+		dW("Can't create content cache directory %s: %s", dir, strerror(errno));
+		free(key);
+		return;
+	}
+
+	// the entry is written aside and renamed so that concurrent runs never read a partial one
+	char *entry_path = oscap_sprintf("%s/%s", dir, key);
+	char *tmp_path = oscap_sprintf("%s/.%s.XXXXXX", dir, key);
+	char *record = _content_cache_record(schema_path);
+	size_t record_len = strlen(record);
+	int fd = mkstemp(tmp_path);
+	if (fd < 0) {
+		dW("Can't create content cache entry %s: %s", entry_path, strerror(errno));
+	} else {
+		bool written = write(fd, record, record_len) == (ssize_t) record_len;
+		if (close(fd) != 0 || !written || rename(tmp_path, entry_path) != 0) {
+			dW("Can't write content cache entry %s: %s", entry_path, strerror(errno));
+			unlink(tmp_path);
+		}
+	}
+	free(record);
+	free(tmp_path);
+	free(entry_path);
+	free(key);
+#endif
+}
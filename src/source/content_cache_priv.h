@@ -0,0 +1,57 @@
+/*
+ * Copyright 2026 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ *
+ */
+#ifndef OSCAP_SOURCE_CONTENT_CACHE_H
+#define OSCAP_SOURCE_CONTENT_CACHE_H
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdbool.h>
+#include "source/public/oscap_source.h"
+
+/*
+ * The content cache is an opt-in directory given by OSCAP_CONTENT_CACHE_DIR.
+ * Entries are named by SHA-256 of the raw content of a resource and record
+ * the version of OpenSCAP and the schema the content has passed validation
+ * against. An entry made by another version or for another schema is stale
+ * and the content is validated again.
+ */
+
+/**
+ * Has the raw content of the source already passed validation against
+ * the given schema?
+ * @param source resource to be validated
+ * @param schema_path path to the XSD schema
+ * @returns true if the validation can be skipped, false if the cache is
+ * disabled, there is no such entry, the entry is stale or on any error
+ */
+bool oscap_content_cache_is_valid(struct oscap_source *source, const char *schema_path);
+
+/**
+ * Record that the raw content of the source has passed validation against
+ * the given schema. Errors are silently ignored.
+ * @param source resource that has been validated
+ * @param schema_path path to the XSD schema
+ */
+void oscap_content_cache_set_valid(struct oscap_source *source, const char *schema_path);
+
+#endif
@@ -31,6 +31,7 @@
 #else
 #include <unistd.h>
 #endif
+#include <sys/stat.h>
 #include <libxml/parser.h>
 #include <libxml/xmlreader.h>
 #include <libxml/xmlerror.h>
@@ -40,6 +41,7 @@
 #include "common/debug_priv.h"
 #include "common/public/oscap.h"
 #include "common/util.h"
+#include "common/oscap_profile.h"
 #include "CPE/public/cpe_lang.h"
 #include "CPE/cpedict_priv.h"
 #include "CPE/cpelang_priv.h"
@@ -60,6 +62,7 @@ typedef enum oscap_source_type {
 	OSCAP_SRC_FROM_USER_XML_FILE = 1,               ///< The source originated from XML file supplied by user
 	OSCAP_SRC_FROM_USER_MEMORY,                     ///< The source originated from memory supplied by user
 	OSCAP_SRC_FROM_XML_DOM,                         ///< The source originated from XML DOM (most often from DataStream).
+	OSCAP_SRC_FROM_XML_MEMORY,                      ///< The source originated from well-formed XML in memory (most often from DataStream).
 	// TODO: downloaded from an http address (XCCDF can refer to remote sources)
 } oscap_source_type_t;
 
@@ -75,6 +78,10 @@ struct oscap_source {
 	struct {
 		xmlDoc *doc;                            /// DOM
 	} xml;
+	struct {
+		char *buffer;                           ///< Content of the file, read once
+		size_t size;                            ///< Size of the content
+	} raw;
 };
 
 struct oscap_source *oscap_source_new_from_file(const char *filepath)
@@ -131,6 +138,14 @@ struct oscap_source *oscap_source_new_take_memory(char *buffer, size_t size, con
 	return source;
 }
 
+struct oscap_source *oscap_source_new_take_xml_memory(char *buffer, size_t size, const char *filepath)
+{
+	struct oscap_source *source = _create_oscap_source(size, filepath);
+	source->origin.type = OSCAP_SRC_FROM_XML_MEMORY;
+	source->origin.memory = buffer;
+	return source;
+}
+
 struct oscap_source *oscap_source_new_from_xmlDoc(xmlDoc *doc, const char *filepath)
 {
 	struct oscap_source *source = (struct oscap_source *) calloc(1, sizeof(struct oscap_source));
@@ -149,6 +164,7 @@ void oscap_source_free(struct oscap_source *source)
 			xmlFreeDoc(source->xml.doc);
 		}
 		free(source->origin.version);
+		free(source->raw.buffer);
 		free(source);
 	}
 }
@@ -163,6 +179,13 @@ void oscap_source_free_xmlDoc(struct oscap_source *source)
 	}
 }
 
+void oscap_source_release_xmlDoc(struct oscap_source *source)
+{
+	if (source != NULL && (source->origin.memory != NULL || source->raw.buffer != NULL)) {
+		oscap_source_free_xmlDoc(source);
+	}
+}
+
 /**
  * Returns human readable description of oscap_source origin
  */
@@ -173,13 +196,34 @@ const char *oscap_source_readable_origin(const struct oscap_source *source)
 	return source->origin.filepath;
 }
 
+static void xmlTextReaderErrorCb(void *source, xmlErrorPtr error)
+{
+	oscap_setxmlerr(error);
+}
+
+static void xmlTextReaderIgnoreErrorCb(void *source, xmlErrorPtr error)
+{
+	;
+}
+
 xmlTextReader *oscap_source_get_xmlTextReader(struct oscap_source *source)
 {
-	xmlDoc *doc = oscap_source_get_xmlDoc(source);
-	if (doc == NULL) {
-		return NULL;
+	xmlTextReader *reader;
+	if (source->xml.doc == NULL && source->origin.type == OSCAP_SRC_FROM_XML_MEMORY) {
+		// The content is known to be well-formed, parse it as it is read
+		// instead of building DOM first.
+		reader = xmlReaderForMemory(source->origin.memory, source->origin.memory_size,
+				oscap_source_readable_origin(source), NULL, 0);
+		if (reader != NULL) {
+			xmlTextReaderSetStructuredErrorHandler(reader, (xmlStructuredErrorFunc) xmlTextReaderErrorCb, source);
+		}
+	} else {
+		xmlDoc *doc = oscap_source_get_xmlDoc(source);
+		if (doc == NULL) {
+			return NULL;
+		}
+		reader = xmlReaderWalker(doc);
 	}
-	xmlTextReader *reader = xmlReaderWalker(doc);
 	if (reader == NULL) {
 		oscap_seterr(OSCAP_EFAMILY_XML, "Unable to create xmlTextReader for %s", oscap_source_readable_origin(source));
 		oscap_setxmlerr(xmlGetLastError());
@@ -187,8 +231,36 @@ xmlTextReader *oscap_source_get_xmlTextReader(struct oscap_source *source)
 	return reader;
 }
 
+/**
+ * Tell whether the raw content is a Source DataStream by reading its root
+ * element only. DataStreams are split into parts later, this saves building
+ * DOM of the whole file just to find out the type.
+ */
+static bool _raw_content_is_sds(struct oscap_source *source)
+{
+	size_t size = 0;
+	const char *buffer = oscap_source_get_raw_buffer(source, &size);
+	if (buffer == NULL) {
+		return false;
+	}
+	xmlTextReader *reader = xmlReaderForMemory(buffer, size, oscap_source_readable_origin(source), NULL, 0);
+	if (reader == NULL) {
+		return false;
+	}
+	// Errors are reported once the content is parsed for real
+	xmlTextReaderSetStructuredErrorHandler(reader, (xmlStructuredErrorFunc) xmlTextReaderIgnoreErrorCb, NULL);
+	int ret;
+	while ((ret = xmlTextReaderRead(reader)) == 1 && xmlTextReaderNodeType(reader) != XML_READER_TYPE_ELEMENT);
+	bool is_sds = ret == 1 && oscap_streq((const char *) xmlTextReaderConstLocalName(reader), "data-stream-collection");
+	xmlFreeTextReader(reader);
+	return is_sds;
+}
+
 oscap_document_type_t oscap_source_get_scap_type(struct oscap_source *source)
 {
+	if (source->scap_type == OSCAP_DOCUMENT_UNKNOWN && source->xml.doc == NULL && _raw_content_is_sds(source)) {
+		source->scap_type = OSCAP_DOCUMENT_SDS;
+	}
 	if (source->scap_type == OSCAP_DOCUMENT_UNKNOWN) {
 		xmlTextReader *reader = oscap_source_get_xmlTextReader(source);
 		if (reader == NULL) {
@@ -222,32 +294,6 @@ static void xmlErrorCb(struct oscap_string *buffer, const char * format, ...)
 	va_end(ap);
 }
 
-static bool fd_file_is_executable(int fd)
-{
-	int fd_dup = dup(fd);
-	if (fd_dup == -1) {
-		return false;
-	}
-	lseek(fd_dup, 0, SEEK_SET);
-	FILE* file = fdopen(fd_dup, "r");
-
-	if (file == NULL) {
-		// Cannot determine type of file we cannot open
-		return false;
-	}
-
-	// Check SHEBANG
-	// When we read after end of file, we get EOF (-1),
-	// So we don't have to do any special check
-	bool is_exec = true;
-	if ( fgetc(file) != (int)'#' ) is_exec = false;
-	if ( fgetc(file) != (int)'!' ) is_exec = false;
-
-	fclose(file);
-	lseek(fd, 0, SEEK_SET);
-	return is_exec;
-}
-
 static bool memory_file_is_executable(const char* memory, const size_t size)
 {
 	if (size < 2){
@@ -260,6 +306,65 @@ static bool memory_file_is_executable(const char* memory, const size_t size)
 	return true;
 }
 
+/*
+ * Read the whole file into memory, unless it has been done. The content
+ * of a DataStream is kept for the life of the source, so that its DOM and
+ * the components cut out of it come from the same bytes even if the file
+ * is replaced or truncated in the meantime. See _release_raw_file.
+ */
+static int _read_raw_file(struct oscap_source *source)
+{
+	if (source->raw.buffer != NULL) {
+		return 0;
+	}
+	int fd = open(source->origin.filepath, O_RDONLY);
+	if (fd == -1) {
+		return -1;
+	}
+	struct stat st;
+	// one more byte than the size, so that the end of file is read without growing
+	size_t alloc = (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) ? (size_t) st.st_size + 1 : 4096;
+	char *buffer = malloc(alloc);
+	size_t size = 0;
+	ssize_t len = 0;
+	while (buffer != NULL && (len = read(fd, buffer + size, alloc - size)) > 0) {
+		size += len;
+		if (size == alloc) {
+			char *grown = realloc(buffer, 2 * alloc);
+			if (grown == NULL) {
+				free(buffer);
+				buffer = NULL;
+				break;
+			}
+			buffer = grown;
+			alloc *= 2;
+		}
+	}
+	close(fd);
+	if (buffer == NULL || len < 0) {
+		free(buffer);
+		return -1;
+	}
+	source->raw.buffer = buffer;
+	source->raw.size = size;
+	return 0;
+}
+
+/*
+ * Free the raw content once DOM has been built from it. Only DataStreams
+ * need it further, their components are cut out of the raw bytes.
+ */
+static void _release_raw_file(struct oscap_source *source)
+{
+	xmlNode *root = source->xml.doc != NULL ? xmlDocGetRootElement(source->xml.doc) : NULL;
+	if (root != NULL && oscap_streq((const char *) root->name, "data-stream-collection")) {
+		return;
+	}
+	free(source->raw.buffer);
+	source->raw.buffer = NULL;
+	source->raw.size = 0;
+}
+
 xmlDoc *oscap_source_get_xmlDoc(struct oscap_source *source)
 {
 	// We check origin.memory first because even with it being non-NULL
@@ -268,6 +373,8 @@ xmlDoc *oscap_source_get_xmlDoc(struct oscap_source *source)
 	xmlSetGenericErrorFunc(xml_error_string, (xmlGenericErrorFunc)xmlErrorCb);
 
 	if (source->xml.doc == NULL) {
+		struct oscap_profile_span span;
+		oscap_profile_begin(&span, OSCAP_PROFILE_SOURCE_LOAD);
 		if (source->origin.memory != NULL) {
 			if (bz2_memory_is_bzip(source->origin.memory, source->origin.memory_size)) {
 #ifdef BZIP2_FOUND
@@ -292,23 +399,24 @@ xmlDoc *oscap_source_get_xmlDoc(struct oscap_source *source)
 			}
 		}
 		else {
-			int fd = open(source->origin.filepath, O_RDONLY);
-			if ( fd == -1 ){
+			// DOM is parsed from the same bytes as the components of
+			// a DataStream are cut from later, the file is read once.
+			if (_read_raw_file(source) != 0) {
 				source->xml.doc = NULL;
 				oscap_seterr(OSCAP_EFAMILY_GLIBC, "Unable to open file: '%s'", oscap_source_readable_origin(source));
 			} else {
-				if (bz2_fd_is_bzip(fd)) {
+				if (bz2_memory_is_bzip(source->raw.buffer, source->raw.size)) {
 #ifdef BZIP2_FOUND
-					source->xml.doc = bz2_fd_read_doc(fd);
+					source->xml.doc = bz2_mem_read_doc(source->raw.buffer, source->raw.size);
 #else
 					source->xml.doc = NULL;
 					oscap_seterr(OSCAP_EFAMILY_OSCAP, "Unable to unpack bz2 file '%s'. Please compile OpenSCAP with bz2 support.", oscap_source_readable_origin(source));
 #endif
 				} else
 				{
-					source->xml.doc = xmlReadFd(fd, NULL, NULL, 0);
+					source->xml.doc = xmlReadMemory(source->raw.buffer, source->raw.size, NULL, NULL, 0);
 					if (source->xml.doc == NULL) {
-						if (fd_file_is_executable(fd)) {
+						if (memory_file_is_executable(source->raw.buffer, source->raw.size)) {
 							dI("oscap-source file was detected as executable file '%s'. Skipped XML parsing", oscap_source_readable_origin(source));
 							oscap_string_clear(xml_error_string);
 						} else {
@@ -319,9 +427,10 @@ xmlDoc *oscap_source_get_xmlDoc(struct oscap_source *source)
 						}
 					}
 				}
-				close(fd);
+				_release_raw_file(source);
 			}
 		}
+		oscap_profile_end(&span);
 	}
 
 	xmlSetGenericErrorFunc(stderr, NULL);
@@ -358,7 +467,10 @@ int oscap_source_validate(struct oscap_source *source, xml_reporter reporter, vo
 		const char *type_name = oscap_document_type_to_string(scap_type);
 		const char *origin = oscap_source_readable_origin(source);
 		dD("Validating %s (%s) document from %s.", type_name, schema_version, origin);
+		struct oscap_profile_span span;
+		oscap_profile_begin(&span, OSCAP_PROFILE_VALIDATION);
 		ret = oscap_source_validate_priv(source, scap_type, schema_version, reporter, user);
+		oscap_profile_end(&span);
 		if (ret != 0) {
 			oscap_seterr(OSCAP_EFAMILY_OSCAP, "Invalid %s (%s) content in %s.", type_name, schema_version, origin);
 		}
@@ -460,6 +572,23 @@ int oscap_source_save_as(struct oscap_source *source, const char *filename)
 	return oscap_xml_save_filename(target, doc) == 1 ? 0 : -1;
 }
 
+const char *oscap_source_get_raw_buffer(struct oscap_source *source, size_t *size)
+{
+	if (source->origin.memory != NULL) {
+		if (bz2_memory_is_bzip(source->origin.memory, source->origin.memory_size)) {
+			return NULL;
+		}
+		*size = source->origin.memory_size;
+		return source->origin.memory;
+	}
+	if (source->origin.type != OSCAP_SRC_FROM_USER_XML_FILE || _read_raw_file(source) != 0 ||
+			source->raw.size == 0 || bz2_memory_is_bzip(source->raw.buffer, source->raw.size)) {
+		return NULL;
+	}
+	*size = source->raw.size;
+	return source->raw.buffer;
+}
+
 int oscap_source_get_raw_memory(struct oscap_source *source, char **buffer, size_t *size)
 {
 	if (source->origin.memory != NULL) {
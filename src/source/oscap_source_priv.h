@@ -48,6 +48,18 @@
  */
 struct oscap_source *oscap_source_new_take_memory(char *buffer, size_t size, const char *filepath);
 
+/**
+ * Create new oscap_source from raw memory holding well-formed XML, such as
+ * a component cut out of a DataStream. The memory buffer becomes owned by
+ * oscap_source. Unlike with oscap_source_new_take_memory the content is
+ * parsed by a streaming xmlTextReader until its DOM is requested.
+ * @param buffer Memory buffer with the XML document
+ * @param size size of the memory buffer
+ * @param filepath Suggested filename for the file or NULL
+ * @returns newly created oscap_source_structure
+ */
+struct oscap_source *oscap_source_new_take_xml_memory(char *buffer, size_t size, const char *filepath);
+
 /**
  * Build new oscap_source from existing xmlDoc. The xmlDoc becomes owned
  * by oscap_source.
@@ -85,4 +97,24 @@ xmlDoc *oscap_source_get_xmlDoc(struct oscap_source *source);
  */
 xmlDoc *oscap_source_pop_xmlDoc(struct oscap_source *source);
 
+/**
+ * Free the DOM of this resource if it can be parsed again from the content
+ * it has been parsed from. DOM of a resource that doesn't originate from
+ * a file or memory is kept.
+ * @memberof oscap_source
+ * @param source Resource to free the DOM of
+ */
+void oscap_source_release_xmlDoc(struct oscap_source *source);
+
+/**
+ * Get the raw content of this resource without parsing it. Files are read
+ * to memory once, their DOM is parsed from the same content. The buffer is
+ * still owned by oscap_source and it is not NUL-terminated.
+ * @memberof oscap_source
+ * @param source Resource to read the content
+ * @param size Size of the content
+ * @returns the content or NULL if it is compressed or not available
+ */
+const char *oscap_source_get_raw_buffer(struct oscap_source *source, size_t *size);
+
 #endif
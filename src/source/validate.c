@@ -36,6 +36,8 @@
 #include "common/util.h"
 #include "oscap.h"
 #include "oscap_source.h"
+#include "common/debug_priv.h"
+#include "source/content_cache_priv.h"
 #include "source/oscap_source_priv.h"
 #include "source/validate_priv.h"
 #include "oscap_helpers.h"
@@ -44,13 +46,14 @@ struct ctxt {
 	xml_reporter reporter;
 	void *arg;
 	char *filename;
+	bool reported;
 };
 
 static void oscap_xml_validity_handler(void *user, const xmlError *error)
 {
 	struct ctxt * context = (struct ctxt *) user;
 
-	if (context == NULL || context->reporter == NULL)
+	if (context == NULL)
 		return;
 
 	if (error == NULL)
@@ -76,6 +79,10 @@ static void oscap_xml_validity_handler(void *user, const xmlError *error)
 		return;
 	}
 
+	context->reported = true;
+	if (context->reporter == NULL)
+		return;
+
 	const char *file = error->file;
 	if (file == NULL)
 		file = context->filename;
@@ -91,7 +98,7 @@ static inline int oscap_validate_xml(struct oscap_source *source, const char *sc
 	xmlSchemaValidCtxtPtr ctxt = NULL;
 	xmlDocPtr doc = NULL;
 
-	struct ctxt context = { reporter, arg, (void*) oscap_source_readable_origin(source)};
+	struct ctxt context = { reporter, arg, (void*) oscap_source_readable_origin(source), false};
 
 	if (schemafile == NULL) {
 		oscap_seterr(OSCAP_EFAMILY_OSCAP, "'schemafile' == NULL");
@@ -105,6 +112,13 @@ static inline int oscap_validate_xml(struct oscap_source *source, const char *sc
 		goto cleanup;
 	}
 
+	if (oscap_content_cache_is_valid(source, schemapath)) {
+		dD("Content of %s has already passed validation against %s, skipping it.",
+			oscap_source_readable_origin(source), schemapath);
+		result = 0;
+		goto cleanup;
+	}
+
 	parser_ctxt = xmlSchemaNewParserCtxt(schemapath);
 	if (parser_ctxt == NULL) {
 		oscap_seterr(OSCAP_EFAMILY_XML, "Could not create parser context for validation");
@@ -140,6 +154,8 @@ static inline int oscap_validate_xml(struct oscap_source *source, const char *sc
 	 */
 	if (result != 0)
 		result = 1;
+	else if (!context.reported)
+		oscap_content_cache_set_valid(source, schemapath);
 	/* This would be nicer
 	 * if (result ==  -1)
 	 *	oscap_setxmlerr(xmlGetLastError());
@@ -38,6 +38,7 @@
 
 #include "common/_error.h"
 #include "common/util.h"
+#include "common/oscap_profile.h"
 #include "oscap.h"
 #include "oscap_source.h"
 #include "source/oscap_source_priv.h"
@@ -193,22 +194,29 @@ static xmlDoc *apply_xslt_path_internal(struct oscap_source *source, const char
 
 int oscap_source_apply_xslt_path(struct oscap_source *source, const char *xsltfile, const char *outfile, const char **params, const char *path_to_xslt)
 {
+	struct oscap_profile_span span;
+	oscap_profile_begin(&span, OSCAP_PROFILE_XSLT);
 	xsltStylesheet *stylesheet = NULL;
 	xmlDocPtr transformed = apply_xslt_path_internal(source, xsltfile, params, path_to_xslt, &stylesheet);
 	if (transformed == NULL) {
+		oscap_profile_end(&span);
 		return -1;
 	}
 	int ret = save_stylesheet_result_to_file(transformed, stylesheet, outfile);
 	xsltFreeStylesheet(stylesheet);
 	xmlFreeDoc(transformed);
+	oscap_profile_end(&span);
 	return ret;
 }
 
 char *oscap_source_apply_xslt_path_mem(struct oscap_source *source, const char *xsltfile, const char **params, const char *path_to_xslt)
 {
+	struct oscap_profile_span span;
+	oscap_profile_begin(&span, OSCAP_PROFILE_XSLT);
 	xsltStylesheet *stylesheet = NULL;
 	xmlDocPtr transformed = apply_xslt_path_internal(source, xsltfile, params, path_to_xslt, &stylesheet);
 	if (transformed == NULL) {
+		oscap_profile_end(&span);
 		return NULL;
 	}
 	xmlChar *result = NULL;
@@ -219,5 +227,6 @@ char *oscap_source_apply_xslt_path_mem(struct oscap_source *source, const char *
 		free(result);
 		result = NULL;
 	}
+	oscap_profile_end(&span);
 	return (char *)result;
 }
@@ -0,0 +1,125 @@
+/*
+ * Copyright 2026 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <oval_agent_api.h>
+#include <oval_results.h>
+#include <oscap.h>
+#include "oscap_source.h"
+
+/*
+ * Evaluate the model with the given number of threads and print the
+ * results of all definitions and tests, and the item counts of the
+ * tests, into a newly allocated string.
+ */
+static char *eval(struct oval_definition_model *model, unsigned int threads)
+{
+	oval_agent_session_t *session;
+	char *buf = NULL;
+	size_t size = 0;
+	FILE *out;
+
+	session = oval_agent_new_session(model, "test_eval_threads");
+	if (session == NULL)
+		return NULL;
+	oval_agent_set_eval_threads(session, threads);
+	if (oval_agent_eval_system(session, NULL, NULL) != 0) {
+		oval_agent_destroy_session(session);
+		return NULL;
+	}
+
+	out = open_memstream(&buf, &size);
+	struct oval_result_system_iterator *systems = oval_results_model_get_systems(oval_agent_get_results_model(session));
+	while (oval_result_system_iterator_has_more(systems)) {
+		struct oval_result_system *sys = oval_result_system_iterator_next(systems);
+
+		struct oval_result_definition_iterator *definitions = oval_result_system_get_definitions(sys);
+		while (oval_result_definition_iterator_has_more(definitions)) {
+			struct oval_result_definition *def = oval_result_definition_iterator_next(definitions);
+			fprintf(out, "%s %s\n", oval_result_definition_get_id(def),
+				oval_result_get_text(oval_result_definition_get_result(def)));
+		}
+		oval_result_definition_iterator_free(definitions);
+
+		struct oval_result_test_iterator *tests = oval_result_system_get_tests(sys);
+		while (oval_result_test_iterator_has_more(tests)) {
+			struct oval_result_test *test = oval_result_test_iterator_next(tests);
+			int items = 0;
+
+			struct oval_result_item_iterator *it = oval_result_test_get_items(test);
+			while (oval_result_item_iterator_has_more(it)) {
+				oval_result_item_iterator_next(it);
+				++items;
+			}
+			oval_result_item_iterator_free(it);
+			fprintf(out, "%s %s %d\n", oval_test_get_id(oval_result_test_get_test(test)),
+				oval_result_get_text(oval_result_test_get_result(test)), items);
+		}
+		oval_result_test_iterator_free(tests);
+	}
+	oval_result_system_iterator_free(systems);
+	fclose(out);
+
+	oval_agent_destroy_session(session);
+	return buf;
+}
+
+int main(int argc, char **argv)
+{
+	struct oscap_source *source;
+	struct oval_definition_model *model;
+	char *serial, *parallel;
+	int ret = 0;
+
+	if (argc != 2) {
+		fprintf(stderr, "Usage: %s OVAL_FILE\n", argv[0]);
+		return 1;
+	}
+
+	source = oscap_source_new_from_file(argv[1]);
+	model = oval_definition_model_import_source(source);
+	oscap_source_free(source);
+	if (model == NULL)
+		return 1;
+
+	serial = eval(model, 1);
+	parallel = eval(model, 4);
+	if (serial == NULL || parallel == NULL) {
+		fprintf(stderr, "Evaluation failed\n");
+		ret = 2;
+	} else if (strcmp(serial, parallel) != 0) {
+		fprintf(stderr, "Results differ\n1 thread:\n%s4 threads:\n%s", serial, parallel);
+		ret = 3;
+	} else {
+		printf("%s", serial);
+	}
+
+	free(serial);
+	free(parallel);
+	oval_definition_model_free(model);
+	oscap_cleanup();
+
+	return ret;
+}
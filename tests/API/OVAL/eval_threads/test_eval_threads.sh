@@ -0,0 +1,33 @@
+#!/usr/bin/env bash
+
+# Evaluate the same content serially and with several threads, the
+# results must not depend on the number of threads.
+
+. $builddir/tests/test_common.sh
+
+set -e -o pipefail
+
+function test_eval_threads_api {
+    ./test_eval_threads "$srcdir/eval_threads.oval.xml"
+}
+
+function test_eval_threads_env {
+    local serial=$(mktemp) parallel=$(mktemp)
+
+    OSCAP_OVAL_EVAL_THREADS=1 $OSCAP oval eval --results $serial "$srcdir/eval_threads.oval.xml"
+    OSCAP_OVAL_EVAL_THREADS=4 $OSCAP oval eval --results $parallel "$srcdir/eval_threads.oval.xml"
+
+    # Item ids are assigned by the probes, compare the results only
+    diff <(grep -o '<\(definition definition_id\|test test_id\)="[^"]*"[^>]*result="[^"]*"' $serial) \
+         <(grep -o '<\(definition definition_id\|test test_id\)="[^"]*"[^>]*result="[^"]*"' $parallel)
+    [ "$(grep -c '<definition definition_id=' $parallel)" -eq 10 ]
+
+    rm -f $serial $parallel
+}
+
+test_init
+
+test_run "test_eval_threads_api" test_eval_threads_api
+test_run "test_eval_threads_env" test_eval_threads_env
+
+test_exit
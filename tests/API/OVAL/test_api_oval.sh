@@ -30,6 +30,15 @@ function test_api_oval_results {
     cmp $srcdir/results-good.xml exported-results.xml
 }
 
+function test_api_oval_results_directives_stdout {
+    ./test_api_results $srcdir/results.xml exported-results-directives.xml $srcdir/directives.xml || return 1
+    ./test_api_results $srcdir/results.xml - $srcdir/directives.xml > exported-results-stdout.xml || return 1
+    cmp exported-results-directives.xml exported-results-stdout.xml || return 1
+    # The directives report the unknown definitions left out by the document's own
+    grep -q 'definition_id="oval:gov.irs.rhel5:def:97" result="unknown"' exported-results-stdout.xml || return 1
+    ! grep -q 'definition_id="oval:gov.irs.rhel5:def:97"' exported-results.xml
+}
+
 function test_api_oval_directives {
     ./test_api_directives $srcdir/directives.xml exported-directives.xml
     cmp $srcdir/directives.xml exported-directives.xml
@@ -43,6 +52,7 @@ if [ -z ${CUSTOM_OSCAP+x} ] ; then
     test_run "test_api_oval_definition" test_api_oval_definition
     test_run "test_api_oval_syschar" test_api_oval_syschar
     test_run "test_api_oval_results" test_api_oval_results
+    test_run "test_api_oval_results_directives_stdout" test_api_oval_results_directives_stdout
     test_run "test_api_oval_directives" test_api_oval_directives
 fi
 
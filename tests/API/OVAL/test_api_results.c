@@ -8,6 +8,7 @@
 
 #include "oval_agent_api.h"
 #include "oval_results.h"
+#include "oval_directives.h"
 #include "oscap.h"
 #include "oscap_error.h"
 #include "oscap_source.h"
@@ -16,6 +17,7 @@ int main(int argc, char **argv)
 {
 	struct oval_results_model *results_model = NULL;
 	struct oval_definition_model *definition_model = NULL;
+	struct oval_directives_model *directives_model = NULL;
 
 	definition_model=oval_definition_model_new();
 	results_model = oval_results_model_new(definition_model,NULL);
@@ -24,10 +26,21 @@ int main(int argc, char **argv)
 	oval_results_model_import_source(results_model, source);
 	oscap_source_free(source);
 
-	oval_results_model_export(results_model, NULL, argv[2]);
+	if (argc > 3) {
+		directives_model = oval_directives_model_new();
+		source = oscap_source_new_from_file(argv[3]);
+		oval_directives_model_import_source(directives_model, source);
+		oscap_source_free(source);
+	}
+
+	int ret = oval_results_model_export(results_model, directives_model, argv[2]);
+
+	if (directives_model != NULL)
+		oval_directives_model_free(directives_model);
 
 	oval_results_model_free(results_model);
 	oval_definition_model_free(definition_model);
 	oscap_cleanup();
+	return ret == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
 }
 
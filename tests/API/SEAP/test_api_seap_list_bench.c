@@ -0,0 +1,177 @@
+/*
+ * Copyright 2026 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <sexp.h>
+
+/*
+ * Times appending to a list, reading it by index in order and at random
+ * and asking for its length, for lists of growing size. Prints the time
+ * per member and fails if a member is wrong or if the time per member
+ * of the largest list is much higher than that of the smallest one.
+ *
+ * usage: test_api_seap_list_bench [max list size]
+ */
+
+#define OPS 5
+#define SCALE_LIMIT 8.0
+
+static const char *op_name[OPS] = { "add", "nth", "random nth", "length", "add shared" };
+
+static double now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static int check(const SEXP_t *list, uint32_t n, uint32_t expected)
+{
+	SEXP_t *memb = SEXP_list_nth(list, n);
+	uint32_t v = memb != NULL ? SEXP_number_getu_32(memb) : UINT32_MAX;
+
+	SEXP_free(memb);
+	if (v != expected) {
+		fprintf(stderr, "Member %u is %u, expected %u.\n", n, v, expected);
+		return 1;
+	}
+
+	return 0;
+}
+
+/* fills ns[] with nanoseconds per member of each operation */
+static int bench(uint32_t size, double ns[OPS])
+{
+	SEXP_t *list, *rest, *memb;
+	uint32_t i, seed = 1;
+	size_t length = 0;
+	double t;
+	int ret = 0;
+
+	list = SEXP_list_new(NULL);
+
+	t = now();
+	for (i = 0; i < size; ++i) {
+		memb = SEXP_number_newu_32(i);
+		SEXP_list_add(list, memb);
+		SEXP_free(memb);
+	}
+	ns[0] = (now() - t) / size;
+
+	t = now();
+	i = 0;
+	SEXP_list_foreach(memb, list) {
+		if (SEXP_number_getu_32(memb) != i++)
+			ret = 1;
+	}
+	ns[1] = (now() - t) / size;
+
+	if (ret != 0 || i != size) {
+		fprintf(stderr, "List of %u members: wrong member or count (%u) in foreach.\n", size, i);
+		ret = 1;
+	}
+
+	t = now();
+	for (i = 0; i < size; ++i) {
+		seed = seed * 1103515245 + 12345;
+		memb = SEXP_list_nth(list, seed % size + 1);
+		if (memb == NULL || SEXP_number_getu_32(memb) != seed % size)
+			ret = 1;
+		SEXP_free(memb);
+	}
+	ns[2] = (now() - t) / size;
+
+	t = now();
+	for (i = 0; i < size; ++i)
+		length += SEXP_list_length(list);
+	ns[3] = (now() - t) / size;
+
+	if (length != (size_t)size * size) {
+		fprintf(stderr, "List of %u members: wrong length.\n", size);
+		ret = 1;
+	}
+
+	/* the rest shares blocks with the list, adding to either must not change the other */
+	rest = SEXP_list_rest(list);
+
+	t = now();
+	for (i = 0; i < size; ++i) {
+		memb = SEXP_number_newu_32(size + i);
+		SEXP_list_add(list, memb);
+		SEXP_free(memb);
+	}
+	ns[4] = (now() - t) / size;
+
+	memb = SEXP_number_newu_32(UINT32_MAX - 1);
+	SEXP_list_add(rest, memb);
+	SEXP_free(memb);
+
+	ret |= check(list, 1, 0);
+	ret |= check(list, size, size - 1);
+	ret |= check(list, 2 * size, 2 * size - 1);
+	ret |= check(rest, size - 1, size - 1);
+	ret |= check(rest, size, UINT32_MAX - 1);
+
+	if (SEXP_list_length(list) != 2 * (size_t)size || SEXP_list_length(rest) != size) {
+		fprintf(stderr, "List of %u members: wrong length after adding to the rest.\n", size);
+		ret = 1;
+	}
+
+	SEXP_free(rest);
+	SEXP_free(list);
+
+	return ret;
+}
+
+int main(int argc, char *argv[])
+{
+	uint32_t max = argc > 1 ? strtoul(argv[1], NULL, 10) : 1000000;
+	double first[OPS], ns[OPS];
+	int ret = 0;
+
+	for (uint32_t size = 1000; size <= max; size *= 10) {
+		ret |= bench(size, ns);
+
+		printf("%8u members:", size);
+		for (int op = 0; op < OPS; ++op)
+			printf(" %s %.1f ns%s", op_name[op], ns[op], op < OPS - 1 ? "," : "\n");
+
+		if (size == 1000) {
+			for (int op = 0; op < OPS; ++op)
+				first[op] = ns[op];
+		}
+	}
+
+	for (int op = 0; op < OPS; ++op) {
+		if (ns[op] > SCALE_LIMIT * first[op] && ns[op] > 1000) {
+			fprintf(stderr, "'%s' takes %.1f ns per member of the largest list, %.1f ns of the smallest one.\n",
+			        op_name[op], ns[op], first[op]);
+			ret = 1;
+		}
+	}
+
+	return ret;
+}
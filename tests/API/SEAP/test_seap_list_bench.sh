@@ -0,0 +1,11 @@
+#!/usr/bin/env bash
+
+# Shows how appending to a S-exp list, indexing it and asking for its
+# length scale with the list size, up to a million members. Fails if a
+# member is wrong or the time per member grows with the list size.
+#
+# usage: test_seap_list_bench.sh [max list size]
+
+. $builddir/tests/test_common.sh
+
+./test_api_seap_list_bench ${1:-1000000}
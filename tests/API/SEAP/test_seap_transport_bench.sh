@@ -0,0 +1,93 @@
+#!/usr/bin/env bash
+
+# Compares the round-trip latency per object of the in-process SEAP
+# transport, which passes packets by pointer, with the S-exp marshalling
+# transport (OSCAP_SEAP_MARSHAL). Every object is sent to the probe and
+# its collected object is sent back, the probe itself does little work.
+# Fails if the two transports give different results.
+#
+# usage: test_seap_transport_bench.sh [object count] [rounds]
+
+. $builddir/tests/test_common.sh
+
+COUNT=${1:-1000}
+ROUNDS=${2:-3}
+
+probecheck "textfilecontent54" || exit 255
+
+DIR=$(mktemp -d)
+DF="$DIR/bench.xml"
+DATA="$DIR/data"
+
+seq 1 10 > "$DATA"
+
+{
+	cat <<EOH
+<?xml version="1.0"?>
+<oval_definitions xmlns="http://oval.mitre.org/XMLSchema/oval-definitions-5" xmlns:oval="http://oval.mitre.org/XMLSchema/oval-common-5" xmlns:ind="http://oval.mitre.org/XMLSchema/oval-definitions-5#independent">
+  <generator>
+    <oval:schema_version>5.11.1</oval:schema_version>
+    <oval:timestamp>2026-10-17T00:00:00-00:00</oval:timestamp>
+  </generator>
+  <definitions>
+    <definition class="compliance" version="1" id="oval:x:def:1">
+      <metadata><title>bench</title><description>bench</description></metadata>
+      <criteria operator="AND">
+EOH
+	for i in $(seq 1 $COUNT); do
+		echo "        <criterion test_ref=\"oval:x:tst:$i\"/>"
+	done
+	echo '      </criteria>'
+	echo '    </definition>'
+	echo '  </definitions>'
+	echo '  <tests>'
+	for i in $(seq 1 $COUNT); do
+		echo "    <ind:textfilecontent54_test check=\"all\" check_existence=\"any_exist\" comment=\"t\" version=\"1\" id=\"oval:x:tst:$i\"><ind:object object_ref=\"oval:x:obj:$i\"/></ind:textfilecontent54_test>"
+	done
+	echo '  </tests>'
+	echo '  <objects>'
+	for i in $(seq 1 $COUNT); do
+		echo "    <ind:textfilecontent54_object version=\"1\" id=\"oval:x:obj:$i\"><ind:filepath>$DATA</ind:filepath><ind:pattern operation=\"pattern match\">^$((i % 10))\$|^x$i\$</ind:pattern><ind:instance datatype=\"int\">1</ind:instance></ind:textfilecontent54_object>"
+	done
+	echo '  </objects>'
+	echo '</oval_definitions>'
+} > "$DF"
+
+# prints the best wall clock time of $ROUNDS evaluations in microseconds
+function bench {
+	local best=0 t0 t1 dt
+
+	for r in $(seq 1 $ROUNDS); do
+		t0=$(date +%s%N)
+		$OSCAP oval eval --skip-valid --results "$DIR/results_$1.xml" "$DF" > /dev/null || return 1
+		t1=$(date +%s%N)
+		dt=$(( (t1 - t0) / 1000 ))
+		if [ $best -eq 0 ] || [ $dt -lt $best ]; then
+			best=$dt
+		fi
+	done
+
+	echo $best
+}
+
+ret_val=0
+
+POINTER=$(bench pointer) || ret_val=1
+MARSHAL=$(OSCAP_SEAP_MARSHAL=1 bench marshal) || ret_val=1
+
+if [ $ret_val -eq 0 ]; then
+	echo "objects=$COUNT pointer: $POINTER us ($(( POINTER / COUNT )) us/object)," \
+	     "marshal: $MARSHAL us ($(( MARSHAL / COUNT )) us/object)"
+
+	for f in pointer marshal; do
+		sed -e 's/timestamp="[^"]*"//g' -e 's/<oval:timestamp>.*<\/oval:timestamp>//' \
+		    -e 's/item_ref="[0-9]*"//g' -e 's/item_id="[0-9]*"//g' -e 's/ id="[0-9]*"//g' \
+		    "$DIR/results_$f.xml" > "$DIR/results_$f.n"
+	done
+	# items collected concurrently may be stored in a different order
+	diff -q <(sort "$DIR/results_pointer.n") <(sort "$DIR/results_marshal.n") || ret_val=1
+fi
+
+rm -rf "$DIR"
+
+exit $ret_val
@@ -136,6 +136,24 @@ function test_api_xccdf_tailoring_profile_include_in_arf {
     rm -f $result
 }
 
+function test_api_xccdf_tailoring_profile_report_and_arf {
+    local INPUT=$srcdir/$1
+    local TAILORING=$srcdir/$2
+
+    result=`mktemp`
+    report=`mktemp`
+    # the ARF is streamed first, the report is generated from the checklists and OVAL results afterwards
+    $OSCAP xccdf eval --tailoring-file $TAILORING --profile "xccdf_com.example.www_profile_customized" --results-arf $result --report $report $INPUT || [ "$?" == "2" ]
+
+    assert_exists 1 '/arf:asset-report-collection/arf:report-requests/arf:report-request/arf:content/ds:data-stream-collection/ds:component/xccdf:Tailoring'
+    assert_exists 1 '/arf:asset-report-collection/arf:reports/arf:report[@id="oval0"]/arf:content/oval_results'
+
+    grep -q "xccdf_com.example.www_profile_customized" $report
+    grep -q "echo \"Fix the first rule\"" $report
+    grep -q "OVAL details taken from arf:report with id='oval0'" $report
+    rm -f $result $report
+}
+
 function test_api_xccdf_tailoring_profile_generate_fix {
     local INPUT=$srcdir/$1
     local TAILORING=$srcdir/$2
@@ -189,6 +207,7 @@ test_run "test_api_xccdf_tailoring_autonegotiation" test_api_xccdf_tailoring_aut
 test_run "test_api_xccdf_tailoring_simple_include_in_arf" test_api_xccdf_tailoring_simple_include_in_arf simple-xccdf.xml simple-tailoring.xml
 test_run "test_api_xccdf_tailoring_simple_include_in_arf_xlink_namespace" test_api_xccdf_tailoring_simple_include_in_arf_xlink_namespace xlink-test-simple-ds.xml simple-tailoring.xml
 test_run "test_api_xccdf_tailoring_profile_include_in_arf" test_api_xccdf_tailoring_profile_include_in_arf baseline.xccdf.xml baseline.tailoring.xml
+test_run "test_api_xccdf_tailoring_profile_report_and_arf" test_api_xccdf_tailoring_profile_report_and_arf baseline.xccdf.xml baseline.tailoring.xml
 test_run "test_api_xccdf_tailoring_profile_generate_fix" test_api_xccdf_tailoring_profile_generate_fix baseline.xccdf.xml baseline.tailoring.xml
 test_run "test_api_xccdf_tailoring_profile_generate_guide" test_api_xccdf_tailoring_profile_generate_guide baseline.xccdf.xml baseline.tailoring.xml
 
@@ -666,6 +666,55 @@ function xccdf_eval_1_multiset_syschar(){
 	done
 }
 
+#
+# Evaluate XCCDF where the third rule binds the same value as the first one.
+# The result of the first evaluation is reused, no third variable set is created.
+#
+function xccdf_eval_3_multiset_repeated(){
+	local variables0="requires_both-oval.xml-0.variables-0.xml"
+	local variables1="requires_both-oval.xml-0.variables-1.xml"
+	local variables2="requires_both-oval.xml-0.variables-2.xml"
+	local oval_result="requires_both-oval.xml.result.xml"
+	local xccdf_result=$(mktemp -t ${FUNCNAME}.xml.XXXXXX)
+	local stderr=$(mktemp -t ${FUNCNAME}.err.XXXXXX)
+	local profile="xccdf_moc.elpmaxe.www_profile_12"
+	local tested_file="testing_file.xml"
+	echo "Stderr file = $stderr"
+	cp $srcdir/testing_file_300.xml $tested_file
+
+	for f in $variables0 $variables1 $variables2 $oval_result $xccdf_result; do
+		[ ! -f $f ] || rm $f
+	done
+	local res=0
+	$OSCAP xccdf eval --profile $profile \
+		--export-variables --oval-results --results $xccdf_result \
+		$srcdir/test_xccdf_variable_instance.xccdf.xml 2> $stderr || res=$?
+	[ $res -eq 2 ]
+	[ -f $stderr ]; [ ! -s $stderr ]
+	[ -f $variables0 ]
+	[ -f $variables1 ]
+	[ ! -f $variables2 ]
+	$OSCAP oval validate --schematron $oval_result
+	local result="$xccdf_result"
+	assert_exists 3 '/Benchmark/TestResult/rule-result/result[text()!="notselected"]'
+	assert_exists 1 '/Benchmark/TestResult/rule-result[@idref="xccdf_moc.elpmaxe.www_rule_2"]/result[text()="pass"]'
+	assert_exists 1 '/Benchmark/TestResult/rule-result[@idref="xccdf_moc.elpmaxe.www_rule_3"]/result[text()="fail"]'
+	assert_exists 1 '/Benchmark/TestResult/rule-result[@idref="xccdf_moc.elpmaxe.www_rule_4"]/result[text()="pass"]'
+	assert_exists 1 '/Benchmark/TestResult/rule-result[@idref="xccdf_moc.elpmaxe.www_rule_4"]/check/check-export[@value-id="xccdf_moc.elpmaxe.www_value_1"]'
+	result="$oval_result"
+	assert_exists 2 '/oval_results/results/system/definitions/definition[@definition_id="oval:com.example.www:def:1"]'
+	assert_exists 1 '/oval_results/results/system/definitions/definition[@definition_id="oval:com.example.www:def:1" and @result="true"]'
+	assert_exists 1 '/oval_results/results/system/definitions/definition[@definition_id="oval:com.example.www:def:1" and @result="false"]'
+	assert_exists 0 '/oval_results/results/system/definitions/definition[@variable_instance="3"]'
+	assert_exists 2 '/oval_results/results/system/tests/test[@test_id="oval:com.example.www:tst:1"]'
+	rm $stderr
+	rm $xccdf_result
+	rm $oval_result
+	rm $variables0
+	rm $variables1
+	chmod u+w $tested_file ; rm $tested_file
+}
+
 test_init test_api_xccdf_variable_instance.log
 
 test_run "Export from XCCDF to variables: 1x2 values (multival)" xccdf_export_1_multival
@@ -681,5 +730,6 @@ test_run "Export from XCCDF to variables: 3x3 the last is subset (multiset,multi
 
 test_run "Evaluate XCCDF: 2x1 values (multiset)" xccdf_eval_2_multiset
 test_run "Evaluate XCCDF: 2x1 values (multiset) in syschar" xccdf_eval_1_multiset_syschar
+test_run "Evaluate XCCDF: 3x1 values, the first repeated (multiset)" xccdf_eval_3_multiset_repeated
 
 test_exit
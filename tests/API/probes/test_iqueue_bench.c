@@ -0,0 +1,180 @@
+/*
+ * Copyright 2026 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Microbenchmark of the probe item queue: N producer threads push items
+ * while one consumer takes them out in batches, like the icache worker.
+ * Prints items/sec for every producer count and checks that no item was
+ * lost and that the items of each producer arrived in order.
+ *
+ * usage: test_iqueue_bench [items per producer] [producer count ...]
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <sys/time.h>
+
+#include "iqueue.h"
+
+#define FAIL(...)                                             \
+        do {                                                  \
+                fprintf (stderr, "FAIL: " __VA_ARGS__);       \
+                exit (1);                                     \
+        } while (0)
+
+/* Every NOP_INTERVAL items a producer synchronizes with the consumer */
+#define NOP_INTERVAL 10000
+
+struct producer {
+	pthread_t thid;
+	probe_iqueue_t *queue;
+	uintptr_t id;
+	uintptr_t count;
+};
+
+static void *producer_thread(void *arg)
+{
+	struct producer *p = arg;
+	probe_iqpair_t pair;
+
+	for (uintptr_t i = 1; i <= p->count; ++i) {
+		pair.cobj = (SEXP_t *) p->id;
+		pair.p.item = (SEXP_t *) i;
+
+		if (probe_iqueue_push(p->queue, &pair) != 0)
+			FAIL("push\n");
+
+		if (i % NOP_INTERVAL == 0 && i < p->count) {
+			volatile uint32_t done = 0;
+
+			pair.cobj = NULL;
+			pair.p.done = &done;
+
+			if (probe_iqueue_push(p->queue, &pair) != 0)
+				FAIL("push (NOP)\n");
+			probe_iqueue_nop_wait(p->queue, &done);
+		}
+	}
+
+	return NULL;
+}
+
+static double now(void)
+{
+	struct timeval tv;
+
+	gettimeofday(&tv, NULL);
+	return (double) tv.tv_sec + (double) tv.tv_usec / 1000000.0;
+}
+
+static void bench(unsigned int nproducers, uintptr_t count)
+{
+	probe_iqueue_t queue;
+	probe_iqpair_t batch[PROBE_IQUEUE_BATCH];
+	struct producer *producers;
+	uintptr_t *last;
+	size_t total = 0, batches = 0, n;
+	double t0, t1;
+
+	if (probe_iqueue_init(&queue, PROBE_IQUEUE_CAPACITY) != 0)
+		FAIL("probe_iqueue_init\n");
+
+	producers = calloc(nproducers, sizeof(struct producer));
+	last = calloc(nproducers + 1, sizeof(uintptr_t));
+	if (producers == NULL || last == NULL)
+		FAIL("calloc\n");
+
+	t0 = now();
+
+	for (unsigned int i = 0; i < nproducers; ++i) {
+		producers[i].queue = &queue;
+		producers[i].id = i + 1;
+		producers[i].count = count;
+
+		if (pthread_create(&producers[i].thid, NULL, producer_thread, &producers[i]) != 0)
+			FAIL("pthread_create\n");
+	}
+
+	while (total < nproducers * count) {
+		n = probe_iqueue_pop_batch(&queue, batch, PROBE_IQUEUE_BATCH);
+		++batches;
+
+		for (size_t i = 0; i < n; ++i) {
+			uintptr_t id, item;
+
+			if (batch[i].cobj == NULL) {
+				probe_iqueue_nop_done(&queue, batch[i].p.done);
+				continue;
+			}
+
+			id = (uintptr_t) batch[i].cobj;
+			item = (uintptr_t) batch[i].p.item;
+
+			if (id > nproducers || item != last[id] + 1)
+				FAIL("producer %zu: got item %zu after %zu\n",
+				     (size_t) id, (size_t) item, (size_t) last[id]);
+
+			last[id] = item;
+			++total;
+		}
+	}
+
+	for (unsigned int i = 0; i < nproducers; ++i)
+		pthread_join(producers[i].thid, NULL);
+
+	t1 = now();
+
+	/* Nothing is left, so after the shutdown the consumer must not block */
+	probe_iqueue_shutdown(&queue);
+	if (probe_iqueue_pop_batch(&queue, batch, PROBE_IQUEUE_BATCH) != 0)
+		FAIL("queue not empty after all items were consumed\n");
+
+	printf("producers=%u items=%zu batches=%zu avg_batch=%.1f items/sec=%.0f\n",
+	       nproducers, total, batches, (double) total / (double) batches,
+	       (double) total / (t1 - t0));
+
+	probe_iqueue_destroy(&queue);
+	free(producers);
+	free(last);
+}
+
+int main(int argc, char *argv[])
+{
+	static const unsigned int default_producers[] = { 1, 2, 4, 8 };
+	uintptr_t count = 200000;
+
+	if (argc > 1)
+		count = strtoul(argv[1], NULL, 10);
+
+	if (argc > 2) {
+		for (int i = 2; i < argc; ++i)
+			bench(strtoul(argv[i], NULL, 10), count);
+	} else {
+		for (size_t i = 0; i < sizeof default_producers / sizeof default_producers[0]; ++i)
+			bench(default_producers[i], count);
+	}
+
+	return 0;
+}
@@ -0,0 +1,171 @@
+/*
+ * Copyright 2026 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "oval_fts_walk.h"
+
+/*
+ * Walks a tree with fts and with the walker, giving both the same
+ * pseudo-random instructions, and compares the entries they return.
+ */
+
+#define MAX_ENTRIES 100000
+
+struct entry {
+	unsigned short info;
+	short level;
+	int err;
+	char *path;
+	char *name;
+};
+
+static unsigned int seed;
+
+static int next_instr(const FTSENT *ent)
+{
+	seed = seed * 1103515245 + 12345;
+	switch ((seed >> 16) % 8) {
+	case 0:
+		return ent->fts_info == FTS_D ? FTS_SKIP : 0;
+	case 1:
+	case 2:
+		return (ent->fts_info == FTS_SL || ent->fts_info == FTS_SLNONE) ? FTS_FOLLOW : 0;
+	default:
+		return 0;
+	}
+}
+
+static void entry_set(struct entry *e, const FTSENT *ent)
+{
+	e->info = ent->fts_info;
+	e->level = ent->fts_level;
+	e->err = (ent->fts_info == FTS_NS || ent->fts_info == FTS_DNR) ? ent->fts_errno : 0;
+	e->path = strdup(ent->fts_path);
+	e->name = strdup(ent->fts_name);
+}
+
+static bool prefetch_all(const FTSENT *dir, void *arg)
+{
+	return true;
+}
+
+static int walk_fts(const char *path, int options, struct entry *out)
+{
+	char * const paths[2] = { (char *) path, NULL };
+	FTSENT *ent;
+	FTS *fts;
+	int n = 0;
+
+	fts = fts_open(paths, options, NULL);
+	if (fts == NULL)
+		return -1;
+	while ((ent = fts_read(fts)) != NULL && n < MAX_ENTRIES) {
+		entry_set(&out[n++], ent);
+		fts_set(fts, ent, next_instr(ent));
+	}
+	fts_close(fts);
+
+	return n;
+}
+
+static int walk_oval(const char *path, int options, unsigned int threads, struct entry *out)
+{
+	OVAL_FTS_WALK *walk;
+	FTSENT *ent;
+	int n = 0;
+
+	walk = oval_fts_walk_open(path, options, threads, prefetch_all, NULL);
+	if (walk == NULL)
+		return -1;
+	while ((ent = oval_fts_walk_read(walk)) != NULL && n < MAX_ENTRIES) {
+		entry_set(&out[n++], ent);
+		oval_fts_walk_set(walk, ent, next_instr(ent));
+	}
+	oval_fts_walk_close(walk);
+
+	return n;
+}
+
+static void entries_free(struct entry *e, int n)
+{
+	for (int i = 0; i < n; ++i) {
+		free(e[i].path);
+		free(e[i].name);
+	}
+}
+
+static int test_walk(const char *path, int options, unsigned int threads, unsigned int s)
+{
+	struct entry *a = calloc(MAX_ENTRIES, sizeof(struct entry));
+	struct entry *b = calloc(MAX_ENTRIES, sizeof(struct entry));
+	int na, nb, ret = 0;
+
+	seed = s;
+	na = walk_fts(path, options, a);
+	seed = s;
+	nb = walk_oval(path, options, threads, b);
+
+	if (na < 0 || nb < 0) {
+		fprintf(stderr, "Unable to walk '%s'.\n", path);
+		ret = 1;
+	} else if (na != nb) {
+		fprintf(stderr, "'%s' (threads: %u, seed: %u): %d entries from fts, %d from the walk.\n",
+		        path, threads, s, na, nb);
+		ret = 1;
+	}
+
+	for (int i = 0; ret == 0 && i < na; ++i) {
+		if (a[i].info != b[i].info || a[i].level != b[i].level || a[i].err != b[i].err
+		    || strcmp(a[i].path, b[i].path) || strcmp(a[i].name, b[i].name)) {
+			fprintf(stderr, "'%s' (threads: %u, seed: %u), entry %d: fts: %u %d '%s' '%s', walk: %u %d '%s' '%s'.\n",
+			        path, threads, s, i, a[i].info, a[i].level, a[i].path, a[i].name,
+			        b[i].info, b[i].level, b[i].path, b[i].name);
+			ret = 1;
+		}
+	}
+
+	entries_free(a, na);
+	entries_free(b, nb);
+	free(a);
+	free(b);
+
+	return ret;
+}
+
+int main(int argc, char *argv[])
+{
+	const int options = FTS_PHYSICAL | FTS_COMFOLLOW | FTS_NOCHDIR;
+	int ret = 0;
+
+	for (int i = 1; i < argc; ++i) {
+		for (unsigned int s = 1; s <= 20; ++s) {
+			ret |= test_walk(argv[i], options, 0, s);
+			ret |= test_walk(argv[i], options, 3, s);
+			ret |= test_walk(argv[i], options | FTS_XDEV, 2, s);
+		}
+	}
+
+	return ret;
+}
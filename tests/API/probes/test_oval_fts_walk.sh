@@ -0,0 +1,28 @@
+#!/usr/bin/env bash
+
+. $builddir/tests/test_common.sh
+
+if [ -n "${CUSTOM_OSCAP+x}" ] ; then
+    exit 255
+fi
+
+set -e -o pipefail
+
+tmpdir=$(mktemp -d)
+trap 'chmod -R u+rwx "$tmpdir"; rm -rf "$tmpdir"' EXIT
+
+mkdir -p "$tmpdir/a/b/c" "$tmpdir/a/e" "$tmpdir/d/x/y" "$tmpdir/empty" "$tmpdir/noread/sub"
+for i in $(seq 1 40); do
+	touch "$tmpdir/a/f$i"
+	mkdir -p "$tmpdir/d/x/y/d$i"
+	touch "$tmpdir/d/x/y/d$i/f"
+done
+ln -s .. "$tmpdir/a/b/c/up"
+ln -s ../d "$tmpdir/a/e/d"
+ln -s "$tmpdir" "$tmpdir/d/x/loop"
+ln -s "$tmpdir/nonexistent" "$tmpdir/a/dangling"
+ln -s "$tmpdir/a/f1" "$tmpdir/a/e/f1"
+mkfifo "$tmpdir/a/fifo"
+chmod 000 "$tmpdir/noread"
+
+./test_oval_fts_walk "$tmpdir" "$tmpdir/a/e/d" "$top_srcdir/src"
@@ -282,6 +282,88 @@ function test_source_date_epoch() {
 	rm -f "$result"
 }
 
+function test_sds_outer_namespaces() {
+	local sds="$srcdir/sds_outer_namespaces/sds.xml"
+	local split_dir="$(mktemp -d)"
+	local dom_dir="$(mktemp -d)"
+	local stdout="$(mktemp)"
+	local stderr="$(mktemp)"
+
+	# components are cut out of the raw file with namespaces declared on
+	# the collection and on ds:component, a DOCTYPE forces splitting by DOM
+	$OSCAP ds sds-split "$sds" "$split_dir" 2> "$stderr"
+	diff /dev/null "$stderr"
+	sed '1a <!DOCTYPE data-stream-collection>' "$sds" > "$dom_dir/sds.xml"
+	$OSCAP ds sds-split "$dom_dir/sds.xml" "$dom_dir" 2> "$stderr"
+	diff /dev/null "$stderr"
+	rm "$dom_dir/sds.xml"
+	diff --exclude "oscap_debug.log.*" "$split_dir" "$dom_dir"
+
+	$OSCAP xccdf eval "$sds" > "$stdout" 2> "$stderr" || [ $? -eq 2 ]
+	diff /dev/null "$stderr"
+	grep -q "^Result.*pass" "$stdout"
+	grep -q "^Result.*fail" "$stdout"
+
+	# an element of another namespace is not a component, even if it is named so
+	sed '/<\/ds:data-stream>/a <f:component xmlns:f="urn:example:foreign" id="scap_org.open-scap_comp_outer-xccdf.xml"><f:Benchmark/></f:component>' "$sds" > "$dom_dir/sds.xml"
+	$OSCAP xccdf eval --skip-valid "$dom_dir/sds.xml" > "$stdout" 2> "$stderr" || [ $? -eq 2 ]
+	diff /dev/null "$stderr"
+	grep -q "^Result.*pass" "$stdout"
+	grep -q "^Result.*fail" "$stdout"
+
+	rm -rf "$split_dir" "$dom_dir" "$stdout" "$stderr"
+}
+
+function test_load_threads() {
+	local dir="$(mktemp -d)"
+	local threads
+
+	cp "$srcdir/sds_multiple_oval/"*.xml "$dir"
+	pushd "$dir"
+	# OVAL files are parsed concurrently, the outcome must not depend on it
+	for threads in 1 4; do
+		# a rule fails, which is exit code 2
+		OSCAP_CONTENT_LOAD_THREADS=$threads $OSCAP xccdf eval multiple-oval-xccdf.xml > stdout.$threads || [ $? -eq 2 ]
+	done
+	diff stdout.1 stdout.4
+
+	# loading stops at the first invalid file, errors of later files are not reported
+	sed -i '0,/<definition /s//<definitionx /' first-oval.xml
+	sed -i '0,/<definition /s//<definitionx /' second-oval.xml
+	for threads in 1 4; do
+		OSCAP_CONTENT_LOAD_THREADS=$threads $OSCAP xccdf eval multiple-oval-xccdf.xml 2> stderr.$threads && return 1
+	done
+	diff stderr.1 stderr.4
+	grep -q "Invalid .* content in first-oval.xml" stderr.4
+	grep -q "second-oval.xml" stderr.4 && return 1
+	popd
+
+	rm -r "$dir"
+}
+
+function test_profile_file() {
+	local dir="$(mktemp -d)"
+	local phase
+
+	pushd "$dir"
+	OSCAP_PROFILE_FILE=profile.json $OSCAP xccdf eval --results-arf arf.xml --report report.html "$srcdir/sds_tailoring/sds.ds.xml"
+	for phase in source_load validation sds_component_extraction model_parsing evaluation export xslt; do
+		grep -q "\"$phase\": {\"count\": [1-9]" profile.json
+	done
+	grep -q '"textfilecontent54": {"objects": 1, "items": [0-9]' profile.json
+	grep -q '"peak_rss_kb": [1-9]' profile.json
+	if command -v python3 >/dev/null; then
+		python3 -m json.tool profile.json >/dev/null
+	fi
+	# nothing is written without the variable
+	rm profile.json
+	$OSCAP xccdf eval "$srcdir/sds_tailoring/sds.ds.xml"
+	[ ! -e profile.json ]
+	popd
+
+	rm -r "$dir"
+}
+
 
 # Testing.
 test_init
@@ -311,6 +393,9 @@ test_run "test_ds_1_2_error_remote_resources" test_ds_error_remote_resources ds_
 test_run "test_ds_1_3_continue_without_remote_resources" test_ds_continue_without_remote_resources ds_continue_without_remote_resources/remote_content_1.3.ds.xml xccdf_com.example.www_profile_test_remote_res
 test_run "test_ds_1_3_error_remote_resources" test_ds_error_remote_resources ds_continue_without_remote_resources/remote_content_1.3.ds.xml xccdf_com.example.www_profile_test_remote_res
 test_run "test_source_date_epoch" test_source_date_epoch
+test_run "sds_outer_namespaces" test_sds_outer_namespaces
+test_run "load_threads" test_load_threads
+test_run "profile_file" test_profile_file
 
 test_exit
 
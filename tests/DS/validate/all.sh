@@ -16,6 +16,35 @@ function test_validation {
 	return 1
 }
 
+function test_content_cache {
+	local cache_dir="$(mktemp -d)"
+	local valid="${srcdir}/sds-valid.xml"
+	local invalid="${srcdir}/sds-invalid.xml"
+	local entry="$cache_dir/$(sha256sum "$valid" | cut -d' ' -f1)"
+	local invalid_entry="$cache_dir/$(sha256sum "$invalid" | cut -d' ' -f1)"
+	export OSCAP_CONTENT_CACHE_DIR="$cache_dir"
+
+	# only content that has passed validation is recorded
+	$OSCAP ds sds-validate "$valid"
+	[ -f "$entry" ]
+	$OSCAP ds sds-validate "$invalid" && return 1
+	[ ! -f "$invalid_entry" ]
+	[ $(ls -A "$cache_dir" | wc -l) -eq 1 ]
+
+	# an entry made by another version is stale and it is replaced
+	echo "openscap 0.0.0" > "$entry"
+	$OSCAP ds sds-validate "$valid"
+	grep -q "^schema .*scap-source-data-stream_1.2.xsd$" "$entry"
+	grep -q "^openscap 0.0.0$" "$entry" && return 1
+
+	# the recorded verdict is trusted without validating the content again
+	cp "$entry" "$invalid_entry"
+	$OSCAP ds sds-validate "$invalid"
+
+	unset OSCAP_CONTENT_CACHE_DIR
+	rm -r "$cache_dir"
+}
+
 test_init test_validation.log
 test_run "valid-sds" test_validation sds sds-valid.xml 0
 test_run "valid-1.3-sds" test_validation sds sds-1.3-valid.xml 0
@@ -26,4 +55,6 @@ test_run "invalid-oval-sds" test_validation sds sds-invalid-oval.xml 1
 
 test_run "valid-rds" test_validation rds rds-valid.xml 0
 test_run "invalid-rds" test_validation rds rds-invalid.xml 1
+
+test_run "content-cache" test_content_cache
 test_exit
@@ -0,0 +1,194 @@
+/*
+ * Copyright 2026 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include "common/oscap_pcre.h"
+
+#define THREADS 4
+
+int test_cache_hit(void);
+int test_cache_options(void);
+int test_cache_error(void);
+int test_cache_eviction(void);
+int test_cache_threads(void);
+
+static bool matches(oscap_pcre_t *re, const char *str)
+{
+	return oscap_pcre_exec(re, str, strlen(str), 0, 0, NULL, 0) >= 0;
+}
+
+int test_cache_hit()
+{
+	unsigned long hits, misses, evictions;
+	oscap_pcre_t *re1, *re2;
+	char *err;
+	int errofs;
+
+	oscap_pcre_cache_clear();
+	re1 = oscap_pcre_cache_get("^/etc/.*\\.conf$", OSCAP_PCRE_OPTS_UTF8, &err, &errofs);
+	re2 = oscap_pcre_cache_get("^/etc/.*\\.conf$", OSCAP_PCRE_OPTS_UTF8, &err, &errofs);
+	if (re1 == NULL || re1 != re2)
+		return 1;
+	if (!matches(re1, "/etc/foo.conf") || matches(re2, "/usr/foo.conf"))
+		return 2;
+	oscap_pcre_cache_release(re1);
+	oscap_pcre_cache_release(re2);
+
+	oscap_pcre_cache_get_stats(&hits, &misses, &evictions);
+	if (hits != 1 || misses != 1 || evictions != 0)
+		return 3;
+
+	return 0;
+}
+
+int test_cache_options()
+{
+	oscap_pcre_t *re1, *re2;
+	char *err;
+	int errofs;
+
+	oscap_pcre_cache_clear();
+	re1 = oscap_pcre_cache_get("^abc$", OSCAP_PCRE_OPTS_UTF8, &err, &errofs);
+	re2 = oscap_pcre_cache_get("^abc$", OSCAP_PCRE_OPTS_CASELESS, &err, &errofs);
+	if (re1 == NULL || re2 == NULL || re1 == re2)
+		return 1;
+	if (matches(re1, "ABC") || !matches(re2, "ABC"))
+		return 2;
+	oscap_pcre_cache_release(re1);
+	oscap_pcre_cache_release(re2);
+
+	return 0;
+}
+
+int test_cache_error()
+{
+	char *err = NULL;
+	int errofs = -1;
+
+	oscap_pcre_cache_clear();
+	if (oscap_pcre_cache_get("^(abc$", OSCAP_PCRE_OPTS_UTF8, &err, &errofs) != NULL)
+		return 1;
+	if (err == NULL || errofs < 0)
+		return 2;
+	oscap_pcre_err_free(err);
+
+	return 0;
+}
+
+int test_cache_eviction()
+{
+	unsigned long hits, misses, evictions;
+	oscap_pcre_t *first, *re;
+	char pattern[32], *err;
+	int errofs;
+
+	oscap_pcre_cache_clear();
+	/* The first pattern is evicted while still in use */
+	first = oscap_pcre_cache_get("^first$", 0, &err, &errofs);
+	for (int i = 0; i < 5000; ++i) {
+		snprintf(pattern, sizeof(pattern), "^p%d$", i);
+		re = oscap_pcre_cache_get(pattern, 0, &err, &errofs);
+		if (re == NULL)
+			return 1;
+		oscap_pcre_cache_release(re);
+	}
+	oscap_pcre_cache_get_stats(&hits, &misses, &evictions);
+	if (hits != 0 || misses != 5001 || evictions == 0)
+		return 2;
+	if (!matches(first, "first"))
+		return 3;
+	oscap_pcre_cache_release(first);
+
+	/* Recently used patterns are still cached */
+	re = oscap_pcre_cache_get("^p4999$", 0, &err, &errofs);
+	oscap_pcre_cache_get_stats(&hits, &misses, &evictions);
+	if (re == NULL || hits != 1)
+		return 4;
+	oscap_pcre_cache_release(re);
+
+	return 0;
+}
+
+static void *cache_worker(void *arg)
+{
+	long n = (long) arg;
+	char pattern[32], subject[32], *err;
+	int errofs;
+
+	for (int i = 0; i < 20000; ++i) {
+		int k = (i * 7 + n) % 1500;
+		oscap_pcre_t *re;
+
+		snprintf(pattern, sizeof(pattern), "^x%d-[0-9]+$", k);
+		snprintf(subject, sizeof(subject), "x%d-%d", k, i);
+		re = oscap_pcre_cache_get(pattern, OSCAP_PCRE_OPTS_UTF8, &err, &errofs);
+		if (re == NULL || !matches(re, subject))
+			return (void *) 1;
+		oscap_pcre_cache_release(re);
+	}
+	return NULL;
+}
+
+int test_cache_threads()
+{
+	pthread_t threads[THREADS];
+	int ret = 0;
+
+	oscap_pcre_cache_clear();
+	for (long i = 0; i < THREADS; ++i) {
+		if (pthread_create(&threads[i], NULL, cache_worker, (void *) i) != 0)
+			return 1;
+	}
+	for (int i = 0; i < THREADS; ++i) {
+		void *res;
+
+		pthread_join(threads[i], &res);
+		if (res != NULL)
+			ret = 2;
+	}
+	oscap_pcre_cache_clear();
+
+	return ret;
+}
+
+int main (int argc, char *argv[])
+{
+	int retval = 0;
+
+	if ((retval = test_cache_hit()) != 0)
+		return retval;
+	if ((retval = test_cache_options()) != 0)
+		return 10 + retval;
+	if ((retval = test_cache_error()) != 0)
+		return 20 + retval;
+	if ((retval = test_cache_eviction()) != 0)
+		return 30 + retval;
+	if ((retval = test_cache_threads()) != 0)
+		return 40 + retval;
+
+	return retval;
+}
@@ -0,0 +1,19 @@
+#!/usr/bin/env bash
+
+. $builddir/tests/test_common.sh
+
+# Test cases.
+
+function test_oscap_pcre_cache {
+    ./test_oscap_pcre_cache
+}
+
+# Testing.
+
+test_init
+
+if [ -z ${CUSTOM_OSCAP+x} ] ; then
+    test_run "test_oscap_pcre_cache" test_oscap_pcre_cache
+fi
+
+test_exit
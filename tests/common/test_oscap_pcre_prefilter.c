@@ -0,0 +1,116 @@
+/*
+ * Copyright 2026 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include "common/oscap_pcre.h"
+
+int test_prefilter_literals(void);
+int test_prefilter_calls(void);
+
+/*
+ * Match the subject and return whether the pattern matched, prefiltered
+ * is set if the subject was rejected by the literal prefilter.
+ */
+static int match(const char *pattern, const char *subject, bool *prefiltered)
+{
+	unsigned long exec_cnt, prefiltered_cnt;
+	oscap_pcre_t *re;
+	char *err;
+	int errofs, rc;
+
+	re = oscap_pcre_compile(pattern, OSCAP_PCRE_OPTS_UTF8, &err, &errofs);
+	if (re == NULL) {
+		fprintf(stderr, "Failed to compile '%s': %s\n", pattern, err);
+		oscap_pcre_err_free(err);
+		return -1;
+	}
+	rc = oscap_pcre_exec(re, subject, strlen(subject), 0, 0, NULL, 0);
+	oscap_pcre_get_stats(re, &exec_cnt, &prefiltered_cnt);
+	oscap_pcre_free(re);
+	*prefiltered = prefiltered_cnt != 0;
+
+	return rc >= 0 ? 1 : 0;
+}
+
+int test_prefilter_literals()
+{
+	bool prefiltered;
+
+	if (match("^\\s*Key\\s+(\\S+)", "Other value", &prefiltered) != 0 || !prefiltered)
+		return 1;
+	if (match("^\\s*Key\\s+(\\S+)", "  Key value", &prefiltered) != 1 || prefiltered)
+		return 2;
+	/* Option settings don't stop the literal */
+	if (match("abc(?s)def", "abc def", &prefiltered) != 0 || !prefiltered)
+		return 3;
+	if (match("(?:ab)cde|xyz", "nothing", &prefiltered) != 0 || !prefiltered)
+		return 4;
+
+	return 0;
+}
+
+int test_prefilter_calls()
+{
+	static const struct {
+		const char *pattern;
+		const char *subject;
+	} calls[] = {
+		{ "abc(?R)def|xyz", "abcxyzdef" },
+		{ "(ghi)abc(?1)def", "ghiabcghidef" },
+		{ "(ghi)abc(?-1)def", "ghiabcghidef" },
+		{ "(?<n>ghi)abc(?&n)def", "ghiabcghidef" },
+		{ "(?P<n>ghi)abc(?P>n)def", "ghiabcghidef" },
+		{ "(?P<n>ghi)abc(?P=n)def", "ghiabcghidef" },
+		{ "(ghi)abc\\1def", "ghiabcghidef" },
+	};
+	bool prefiltered;
+
+	for (size_t i = 0; i < sizeof(calls) / sizeof(calls[0]); ++i) {
+		if (match(calls[i].pattern, calls[i].subject, &prefiltered) != 1 || prefiltered) {
+			fprintf(stderr, "'%s' doesn't match '%s'\n", calls[i].pattern, calls[i].subject);
+			return 1;
+		}
+		/* Recursions and calls can match anything, no literal is required */
+		if (match(calls[i].pattern, "nothing", &prefiltered) != 0 || prefiltered) {
+			fprintf(stderr, "'%s' was prefiltered\n", calls[i].pattern);
+			return 2;
+		}
+	}
+
+	return 0;
+}
+
+int main (int argc, char *argv[])
+{
+	int retval = 0;
+
+	if ((retval = test_prefilter_literals()) != 0)
+		return retval;
+	if ((retval = test_prefilter_calls()) != 0)
+		return 10 + retval;
+
+	return retval;
+}
@@ -0,0 +1,19 @@
+#!/usr/bin/env bash
+
+. $builddir/tests/test_common.sh
+
+# Test cases.
+
+function test_oscap_pcre_prefilter {
+    ./test_oscap_pcre_prefilter
+}
+
+# Testing.
+
+test_init
+
+if [ -z ${CUSTOM_OSCAP+x} ] ; then
+    test_run "test_oscap_pcre_prefilter" test_oscap_pcre_prefilter
+fi
+
+test_exit
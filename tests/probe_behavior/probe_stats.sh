@@ -0,0 +1,21 @@
+#!/bin/bash
+
+set -e -o pipefail
+
+. $builddir/tests/test_common.sh
+
+dir=$(mktemp -d)
+seq 110 > "$dir/longfile"
+sed "s|/tmp/longfile|$dir/longfile|" $srcdir/collect_limit.oval.xml > "$dir/oval.xml"
+
+$OSCAP oval eval --stats "$dir/oval.xml" > "$dir/stdout"
+grep -q "^Probe statistics:" "$dir/stdout"
+# one query answered from the object collected ahead of the evaluation
+grep -Eq "^textfilecontent54 +1 +1 +1 +110 +[1-9][0-9]* +[1-9][0-9]* " "$dir/stdout"
+grep -Eq "^textfilecontent54( +[01]){7}  oval:x:obj:1 \(" "$dir/stdout"
+
+# nothing is printed without the option
+$OSCAP oval eval "$dir/oval.xml" > "$dir/stdout"
+grep -q "Probe statistics" "$dir/stdout" && exit 1
+
+rm -r "$dir"
@@ -0,0 +1,65 @@
+#!/usr/bin/env bash
+
+# Evaluates dpkginfo objects against a dpkg status file in an offline root.
+
+set -e -o pipefail
+
+. $builddir/tests/test_common.sh
+probecheck "dpkginfo" || exit 255
+
+name=$(basename $0 .sh)
+result=$(mktemp ${name}.out.XXXXXX)
+stderr=$(mktemp ${name}.err.XXXXXX)
+
+root=$(mktemp -d)
+mkdir -p "$root/var/lib/dpkg"
+# The last paragraph isn't terminated by an empty line
+cat > "$root/var/lib/dpkg/status" <<'STATUS'
+Package: removed
+Status: deinstall ok config-files
+Architecture: amd64
+Version: 1.0
+
+Package: libfoo1
+Status: deinstall ok config-files
+Architecture: amd64
+Version: 1.0-1
+
+Package: libfoo1
+Status: install ok installed
+Architecture: amd64
+Version: 1:2.0-2
+Description: foo library
+ Continuation line: not a field
+
+Package: libbar2
+Status: install ok installed
+Architecture: i386
+Version: 3
+
+Package: bar
+Status: install ok installed
+Architecture: all
+Version: 0.1-1
+STATUS
+
+export OSCAP_PROBE_ROOT="$root"
+$OSCAP oval eval --results $result $srcdir/$name.oval.xml 2> $stderr
+
+[ ! -s "$stderr" ]
+[ -s "$result" ]
+
+assert_exists 1 '/oval_results/results/system/definitions/definition[@result="true"]'
+co='/oval_results/results/system/oval_system_characteristics/collected_objects'
+assert_exists 1 $co'/object[@id="oval:x:obj:1"]/reference'
+assert_exists 1 $co'/object[@id="oval:x:obj:2"][@flag="does not exist"]'
+assert_exists 2 $co'/object[@id="oval:x:obj:3"]/reference'
+assert_exists 2 $co'/object[@id="oval:x:obj:4"]/reference'
+assert_exists 1 $co'/object[@id="oval:x:obj:5"]/reference'
+sd='/oval_results/results/system/oval_system_characteristics/system_data'
+assert_exists 3 $sd'/lin-sys:dpkginfo_item'
+assert_exists 1 $sd'/lin-sys:dpkginfo_item[lin-sys:name="libfoo1"][lin-sys:evr="1:2.0-2"]'
+
+rm "$stderr"
+rm "$result"
+rm -r "$root"
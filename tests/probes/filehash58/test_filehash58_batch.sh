@@ -0,0 +1,47 @@
+#!/usr/bin/env bash
+
+# Hashes more files than the probe hashes in one batch with several
+# threads, and the same files again by other objects, whose digests are
+# partly taken from the memo of the probe. All of them have to match the
+# digests computed by sha256sum and sha512sum.
+
+. $builddir/tests/test_common.sh
+
+set -e -o pipefail
+
+probecheck "filehash58" || exit 255
+require "sha256sum" || exit 255
+require "sha512sum" || exit 255
+
+name=$(basename $0 .sh)
+tmpdir=$(make_temp_dir /tmp ${name})
+tpl=${srcdir}/${name}.xml.tpl
+input=${tmpdir}/${name}.xml
+result=${tmpdir}/${name}.results.xml
+echo "Temp dir: $tmpdir"
+
+# prepare the environment
+mkdir "${tmpdir}/files"
+sed "s@%PATH%@${tmpdir}/files@" $tpl > $input
+for i in $(seq 1 150); do
+	head -c $((i * 1000)) /dev/urandom > "${tmpdir}/files/f${i}"
+done
+
+echo "Evaluating content."
+OSCAP_PROBE_HASH_THREADS=3 $OSCAP oval eval --results $result $input
+echo "Testing collected items."
+objects='/oval_results/results/system/oval_system_characteristics/collected_objects'
+items='/oval_results/results/system/oval_system_characteristics/system_data/filehash58_item'
+[ "$($XPATH $result "count(${objects}/object[@id=\"oval:x:obj:1\"]/reference)")" == "150" ]
+[ "$($XPATH $result "count(${objects}/object[@id=\"oval:x:obj:2\"]/reference)")" == "300" ]
+[ "$($XPATH $result "count(${objects}/object[@id=\"oval:x:obj:3\"]/reference)")" == "1" ]
+[ "$($XPATH $result "count(${items}[@status!=\"exists\"])")" == "0" ]
+for i in 1 7 64 65 100 128 129 150; do
+	file="${tmpdir}/files/f${i}"
+	sha256=$(sha256sum "$file" | cut -d ' ' -f 1)
+	sha512=$(sha512sum "$file" | cut -d ' ' -f 1)
+	[ "$($XPATH $result "count(${items}[filepath=\"${file}\" and hash_type=\"SHA-256\" and hash=\"${sha256}\"])")" == "1" ]
+	[ "$($XPATH $result "count(${items}[filepath=\"${file}\" and hash_type=\"SHA-512\" and hash=\"${sha512}\"])")" == "1" ]
+done
+
+rm -rf $tmpdir
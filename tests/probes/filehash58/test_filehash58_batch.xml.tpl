@@ -0,0 +1,57 @@
+<?xml version="1.0"?>
+<oval_definitions xmlns:oval-def="http://oval.mitre.org/XMLSchema/oval-definitions-5" xmlns:oval="http://oval.mitre.org/XMLSchema/oval-common-5" xmlns:xsi="http://www.w3.org/2001/XMLSchema-instance" xmlns:ind-def="http://oval.mitre.org/XMLSchema/oval-definitions-5#independent" xmlns="http://oval.mitre.org/XMLSchema/oval-definitions-5" xsi:schemaLocation="http://oval.mitre.org/XMLSchema/oval-definitions-5#independent independent-definitions-schema.xsd http://oval.mitre.org/XMLSchema/oval-definitions-5 oval-definitions-schema.xsd http://oval.mitre.org/XMLSchema/oval-common-5 oval-common-schema.xsd">
+  <generator>
+    <oval:schema_version>5.11.2</oval:schema_version>
+    <oval:timestamp>2026-10-18T00:00:00-00:00</oval:timestamp>
+  </generator>
+
+  <definitions>
+    <definition class="compliance" version="1" id="oval:x:def:1">
+      <metadata>
+        <title>x</title>
+        <description>x</description>
+      </metadata>
+      <criteria operator="AND">
+        <criterion test_ref="oval:x:tst:1"/>
+        <criterion test_ref="oval:x:tst:2"/>
+        <criterion test_ref="oval:x:tst:3"/>
+      </criteria>
+    </definition>
+  </definitions>
+
+  <tests>
+    <ind-def:filehash58_test check="all" check_existence="at_least_one_exists" comment="x" version="1" id="oval:x:tst:1">
+      <ind-def:object object_ref="oval:x:obj:1"/>
+    </ind-def:filehash58_test>
+    <ind-def:filehash58_test check="all" check_existence="at_least_one_exists" comment="x" version="1" id="oval:x:tst:2">
+      <ind-def:object object_ref="oval:x:obj:2"/>
+    </ind-def:filehash58_test>
+    <ind-def:filehash58_test check="all" check_existence="at_least_one_exists" comment="x" version="1" id="oval:x:tst:3">
+      <ind-def:object object_ref="oval:x:obj:3"/>
+    </ind-def:filehash58_test>
+  </tests>
+
+  <objects>
+    <ind-def:filehash58_object version="1" id="oval:x:obj:1">
+      <ind-def:path>%PATH%</ind-def:path>
+      <ind-def:filename operation="pattern match">^f</ind-def:filename>
+      <ind-def:hash_type>SHA-256</ind-def:hash_type>
+    </ind-def:filehash58_object>
+    <ind-def:filehash58_object version="1" id="oval:x:obj:2">
+      <ind-def:path>%PATH%</ind-def:path>
+      <ind-def:filename operation="pattern match">^f</ind-def:filename>
+      <ind-def:hash_type var_ref="oval:x:var:1" var_check="at least one"/>
+    </ind-def:filehash58_object>
+    <ind-def:filehash58_object version="1" id="oval:x:obj:3">
+      <ind-def:filepath>%PATH%/f7</ind-def:filepath>
+      <ind-def:hash_type>SHA-512</ind-def:hash_type>
+    </ind-def:filehash58_object>
+  </objects>
+
+  <variables>
+    <constant_variable datatype="string" comment="x" version="1" id="oval:x:var:1">
+      <value>SHA-256</value>
+      <value>SHA-512</value>
+    </constant_variable>
+  </variables>
+</oval_definitions>
@@ -0,0 +1,69 @@
+#!/usr/bin/env bash
+
+# usage: shared_sockets.xml.sh PORT [process58]
+PORT=$1
+PROCESS58=$2
+
+if [ "$PROCESS58" == "process58" ]; then
+	PROCESS58_CRITERION='<criterion test_ref="oval:x:tst:4" comment="Listener process"/>'
+	PROCESS58_TEST='<unix-def:process58_test id="oval:x:tst:4" version="1" check="all" comment="Test.">
+        <unix-def:object object_ref="oval:x:obj:4"/>
+      </unix-def:process58_test>'
+	PROCESS58_OBJECT='<unix-def:process58_object id="oval:x:obj:4" version="1">
+        <unix-def:command_line operation="pattern match">.*shared_sockets_listener$</unix-def:command_line>
+        <unix-def:pid datatype="int" operation="greater than">0</unix-def:pid>
+      </unix-def:process58_object>'
+fi
+
+cat <<EOF
+<oval_definitions xmlns:oval="http://oval.mitre.org/XMLSchema/oval-common-5" xmlns:xsi="http://www.w3.org/2001/XMLSchema-instance" xmlns:unix-def="http://oval.mitre.org/XMLSchema/oval-definitions-5#unix" xmlns:ind-def="http://oval.mitre.org/XMLSchema/oval-definitions-5#independent" xmlns:lin-def="http://oval.mitre.org/XMLSchema/oval-definitions-5#linux" xmlns="http://oval.mitre.org/XMLSchema/oval-definitions-5" xsi:schemaLocation="http://oval.mitre.org/XMLSchema/oval-definitions-5#unix unix-definitions-schema.xsd http://oval.mitre.org/XMLSchema/oval-definitions-5#independent independent-definitions-schema.xsd http://oval.mitre.org/XMLSchema/oval-definitions-5#linux linux-definitions-schema.xsd http://oval.mitre.org/XMLSchema/oval-definitions-5 oval-definitions-schema.xsd http://oval.mitre.org/XMLSchema/oval-common-5 oval-common-schema.xsd">
+    <generator>
+      <oval:product_name>My hands</oval:product_name>
+      <oval:product_version>1.0</oval:product_version>
+      <oval:schema_version>5.11</oval:schema_version>
+      <oval:timestamp>2026-10-18T12:00:00+02:00</oval:timestamp>
+    </generator>
+    <definitions>
+      <definition id="oval:x:def:1" version="1" class="compliance">
+        <metadata>
+          <title>Test</title>
+          <description>Collect the listening socket and the process of the listener by the probes sharing the socket table and the process snapshot</description>
+        </metadata>
+        <criteria operator="AND">
+          <criterion test_ref="oval:x:tst:1" comment="Listening socket"/>
+          <criterion test_ref="oval:x:tst:2" comment="UDP sockets"/>
+          <criterion test_ref="oval:x:tst:3" comment="Packet sockets"/>
+          ${PROCESS58_CRITERION}
+        </criteria>
+      </definition>
+    </definitions>
+    <tests>
+      <lin-def:inetlisteningservers_test id="oval:x:tst:1" version="1" check="all" comment="Test.">
+        <lin-def:object object_ref="oval:x:obj:1"/>
+      </lin-def:inetlisteningservers_test>
+      <lin-def:inetlisteningservers_test id="oval:x:tst:2" version="1" check="all" check_existence="any_exist" comment="Test.">
+        <lin-def:object object_ref="oval:x:obj:2"/>
+      </lin-def:inetlisteningservers_test>
+      <lin-def:iflisteners_test id="oval:x:tst:3" version="1" check="all" check_existence="any_exist" comment="Test.">
+        <lin-def:object object_ref="oval:x:obj:3"/>
+      </lin-def:iflisteners_test>
+      ${PROCESS58_TEST}
+    </tests>
+    <objects>
+      <lin-def:inetlisteningservers_object id="oval:x:obj:1" version="1">
+        <lin-def:protocol>tcp</lin-def:protocol>
+        <lin-def:local_address>127.0.0.1</lin-def:local_address>
+        <lin-def:local_port datatype="int">${PORT}</lin-def:local_port>
+      </lin-def:inetlisteningservers_object>
+      <lin-def:inetlisteningservers_object id="oval:x:obj:2" version="1">
+        <lin-def:protocol>udp</lin-def:protocol>
+        <lin-def:local_address operation="pattern match">.*</lin-def:local_address>
+        <lin-def:local_port datatype="int" operation="greater than or equal">0</lin-def:local_port>
+      </lin-def:inetlisteningservers_object>
+      <lin-def:iflisteners_object id="oval:x:obj:3" version="1">
+        <lin-def:interface_name operation="pattern match">.*</lin-def:interface_name>
+      </lin-def:iflisteners_object>
+      ${PROCESS58_OBJECT}
+    </objects>
+</oval_definitions>
+EOF
@@ -0,0 +1,24 @@
+# Start a process listening on a TCP port of 127.0.0.1 picked by the kernel,
+# sets $listener_pid and $listener_port. The process is killed on exit.
+function start_listener {
+	local port_file=$(mktemp)
+
+	python3 -c 'import socket, sys, time
+s = socket.socket()
+s.bind(("127.0.0.1", 0))
+s.listen()
+with open(sys.argv[1], "w") as f:
+    f.write(str(s.getsockname()[1]))
+time.sleep(60)' "$port_file" shared_sockets_listener &
+	listener_pid=$!
+	trap "kill $listener_pid" EXIT
+
+	# The port is written once the socket is listening
+	for i in $(seq 1 50); do
+		[ -s "$port_file" ] && break
+		sleep 0.1
+	done
+	listener_port=$(cat "$port_file")
+	rm -f "$port_file"
+	[ -n "$listener_port" ]
+}
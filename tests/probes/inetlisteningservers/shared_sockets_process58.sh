@@ -0,0 +1,38 @@
+#!/usr/bin/env bash
+
+# The inetlisteningservers, iflisteners and process58 probes share the socket
+# table and the process snapshot, collect all of them in a single evaluation
+# and check that each probe still finds the socket owner and the process.
+
+set -e -o pipefail
+
+. $builddir/tests/test_common.sh
+. $srcdir/shared_sockets_listener.sh
+probecheck "inetlisteningservers" || exit 255
+probecheck "iflisteners" || exit 255
+probecheck "process58" || exit 255
+command -v python3 > /dev/null || exit 255
+
+name=$(basename $0 .sh)
+input=$(mktemp ${name}.xml.XXXXXX)
+result=$(mktemp ${name}.out.XXXXXX)
+echo "result file: $result"
+stderr=$(mktemp ${name}.err.XXXXXX)
+echo "stderr file: $stderr"
+
+start_listener
+bash $srcdir/shared_sockets.xml.sh $listener_port process58 > $input
+
+echo "Eval:"
+$OSCAP oval eval --results $result $input 2> $stderr
+[ ! -s $stderr ]
+
+rm $stderr $input
+
+[ -s $result ]
+assert_exists 1 '/oval_results/results/system/definitions/definition[@result="true"]'
+assert_exists 0 '/oval_results/results/system/oval_system_characteristics/collected_objects/object[@flag="error"]'
+assert_exists 1 '/oval_results/results/system/oval_system_characteristics/system_data/lin-sys:inetlisteningserver_item[lin-sys:local_port/text()="'$listener_port'"]/lin-sys:pid[text()="'$listener_pid'"]'
+assert_exists 1 '/oval_results/results/system/oval_system_characteristics/system_data/unix-sys:process58_item/unix-sys:pid[text()="'$listener_pid'"]'
+
+rm $result
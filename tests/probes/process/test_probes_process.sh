@@ -0,0 +1,42 @@
+#!/usr/bin/env bash
+
+# Looks processes up in the process snapshot by their command, with one
+# and more threads reading /proc.
+
+set -e -o pipefail
+
+. $builddir/tests/test_common.sh
+probecheck "process" || exit 255
+
+name=$(basename $0 .sh)
+tmpdir=$(make_temp_dir /tmp ${name})
+input=${tmpdir}/${name}.xml
+stderr=${tmpdir}/${name}.err
+
+# Two processes with a command nothing else has
+command=oscap_proc_$$
+cp "$(command -v sleep)" "${tmpdir}/${command}"
+"${tmpdir}/${command}" 300 &
+pid1=$!
+"${tmpdir}/${command}" 301 &
+pid2=$!
+trap "kill $pid1 $pid2" EXIT
+
+bash ${srcdir}/${name}.xml.sh "$command" > $input
+
+items='/oval_results/results/system/oval_system_characteristics/system_data/unix-sys:process_item'
+objects='/oval_results/results/system/oval_system_characteristics/collected_objects'
+
+for threads in 1 4; do
+	result=${tmpdir}/${name}.${threads}.results.xml
+	OSCAP_PROBE_PROC_THREADS=$threads $OSCAP oval eval --results $result $input 2> $stderr
+	[ ! -s $stderr ]
+
+	assert_exists 1 '/oval_results/results/system/definitions/definition[@result="true"]'
+	assert_exists 2 "${objects}/object[@id=\"oval:1:obj:1\"]/reference"
+	assert_exists 1 "${objects}/object[@id=\"oval:1:obj:2\"][@flag=\"does not exist\"]"
+	assert_exists 1 "${items}[unix-sys:command=\"${command}\"][unix-sys:pid=\"${pid1}\"]"
+	assert_exists 1 "${items}[unix-sys:command=\"${command}\"][unix-sys:pid=\"${pid2}\"]"
+done
+
+rm -rf $tmpdir
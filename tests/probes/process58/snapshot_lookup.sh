@@ -0,0 +1,52 @@
+#!/usr/bin/env bash
+
+# Looks a process up in the process snapshot by pid and by command line
+# and checks the values read lazily (SELinux label, exec shield) and the
+# capabilities parsed from CapEff, with one and more threads reading /proc.
+
+set -e -o pipefail
+
+. $builddir/tests/test_common.sh
+probecheck "process58" || exit 255
+
+name=$(basename $0 .sh)
+tmpdir=$(make_temp_dir /tmp ${name})
+input=${tmpdir}/${name}.xml
+stderr=${tmpdir}/${name}.err
+
+# A process with a command line nothing else has
+cp "$(command -v sleep)" "${tmpdir}/oscap_snap"
+"${tmpdir}/oscap_snap" 300 &
+pid=$!
+trap "kill $pid" EXIT
+command_line="${tmpdir}/oscap_snap 300"
+cap_eff=$(awk '/^CapEff:/ { print $2 }' /proc/$pid/status)
+
+bash ${srcdir}/${name}.xml.sh "$pid" "$command_line" > $input
+
+items='/oval_results/results/system/oval_system_characteristics/system_data/unix-sys:process58_item'
+objects='/oval_results/results/system/oval_system_characteristics/collected_objects'
+
+for threads in 1 4; do
+	result=${tmpdir}/${name}.${threads}.results.xml
+	OSCAP_PROBE_PROC_THREADS=$threads $OSCAP oval eval --results $result $input 2> $stderr
+	[ ! -s $stderr ]
+
+	assert_exists 1 '/oval_results/results/system/definitions/definition[@result="true"]'
+	assert_exists 1 "${objects}/object[@id=\"oval:1:obj:1\"]/reference"
+	assert_exists 1 "${objects}/object[@id=\"oval:1:obj:2\"]/reference"
+	assert_exists 1 "${objects}/object[@id=\"oval:1:obj:3\"][@flag=\"does not exist\"]"
+	assert_exists 1 "${items}[unix-sys:pid=\"${pid}\"]"
+	assert_exists 1 "${items}[unix-sys:pid=\"${pid}\"][unix-sys:command_line=\"${command_line}\"]"
+	assert_exists 1 "${items}[unix-sys:pid=\"${pid}\"]/unix-sys:exec_shield"
+	if [ "$cap_eff" == "0000000000000000" ]; then
+		assert_exists 0 "${items}[unix-sys:pid=\"${pid}\"]/unix-sys:posix_capability"
+	elif (( 0x$cap_eff & 1 )); then
+		assert_exists 1 "${items}[unix-sys:pid=\"${pid}\"]/unix-sys:posix_capability[text()=\"CAP_CHOWN\"]"
+	fi
+	if require selinuxenabled && selinuxenabled; then
+		assert_exists 1 "${items}[unix-sys:pid=\"${pid}\"]/unix-sys:selinux_domain_label"
+	fi
+done
+
+rm -rf $tmpdir
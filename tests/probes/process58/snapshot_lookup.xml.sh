@@ -0,0 +1,59 @@
+#!/usr/bin/env bash
+
+PID=$1
+COMMAND_LINE=$2
+
+cat <<EOF
+<?xml version="1.0"?>
+<oval_definitions xmlns:oval-def="http://oval.mitre.org/XMLSchema/oval-definitions-5" xmlns:oval="http://oval.mitre.org/XMLSchema/oval-common-5" xmlns:xsi="http://www.w3.org/2001/XMLSchema-instance" xmlns:unix-def="http://oval.mitre.org/XMLSchema/oval-definitions-5#unix" xmlns="http://oval.mitre.org/XMLSchema/oval-definitions-5" xsi:schemaLocation="http://oval.mitre.org/XMLSchema/oval-definitions-5#unix unix-definitions-schema.xsd http://oval.mitre.org/XMLSchema/oval-definitions-5 oval-definitions-schema.xsd http://oval.mitre.org/XMLSchema/oval-common-5 oval-common-schema.xsd">
+
+  <generator>
+    <oval:product_name>process58</oval:product_name>
+    <oval:product_version>1.0</oval:product_version>
+    <oval:schema_version>5.11</oval:schema_version>
+    <oval:timestamp>2011-07-13T00:00:00-00:00</oval:timestamp>
+  </generator>
+
+  <definitions>
+    <definition class="compliance" version="1" id="oval:1:def:1">
+      <metadata>
+        <title>Look processes up by pid and command line</title>
+        <description>x</description>
+      </metadata>
+      <criteria>
+        <criterion test_ref="oval:1:tst:1"/>
+        <criterion test_ref="oval:1:tst:2"/>
+        <criterion test_ref="oval:1:tst:3"/>
+      </criteria>
+    </definition>
+  </definitions>
+
+  <tests>
+    <process58_test version="1" id="oval:1:tst:1" check="all" comment="x" xmlns="http://oval.mitre.org/XMLSchema/oval-definitions-5#unix">
+      <object object_ref="oval:1:obj:1"/>
+    </process58_test>
+    <process58_test version="1" id="oval:1:tst:2" check="all" comment="x" xmlns="http://oval.mitre.org/XMLSchema/oval-definitions-5#unix">
+      <object object_ref="oval:1:obj:2"/>
+    </process58_test>
+    <process58_test version="1" id="oval:1:tst:3" check="all" check_existence="none_exist" comment="x" xmlns="http://oval.mitre.org/XMLSchema/oval-definitions-5#unix">
+      <object object_ref="oval:1:obj:3"/>
+    </process58_test>
+  </tests>
+
+  <objects>
+    <process58_object version="1" id="oval:1:obj:1" xmlns="http://oval.mitre.org/XMLSchema/oval-definitions-5#unix">
+      <command_line operation="pattern match">.*</command_line>
+      <pid datatype="int">${PID}</pid>
+    </process58_object>
+    <process58_object version="1" id="oval:1:obj:2" xmlns="http://oval.mitre.org/XMLSchema/oval-definitions-5#unix">
+      <command_line>${COMMAND_LINE}</command_line>
+      <pid datatype="int" operation="greater than">0</pid>
+    </process58_object>
+    <process58_object version="1" id="oval:1:obj:3" xmlns="http://oval.mitre.org/XMLSchema/oval-definitions-5#unix">
+      <command_line>${COMMAND_LINE} no such process</command_line>
+      <pid datatype="int" operation="greater than">0</pid>
+    </process58_object>
+  </objects>
+
+</oval_definitions>
+EOF
@@ -0,0 +1,40 @@
+#!/usr/bin/env bash
+
+# The file lists of packages are read from the rpmdb only for the packages
+# whose filepaths are collected.
+
+. $builddir/tests/test_common.sh
+. $srcdir/../rpm_common.sh
+
+set -e -o pipefail
+
+function test_probes_rpminfo_filepaths {
+    probecheck "rpminfo" || return 255
+    require "rpm" || return 255
+
+    local name=test_probes_rpminfo_filepaths_offline
+    local result=$(mktemp ${name}.out.XXXXXX)
+    local log=$(mktemp ${name}.log.XXXXXX)
+
+    $OSCAP --verbose DEVEL --verbose-log-file $log oval eval --results $result $srcdir/$name.xml
+
+    assert_exists 1 '/oval_results/results/system/definitions/definition[@result="true"]'
+    assert_exists 1 '/oval_results/results/system/oval_system_characteristics/system_data/lin-sys:rpminfo_item[lin-sys:name="foo"]/lin-sys:filepath[contains(text(), "/etc/foo")]'
+    assert_exists 0 '/oval_results/results/system/oval_system_characteristics/system_data/lin-sys:rpminfo_item[lin-sys:name="foobar"]/lin-sys:filepath'
+    grep -q "files of package foo-[0-9:]*1.0-1.noarch" $log || return 1
+    if grep -q "files of package foobar-" $log ; then
+        return 1
+    fi
+
+    rm -f $result $log
+}
+
+test_init
+
+rpm_prepare_offline
+
+test_run "rpminfo probe reads file lists on demand (offline)" test_probes_rpminfo_filepaths
+
+rpm_cleanup_offline
+
+test_exit
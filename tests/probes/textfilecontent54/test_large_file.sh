@@ -0,0 +1,49 @@
+#!/usr/bin/env bash
+
+# Matches a file that is much bigger than the block the probe reads it in,
+# with a line longer than the block, to check that no match is lost or
+# duplicated at the block boundaries. Patterns with \s are matched one
+# line at a time.
+
+. $builddir/tests/test_common.sh
+
+set -e -o pipefail
+
+name=$(basename $0 .sh)
+tmpdir=$(make_temp_dir /tmp ${name})
+tpl=${srcdir}/${name}.xml.tpl
+input=${tmpdir}/${name}.xml
+result=${tmpdir}/${name}.results.xml
+log=${tmpdir}/${name}.log
+echo "Temp dir: $tmpdir"
+
+# prepare the environment
+sed "s@%PATH%@${tmpdir}@" $tpl > $input
+awk 'BEGIN {
+	for (i = 1; i <= 3000; i++) {
+		printf "key_%d = on\n", i
+		if (i % 10 == 0)
+			printf "\n"
+		if (i % 100 == 0)
+			printf "  Key\tvalue_%d\n", i
+		if (i == 1500) {
+			for (s = "a"; length(s) < 200000; s = s s)
+				;
+			print substr(s, 1, 200000) "b"
+		}
+	}
+}' > "${tmpdir}/large"
+
+echo "Evaluating content."
+$OSCAP --verbose DEVEL --verbose-log-file $log oval eval --results $result $input
+echo "Testing collected items."
+objects='/oval_results/results/system/oval_system_characteristics/collected_objects'
+[ "$($XPATH $result "count(${objects}/object[@id=\"oval:x:obj:1\"]/reference)")" == "3000" ]
+[ "$($XPATH $result "count(${objects}/object[@id=\"oval:x:obj:2\"]/reference)")" == "1" ]
+[ "$($XPATH $result "count(${objects}/object[@id=\"oval:x:obj:3\"]/reference)")" == "1" ]
+[ "$($XPATH $result "count(${objects}/object[@id=\"oval:x:obj:4\"]/reference)")" == "1" ]
+[ "$($XPATH $result "count(${objects}/object[@id=\"oval:x:obj:5\"]/reference)")" == "300" ]
+[ "$($XPATH $result "count(${objects}/object[@id=\"oval:x:obj:6\"]/reference)")" == "30" ]
+grep -F "Pattern '^\s*Key\s+(\S+)' is matched one line at a time." $log
+
+rm -rf $tmpdir
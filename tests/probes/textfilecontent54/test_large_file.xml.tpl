@@ -0,0 +1,78 @@
+<?xml version="1.0"?>
+<oval_definitions xmlns:oval-def="http://oval.mitre.org/XMLSchema/oval-definitions-5" xmlns:oval="http://oval.mitre.org/XMLSchema/oval-common-5" xmlns:xsi="http://www.w3.org/2001/XMLSchema-instance" xmlns:ind-def="http://oval.mitre.org/XMLSchema/oval-definitions-5#independent" xmlns:unix-def="http://oval.mitre.org/XMLSchema/oval-definitions-5#unix" xmlns:lin-def="http://oval.mitre.org/XMLSchema/oval-definitions-5#linux" xmlns="http://oval.mitre.org/XMLSchema/oval-definitions-5" xsi:schemaLocation="http://oval.mitre.org/XMLSchema/oval-definitions-5#unix unix-definitions-schema.xsd http://oval.mitre.org/XMLSchema/oval-definitions-5#independent independent-definitions-schema.xsd http://oval.mitre.org/XMLSchema/oval-definitions-5#linux linux-definitions-schema.xsd http://oval.mitre.org/XMLSchema/oval-definitions-5 oval-definitions-schema.xsd http://oval.mitre.org/XMLSchema/oval-common-5 oval-common-schema.xsd">
+    <generator>
+        <oval:schema_version>5.11.1</oval:schema_version>
+        <oval:timestamp>0001-01-01T00:00:00+00:00</oval:timestamp>
+    </generator>
+
+    <definitions>
+        <definition class="compliance" version="1" id="oval:x:def:1">
+            <metadata>
+                <title>x</title>
+                <description>x</description>
+            </metadata>
+            <criteria comment="x">
+                <criterion test_ref="oval:x:tst:1"/>
+                <criterion test_ref="oval:x:tst:2"/>
+                <criterion test_ref="oval:x:tst:3"/>
+                <criterion test_ref="oval:x:tst:4"/>
+                <criterion test_ref="oval:x:tst:5"/>
+                <criterion test_ref="oval:x:tst:6"/>
+            </criteria>
+        </definition>
+    </definitions>
+
+    <tests>
+        <textfilecontent54_test id="oval:x:tst:1" check="all" comment="x" version="1" xmlns="http://oval.mitre.org/XMLSchema/oval-definitions-5#independent">
+            <object object_ref="oval:x:obj:1"/>
+        </textfilecontent54_test>
+        <textfilecontent54_test id="oval:x:tst:2" check="all" comment="x" version="1" xmlns="http://oval.mitre.org/XMLSchema/oval-definitions-5#independent">
+            <object object_ref="oval:x:obj:2"/>
+        </textfilecontent54_test>
+        <textfilecontent54_test id="oval:x:tst:3" check="all" comment="x" version="1" xmlns="http://oval.mitre.org/XMLSchema/oval-definitions-5#independent">
+            <object object_ref="oval:x:obj:3"/>
+        </textfilecontent54_test>
+        <textfilecontent54_test id="oval:x:tst:4" check="all" comment="x" version="1" xmlns="http://oval.mitre.org/XMLSchema/oval-definitions-5#independent">
+            <object object_ref="oval:x:obj:4"/>
+        </textfilecontent54_test>
+        <textfilecontent54_test id="oval:x:tst:5" check="all" comment="x" version="1" xmlns="http://oval.mitre.org/XMLSchema/oval-definitions-5#independent">
+            <object object_ref="oval:x:obj:5"/>
+        </textfilecontent54_test>
+        <textfilecontent54_test id="oval:x:tst:6" check="all" comment="x" version="1" xmlns="http://oval.mitre.org/XMLSchema/oval-definitions-5#independent">
+            <object object_ref="oval:x:obj:6"/>
+        </textfilecontent54_test>
+    </tests>
+
+    <objects>
+        <textfilecontent54_object id="oval:x:obj:1" version="1" xmlns="http://oval.mitre.org/XMLSchema/oval-definitions-5#independent">
+            <filepath>%PATH%/large</filepath>
+            <pattern operation="pattern match">^key_(\d+) = on$</pattern>
+            <instance datatype="int" operation="greater than or equal">1</instance>
+        </textfilecontent54_object>
+        <textfilecontent54_object id="oval:x:obj:2" version="1" xmlns="http://oval.mitre.org/XMLSchema/oval-definitions-5#independent">
+            <filepath>%PATH%/large</filepath>
+            <pattern operation="pattern match">^key_3000 = on$</pattern>
+            <instance datatype="int" operation="equals">1</instance>
+        </textfilecontent54_object>
+        <textfilecontent54_object id="oval:x:obj:3" version="1" xmlns="http://oval.mitre.org/XMLSchema/oval-definitions-5#independent">
+            <filepath>%PATH%/large</filepath>
+            <pattern operation="pattern match">^a+b$</pattern>
+            <instance datatype="int" operation="equals">1</instance>
+        </textfilecontent54_object>
+        <textfilecontent54_object id="oval:x:obj:4" version="1" xmlns="http://oval.mitre.org/XMLSchema/oval-definitions-5#independent">
+            <filepath>%PATH%/large</filepath>
+            <pattern operation="pattern match">key_1 = on\nkey_2 = on</pattern>
+            <instance datatype="int" operation="equals">1</instance>
+        </textfilecontent54_object>
+        <textfilecontent54_object id="oval:x:obj:5" version="1" xmlns="http://oval.mitre.org/XMLSchema/oval-definitions-5#independent">
+            <filepath>%PATH%/large</filepath>
+            <pattern operation="pattern match">^key_\d*0 = on$</pattern>
+            <instance datatype="int" operation="greater than or equal">1</instance>
+        </textfilecontent54_object>
+        <textfilecontent54_object id="oval:x:obj:6" version="1" xmlns="http://oval.mitre.org/XMLSchema/oval-definitions-5#independent">
+            <filepath>%PATH%/large</filepath>
+            <pattern operation="pattern match">^\s*Key\s+(\S+)</pattern>
+            <instance datatype="int" operation="greater than or equal">1</instance>
+        </textfilecontent54_object>
+    </objects>
+</oval_definitions>
@@ -0,0 +1,45 @@
+#!/usr/bin/env bash
+
+. $builddir/tests/test_common.sh
+
+# Objects without variable references are collected in batches before
+# the evaluation, the results have to be the same as if they were
+# collected one by one.
+function test_prefetch {
+
+    probecheck "textfilecontent54" || return 255
+
+    local ret_val=0;
+    local DF="${srcdir}/test_prefetch.xml"
+    local RF="results.xml"
+    local LOG="prefetch.log"
+
+    [ -f $RF ] && rm -f $RF
+
+    local FILE_A="/tmp/test_prefetch.tmp_file_a"
+    local FILE_B="/tmp/test_prefetch.tmp_file_b"
+    local FILE_C="/tmp/test_prefetch.tmp_file_c"
+
+    echo "key = value_a" > "$FILE_A"
+    echo "key = value_b" > "$FILE_B"
+    echo "key = value_c" > "$FILE_C"
+
+    $OSCAP --verbose INFO --verbose-log-file $LOG oval eval --results $RF $DF
+
+    if [ -f $RF ]; then
+	verify_results "tst" $DF $RF 8 && verify_results "def" $DF $RF 2
+	ret_val=$?
+    else
+	ret_val=1
+    fi
+
+    # obj:5 references a variable and is queried separately
+    grep -q "Prefetching 5 textfilecontent54 objects" $LOG || ret_val=1
+    grep -q "Prefetching 1 file objects" $LOG || ret_val=1
+
+    rm -f $FILE_A $FILE_B $FILE_C $LOG
+
+    return $ret_val
+}
+
+test_prefetch
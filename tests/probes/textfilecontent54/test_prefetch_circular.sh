@@ -0,0 +1,37 @@
+#!/usr/bin/env bash
+
+. $builddir/tests/test_common.sh
+
+# The objects of circular extend_definition chains are prefetched once,
+# the definitions themselves are reported as not evaluated.
+function test_prefetch_circular {
+
+    probecheck "textfilecontent54" || return 255
+
+    local ret_val=0;
+    local DF="${srcdir}/test_prefetch_circular.xml"
+    local STDOUT="$(mktemp)"
+    local STDERR="$(mktemp)"
+    local LOG="$(mktemp)"
+
+    local FILE_A="/tmp/test_prefetch_circular.tmp_file_a"
+    local FILE_B="/tmp/test_prefetch_circular.tmp_file_b"
+
+    echo "key = value_a" > "$FILE_A"
+    echo "key = value_b" > "$FILE_B"
+
+    $OSCAP --verbose INFO --verbose-log-file $LOG oval eval $DF > $STDOUT 2> $STDERR || ret_val=1
+
+    grep -q "Definition oval:0:def:1: not evaluated" $STDOUT || ret_val=1
+    grep -q "Definition oval:0:def:2: not evaluated" $STDOUT || ret_val=1
+    grep -q "Definition oval:0:def:3: not evaluated" $STDOUT || ret_val=1
+    grep -q "Definition oval:0:def:4: true" $STDOUT || ret_val=1
+    grep -q "Circular dependency in OVAL definition 'oval:0:def:3'\." $STDERR $LOG || ret_val=1
+    grep -q "Prefetching 2 textfilecontent54 objects" $LOG || ret_val=1
+
+    rm -f $FILE_A $FILE_B $STDOUT $STDERR $LOG
+
+    return $ret_val
+}
+
+test_prefetch_circular
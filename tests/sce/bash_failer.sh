@@ -0,0 +1,3 @@
+#!/usr/bin/env bash
+
+exit $XCCDF_RESULT_FAIL
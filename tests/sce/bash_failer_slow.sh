@@ -0,0 +1,6 @@
+#!/usr/bin/env bash
+
+# Failing check which takes a while, so that the checks evaluated
+# in parallel finish in different order than they are listed.
+sleep 0.5
+exit $XCCDF_RESULT_FAIL
@@ -0,0 +1,50 @@
+#!/usr/bin/env bash
+
+# Test that parallel evaluation of SCE checks gives the same results
+# as the serial one and that fixes are applied in the same order.
+
+. $builddir/tests/test_common.sh
+
+set -e -o pipefail
+
+function test_sce_jobs {
+
+    local xccdf_file=${srcdir}/$1
+    local serial=$(mktemp)
+    local parallel=$(mktemp)
+    local serial_out=$(mktemp)
+    local parallel_out=$(mktemp)
+
+    $OSCAP xccdf eval --results "$serial" "$xccdf_file" > $serial_out
+    $OSCAP xccdf eval --jobs 4 --results "$parallel" "$xccdf_file" > $parallel_out
+
+    sed -i -E 's/(start-time|end-time|time)="[^"]*"//g' $serial $parallel
+    diff $serial_out $parallel_out
+    diff $serial $parallel
+    [ "$(grep -c '<result>pass</result>' $parallel)" == "4" ]
+
+    rm -f $serial $parallel $serial_out $parallel_out
+}
+
+function test_sce_jobs_remediate {
+
+    local xccdf_file=${srcdir}/$1
+    local serial=$(mktemp)
+    local parallel=$(mktemp)
+
+    FIX_ORDER_LOG=$serial $OSCAP xccdf eval --remediate "$xccdf_file" || [ $? == 2 ]
+    FIX_ORDER_LOG=$parallel $OSCAP xccdf eval --jobs 4 --remediate "$xccdf_file" || [ $? == 2 ]
+
+    [ "$(cat $serial | tr '\n' ' ')" == "rule_1 rule_2 rule_3 rule_4 " ]
+    diff $serial $parallel
+
+    rm -f $serial $parallel
+}
+
+# Testing.
+test_init
+
+test_run "SCE parallel evaluation" test_sce_jobs test_sce_jobs.xccdf.xml
+test_run "SCE parallel evaluation with remediation" test_sce_jobs_remediate test_sce_jobs_remediate.xccdf.xml
+
+test_exit
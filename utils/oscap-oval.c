@@ -37,6 +37,7 @@
 #include <oval_variables.h>
 #include <ds_sds_session.h>
 #include <assert.h>
+#include <inttypes.h>
 #include <limits.h>
 #ifdef HAVE_GETOPT_H
 #include <getopt.h>
@@ -116,7 +117,8 @@ static struct oscap_module OVAL_EVAL = {
 	"                                   (only applicable for source data streams)\n"
 	"   --fetch-remote-resources      - Download remote content referenced by OVAL Definitions.\n"
 	"                                   (only applicable for source data streams)\n"
-	"   --local-files <dir>           - Use locally downloaded copies of remote resources stored in the given directory.\n",
+	"   --local-files <dir>           - Use locally downloaded copies of remote resources stored in the given directory.\n"
+	"   --stats                       - Print statistics of the probes which collected the objects.\n",
     .opt_parser = getopt_oval_eval,
     .func = app_evaluate_oval
 };
@@ -320,6 +322,84 @@ cleanup:
 	return ret;
 }
 
+static int probe_stats_cmp_time(const void *a, const void *b)
+{
+	uint64_t ta = oval_probe_stats_get_time(*(struct oval_probe_stats * const *) a);
+	uint64_t tb = oval_probe_stats_get_time(*(struct oval_probe_stats * const *) b);
+
+	return (ta < tb) - (ta > tb);
+}
+
+static void format_probe_stats_time(char *buf, size_t size, uint64_t us)
+{
+	if (us >= 1000000)
+		snprintf(buf, size, "%"PRIu64"s", us / 1000000);
+	else if (us >= 1000)
+		snprintf(buf, size, "%"PRIu64"ms", us / 1000);
+	else
+		snprintf(buf, size, "%"PRIu64"us", us);
+}
+
+/* Print the probe counters, the probes which took the most time first */
+static void print_probe_stats(struct oval_probe_session *psess)
+{
+	if (psess == NULL)
+		return;
+
+	struct oval_probe_stats **stats = NULL;
+	size_t count = 0;
+	struct oval_probe_stats_iterator *it = oval_probe_session_get_stats(psess);
+	while (oval_probe_stats_iterator_has_more(it)) {
+		struct oval_probe_stats **tmp = realloc(stats, (count + 1) * sizeof(struct oval_probe_stats *));
+		if (tmp == NULL)
+			break;
+		stats = tmp;
+		stats[count++] = oval_probe_stats_iterator_next(it);
+	}
+	oval_probe_stats_iterator_free(it);
+	qsort(stats, count, sizeof(struct oval_probe_stats *), probe_stats_cmp_time);
+
+	printf("\nProbe statistics:\n");
+	printf("%-26s %8s %8s %9s %9s %12s %12s %10s\n", "Probe", "Queries", "Cached",
+	       "Collected", "Items", "Sent [B]", "Received [B]", "Time [ms]");
+	for (size_t i = 0; i < count; ++i) {
+		printf("%-26s %8"PRIu64" %8"PRIu64" %9"PRIu64" %9"PRIu64" %12"PRIu64" %12"PRIu64" %10.3f\n",
+		       oval_subtype_get_text(oval_probe_stats_get_subtype(stats[i])),
+		       oval_probe_stats_get_queries(stats[i]),
+		       oval_probe_stats_get_cache_hits(stats[i]),
+		       oval_probe_stats_get_collected(stats[i]),
+		       oval_probe_stats_get_items(stats[i]),
+		       oval_probe_stats_get_bytes_sent(stats[i]),
+		       oval_probe_stats_get_bytes_received(stats[i]),
+		       oval_probe_stats_get_time(stats[i]) / 1000.0);
+	}
+
+	printf("\nCollection latency:\n");
+	printf("%-26s", "Probe");
+	for (unsigned int b = 0; b < OVAL_PROBE_STATS_HISTOGRAM_SIZE; ++b) {
+		char label[24], bound[16];
+		if (b + 1 < OVAL_PROBE_STATS_HISTOGRAM_SIZE) {
+			format_probe_stats_time(bound, sizeof(bound), oval_probe_stats_histogram_bound(b));
+			snprintf(label, sizeof(label), "<=%s", bound);
+		} else {
+			format_probe_stats_time(bound, sizeof(bound), oval_probe_stats_histogram_bound(b - 1));
+			snprintf(label, sizeof(label), ">%s", bound);
+		}
+		printf(" %8s", label);
+	}
+	printf("  Slowest object\n");
+	for (size_t i = 0; i < count; ++i) {
+		if (oval_probe_stats_get_collected(stats[i]) == 0)
+			continue;
+		printf("%-26s", oval_subtype_get_text(oval_probe_stats_get_subtype(stats[i])));
+		for (unsigned int b = 0; b < OVAL_PROBE_STATS_HISTOGRAM_SIZE; ++b)
+			printf(" %8"PRIu64, oval_probe_stats_get_histogram(stats[i], b));
+		printf("  %s (%.3f ms)\n", oval_probe_stats_get_slowest_object(stats[i]),
+		       oval_probe_stats_get_slowest_time(stats[i]) / 1000.0);
+	}
+	free(stats);
+}
+
 int app_evaluate_oval(const struct oscap_action *action)
 {
 	struct oval_session *session = NULL;
@@ -363,6 +443,9 @@ int app_evaluate_oval(const struct oscap_action *action)
 
 	printf("Evaluation done.\n");
 
+	if (action->probe_stats)
+		print_probe_stats(oval_session_get_probe_session(session));
+
 	oval_session_set_directives(session, action->f_directives);
 	oval_session_set_results_export(session, action->f_results);
 	oval_session_set_report_export(session, action->f_report);
@@ -523,6 +606,7 @@ bool getopt_oval_eval(int argc, char **argv, struct oscap_action *action)
 		{ "skip-validation",	no_argument, &action->validate, 0 },
 		{ "fetch-remote-resources", no_argument, &action->remote_resources, 1},
 		{ "local-files", required_argument, NULL, OVAL_OPT_LOCAL_FILES},
+		{ "stats",	no_argument, &action->probe_stats, 1},
 		{ 0, 0, 0, 0 }
 	};
 
@@ -167,7 +167,9 @@ struct oscap_action {
 	int progress;
 	int oval_results;
 	int without_sys_chars;
+	int probe_stats;
 	int thin_results;
+	unsigned int jobs;
 	int remediate;
 	char *sce_template;
 	int check_engine_results;
@@ -187,7 +187,9 @@ static struct oscap_module XCCDF_EVAL = {
 		"                                   (only applicable for source data streams)\n"
 		"                                   (only applicable when datastream-id AND xccdf-id are not specified)\n"
 		"   --remediate                   - Automatically execute XCCDF fix elements for failed rules.\n"
-		"                                   Use of this option is always at your own risk.\n",
+		"                                   Use of this option is always at your own risk.\n"
+		"   --jobs <n>                    - Evaluate SCE checks of rules using n threads. OVAL checks are\n"
+		"                                   evaluated serially. Results are the same as with serial evaluation.\n",
     .opt_parser = getopt_xccdf,
     .func = app_evaluate_xccdf
 };
@@ -665,6 +667,8 @@ int app_evaluate_xccdf(const struct oscap_action *action)
 		xccdf_session_set_thin_results(session, true);
 		xccdf_session_set_without_sys_chars_export(session, true);
 	}
+	if (action->jobs > 1)
+		xccdf_session_set_jobs(session, action->jobs);
 	if (xccdf_session_is_sds(session)) {
 		xccdf_session_set_datastream_id(session, action->f_datastream_id);
 		xccdf_session_set_component_id(session, action->f_xccdf_id);
@@ -1276,7 +1280,8 @@ enum oval_opt {
     XCCDF_OPT_RESULT_ID = 'i',
 	XCCDF_OPT_FIX_TYPE,
 	XCCDF_OPT_LOCAL_FILES,
-	XCCDF_OPT_REFERENCE
+	XCCDF_OPT_REFERENCE,
+	XCCDF_OPT_JOBS
 };
 
 bool getopt_xccdf(int argc, char **argv, struct oscap_action *action)
@@ -1311,6 +1316,7 @@ bool getopt_xccdf(int argc, char **argv, struct oscap_action *action)
 		{"fix-type", required_argument, NULL, XCCDF_OPT_FIX_TYPE},
 		{"local-files", required_argument, NULL, XCCDF_OPT_LOCAL_FILES},
 		{"reference", required_argument, NULL, XCCDF_OPT_REFERENCE},
+		{"jobs", required_argument, NULL, XCCDF_OPT_JOBS},
 	// flags
 		{"force",		no_argument, &action->force, 1},
 		{"oval-results",	no_argument, &action->oval_results, 1},
@@ -1377,6 +1383,10 @@ bool getopt_xccdf(int argc, char **argv, struct oscap_action *action)
 		case XCCDF_OPT_REFERENCE:
 			action->reference = optarg;
 			break;
+		case XCCDF_OPT_JOBS:
+			if (sscanf(optarg, "%u", &action->jobs) != 1 || action->jobs == 0)
+				return oscap_module_usage(action->module, stderr, "The --jobs option requires a positive number.");
+			break;
 		case 0: break;
 		default: return oscap_module_usage(action->module, stderr, NULL);
 		}